@@ -232,6 +232,12 @@ void DiscardSystemPages(void* address, size_t length) {
   DiscardSystemPagesInternal(address, length);
 }
 
+bool MarkSystemPagesMergeable(void* address, size_t length) {
+  PA_DCHECK(!(reinterpret_cast<uintptr_t>(address) & SystemPageOffsetMask()));
+  PA_DCHECK(!(length & SystemPageOffsetMask()));
+  return MarkSystemPagesMergeableInternal(address, length);
+}
+
 bool ReserveAddressSpace(size_t size) {
   // To avoid deadlock, call only SystemAllocPages.
   AutoLock guard(GetReserveLock());
@@ -149,6 +149,17 @@ BASE_EXPORT WARN_UNUSED_RESULT bool RecommitSystemPages(
 // based on the original page content, or a page of zeroes.
 BASE_EXPORT void DiscardSystemPages(void* address, size_t length);
 
+// Hints the operating system that the pages in the range may be deduplicated
+// against identical pages, in this or other processes, e.g. by Linux's kernel
+// same-page merging (KSM). Merged pages are copied again on the next write,
+// so this is only worth it for memory that is rarely written after it has
+// been filled.
+//
+// |address| and |length| must be aligned to the system page size. Returns
+// true if the hint was accepted, false if the platform or kernel doesn't
+// support page merging.
+BASE_EXPORT bool MarkSystemPagesMergeable(void* address, size_t length);
+
 // Rounds up |address| to the next multiple of |SystemPageSize()|. Returns
 // 0 for an |address| of 0.
 PAGE_ALLOCATOR_CONSTANTS_DECLARE_CONSTEXPR ALWAYS_INLINE uintptr_t
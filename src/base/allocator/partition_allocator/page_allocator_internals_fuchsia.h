@@ -198,6 +198,10 @@ bool RecommitSystemPagesInternal(void* address,
   return true;
 }
 
+bool MarkSystemPagesMergeableInternal(void* address, size_t length) {
+  return false;
+}
+
 }  // namespace base
 
 #endif  // BASE_ALLOCATOR_PARTITION_ALLOCATOR_PAGE_ALLOCATOR_INTERNALS_FUCHSIA_H_
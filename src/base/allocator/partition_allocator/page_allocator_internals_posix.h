@@ -239,6 +239,16 @@ void DiscardSystemPagesInternal(void* address, size_t length) {
 #endif
 }
 
+bool MarkSystemPagesMergeableInternal(void* address, size_t length) {
+#if (defined(OS_LINUX) || defined(OS_CHROMEOS) || defined(OS_ANDROID)) && \
+    defined(MADV_MERGEABLE)
+  // Fails with EINVAL on kernels built without CONFIG_KSM.
+  return !madvise(address, length, MADV_MERGEABLE);
+#else
+  return false;
+#endif
+}
+
 }  // namespace base
 
 #endif  // BASE_ALLOCATOR_PARTITION_ALLOCATOR_PAGE_ALLOCATOR_INTERNALS_POSIX_H_
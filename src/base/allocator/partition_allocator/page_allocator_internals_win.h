@@ -140,6 +140,10 @@ void DiscardSystemPagesInternal(void* address, size_t length) {
   }
 }
 
+bool MarkSystemPagesMergeableInternal(void* address, size_t length) {
+  return false;
+}
+
 }  // namespace base
 
 #endif  // BASE_ALLOCATOR_PARTITION_ALLOCATOR_PAGE_ALLOCATOR_INTERNALS_WIN_H_
@@ -272,6 +272,8 @@ void PartitionRoot<thread_safe>::Init(PartitionOptions opts) {
   // If alignment needs to be enforced, disallow adding cookies and/or tags at
   // the beginning of the slot.
   allow_extras = (opts.alignment != PartitionOptions::Alignment::kAlignedAlloc);
+  allow_page_merging =
+      (opts.page_merging == PartitionOptions::PageMerging::kEnabled);
 
   // We mark the sentinel bucket/page as free to make sure it is skipped by our
   // logic to find a new active page.
@@ -802,6 +804,7 @@ void PartitionRoot<thread_safe>::DumpStats(const char* partition_name,
     stats.total_mmapped_bytes =
         total_size_of_super_pages + total_size_of_direct_mapped_pages;
     stats.total_committed_bytes = total_size_of_committed_pages;
+    stats.total_mergeable_bytes = total_size_of_mergeable_pages;
 
     size_t direct_mapped_allocations_total_size = 0;
     for (size_t i = 0; i < kNumBuckets; ++i) {
@@ -241,6 +241,7 @@ struct PartitionMemoryStats {
   size_t total_active_bytes;     // Total active bytes in the partition.
   size_t total_decommittable_bytes;  // Total bytes that could be decommitted.
   size_t total_discardable_bytes;    // Total bytes that could be discarded.
+  size_t total_mergeable_bytes;  // Total bytes offered for page merging.
 
   bool has_thread_cache;
   internal::ThreadCacheStats current_thread_cache_stats;
@@ -389,8 +390,20 @@ struct PartitionOptions {
     kEnabled,
   };
 
+  enum class PageMerging {
+    kDisabled,
+
+    // Offers the partition's super pages to the kernel for same-page merging
+    // (KSM on Linux), so that pages with identical content in several
+    // processes can share physical memory. Only suitable for partitions whose
+    // memory is rarely written after being filled, since writing to a merged
+    // page takes a copy-on-write fault.
+    kEnabled,
+  };
+
   Alignment alignment = Alignment::kRegular;
   ThreadCache thread_cache = ThreadCache::kDisabled;
+  PageMerging page_merging = PageMerging::kDisabled;
 };
 
 // Never instantiate a PartitionRoot directly, instead use
@@ -414,6 +427,7 @@ struct BASE_EXPORT PartitionRoot {
   // size instead of having an if branch on the hot paths.
   bool allow_extras;
   bool initialized = false;
+  bool allow_page_merging = false;
 
 #if ENABLE_TAG_FOR_CHECKED_PTR2 || ENABLE_TAG_FOR_MTE_CHECKED_PTR
   internal::PartitionTag current_partition_tag = 0;
@@ -429,6 +443,9 @@ struct BASE_EXPORT PartitionRoot {
   size_t total_size_of_committed_pages GUARDED_BY(lock_) = 0;
   size_t total_size_of_super_pages GUARDED_BY(lock_) = 0;
   size_t total_size_of_direct_mapped_pages GUARDED_BY(lock_) = 0;
+  // Bytes of super page slot span areas for which the page merging hint was
+  // accepted.
+  size_t total_size_of_mergeable_pages GUARDED_BY(lock_) = 0;
 
   char* next_super_page = nullptr;
   char* next_partition_page = nullptr;
@@ -361,6 +361,7 @@ class MockPartitionStatsDumper : public PartitionStatsDumper {
     EXPECT_EQ(total_active_bytes, stats->total_active_bytes);
     EXPECT_EQ(total_decommittable_bytes, stats->total_decommittable_bytes);
     EXPECT_EQ(total_discardable_bytes, stats->total_discardable_bytes);
+    total_mergeable_bytes = stats->total_mergeable_bytes;
   }
 
   void PartitionsDumpBucketStats(
@@ -380,6 +381,8 @@ class MockPartitionStatsDumper : public PartitionStatsDumper {
     return total_resident_bytes != 0 && total_active_bytes != 0;
   }
 
+  size_t GetMergeableBytes() const { return total_mergeable_bytes; }
+
   const PartitionBucketMemoryStats* GetBucketStats(size_t bucket_size) {
     for (size_t i = 0; i < bucket_stats.size(); ++i) {
       if (bucket_stats[i].bucket_slot_size == bucket_size)
@@ -393,6 +396,7 @@ class MockPartitionStatsDumper : public PartitionStatsDumper {
   size_t total_active_bytes;
   size_t total_decommittable_bytes;
   size_t total_discardable_bytes;
+  size_t total_mergeable_bytes = 0;
 
   std::vector<PartitionBucketMemoryStats> bucket_stats;
 };
@@ -1617,6 +1621,46 @@ TEST_F(PartitionAllocDeathTest, GuardPages) {
 
 #endif  // !defined(OS_ANDROID) && !defined(OS_IOS)
 
+// Tests that the slot span areas of super pages of partitions that opt into
+// page merging are offered to the kernel and reported in the memory stats.
+TEST_F(PartitionAllocTest, PageMergingStats) {
+  // Find out whether the platform accepts the hint at all.
+  void* probe = AllocPages(nullptr, PageAllocationGranularity(),
+                           PageAllocationGranularity(), PageReadWrite,
+                           PageTag::kChromium);
+  ASSERT_TRUE(probe);
+  const bool merging_supported =
+      MarkSystemPagesMergeable(probe, PageAllocationGranularity());
+  FreePages(probe, PageAllocationGranularity());
+
+  PartitionAllocator<base::internal::ThreadSafe> merging_allocator;
+  merging_allocator.init({PartitionOptions::Alignment::kRegular,
+                          PartitionOptions::ThreadCache::kDisabled,
+                          PartitionOptions::PageMerging::kEnabled});
+  void* ptr = merging_allocator.root()->Alloc(kTestAllocSize, type_name);
+  void* other_ptr = allocator.root()->Alloc(kTestAllocSize, type_name);
+
+  {
+    MockPartitionStatsDumper dumper;
+    merging_allocator.root()->DumpStats("mock_allocator",
+                                        false /* detailed dump */, &dumper);
+    // The guard partition pages and the tag bitmap are not offered.
+    const size_t slot_span_area_size =
+        kSuperPageSize - 2 * PartitionPageSize() - kReservedTagBitmapSize;
+    EXPECT_EQ(merging_supported ? slot_span_area_size : 0u,
+              dumper.GetMergeableBytes());
+  }
+  {
+    MockPartitionStatsDumper dumper;
+    allocator.root()->DumpStats("mock_allocator", false /* detailed dump */,
+                                &dumper);
+    EXPECT_EQ(0u, dumper.GetMergeableBytes());
+  }
+
+  merging_allocator.root()->Free(ptr);
+  allocator.root()->Free(other_ptr);
+}
+
 // Tests that |PartitionDumpStats| and |PartitionDumpStats| run without
 // crashing and return non-zero values when memory is allocated.
 TEST_F(PartitionAllocTest, DumpMemoryStats) {
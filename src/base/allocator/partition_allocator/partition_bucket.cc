@@ -295,6 +295,13 @@ ALWAYS_INLINE void* PartitionBucket<thread_safe>::AllocNewSlotSpan(
   char* ret = tag_bitmap + kReservedTagBitmapSize;
   root->next_partition_page = ret + total_size;
   root->next_partition_page_end = root->next_super_page - PartitionPageSize();
+  // Only the slot span area holds allocations worth merging. The guard
+  // pages, metadata and tag bitmap are left alone.
+  if (root->allow_page_merging) {
+    size_t slot_span_area_size = root->next_partition_page_end - ret;
+    if (MarkSystemPagesMergeable(ret, slot_span_area_size))
+      root->total_size_of_mergeable_pages += slot_span_area_size;
+  }
   // Make the first partition page in the super page a guard page, but leave a
   // hole in the middle.
   // This is where we put page metadata and also a tiny amount of extent
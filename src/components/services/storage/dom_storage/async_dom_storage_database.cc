@@ -111,6 +111,23 @@ void AsyncDomStorageDatabase::RewriteDB(StatusCallback callback) {
           std::move(callback), base::SequencedTaskRunnerHandle::Get()));
 }
 
+void AsyncDomStorageDatabase::CompactNextRange(
+    CompactNextRangeCallback callback) {
+  DCHECK(database_);
+  database_.PostTaskWithThisObject(
+      FROM_HERE,
+      base::BindOnce(
+          [](CompactNextRangeCallback callback,
+             scoped_refptr<base::SequencedTaskRunner> callback_task_runner,
+             DomStorageDatabase* db) {
+            bool done = true;
+            leveldb::Status status = db->CompactNextRange(&done);
+            callback_task_runner->PostTask(
+                FROM_HERE, base::BindOnce(std::move(callback), status, done));
+          },
+          std::move(callback), base::SequencedTaskRunnerHandle::Get()));
+}
+
 void AsyncDomStorageDatabase::Get(const std::vector<uint8_t>& key,
                                   GetCallback callback) {
   struct GetResult {
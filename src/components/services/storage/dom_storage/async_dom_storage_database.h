@@ -65,6 +65,12 @@ class AsyncDomStorageDatabase {
 
   void RewriteDB(StatusCallback callback);
 
+  // Compacts the next key range of the database. |callback| receives whether
+  // the whole database has now been compacted.
+  using CompactNextRangeCallback =
+      base::OnceCallback<void(leveldb::Status status, bool done)>;
+  void CompactNextRange(CompactNextRangeCallback callback);
+
   using GetCallback = base::OnceCallback<void(leveldb::Status status,
                                               const std::vector<uint8_t>&)>;
   void Get(const std::vector<uint8_t>& key, GetCallback callback);
@@ -349,12 +349,29 @@ DomStorageDatabase::Status DomStorageDatabase::Commit(
 DomStorageDatabase::Status DomStorageDatabase::RewriteDB() {
   if (!db_)
     return Status::IOError(kInvalidDatabaseMessage);
+  compactor_.reset();
   Status status = leveldb_env::RewriteDB(options_, name_, &db_);
   if (!status.ok())
     db_.reset();
   return status;
 }
 
+DomStorageDatabase::Status DomStorageDatabase::CompactNextRange(bool* done) {
+  DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+  *done = true;
+  if (!db_)
+    return Status::IOError(kInvalidDatabaseMessage);
+  if (!compactor_)
+    compactor_ = std::make_unique<LevelDBIncrementalCompactor>(db_.get());
+  if (!compactor_->CompactNextRange()) {
+    *done = false;
+    return Status::OK();
+  }
+  compactor_->RecordMetrics("DOMStorage.IncrementalCompaction");
+  compactor_.reset();
+  return Status::OK();
+}
+
 bool DomStorageDatabase::OnMemoryDump(
     const base::trace_event::MemoryDumpArgs& args,
     base::trace_event::ProcessMemoryDump* pmd) {
@@ -22,6 +22,7 @@
 #include "base/threading/sequence_bound.h"
 #include "base/trace_event/memory_allocator_dump_guid.h"
 #include "base/trace_event/memory_dump_provider.h"
+#include "components/services/storage/leveldb_incremental_compactor.h"
 #include "third_party/leveldatabase/env_chromium.h"
 #include "third_party/leveldatabase/src/include/leveldb/db.h"
 #include "third_party/leveldatabase/src/include/leveldb/env.h"
@@ -146,6 +147,12 @@ class DomStorageDatabase : private base::trace_event::MemoryDumpProvider {
   // usable; in such cases, all future operations will return an IOError status.
   Status RewriteDB();
 
+  // Compacts the next key range of the database. Successive calls walk the
+  // whole key space, each blocking the database sequence for only a short
+  // time; |*done| is set once a pass is complete, after which the next call
+  // starts a new pass.
+  Status CompactNextRange(bool* done);
+
   void SetDestructionCallbackForTesting(base::OnceClosure callback) {
     destruction_callback_ = std::move(callback);
   }
@@ -200,6 +207,10 @@ class DomStorageDatabase : private base::trace_event::MemoryDumpProvider {
       memory_dump_id_;
   std::unique_ptr<leveldb::DB> db_;
 
+  // The in-progress |CompactNextRange()| pass, if any. Must be destroyed
+  // before |db_|.
+  std::unique_ptr<LevelDBIncrementalCompactor> compactor_;
+
   // Causes all calls to |Commit()| to fail with an IOError for simulated
   // disk failures in testing.
   bool fail_commits_for_testing_ = false;
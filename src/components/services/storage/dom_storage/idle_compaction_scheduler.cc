@@ -0,0 +1,97 @@
+// Copyright 2020 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "components/services/storage/dom_storage/idle_compaction_scheduler.h"
+
+#include "base/bind.h"
+#include "base/location.h"
+#include "base/memory/memory_pressure_monitor.h"
+#include "base/threading/sequenced_task_runner_handle.h"
+#include "components/services/storage/dom_storage/async_dom_storage_database.h"
+
+namespace storage {
+
+namespace {
+
+// After this many successful commits the database is compacted incrementally,
+// once no commit has happened for |kIdleCompactionDelay|.
+const int kCommitsBeforeIdleCompaction = 1000;
+constexpr base::TimeDelta kIdleCompactionDelay =
+    base::TimeDelta::FromSeconds(30);
+
+}  // namespace
+
+IdleCompactionScheduler::IdleCompactionScheduler()
+    : commits_before_compaction_(kCommitsBeforeIdleCompaction) {}
+
+IdleCompactionScheduler::~IdleCompactionScheduler() = default;
+
+void IdleCompactionScheduler::SetDatabase(AsyncDomStorageDatabase* database) {
+  database_ = database;
+  commits_since_compaction_ = 0;
+  step_in_flight_ = false;
+  timer_.Stop();
+  // A step in flight belongs to the previous database.
+  weak_ptr_factory_.InvalidateWeakPtrs();
+}
+
+void IdleCompactionScheduler::OnCommit() {
+  if (!database_)
+    return;
+  // Restarting the timer on every commit means compaction only starts, or
+  // resumes, once the database has been idle for |kIdleCompactionDelay|.
+  if (++commits_since_compaction_ >= commits_before_compaction_) {
+    timer_.Start(FROM_HERE, kIdleCompactionDelay, this,
+                 &IdleCompactionScheduler::CompactNextRangeIfIdle);
+  }
+}
+
+bool IdleCompactionScheduler::RunForTesting() {
+  if (!timer_.IsRunning())
+    return false;
+  timer_.FireNow();
+  return true;
+}
+
+void IdleCompactionScheduler::CompactNextRangeIfIdle() {
+  if (!database_ || step_in_flight_)
+    return;
+
+  // Compaction is deferrable work that churns memory and disk; don't add to
+  // an already loaded system.
+  auto* memory_pressure_monitor = base::MemoryPressureMonitor::Get();
+  if (memory_pressure_monitor &&
+      memory_pressure_monitor->GetCurrentPressureLevel() !=
+          base::MemoryPressureListener::MEMORY_PRESSURE_LEVEL_NONE) {
+    timer_.Start(FROM_HERE, kIdleCompactionDelay, this,
+                 &IdleCompactionScheduler::CompactNextRangeIfIdle);
+    return;
+  }
+
+  step_in_flight_ = true;
+  database_->CompactNextRange(
+      base::BindOnce(&IdleCompactionScheduler::OnCompactedRange,
+                     weak_ptr_factory_.GetWeakPtr()));
+}
+
+void IdleCompactionScheduler::OnCompactedRange(leveldb::Status status,
+                                               bool done) {
+  step_in_flight_ = false;
+  if (!status.ok() || done) {
+    commits_since_compaction_ = 0;
+    return;
+  }
+
+  // A commit came in while this step ran; the restarted timer resumes
+  // compaction once things are idle again.
+  if (timer_.IsRunning())
+    return;
+
+  base::SequencedTaskRunnerHandle::Get()->PostTask(
+      FROM_HERE,
+      base::BindOnce(&IdleCompactionScheduler::CompactNextRangeIfIdle,
+                     weak_ptr_factory_.GetWeakPtr()));
+}
+
+}  // namespace storage
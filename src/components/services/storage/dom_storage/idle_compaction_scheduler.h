@@ -0,0 +1,63 @@
+// Copyright 2020 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef COMPONENTS_SERVICES_STORAGE_DOM_STORAGE_IDLE_COMPACTION_SCHEDULER_H_
+#define COMPONENTS_SERVICES_STORAGE_DOM_STORAGE_IDLE_COMPACTION_SCHEDULER_H_
+
+#include "base/macros.h"
+#include "base/memory/weak_ptr.h"
+#include "base/timer/timer.h"
+#include "third_party/leveldatabase/src/include/leveldb/status.h"
+
+namespace storage {
+
+class AsyncDomStorageDatabase;
+
+// Compacts a DOM storage database incrementally once it has seen enough
+// commits and then gone idle. Each step compacts one key range; stepping stops
+// as soon as a new commit comes in and resumes after the next idle period.
+class IdleCompactionScheduler {
+ public:
+  IdleCompactionScheduler();
+  ~IdleCompactionScheduler();
+
+  // Sets the database to compact, which must outlive this object or be
+  // replaced first. Null stops compacting. Either way, the commits counted so
+  // far are forgotten.
+  void SetDatabase(AsyncDomStorageDatabase* database);
+
+  // Must be called for each successful commit to the database.
+  void OnCommit();
+
+  // Lowers the number of commits after which the database is compacted once
+  // idle.
+  void SetCommitsBeforeCompactionForTesting(int commits) {
+    commits_before_compaction_ = commits;
+  }
+
+  // Starts the pending compaction without waiting for the idle delay. Returns
+  // false if none is pending.
+  bool RunForTesting();
+
+ private:
+  void CompactNextRangeIfIdle();
+  void OnCompactedRange(leveldb::Status status, bool done);
+
+  AsyncDomStorageDatabase* database_ = nullptr;
+
+  // Successful commits since the database was last fully compacted, and the
+  // timer which starts compacting once commits have stopped for a while.
+  int commits_since_compaction_ = 0;
+  int commits_before_compaction_;
+  base::OneShotTimer timer_;
+  bool step_in_flight_ = false;
+
+  base::WeakPtrFactory<IdleCompactionScheduler> weak_ptr_factory_{this};
+
+  DISALLOW_COPY_AND_ASSIGN(IdleCompactionScheduler);
+};
+
+}  // namespace storage
+
+#endif  // COMPONENTS_SERVICES_STORAGE_DOM_STORAGE_IDLE_COMPACTION_SCHEDULER_H_
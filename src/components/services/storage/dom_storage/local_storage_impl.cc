@@ -30,6 +30,7 @@
 #include "base/task/post_task.h"
 #include "base/task/thread_pool.h"
 #include "base/task_runner_util.h"
+#include "base/threading/sequenced_task_runner_handle.h"
 #include "base/trace_event/memory_dump_manager.h"
 #include "build/build_config.h"
 #include "components/services/storage/dom_storage/async_dom_storage_database.h"
@@ -272,6 +273,19 @@ base::StringPiece GetTLD1DomainFromOrigin(const url::Origin& origin) {
     return base::StringPiece();
   return tld1_host;
 }
+
+// Returns every domain D for which url::DomainIs(|host|, D) holds and which
+// GetTLD1DomainFromOrigin() could return, i.e. |host| itself and each of its
+// dot-separated suffixes that still contains a dot.
+std::vector<base::StringPiece> GetUsageDomainsForHost(base::StringPiece host) {
+  std::vector<base::StringPiece> domains;
+  size_t pos = 0;
+  while (host.find('.', pos) != base::StringPiece::npos) {
+    domains.push_back(host.substr(pos));
+    pos = host.find('.', pos) + 1;
+  }
+  return domains;
+}
 #endif
 
 }  // namespace
@@ -296,6 +310,7 @@ class LocalStorageImpl::StorageAreaHolder final
     options.default_commit_delay = kCommitDefaultDelaySecs;
     options.max_bytes_per_hour = kMaxBytesPerHour;
     options.max_commits_per_hour = kMaxCommitsPerHour;
+    options.adaptive_commit_delay = true;
 #if defined(OS_ANDROID)
     options.cache_mode = StorageAreaImpl::CacheMode::KEYS_ONLY_WHEN_POSSIBLE;
 #else
@@ -332,6 +347,11 @@ class LocalStorageImpl::StorageAreaHolder final
       context_->database_initialized_ = true;
     }
 
+#if defined(USE_NEVA_APPRUNTIME)
+    context_->UpdateOriginUsage(
+        origin_, storage_area()->empty() ? 0 : storage_area()->storage_used());
+#endif
+
     DomStorageDatabase::Key metadata_key = CreateMetaDataKey(origin_);
     if (storage_area()->empty()) {
       extra_keys_to_delete->push_back(std::move(metadata_key));
@@ -444,48 +464,6 @@ class LocalStorageImpl::StorageAreaHolder final
 
   bool has_bindings() const { return has_bindings_; }
 
-#if defined(USE_NEVA_APPRUNTIME)
-  void OnGotMetaDataForOrigin(
-      GetUsageCallback callback,
-      std::vector<DomStorageDatabase::KeyValuePair> data) {
-    std::vector<mojom::LocalStorageUsageInfoPtr> result;
-    size_t total_size = 0;
-    for (const auto& row : data) {
-      base::Optional<url::Origin> origin =
-          ExtractOriginFromMetaDataKey(row.key);
-      if (!origin) {
-        continue;
-      }
-
-      if (!origin->IsSameOriginWith(origin_) &&
-          !origin->DomainIs(GetTLD1DomainFromOrigin(origin_))) {
-        continue;
-      }
-
-      storage::LocalStorageOriginMetaData row_data;
-      if (!row_data.ParseFromArray(row.value.data(), row.value.size())) {
-        continue;
-      }
-
-      result.push_back(mojom::LocalStorageUsageInfo::New(
-          *origin, row_data.size_bytes(),
-          base::Time::FromInternalValue(row_data.last_modified())));
-
-      total_size += row_data.size_bytes();
-    }
-
-    if (total_size > context_->storage_size_limit_)
-      std::move(callback).Run(std::move(result));
-  }
-
-  void PurgeStorageUsageForOrigin(
-      std::vector<mojom::LocalStorageUsageInfoPtr> usage) {
-    for (const auto& info : usage) {
-      context_->DeleteStorage(info->origin, base::DoNothing());
-    }
-  }
-#endif
-
  private:
   base::FilePath sql_db_path() const {
     if (context_->directory_.empty())
@@ -602,6 +580,9 @@ void LocalStorageImpl::DeleteStorage(const url::Origin& origin,
         base::BindOnce(&SuccessResponse, std::move(callback)));
     found->second->storage_area()->ScheduleImmediateCommit();
   } else if (database_) {
+#if defined(USE_NEVA_APPRUNTIME)
+    UpdateOriginUsage(origin, 0);
+#endif
     DeleteOrigins(
         database_.get(), {origin},
         base::BindOnce([](base::OnceClosure callback,
@@ -673,6 +654,7 @@ void LocalStorageImpl::ShutdownAndDelete() {
   }
 
   connection_state_ = CONNECTION_SHUTDOWN;
+  idle_compaction_.SetDatabase(nullptr);
 
   // Flush any uncommitted data.
   for (const auto& it : areas_) {
@@ -976,12 +958,20 @@ void LocalStorageImpl::OnConnectionFinished() {
   if (database_)
     tried_to_recreate_during_open_ = false;
 
+#if defined(USE_NEVA_APPRUNTIME)
+  if (database_ && storage_size_limit_ > 0 && !usage_index_loaded_) {
+    LoadUsageIndex();
+    return;
+  }
+#endif
+
   LogDatabaseOpenResult(OpenResult::SUCCESS);
   open_result_histogram_ = nullptr;
 
   // |database_| should be known to either be valid or invalid by now. Run our
   // delayed bindings.
   connection_state_ = CONNECTION_FINISHED;
+  idle_compaction_.SetDatabase(database_.get());
   for (size_t i = 0; i < on_database_opened_callbacks_.size(); ++i)
     std::move(on_database_opened_callbacks_[i]).Run();
   on_database_opened_callbacks_.clear();
@@ -998,6 +988,12 @@ void LocalStorageImpl::DeleteAndRecreateDatabase(const char* histogram_name) {
   // StorageAreas to be queued until the connection is complete.
   connection_state_ = CONNECTION_IN_PROGRESS;
   commit_error_count_ = 0;
+  idle_compaction_.SetDatabase(nullptr);
+#if defined(USE_NEVA_APPRUNTIME)
+  usage_index_loaded_ = false;
+  origin_usage_.clear();
+  domain_usage_.clear();
+#endif
   database_.reset();
   open_result_histogram_ = histogram_name;
 
@@ -1060,13 +1056,8 @@ LocalStorageImpl::StorageAreaHolder* LocalStorageImpl::GetOrCreateStorageArea(
   areas_[origin] = std::move(holder);
 
 #if defined(USE_NEVA_APPRUNTIME)
-  if (storage_size_limit_ > 0) {
-    RetrieveStorageUsageForOrigin(
-        base::BindOnce(
-            &LocalStorageImpl::StorageAreaHolder::PurgeStorageUsageForOrigin,
-            base::Unretained(holder_ptr)),
-        origin);
-  }
+  if (storage_size_limit_ > 0)
+    CheckStorageUsageForOrigin(origin);
 #endif
 
   return holder_ptr;
@@ -1115,19 +1106,100 @@ void LocalStorageImpl::RetrieveStorageUsage(GetUsageCallback callback) {
 }
 
 #if defined(USE_NEVA_APPRUNTIME)
-void LocalStorageImpl::RetrieveStorageUsageForOrigin(GetUsageCallback callback,
-                                                     url::Origin origin) {
-  if (!database_)
-    return;
+void LocalStorageImpl::LoadUsageIndex() {
   database_->RunDatabaseTask(
       base::BindOnce([](const DomStorageDatabase& db) {
         std::vector<DomStorageDatabase::KeyValuePair> data;
         db.GetPrefixed(base::make_span(kMetaPrefix), &data);
         return data;
       }),
-      base::BindOnce(
-          &LocalStorageImpl::StorageAreaHolder::OnGotMetaDataForOrigin,
-          base::Unretained(areas_[origin].get()), std::move(callback)));
+      base::BindOnce(&LocalStorageImpl::OnGotUsageIndex,
+                     weak_ptr_factory_.GetWeakPtr()));
+}
+
+void LocalStorageImpl::OnGotUsageIndex(
+    std::vector<DomStorageDatabase::KeyValuePair> data) {
+  DCHECK_EQ(connection_state_, CONNECTION_IN_PROGRESS);
+  origin_usage_.clear();
+  domain_usage_.clear();
+  usage_index_loaded_ = true;
+  for (const auto& row : data) {
+    base::Optional<url::Origin> origin = ExtractOriginFromMetaDataKey(row.key);
+    if (!origin)
+      continue;
+    storage::LocalStorageOriginMetaData row_data;
+    if (!row_data.ParseFromArray(row.value.data(), row.value.size()))
+      continue;
+    UpdateOriginUsage(*origin, row_data.size_bytes());
+  }
+  OnConnectionFinished();
+}
+
+void LocalStorageImpl::UpdateOriginUsage(const url::Origin& origin,
+                                         size_t size_bytes) {
+  if (!usage_index_loaded_)
+    return;
+
+  auto it = origin_usage_.find(origin);
+  size_t old_size_bytes = it == origin_usage_.end() ? 0 : it->second;
+  if (old_size_bytes == size_bytes)
+    return;
+
+  for (base::StringPiece domain : GetUsageDomainsForHost(origin.host())) {
+    auto domain_it = domain_usage_.emplace(domain.as_string(), 0).first;
+    domain_it->second = domain_it->second - old_size_bytes + size_bytes;
+    if (domain_it->second == 0)
+      domain_usage_.erase(domain_it);
+  }
+
+  if (size_bytes == 0)
+    origin_usage_.erase(it);
+  else if (it == origin_usage_.end())
+    origin_usage_.emplace(origin, size_bytes);
+  else
+    it->second = size_bytes;
+}
+
+void LocalStorageImpl::CheckStorageUsageForOrigin(const url::Origin& origin) {
+  if (!usage_index_loaded_)
+    return;
+
+  // Without a second-level domain only the origin itself counts.
+  const base::StringPiece domain = GetTLD1DomainFromOrigin(origin);
+  size_t total_size = 0;
+  if (domain.empty()) {
+    auto origin_it = origin_usage_.find(origin);
+    if (origin_it != origin_usage_.end())
+      total_size = origin_it->second;
+  } else {
+    auto domain_it = domain_usage_.find(domain.as_string());
+    if (domain_it != domain_usage_.end())
+      total_size = domain_it->second;
+  }
+  if (total_size <= storage_size_limit_)
+    return;
+
+  // Over the limit, which is rare, so a scan of all origins is fine here.
+  std::vector<url::Origin> origins_to_purge;
+  for (const auto& it : origin_usage_) {
+    if (it.first.IsSameOriginWith(origin) ||
+        (!domain.empty() && it.first.DomainIs(domain))) {
+      origins_to_purge.push_back(it.first);
+    }
+  }
+
+  // Purge asynchronously, as the area for |origin| is still being set up.
+  base::SequencedTaskRunnerHandle::Get()->PostTask(
+      FROM_HERE, base::BindOnce(
+                     [](base::WeakPtr<LocalStorageImpl> context,
+                        std::vector<url::Origin> origins) {
+                       if (!context)
+                         return;
+                       for (const auto& origin : origins)
+                         context->DeleteStorage(origin, base::DoNothing());
+                     },
+                     weak_ptr_factory_.GetWeakPtr(),
+                     std::move(origins_to_purge)));
 }
 #endif
 
@@ -1208,6 +1280,7 @@ void LocalStorageImpl::OnCommitResult(leveldb::Status status) {
       << connection_state_;
   if (status.ok()) {
     commit_error_count_ = 0;
+    idle_compaction_.OnCommit();
     return;
   }
 
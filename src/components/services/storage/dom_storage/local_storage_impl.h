@@ -21,6 +21,7 @@
 #include "base/trace_event/memory_dump_provider.h"
 #include "components/services/storage/dom_storage/async_dom_storage_database.h"
 #include "components/services/storage/dom_storage/dom_storage_database.h"
+#include "components/services/storage/dom_storage/idle_compaction_scheduler.h"
 #include "components/services/storage/public/mojom/local_storage_control.mojom.h"
 #include "mojo/public/cpp/bindings/pending_receiver.h"
 #include "mojo/public/cpp/bindings/receiver.h"
@@ -54,6 +55,18 @@ class LocalStorageImpl : public base::trace_event::MemoryDumpProvider,
 
   void FlushOriginForTesting(const url::Origin& origin);
 
+  // Lowers the number of commits after which the database is compacted once
+  // idle.
+  void SetCommitsBeforeIdleCompactionForTesting(int commits) {
+    idle_compaction_.SetCommitsBeforeCompactionForTesting(commits);
+  }
+
+  // Starts the pending idle compaction without waiting for the idle delay.
+  // Returns false if none is pending.
+  bool RunIdleCompactionForTesting() {
+    return idle_compaction_.RunForTesting();
+  }
+
   // Used by content settings to alter the behavior around
   // what data to keep and what data to discard at shutdown.
   // The policy is not so straight forward to describe, see
@@ -100,6 +113,14 @@ class LocalStorageImpl : public base::trace_event::MemoryDumpProvider,
   // is already opened, |callback| is invoked immediately.
   void SetDatabaseOpenCallbackForTesting(base::OnceClosure callback);
 
+#if defined(USE_NEVA_APPRUNTIME)
+  // Returns the total usage indexed for the origins under |domain|.
+  size_t GetDomainUsageForTesting(const std::string& domain) const {
+    auto it = domain_usage_.find(domain);
+    return it == domain_usage_.end() ? 0 : it->second;
+  }
+#endif
+
  private:
   friend class DOMStorageBrowserTest;
 
@@ -130,8 +151,16 @@ class LocalStorageImpl : public base::trace_event::MemoryDumpProvider,
                      std::vector<DomStorageDatabase::KeyValuePair> data);
 
 #if defined(USE_NEVA_APPRUNTIME)
-  void RetrieveStorageUsageForOrigin(GetUsageCallback callback,
-                                     url::Origin origin);
+  // Builds |origin_usage_| and |domain_usage_| from the metadata of every
+  // origin. Runs once per database open, before the connection is reported
+  // as finished.
+  void LoadUsageIndex();
+  void OnGotUsageIndex(std::vector<DomStorageDatabase::KeyValuePair> data);
+  // Records that |origin| now uses |size_bytes|, as of its latest commit.
+  void UpdateOriginUsage(const url::Origin& origin, size_t size_bytes);
+  // Purges all origins under the second-level domain of |origin| if their
+  // total usage exceeds |storage_size_limit_|.
+  void CheckStorageUsageForOrigin(const url::Origin& origin);
 #endif
 
   void OnGotStorageUsageForShutdown(
@@ -188,6 +217,9 @@ class LocalStorageImpl : public base::trace_event::MemoryDumpProvider,
   int commit_error_count_ = 0;
   bool tried_to_recover_from_commit_errors_ = false;
 
+  // Compacts |database_| while the connection is finished.
+  IdleCompactionScheduler idle_compaction_;
+
   // The set of (origin) URLs whose storage should be cleared on shutdown.
   std::set<GURL> origins_to_purge_on_shutdown_;
 
@@ -196,6 +228,14 @@ class LocalStorageImpl : public base::trace_event::MemoryDumpProvider,
 
 #if defined(USE_NEVA_APPRUNTIME)
   size_t storage_size_limit_ = 0;
+
+  // In-memory index of storage usage, maintained only when
+  // |storage_size_limit_| is set. |origin_usage_| holds each origin's size as
+  // of its last commit; |domain_usage_| holds, for every domain D, the total
+  // size of the origins whose host is D or ends with "." + D.
+  bool usage_index_loaded_ = false;
+  std::map<url::Origin, size_t> origin_usage_;
+  std::map<std::string, size_t> domain_usage_;
 #endif
 
   mojo::Receiver<mojom::LocalStorageControl> control_receiver_{this};
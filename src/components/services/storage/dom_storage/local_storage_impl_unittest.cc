@@ -15,7 +15,10 @@
 #include "base/strings/stringprintf.h"
 #include "base/strings/utf_string_conversions.h"
 #include "base/test/bind_test_util.h"
+#include "base/test/metrics/histogram_tester.h"
+#include "base/test/scoped_command_line.h"
 #include "base/test/task_environment.h"
+#include "base/util/memory_pressure/fake_memory_pressure_monitor.h"
 #include "build/build_config.h"
 #include "components/services/storage/dom_storage/legacy_dom_storage_database.h"
 #include "components/services/storage/dom_storage/storage_area_test_util.h"
@@ -27,6 +30,10 @@
 #include "third_party/leveldatabase/src/include/leveldb/db.h"
 #include "url/gurl.h"
 
+#if defined(USE_NEVA_APPRUNTIME)
+#include "base/neva/base_switches.h"
+#endif
+
 namespace storage {
 
 namespace {
@@ -262,6 +269,22 @@ class LocalStorageImplTest : public testing::Test {
     return false;
   }
 
+  // Sets |key| to |value| in |origin| and commits it.
+  void CommitValue(const url::Origin& origin,
+                   const std::vector<uint8_t>& key,
+                   const std::vector<uint8_t>& value) {
+    mojo::Remote<blink::mojom::StorageArea> area;
+    context()->BindStorageArea(origin, area.BindNewPipeAndPassReceiver());
+    bool success = false;
+    base::RunLoop run_loop;
+    area->Put(key, value, base::nullopt, "source",
+              test::MakeSuccessCallback(run_loop.QuitClosure(), &success));
+    run_loop.Run();
+    EXPECT_TRUE(success);
+    context()->FlushOriginForTesting(origin);
+    RunUntilIdle();
+  }
+
   base::FilePath FirstEntryInDir() {
     base::FileEnumerator enumerator(
         storage_path(), false /* recursive */,
@@ -462,6 +485,29 @@ TEST_F(LocalStorageImplTest, GetStorageUsage_Data) {
   EXPECT_GT(info[0]->size_in_bytes, info[1]->size_in_bytes);
 }
 
+TEST_F(LocalStorageImplTest, MetaDataSizeOfLargeWrite) {
+  url::Origin origin = url::Origin::Create(GURL("http://foobar.com"));
+  auto key = StdStringToUint8Vector("key");
+  // Large enough to be committed from within Put() instead of by the timer.
+  std::vector<uint8_t> value(300 * 1024, 'x');
+
+  mojo::Remote<blink::mojom::StorageArea> area;
+  context()->BindStorageArea(origin, area.BindNewPipeAndPassReceiver());
+  bool success = false;
+  base::RunLoop run_loop;
+  area->Put(key, value, base::nullopt, "source",
+            test::MakeSuccessCallback(run_loop.QuitClosure(), &success));
+  run_loop.Run();
+  EXPECT_TRUE(success);
+  RunUntilIdle();
+
+  // The commit must record the size including the write that triggered it.
+  std::vector<mojom::LocalStorageUsageInfoPtr> info = GetStorageUsageSync();
+  ASSERT_EQ(1u, info.size());
+  EXPECT_EQ(origin, info[0]->origin);
+  EXPECT_EQ(key.size() + value.size(), info[0]->size_in_bytes);
+}
+
 TEST_F(LocalStorageImplTest, MetaDataClearedOnDelete) {
   url::Origin origin1 = url::Origin::Create(GURL("http://foobar.com"));
   url::Origin origin2 = url::Origin::Create(GURL("http://example.com"));
@@ -1268,4 +1314,155 @@ TEST_F(LocalStorageImplTest, DontRecreateOnRepeatedCommitFailure) {
   context->ShutdownAndDelete();
 }
 
+TEST_F(LocalStorageImplTest, CompactsWhenIdleAfterManyCommits) {
+  const url::Origin kOrigin = url::Origin::Create(GURL("http://foobar.com"));
+  const auto kKey = StdStringToUint8Vector("key");
+  WaitForDatabaseOpen();
+  context()->SetCommitsBeforeIdleCompactionForTesting(3);
+  base::HistogramTester histograms;
+
+  CommitValue(kOrigin, kKey, StdStringToUint8Vector("value1"));
+  CommitValue(kOrigin, kKey, StdStringToUint8Vector("value2"));
+  EXPECT_FALSE(context()->RunIdleCompactionForTesting());
+
+  CommitValue(kOrigin, kKey, StdStringToUint8Vector("value3"));
+  EXPECT_TRUE(context()->RunIdleCompactionForTesting());
+  RunUntilIdle();
+
+  // Compaction ran to completion and the data survived it.
+  histograms.ExpectTotalCount("DOMStorage.IncrementalCompaction.Steps", 1);
+  std::vector<uint8_t> result;
+  EXPECT_TRUE(DoTestGet(context(), kKey, &result));
+  EXPECT_EQ(StdStringToUint8Vector("value3"), result);
+
+  // The commit count starts over after a full compaction.
+  CommitValue(kOrigin, kKey, StdStringToUint8Vector("value4"));
+  CommitValue(kOrigin, kKey, StdStringToUint8Vector("value5"));
+  EXPECT_FALSE(context()->RunIdleCompactionForTesting());
+}
+
+TEST_F(LocalStorageImplTest, IdleCompactionDeferredUnderMemoryPressure) {
+  const url::Origin kOrigin = url::Origin::Create(GURL("http://foobar.com"));
+  util::test::FakeMemoryPressureMonitor memory_pressure_monitor;
+  WaitForDatabaseOpen();
+  context()->SetCommitsBeforeIdleCompactionForTesting(1);
+  base::HistogramTester histograms;
+
+  memory_pressure_monitor.SetAndNotifyMemoryPressure(
+      base::MemoryPressureListener::MEMORY_PRESSURE_LEVEL_MODERATE);
+  CommitValue(kOrigin, StdStringToUint8Vector("key"),
+              StdStringToUint8Vector("value"));
+  EXPECT_TRUE(context()->RunIdleCompactionForTesting());
+  RunUntilIdle();
+  histograms.ExpectTotalCount("DOMStorage.IncrementalCompaction.Steps", 0);
+
+  // Compaction is retried after another idle delay, and goes ahead once the
+  // pressure is gone.
+  memory_pressure_monitor.SetAndNotifyMemoryPressure(
+      base::MemoryPressureListener::MEMORY_PRESSURE_LEVEL_NONE);
+  EXPECT_TRUE(context()->RunIdleCompactionForTesting());
+  RunUntilIdle();
+  histograms.ExpectTotalCount("DOMStorage.IncrementalCompaction.Steps", 1);
+}
+
+#if defined(USE_NEVA_APPRUNTIME)
+class LocalStorageImplUsageLimitTest : public LocalStorageImplTest {
+ public:
+  LocalStorageImplUsageLimitTest() {
+    // The limit is in megabytes per second-level domain.
+    scoped_command_line_.GetProcessCommandLine()->AppendSwitchASCII(
+        switches::kLocalStorageLimitPerSecondLevelDomain, "1");
+  }
+
+ private:
+  base::test::ScopedCommandLine scoped_command_line_;
+};
+
+TEST_F(LocalStorageImplUsageLimitTest, UsageIndexTracksCommits) {
+  const url::Origin kOrigin1 =
+      url::Origin::Create(GURL("http://a.example.com"));
+  const url::Origin kOrigin2 =
+      url::Origin::Create(GURL("http://b.example.com"));
+  WaitForDatabaseOpen();
+
+  CommitValue(kOrigin1, StdStringToUint8Vector("key"),
+              StdStringToUint8Vector("value"));
+  const size_t usage1 = context()->GetDomainUsageForTesting("a.example.com");
+  EXPECT_GT(usage1, 0u);
+  EXPECT_EQ(usage1, context()->GetDomainUsageForTesting("example.com"));
+
+  CommitValue(kOrigin2, StdStringToUint8Vector("key"),
+              StdStringToUint8Vector("longer value"));
+  const size_t usage2 = context()->GetDomainUsageForTesting("b.example.com");
+  EXPECT_GT(usage2, usage1);
+  EXPECT_EQ(usage1 + usage2,
+            context()->GetDomainUsageForTesting("example.com"));
+
+  // Overwriting a value replaces the origin's usage rather than adding to it.
+  CommitValue(kOrigin1, StdStringToUint8Vector("key"),
+              StdStringToUint8Vector("longer value"));
+  EXPECT_EQ(usage2, context()->GetDomainUsageForTesting("a.example.com"));
+  EXPECT_EQ(2 * usage2, context()->GetDomainUsageForTesting("example.com"));
+  EXPECT_EQ(0u, context()->GetDomainUsageForTesting("other.com"));
+}
+
+TEST_F(LocalStorageImplUsageLimitTest, UsageIndexLoadedOnOpen) {
+  const url::Origin kOrigin1 =
+      url::Origin::Create(GURL("http://a.example.com"));
+  const url::Origin kOrigin2 =
+      url::Origin::Create(GURL("http://b.example.com"));
+  CommitValue(kOrigin1, StdStringToUint8Vector("key"),
+              StdStringToUint8Vector("value"));
+  CommitValue(kOrigin2, StdStringToUint8Vector("key"),
+              StdStringToUint8Vector("value"));
+  const size_t usage1 = context()->GetDomainUsageForTesting("a.example.com");
+  const size_t total = context()->GetDomainUsageForTesting("example.com");
+  ShutdownContext();
+
+  // The index of a reopened database is built from the stored metadata.
+  WaitForDatabaseOpen();
+  EXPECT_EQ(total, context()->GetDomainUsageForTesting("example.com"));
+
+  // Deleting an origin that has no open area updates the index as well.
+  base::RunLoop run_loop;
+  context()->DeleteStorage(kOrigin2, run_loop.QuitClosure());
+  run_loop.Run();
+  EXPECT_EQ(0u, context()->GetDomainUsageForTesting("b.example.com"));
+  EXPECT_EQ(usage1, context()->GetDomainUsageForTesting("example.com"));
+}
+
+TEST_F(LocalStorageImplUsageLimitTest, PurgesDomainOverLimit) {
+  const url::Origin kOrigin1 =
+      url::Origin::Create(GURL("http://a.example.com"));
+  const url::Origin kOrigin2 =
+      url::Origin::Create(GURL("http://b.example.com"));
+  const url::Origin kOtherOrigin =
+      url::Origin::Create(GURL("http://other.com"));
+  const std::vector<uint8_t> kKey = StdStringToUint8Vector("key");
+  const std::vector<uint8_t> kLargeValue(600 * 1024, 'x');
+  WaitForDatabaseOpen();
+
+  CommitValue(kOtherOrigin, kKey, kLargeValue);
+  CommitValue(kOrigin1, kKey, kLargeValue);
+  CommitValue(kOrigin2, kKey, kLargeValue);
+  EXPECT_GT(context()->GetDomainUsageForTesting("example.com"),
+            1024u * 1024u);
+
+  // Opening another area under the domain finds it over the limit and purges
+  // all of its origins, but not those of other domains.
+  mojo::Remote<blink::mojom::StorageArea> area;
+  context()->BindStorageArea(
+      url::Origin::Create(GURL("http://c.example.com")),
+      area.BindNewPipeAndPassReceiver());
+  RunUntilIdle();
+  area.reset();
+  RunUntilIdle();
+
+  EXPECT_EQ(0u, context()->GetDomainUsageForTesting("example.com"));
+  std::vector<mojom::LocalStorageUsageInfoPtr> usage = GetStorageUsageSync();
+  ASSERT_EQ(1u, usage.size());
+  EXPECT_EQ(kOtherOrigin, usage[0]->origin);
+}
+#endif  // defined(USE_NEVA_APPRUNTIME)
+
 }  // namespace storage
@@ -112,6 +112,7 @@ StorageAreaImpl::Options SessionStorageDataMap::GetOptions() {
   options.default_commit_delay = kCommitDefaultDelaySecs;
   options.max_bytes_per_hour = kPerStorageAreaQuota;
   options.max_commits_per_hour = 60;
+  options.adaptive_commit_delay = true;
   options.cache_mode = StorageAreaImpl::CacheMode::KEYS_ONLY_WHEN_POSSIBLE;
   return options;
 }
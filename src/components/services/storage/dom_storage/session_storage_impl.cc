@@ -22,6 +22,7 @@
 #include "base/strings/stringprintf.h"
 #include "base/system/sys_info.h"
 #include "base/task/post_task.h"
+#include "base/threading/sequenced_task_runner_handle.h"
 #include "base/trace_event/memory_dump_manager.h"
 #include "build/build_config.h"
 #include "components/services/storage/dom_storage/async_dom_storage_database.h"
@@ -397,6 +398,7 @@ void SessionStorageImpl::ShutdownAndDelete() {
     return;
   }
   connection_state_ = CONNECTION_SHUTDOWN;
+  idle_compaction_.SetDatabase(nullptr);
 
   // Flush any uncommitted data.
   for (const auto& it : data_maps_) {
@@ -609,6 +611,7 @@ void SessionStorageImpl::OnCommitResult(leveldb::Status status) {
                             leveldb_env::LEVELDB_STATUS_MAX);
   if (status.ok()) {
     commit_error_count_ = 0;
+    idle_compaction_.OnCommit();
     return;
   }
   commit_error_count_++;
@@ -977,6 +980,7 @@ void SessionStorageImpl::OnConnectionFinished() {
   // |database_| should be known to either be valid or invalid by now. Run our
   // delayed bindings.
   connection_state_ = CONNECTION_FINISHED;
+  idle_compaction_.SetDatabase(database_.get());
   receiver_.Resume();
   std::vector<base::OnceClosure> callbacks;
   std::swap(callbacks, on_database_opened_callbacks_);
@@ -1000,6 +1004,7 @@ void SessionStorageImpl::DeleteAndRecreateDatabase(const char* histogram_name) {
   connection_state_ = CONNECTION_IN_PROGRESS;
   receiver_.Pause();
   commit_error_count_ = 0;
+  idle_compaction_.SetDatabase(nullptr);
   database_.reset();
   open_result_histogram_ = histogram_name;
 
@@ -22,6 +22,7 @@
 #include "base/trace_event/memory_dump_provider.h"
 #include "components/services/storage/dom_storage/async_dom_storage_database.h"
 #include "components/services/storage/dom_storage/dom_storage_database.h"
+#include "components/services/storage/dom_storage/idle_compaction_scheduler.h"
 #include "components/services/storage/dom_storage/session_storage_data_map.h"
 #include "components/services/storage/dom_storage/session_storage_metadata.h"
 #include "components/services/storage/dom_storage/session_storage_namespace_impl.h"
@@ -113,6 +114,18 @@ class SessionStorageImpl : public base::trace_event::MemoryDumpProvider,
   void FlushAreaForTesting(const std::string& namespace_id,
                            const url::Origin& origin);
 
+  // Lowers the number of commits after which the database is compacted once
+  // idle.
+  void SetCommitsBeforeIdleCompactionForTesting(int commits) {
+    idle_compaction_.SetCommitsBeforeCompactionForTesting(commits);
+  }
+
+  // Starts the pending idle compaction without waiting for the idle delay.
+  // Returns false if none is pending.
+  bool RunIdleCompactionForTesting() {
+    return idle_compaction_.RunForTesting();
+  }
+
   // Access the underlying DomStorageDatabase. May be null if the database is
   // not yet open.
   const base::SequenceBound<DomStorageDatabase>& GetDatabaseForTesting() const {
@@ -279,6 +292,9 @@ class SessionStorageImpl : public base::trace_event::MemoryDumpProvider,
   int commit_error_count_ = 0;
   bool tried_to_recover_from_commit_errors_ = false;
 
+  // Compacts |database_| while the connection is finished.
+  IdleCompactionScheduler idle_compaction_;
+
   // Name of an extra histogram to log open results to, if not null.
   const char* open_result_histogram_ = nullptr;
 
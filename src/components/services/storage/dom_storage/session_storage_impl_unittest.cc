@@ -22,7 +22,9 @@
 #include "base/task/post_task.h"
 #include "base/task/thread_pool.h"
 #include "base/test/bind_test_util.h"
+#include "base/test/metrics/histogram_tester.h"
 #include "base/test/task_environment.h"
+#include "base/util/memory_pressure/fake_memory_pressure_monitor.h"
 #include "components/services/storage/dom_storage/legacy_dom_storage_database.h"
 #include "components/services/storage/dom_storage/storage_area_test_util.h"
 #include "components/services/storage/dom_storage/testing_legacy_session_storage_database.h"
@@ -1325,4 +1327,43 @@ TEST_F(SessionStorageImplTest, Bug1128318) {
   EXPECT_EQ(ns->namespace_entry(), SessionStorageMetadata::NamespaceEntry());
 }
 
+TEST_F(SessionStorageImplTest, CompactsWhenIdleAfterManyCommits) {
+  std::string namespace_id = base::GenerateGUID();
+  url::Origin origin = url::Origin::Create(GURL("http://host1:1/"));
+  util::test::FakeMemoryPressureMonitor memory_pressure_monitor;
+  base::HistogramTester histograms;
+
+  session_storage_impl()->SetCommitsBeforeIdleCompactionForTesting(1);
+  session_storage()->CreateNamespace(namespace_id);
+  mojo::Remote<blink::mojom::StorageArea> area;
+  session_storage()->BindStorageArea(origin, namespace_id,
+                                     area.BindNewPipeAndPassReceiver(),
+                                     base::DoNothing());
+  EXPECT_TRUE(test::PutSync(area.get(), StringPieceToUint8Vector("key"),
+                            StringPieceToUint8Vector("value"), base::nullopt,
+                            "source"));
+  session_storage_impl()->FlushAreaForTesting(namespace_id, origin);
+  RunUntilIdle();
+
+  // Compaction waits for memory pressure to go away.
+  memory_pressure_monitor.SetAndNotifyMemoryPressure(
+      base::MemoryPressureListener::MEMORY_PRESSURE_LEVEL_MODERATE);
+  EXPECT_TRUE(session_storage_impl()->RunIdleCompactionForTesting());
+  RunUntilIdle();
+  histograms.ExpectTotalCount("DOMStorage.IncrementalCompaction.Steps", 0);
+
+  memory_pressure_monitor.SetAndNotifyMemoryPressure(
+      base::MemoryPressureListener::MEMORY_PRESSURE_LEVEL_NONE);
+  EXPECT_TRUE(session_storage_impl()->RunIdleCompactionForTesting());
+  RunUntilIdle();
+  histograms.ExpectTotalCount("DOMStorage.IncrementalCompaction.Steps", 1);
+  EXPECT_FALSE(session_storage_impl()->RunIdleCompactionForTesting());
+
+  // The data survived compaction.
+  std::vector<blink::mojom::KeyValuePtr> data;
+  EXPECT_TRUE(test::GetAllSync(area.get(), &data));
+  ASSERT_EQ(1u, data.size());
+  EXPECT_EQ(StringPieceToUint8Vector("value"), data[0]->value);
+}
+
 }  // namespace storage
@@ -8,6 +8,7 @@
 #include "base/bind_helpers.h"
 #include "base/containers/span.h"
 #include "base/metrics/histogram_macros.h"
+#include "base/numerics/safe_conversions.h"
 #include "base/threading/thread_task_runner_handle.h"
 #include "base/trace_event/memory_dump_manager.h"
 #include "base/trace_event/process_memory_dump.h"
@@ -16,6 +17,36 @@
 
 namespace storage {
 
+namespace {
+
+// Tuning for Options::adaptive_commit_delay.
+//
+// Delay used for areas which are written rarely.
+constexpr base::TimeDelta kMinAdaptiveCommitDelay =
+    base::TimeDelta::FromSeconds(1);
+// Areas written more often than every |default_commit_delay| divided by this
+// are considered to be written in a loop...
+constexpr int kBurstWriteIntervalDivisor = 10;
+// ...and wait this multiple of |default_commit_delay| before committing.
+constexpr int kBurstCommitDelayFactor = 4;
+// Once this many bytes have been written into a batch, commit it without
+// waiting for the timer, provided the rate limits allow it.
+constexpr size_t kAdaptiveMaxPendingBytes = 256 * 1024;
+// The commit delay is at least this multiple of the average commit latency,
+// which bounds the share of time spent committing on slow storage.
+constexpr int kCommitLatencyFactor = 10;
+// Weight of the newest sample in the exponentially weighted averages.
+constexpr double kAverageWeight = 0.25;
+
+base::TimeDelta UpdateAverage(base::TimeDelta average,
+                              base::TimeDelta sample) {
+  return base::TimeDelta::FromSecondsD(average.InSecondsF() *
+                                           (1 - kAverageWeight) +
+                                       sample.InSecondsF() * kAverageWeight);
+}
+
+}  // namespace
+
 StorageAreaImpl::Delegate::~Delegate() = default;
 
 void StorageAreaImpl::Delegate::PrepareToCommit(
@@ -75,6 +106,7 @@ StorageAreaImpl::StorageAreaImpl(AsyncDomStorageDatabase* database,
       delegate_(delegate),
       database_(database),
       cache_mode_(database ? options.cache_mode : CacheMode::KEYS_AND_VALUES),
+      keys_values_map_(base::MakeRefCounted<SharedValueMap>()),
       storage_used_(0),
       max_size_(options.max_size),
       memory_used_(0),
@@ -83,7 +115,8 @@ StorageAreaImpl::StorageAreaImpl(AsyncDomStorageDatabase* database,
       data_rate_limiter_(options.max_bytes_per_hour,
                          base::TimeDelta::FromHours(1)),
       commit_rate_limiter_(options.max_commits_per_hour,
-                           base::TimeDelta::FromHours(1)) {
+                           base::TimeDelta::FromHours(1)),
+      adaptive_commit_delay_(options.adaptive_commit_delay) {
   receivers_.set_disconnect_handler(base::BindRepeating(
       &StorageAreaImpl::OnConnectionError, weak_ptr_factory_.GetWeakPtr()));
 }
@@ -220,7 +253,7 @@ void StorageAreaImpl::PurgeMemory() {
   map_state_ = MapState::UNLOADED;
   memory_used_ = 0;
   keys_only_map_.clear();
-  keys_values_map_.clear();
+  ResetKeysValuesMap();
 }
 
 void StorageAreaImpl::SetCacheModeForTesting(CacheMode cache_mode) {
@@ -249,9 +282,13 @@ void StorageAreaImpl::Put(
     return;
   }
 
+  if (database_)
+    UpdateWriteRate();
+
   size_t old_item_size = 0;
   size_t old_item_memory = 0;
   size_t new_item_memory = 0;
+  bool replaces_cached_value = false;
   base::Optional<std::vector<uint8_t>> old_value;
   if (map_state_ == MapState::LOADED_KEYS_ONLY) {
     KeysOnlyMap::const_iterator found = keys_only_map_.find(key);
@@ -292,8 +329,8 @@ void StorageAreaImpl::Put(
     new_item_memory = key.size() + sizeof(size_t);
   } else {
     DCHECK_EQ(map_state_, MapState::LOADED_KEYS_AND_VALUES);
-    auto found = keys_values_map_.find(key);
-    if (found != keys_values_map_.end()) {
+    auto found = keys_values_map().find(key);
+    if (found != keys_values_map().end()) {
       if (found->second == value) {
         // NOTE: Even though the key is not changing, we have to acknowledge
         // the change request, as clients may rely on this acknowledgement for
@@ -303,8 +340,10 @@ void StorageAreaImpl::Put(
         std::move(callback).Run(true);  // Key already has this value.
         return;
       }
-      old_value = std::move(found->second);
-      old_item_size = key.size() + old_value.value().size();
+      // The old value is moved out of the map once the change is known to
+      // succeed, as the map may have to be copied first.
+      replaces_cached_value = true;
+      old_item_size = key.size() + found->second.size();
       old_item_memory = old_item_size;
     }
     new_item_memory = key.size() + value.size();
@@ -339,13 +378,20 @@ void StorageAreaImpl::Put(
       commit_batch_->changed_keys.insert(key);
   }
 
-  if (map_state_ == MapState::LOADED_KEYS_ONLY)
+  if (map_state_ == MapState::LOADED_KEYS_ONLY) {
     keys_only_map_[key] = value.size();
-  else
-    keys_values_map_[key] = value;
-
+  } else {
+    std::vector<uint8_t>& cached_value = MutableKeysValuesMap()[key];
+    if (replaces_cached_value)
+      old_value = std::move(cached_value);
+    cached_value = value;
+  }
   storage_used_ = new_storage_used;
   memory_used_ += new_item_memory - old_item_memory;
+  // This may commit right away, which reads the sizes updated above.
+  if (commit_batch_)
+    OnClientWriteBatched(new_item_size);
+
   for (const auto& observer : observers_)
     observer->KeyChanged(key, value, old_value, source);
   std::move(callback).Run(true);
@@ -367,8 +413,10 @@ void StorageAreaImpl::Delete(
     return;
   }
 
-  if (database_)
+  if (database_) {
+    UpdateWriteRate();
     CreateCommitBatchIfNeeded();
+  }
 
   std::vector<uint8_t> old_value;
   if (map_state_ == MapState::LOADED_KEYS_ONLY) {
@@ -408,8 +456,7 @@ void StorageAreaImpl::Delete(
       commit_batch_->changed_values[key] = std::vector<uint8_t>();
   } else {
     DCHECK_EQ(map_state_, MapState::LOADED_KEYS_AND_VALUES);
-    auto found = keys_values_map_.find(key);
-    if (found == keys_values_map_.end()) {
+    if (!keys_values_map().count(key)) {
       // NOTE: Even though the key is not changing, we have to acknowledge
       // the change request, as clients may rely on this acknowledgement for
       // caching behavior.
@@ -418,13 +465,17 @@ void StorageAreaImpl::Delete(
       std::move(callback).Run(true);
       return;
     }
+    ValueMap& values = MutableKeysValuesMap();
+    auto found = values.find(key);
     old_value.swap(found->second);
-    keys_values_map_.erase(found);
+    values.erase(found);
     memory_used_ -= key.size() + old_value.size();
     storage_used_ -= key.size() + old_value.size();
     if (commit_batch_)
       commit_batch_->changed_keys.insert(key);
   }
+  if (commit_batch_)
+    OnClientWriteBatched(key.size());
 
   for (auto& observer : observers_)
     observer->KeyDeleted(key, old_value, source);
@@ -448,7 +499,7 @@ void StorageAreaImpl::DeleteAll(
 
   // Upgrade map state if needed.
   if (IsMapUpgradeNeeded()) {
-    DCHECK(keys_values_map_.empty());
+    DCHECK(keys_values_map().empty());
     map_state_ = MapState::LOADED_KEYS_AND_VALUES;
   }
 
@@ -463,6 +514,7 @@ void StorageAreaImpl::DeleteAll(
   }
 
   if (database_) {
+    UpdateWriteRate();
     CreateCommitBatchIfNeeded();
     commit_batch_->clear_all_first = true;
     commit_batch_->changed_values.clear();
@@ -470,10 +522,12 @@ void StorageAreaImpl::DeleteAll(
   }
 
   keys_only_map_.clear();
-  keys_values_map_.clear();
+  ResetKeysValuesMap();
 
   storage_used_ = 0;
   memory_used_ = 0;
+  if (commit_batch_)
+    OnClientWriteBatched(0);
   for (const auto& observer : observers_)
     observer->AllDeleted(/*was_nonempty=*/true, source);
   std::move(callback).Run(/*success=*/true);
@@ -494,8 +548,8 @@ void StorageAreaImpl::Get(const std::vector<uint8_t>& key,
     return;
   }
 
-  auto found = keys_values_map_.find(key);
-  if (found == keys_values_map_.end()) {
+  auto found = keys_values_map().find(key);
+  if (found == keys_values_map().end()) {
     std::move(callback).Run(false, std::vector<uint8_t>());
     return;
   }
@@ -522,7 +576,7 @@ void StorageAreaImpl::GetAll(
   }
 
   std::vector<blink::mojom::KeyValuePtr> all;
-  for (const auto& it : keys_values_map_) {
+  for (const auto& it : keys_values_map()) {
     auto kv = blink::mojom::KeyValue::New();
     kv->key = it.first;
     kv->value = it.second;
@@ -562,7 +616,7 @@ void StorageAreaImpl::OnConnectionError() {
 
 void StorageAreaImpl::LoadMap(base::OnceClosure completion_callback) {
   DCHECK_NE(map_state_, MapState::LOADED_KEYS_AND_VALUES);
-  DCHECK(keys_values_map_.empty());
+  DCHECK(keys_values_map().empty());
 
   // Current commit batch needs to be applied before re-loading the map. The
   // re-load of map occurs only when GetAll() is called or CacheMode is set to
@@ -608,7 +662,7 @@ void StorageAreaImpl::LoadMap(base::OnceClosure completion_callback) {
 void StorageAreaImpl::OnMapLoaded(
     leveldb::Status status,
     std::vector<DomStorageDatabase::KeyValuePair> data) {
-  DCHECK(keys_values_map_.empty());
+  DCHECK(keys_values_map().empty());
   DCHECK_EQ(map_state_, MapState::LOADING_FROM_DATABASE);
 
   if (data.empty() && status.ok()) {
@@ -620,29 +674,29 @@ void StorageAreaImpl::OnMapLoaded(
   keys_only_map_.clear();
   map_state_ = MapState::LOADED_KEYS_AND_VALUES;
 
-  keys_values_map_.clear();
+  ResetKeysValuesMap();
+  ValueMap& values = keys_values_map_->data;
   for (auto& entry : data) {
     DCHECK_GE(entry.key.size(), prefix_.size());
-    keys_values_map_[DomStorageDatabase::Key(entry.key.begin() + prefix_.size(),
-                                             entry.key.end())] =
-        std::move(entry.value);
+    values[DomStorageDatabase::Key(entry.key.begin() + prefix_.size(),
+                                   entry.key.end())] = std::move(entry.value);
   }
   CalculateStorageAndMemoryUsed();
 
-  std::vector<Change> changes = delegate_->FixUpData(keys_values_map_);
+  std::vector<Change> changes = delegate_->FixUpData(values);
   if (!changes.empty()) {
     DCHECK(database_);
     CreateCommitBatchIfNeeded();
     for (auto& change : changes) {
-      auto it = keys_values_map_.find(change.first);
+      auto it = values.find(change.first);
       if (!change.second) {
-        DCHECK(it != keys_values_map_.end());
-        keys_values_map_.erase(it);
+        DCHECK(it != values.end());
+        values.erase(it);
       } else {
-        if (it != keys_values_map_.end()) {
+        if (it != values.end()) {
           it->second = std::move(*change.second);
         } else {
-          keys_values_map_[change.first] = std::move(*change.second);
+          values[change.first] = std::move(*change.second);
         }
       }
       // No need to store values in |commit_batch_| if values are already
@@ -670,7 +724,8 @@ void StorageAreaImpl::OnMapLoaded(
 
 void StorageAreaImpl::OnGotMigrationData(std::unique_ptr<ValueMap> data) {
   keys_only_map_.clear();
-  keys_values_map_ = data ? std::move(*data) : ValueMap();
+  keys_values_map_ = base::MakeRefCounted<SharedValueMap>(
+      data ? std::move(*data) : ValueMap());
   map_state_ = MapState::LOADED_KEYS_AND_VALUES;
   CalculateStorageAndMemoryUsed();
   delegate_->OnMapLoaded(leveldb::Status::OK());
@@ -678,7 +733,7 @@ void StorageAreaImpl::OnGotMigrationData(std::unique_ptr<ValueMap> data) {
   if (database_ && !empty()) {
     CreateCommitBatchIfNeeded();
     // CommitChanges() will take values from |keys_values_map_|.
-    for (const auto& it : keys_values_map_)
+    for (const auto& it : keys_values_map())
       commit_batch_->changed_keys.insert(it.first);
     CommitChanges();
   }
@@ -689,7 +744,7 @@ void StorageAreaImpl::CalculateStorageAndMemoryUsed() {
   memory_used_ = 0;
   storage_used_ = 0;
 
-  for (auto& it : keys_values_map_)
+  for (const auto& it : keys_values_map())
     memory_used_ += it.first.size() + it.second.size();
   storage_used_ = memory_used_;
 
@@ -760,7 +815,8 @@ base::TimeDelta StorageAreaImpl::ComputeCommitDelay() const {
 
   base::TimeDelta elapsed_time = base::TimeTicks::Now() - start_time_;
   base::TimeDelta delay =
-      std::max(default_commit_delay_,
+      std::max(adaptive_commit_delay_ ? ComputeAdaptiveCommitDelay()
+                                      : default_commit_delay_,
                std::max(commit_rate_limiter_.ComputeDelayNeeded(elapsed_time),
                         data_rate_limiter_.ComputeDelayNeeded(elapsed_time)));
   // TODO(mek): Rename histogram to match class name, or eliminate histogram
@@ -769,6 +825,53 @@ base::TimeDelta StorageAreaImpl::ComputeCommitDelay() const {
   return delay;
 }
 
+base::TimeDelta StorageAreaImpl::ComputeAdaptiveCommitDelay() const {
+  base::TimeDelta delay;
+  if (!has_write_interval_ ||
+      average_write_interval_ >= default_commit_delay_) {
+    // Further writes are unlikely to arrive soon, so waiting would only delay
+    // durability.
+    delay = kMinAdaptiveCommitDelay;
+  } else if (average_write_interval_ * kBurstWriteIntervalDivisor <
+             default_commit_delay_) {
+    delay = default_commit_delay_ * kBurstCommitDelayFactor;
+  } else {
+    delay = default_commit_delay_;
+  }
+  return std::max(delay, average_commit_latency_ * kCommitLatencyFactor);
+}
+
+void StorageAreaImpl::UpdateWriteRate() {
+  base::TimeTicks now = base::TimeTicks::Now();
+  if (!last_write_time_.is_null()) {
+    base::TimeDelta interval = now - last_write_time_;
+    average_write_interval_ =
+        has_write_interval_ ? UpdateAverage(average_write_interval_, interval)
+                            : interval;
+    has_write_interval_ = true;
+  }
+  last_write_time_ = now;
+}
+
+void StorageAreaImpl::OnClientWriteBatched(size_t bytes) {
+  DCHECK(commit_batch_);
+  ++commit_batch_->client_writes;
+  commit_batch_->client_bytes += bytes;
+
+  // Don't let a large amount of data sit in memory waiting for the timer.
+  if (!adaptive_commit_delay_ ||
+      commit_batch_->client_bytes < kAdaptiveMaxPendingBytes ||
+      commit_batches_in_flight_ > 0) {
+    return;
+  }
+  base::TimeDelta elapsed_time = base::TimeTicks::Now() - start_time_;
+  if (!commit_rate_limiter_.ComputeDelayNeeded(elapsed_time).is_zero() ||
+      !data_rate_limiter_.ComputeDelayNeeded(elapsed_time).is_zero()) {
+    return;
+  }
+  CommitChanges();
+}
+
 void StorageAreaImpl::CommitChanges(base::OnceClosure callback) {
   // Note: commit_batch_ may be null if ScheduleImmediateCommit was called
   // after a delayed commit task was scheduled.
@@ -811,8 +914,8 @@ void StorageAreaImpl::CommitChanges(base::OnceClosure callback) {
       prefixed_key.reserve(prefix_.size() + key.size());
       prefixed_key.insert(prefixed_key.end(), prefix_.begin(), prefix_.end());
       prefixed_key.insert(prefixed_key.end(), key.begin(), key.end());
-      auto it = keys_values_map_.find(key);
-      if (it != keys_values_map_.end()) {
+      auto it = keys_values_map().find(key);
+      if (it != keys_values_map().end()) {
         data_size += it->second.size();
         commit.entries_to_add.emplace_back(std::move(prefixed_key), it->second);
       } else {
@@ -847,6 +950,18 @@ void StorageAreaImpl::CommitChanges(base::OnceClosure callback) {
     DCHECK(!commit_batch_->clear_all_first);
     commit.copy_to_prefix = std::move(commit_batch_->copy_to_prefix);
   }
+  // How many client writes were coalesced, and how the bytes actually
+  // written compare to the bytes the clients wrote.
+  if (commit_batch_->client_writes > 0) {
+    UMA_HISTOGRAM_COUNTS_1000("LevelDBWrapper.CommitBatch.ClientWrites",
+                              commit_batch_->client_writes);
+    if (commit_batch_->client_bytes > 0) {
+      UMA_HISTOGRAM_COUNTS_1000(
+          "LevelDBWrapper.CommitBatch.WrittenBytesPercent",
+          base::saturated_cast<int>(data_size * 100 /
+                                    commit_batch_->client_bytes));
+    }
+  }
   commit_batch_.reset();
 
   data_rate_limiter_.add_samples(data_size);
@@ -873,11 +988,20 @@ void StorageAreaImpl::CommitChanges(base::OnceClosure callback) {
           },
           std::move(commit)),
       base::BindOnce(&StorageAreaImpl::OnCommitComplete,
-                     weak_ptr_factory_.GetWeakPtr(), std::move(callback)));
+                     weak_ptr_factory_.GetWeakPtr(), std::move(callback),
+                     base::TimeTicks::Now()));
 }
 
 void StorageAreaImpl::OnCommitComplete(base::OnceClosure callback,
+                                       base::TimeTicks commit_start,
                                        leveldb::Status status) {
+  base::TimeDelta latency = base::TimeTicks::Now() - commit_start;
+  UMA_HISTOGRAM_TIMES("LevelDBWrapper.CommitLatency", latency);
+  average_commit_latency_ =
+      average_commit_latency_.is_zero()
+          ? latency
+          : UpdateAverage(average_commit_latency_, latency);
+
   has_committed_data_ = true;
   --commit_batches_in_flight_;
   StartCommitTimer();
@@ -910,25 +1034,43 @@ void StorageAreaImpl::UnloadMapIfPossible() {
 
   keys_only_map_.clear();
   memory_used_ = 0;
-  for (auto& it : keys_values_map_) {
+  for (const auto& it : keys_values_map()) {
     keys_only_map_.insert(std::make_pair(it.first, it.second.size()));
   }
   if (commit_batch_) {
+    // Values can only be moved out of the map if it isn't shared.
+    const bool can_move_values = keys_values_map_->HasOneRef();
     for (const auto& key : commit_batch_->changed_keys) {
-      auto value_it = keys_values_map_.find(key);
-      commit_batch_->changed_values[key] = value_it == keys_values_map_.end()
-                                               ? std::vector<uint8_t>()
-                                               : std::move(value_it->second);
+      auto value_it = keys_values_map_->data.find(key);
+      std::vector<uint8_t>& value = commit_batch_->changed_values[key];
+      if (value_it == keys_values_map_->data.end())
+        continue;
+      if (can_move_values)
+        value = std::move(value_it->second);
+      else
+        value = value_it->second;
     }
     commit_batch_->changed_keys.clear();
   }
 
-  keys_values_map_.clear();
+  ResetKeysValuesMap();
   map_state_ = MapState::LOADED_KEYS_ONLY;
 
   CalculateStorageAndMemoryUsed();
 }
 
+StorageAreaImpl::ValueMap& StorageAreaImpl::MutableKeysValuesMap() {
+  if (!keys_values_map_->HasOneRef()) {
+    keys_values_map_ =
+        base::MakeRefCounted<SharedValueMap>(keys_values_map_->data);
+  }
+  return keys_values_map_->data;
+}
+
+void StorageAreaImpl::ResetKeysValuesMap() {
+  keys_values_map_ = base::MakeRefCounted<SharedValueMap>();
+}
+
 void StorageAreaImpl::DoForkOperation(
     const base::WeakPtr<StorageAreaImpl>& forked_area) {
   if (!forked_area)
@@ -951,13 +1093,14 @@ void StorageAreaImpl::DoForkOperation(
                                  keys_only_map_);
 }
 
-void StorageAreaImpl::OnForkStateLoaded(bool database_enabled,
-                                        const ValueMap& value_map,
-                                        const KeysOnlyMap& keys_only_map) {
+void StorageAreaImpl::OnForkStateLoaded(
+    bool database_enabled,
+    scoped_refptr<SharedValueMap> value_map,
+    const KeysOnlyMap& keys_only_map) {
   // This callback can get either the value map or the key only map depending
   // on parent operations and other things. So handle both.
-  if (!value_map.empty() || keys_only_map.empty()) {
-    keys_values_map_ = value_map;
+  if (!value_map->data.empty() || keys_only_map.empty()) {
+    keys_values_map_ = std::move(value_map);
     map_state_ = MapState::LOADED_KEYS_AND_VALUES;
   } else {
     keys_only_map_ = keys_only_map;
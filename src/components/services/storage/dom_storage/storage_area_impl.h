@@ -13,6 +13,7 @@
 #include "base/callback.h"
 #include "base/gtest_prod_util.h"
 #include "base/macros.h"
+#include "base/memory/ref_counted.h"
 #include "base/optional.h"
 #include "base/time/time.h"
 #include "components/services/storage/dom_storage/dom_storage_database.h"
@@ -88,6 +89,13 @@ class StorageAreaImpl : public blink::mojom::StorageArea {
     int max_bytes_per_hour = 0;
     // Maximum number of disk write batches in one hour.
     int max_commits_per_hour = 0;
+    // If set, the delay before a commit adapts to how the area is written
+    // instead of always being |default_commit_delay|: it is short for areas
+    // written rarely, so their data is durable sooner, and longer for areas
+    // written in tight loops, so more writes are coalesced. It never drops
+    // below a multiple of recent commit latency, and the hourly limits above
+    // still apply.
+    bool adaptive_commit_delay = false;
   };
 
   // |Delegate::OnNoBindings| will be called when this object has no more
@@ -212,6 +220,7 @@ class StorageAreaImpl : public blink::mojom::StorageArea {
   FRIEND_TEST_ALL_PREFIXES(StorageAreaImplTest, SetCacheModeConsistent);
   FRIEND_TEST_ALL_PREFIXES(StorageAreaImplParamTest,
                            CommitOnDifferentCacheModes);
+  FRIEND_TEST_ALL_PREFIXES(StorageAreaImplTest, AdaptiveCommitDelay);
 
   // Used to rate limit commits.
   class RateLimiter {
@@ -250,6 +259,10 @@ class StorageAreaImpl : public blink::mojom::StorageArea {
     std::map<std::vector<uint8_t>, std::vector<uint8_t>> changed_values;
     // Used if the map_type_ is LOADED_KEYS_AND_VALUES.
     std::set<std::vector<uint8_t>> changed_keys;
+    // Number of client writes coalesced into this batch, and the bytes they
+    // wrote.
+    int client_writes = 0;
+    size_t client_bytes = 0;
   };
 
   enum class MapState {
@@ -262,10 +275,12 @@ class StorageAreaImpl : public blink::mojom::StorageArea {
     LOADED_KEYS_AND_VALUES
   };
 
-  using LoadStateForForkCallback = base::OnceCallback<
-      void(bool database_enabled, const ValueMap&, const KeysOnlyMap&)>;
-  using ForkSourceEarlyDeathCallback =
-      base::OnceCallback<void(std::vector<uint8_t> source_prefix)>;
+  // The keys-and-values cache. Forking shares it between the source area and
+  // the forked area, and whichever of them modifies it first copies the whole
+  // map. Session storage only forks an area when it is about to be written,
+  // so this moves the copy out of the fork rather than avoiding it; only
+  // clears and rejected or no-op writes skip it.
+  using SharedValueMap = base::RefCountedData<ValueMap>;
 
   // Changes the cache mode of the area. If applicable, this will change the
   // internal storage type after the next commit. The keys-only mode can only
@@ -293,9 +308,18 @@ class StorageAreaImpl : public blink::mojom::StorageArea {
   void CreateCommitBatchIfNeeded();
   void StartCommitTimer();
   base::TimeDelta ComputeCommitDelay() const;
+  base::TimeDelta ComputeAdaptiveCommitDelay() const;
+
+  // Called by Put(), Delete() and DeleteAll(): UpdateWriteRate() before the
+  // change is added to |commit_batch_|, and OnClientWriteBatched() once the
+  // change and the size bookkeeping are applied, as it may commit right away.
+  void UpdateWriteRate();
+  void OnClientWriteBatched(size_t bytes);
 
   void CommitChanges(base::OnceClosure callback = {});
-  void OnCommitComplete(base::OnceClosure callback, leveldb::Status status);
+  void OnCommitComplete(base::OnceClosure callback,
+                        base::TimeTicks commit_start,
+                        leveldb::Status status);
 
   void UnloadMapIfPossible();
 
@@ -313,12 +337,19 @@ class StorageAreaImpl : public blink::mojom::StorageArea {
     return (map_state_ == MapState::LOADED_KEYS_ONLY &&
             keys_only_map_.empty()) ||
            (map_state_ == MapState::LOADED_KEYS_AND_VALUES &&
-            keys_values_map_.empty());
+            keys_values_map().empty());
   }
 
+  const ValueMap& keys_values_map() const { return keys_values_map_->data; }
+  // Returns |keys_values_map_| for modification, first copying it if it is
+  // shared with a forked area.
+  ValueMap& MutableKeysValuesMap();
+  // Replaces |keys_values_map_| with a new empty map without copying.
+  void ResetKeysValuesMap();
+
   void DoForkOperation(const base::WeakPtr<StorageAreaImpl>& forked_area);
   void OnForkStateLoaded(bool database_enabled,
-                         const ValueMap& map,
+                         scoped_refptr<SharedValueMap> value_map,
                          const KeysOnlyMap& key_only_map);
 
   std::vector<uint8_t> prefix_;
@@ -331,7 +362,7 @@ class StorageAreaImpl : public blink::mojom::StorageArea {
   // must stay consistent for a given commit batch.
   MapState map_state_ = MapState::UNLOADED;
   CacheMode cache_mode_;
-  ValueMap keys_values_map_;
+  scoped_refptr<SharedValueMap> keys_values_map_;
   KeysOnlyMap keys_only_map_;
   // These are always consumed & cleared when the map is loaded.
   std::vector<base::OnceClosure> on_load_complete_tasks_;
@@ -343,6 +374,14 @@ class StorageAreaImpl : public blink::mojom::StorageArea {
   base::TimeDelta default_commit_delay_;
   RateLimiter data_rate_limiter_;
   RateLimiter commit_rate_limiter_;
+  // State for Options::adaptive_commit_delay. The averages are exponentially
+  // weighted; |average_write_interval_| is only meaningful once
+  // |has_write_interval_| is set.
+  const bool adaptive_commit_delay_;
+  base::TimeTicks last_write_time_;
+  bool has_write_interval_ = false;
+  base::TimeDelta average_write_interval_;
+  base::TimeDelta average_commit_latency_;
   int commit_batches_in_flight_ = 0;
   bool has_committed_data_ = false;
   std::unique_ptr<CommitBatch> commit_batch_;
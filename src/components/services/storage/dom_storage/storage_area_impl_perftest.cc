@@ -0,0 +1,119 @@
+// Copyright 2020 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "components/services/storage/dom_storage/storage_area_impl.h"
+
+#include <stdint.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "base/bind_helpers.h"
+#include "base/logging.h"
+#include "base/macros.h"
+#include "base/strings/string_number_conversions.h"
+#include "base/test/task_environment.h"
+#include "base/time/time.h"
+#include "base/timer/lap_timer.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace storage {
+
+namespace {
+
+const int kWarmupRuns = 5;
+const int kTimeCheckInterval = 10;
+const size_t kValueSize = 100;
+
+std::vector<uint8_t> ToBytes(const std::string& input) {
+  return std::vector<uint8_t>(input.begin(), input.end());
+}
+
+class NoOpDelegate : public StorageAreaImpl::Delegate {
+ public:
+  NoOpDelegate() = default;
+  ~NoOpDelegate() override = default;
+
+  void OnNoBindings() override {}
+  void DidCommit(leveldb::Status status) override {}
+
+ private:
+  DISALLOW_COPY_AND_ASSIGN(NoOpDelegate);
+};
+
+StorageAreaImpl::Options GetOptions() {
+  StorageAreaImpl::Options options;
+  options.max_size = 100 * 1024 * 1024;
+  options.default_commit_delay = base::TimeDelta::FromSeconds(5);
+  options.max_bytes_per_hour = 100 * 1024 * 1024;
+  options.max_commits_per_hour = 60;
+  options.cache_mode = StorageAreaImpl::CacheMode::KEYS_AND_VALUES;
+  return options;
+}
+
+class StorageAreaImplPerfTest : public testing::Test {
+ public:
+  StorageAreaImplPerfTest()
+      : timer_(kWarmupRuns,
+               base::TimeDelta::FromSeconds(2),
+               kTimeCheckInterval) {}
+
+ protected:
+  // Forks an area holding |entries| loaded keys and values, and then writes
+  // |writes| keys of the fork, reporting the average time of each fork.
+  void RunFork(int entries, int writes) {
+    StorageAreaImpl area(nullptr, ToBytes("source-"), &delegate_,
+                         GetOptions());
+    area.InitializeAsEmpty();
+    const std::vector<uint8_t> value(kValueSize, 'x');
+    for (int i = 0; i < entries; ++i) {
+      area.Put(ToBytes("key" + base::NumberToString(i)), value, base::nullopt,
+               "source", base::DoNothing());
+    }
+    ASSERT_FALSE(area.empty());
+
+    int lap = 0;
+    timer_.Reset();
+    do {
+      std::unique_ptr<StorageAreaImpl> fork =
+          area.ForkToNewPrefix("fork-", &delegate_, GetOptions());
+      for (int i = 0; i < writes; ++i) {
+        fork->Put(ToBytes("key" + base::NumberToString(i)),
+                  ToBytes(base::NumberToString(lap)), base::nullopt, "source",
+                  base::DoNothing());
+      }
+      ++lap;
+      timer_.NextLap();
+    } while (!timer_.HasTimeLimitExpired());
+
+    VLOG(0) << "Fork of " << entries << " entries followed by " << writes
+            << " writes (us): " << timer_.TimePerLap().InMicrosecondsF();
+  }
+
+  base::test::SingleThreadTaskEnvironment task_environment_;
+  NoOpDelegate delegate_;
+  base::LapTimer timer_;
+
+ private:
+  DISALLOW_COPY_AND_ASSIGN(StorageAreaImplPerfTest);
+};
+
+}  // namespace
+
+// Forking alone shares the loaded map, so its cost doesn't depend on the size
+// of the map.
+TEST_F(StorageAreaImplPerfTest, ForkOnly) {
+  RunFork(100, 0);
+  RunFork(10000, 0);
+}
+
+// The first write to a fork copies the whole map. This is what session storage
+// does, as it forks a shared area when the area is first written.
+TEST_F(StorageAreaImplPerfTest, ForkAndWriteOnce) {
+  RunFork(100, 1);
+  RunFork(10000, 1);
+}
+
+}  // namespace storage
@@ -1218,6 +1218,69 @@ TEST_P(StorageAreaImplParamTest, PrefixForkAfterLoad) {
   EXPECT_EQ(kValue, GetDatabaseEntry(test_copy_prefix1_ + test_key1_));
 }
 
+TEST_F(StorageAreaImplTest, AdaptiveCommitDelay) {
+  StorageAreaImpl::Options options =
+      GetDefaultTestingOptions(CacheMode::KEYS_AND_VALUES);
+  options.adaptive_commit_delay = true;
+  MockDelegate delegate;
+  StorageAreaImpl area(database(), test_copy_prefix1_, &delegate, options);
+
+  // The first write to an area isn't expected to be followed by others, so it
+  // is committed sooner than the default delay.
+  EXPECT_TRUE(test::PutSync(&area, test_key1_bytes_, test_value1_bytes_,
+                            base::nullopt, test_source_));
+  EXPECT_LT(area.ComputeCommitDelay(), options.default_commit_delay);
+
+  // Writes in a tight loop are coalesced for longer.
+  for (int i = 0; i < 20; ++i) {
+    EXPECT_TRUE(test::PutSync(&area, test_key1_bytes_,
+                              ToBytes(base::NumberToString(i)), base::nullopt,
+                              test_source_));
+  }
+  EXPECT_GT(area.ComputeCommitDelay(), options.default_commit_delay);
+
+  BlockingCommit(&delegate, &area);
+  EXPECT_EQ("19", GetDatabaseEntry(test_copy_prefix1_ + test_key1_));
+
+  // Without the option the delay is fixed.
+  StorageAreaImpl fixed_area(
+      database(), test_copy_prefix2_, &delegate,
+      GetDefaultTestingOptions(CacheMode::KEYS_AND_VALUES));
+  EXPECT_EQ(options.default_commit_delay, fixed_area.ComputeCommitDelay());
+}
+
+TEST_F(StorageAreaImplTest, ForkSharesLoadedMapUntilWritten) {
+  // Load the keys and values.
+  EXPECT_EQ(test_value1_,
+            GetSyncStrUsingGetAll(storage_area_impl(), test_key1_));
+
+  MockDelegate fork_delegate;
+  std::unique_ptr<StorageAreaImpl> fork = storage_area_impl()->ForkToNewPrefix(
+      test_copy_prefix1_, &fork_delegate,
+      GetDefaultTestingOptions(CacheMode::KEYS_AND_VALUES));
+  EXPECT_EQ(test_value1_, GetSyncStrUsingGetAll(fork.get(), test_key1_));
+  EXPECT_EQ(test_value2_, GetSyncStrUsingGetAll(fork.get(), test_key2_));
+
+  // Writes on either side must not be visible on the other.
+  EXPECT_TRUE(test::PutSync(fork.get(), test_key1_bytes_, ToBytes("fork"),
+                            base::nullopt, test_source_));
+  EXPECT_TRUE(test::PutSync(storage_area_impl(), test_key2_bytes_,
+                            ToBytes("original"), base::nullopt, test_source_));
+  EXPECT_TRUE(test::DeleteSync(storage_area_impl(), test_key1_bytes_,
+                               base::nullopt, test_source_));
+
+  EXPECT_EQ("", GetSyncStrUsingGetAll(storage_area_impl(), test_key1_));
+  EXPECT_EQ("original", GetSyncStrUsingGetAll(storage_area_impl(), test_key2_));
+  EXPECT_EQ("fork", GetSyncStrUsingGetAll(fork.get(), test_key1_));
+  EXPECT_EQ(test_value2_, GetSyncStrUsingGetAll(fork.get(), test_key2_));
+
+  BlockingCommit();
+  BlockingCommit(&fork_delegate, fork.get());
+  EXPECT_EQ("fork", GetDatabaseEntry(test_copy_prefix1_ + test_key1_));
+  EXPECT_EQ(test_value2_, GetDatabaseEntry(test_copy_prefix1_ + test_key2_));
+  EXPECT_EQ("original", GetDatabaseEntry(test_prefix_ + test_key2_));
+}
+
 namespace {
 std::string GetNewPrefix(int* i) {
   std::string prefix = "prefix-" + base::NumberToString(*i) + "-";
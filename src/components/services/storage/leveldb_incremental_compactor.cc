@@ -0,0 +1,101 @@
+// Copyright 2020 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "components/services/storage/leveldb_incremental_compactor.h"
+
+#include <algorithm>
+#include <memory>
+#include <utility>
+
+#include "base/check.h"
+#include "base/metrics/histogram_functions.h"
+#include "third_party/leveldatabase/src/include/leveldb/db.h"
+#include "third_party/leveldatabase/src/include/leveldb/iterator.h"
+
+namespace storage {
+
+LevelDBIncrementalCompactor::LevelDBIncrementalCompactor(leveldb::DB* db,
+                                                         size_t keys_per_step)
+    : db_(db), keys_per_step_(keys_per_step) {
+  DCHECK(db_);
+  DCHECK_GT(keys_per_step_, 0u);
+}
+
+LevelDBIncrementalCompactor::~LevelDBIncrementalCompactor() = default;
+
+bool LevelDBIncrementalCompactor::CompactNextRange() {
+  DCHECK(!done_);
+  base::TimeTicks start = base::TimeTicks::Now();
+
+  // Find the end of this step's range. The iterator must be gone before
+  // compacting so that it doesn't pin the files being replaced.
+  std::string limit;
+  bool reached_end;
+  {
+    leveldb::ReadOptions options;
+    options.fill_cache = false;
+    std::unique_ptr<leveldb::Iterator> it(db_->NewIterator(options));
+    it->Seek(next_begin_);
+    for (size_t keys = 0; it->Valid() && keys < keys_per_step_; ++keys)
+      it->Next();
+    if (!it->status().ok()) {
+      done_ = true;
+      return true;
+    }
+    reached_end = !it->Valid();
+    if (reached_end) {
+      // Any key sorts before the last key with a byte appended, so this
+      // bounds the size estimate of the final range.
+      it->SeekToLast();
+      if (it->Valid())
+        limit = it->key().ToString() + '\0';
+    } else {
+      limit = it->key().ToString();
+    }
+  }
+
+  bool has_range = !limit.empty() && limit > next_begin_;
+  if (has_range)
+    bytes_before_ += GetApproximateSize(next_begin_, limit);
+
+  leveldb::Slice begin_slice(next_begin_);
+  leveldb::Slice end_slice(limit);
+  db_->CompactRange(&begin_slice, reached_end ? nullptr : &end_slice);
+
+  if (has_range)
+    bytes_after_ += GetApproximateSize(next_begin_, limit);
+
+  base::TimeDelta elapsed = base::TimeTicks::Now() - start;
+  ++steps_;
+  total_time_ += elapsed;
+  longest_step_ = std::max(longest_step_, elapsed);
+
+  next_begin_ = std::move(limit);
+  done_ = reached_end;
+  return done_;
+}
+
+void LevelDBIncrementalCompactor::RecordMetrics(
+    const std::string& histogram_prefix) const {
+  base::UmaHistogramCounts1000(histogram_prefix + ".Steps", steps_);
+  base::UmaHistogramTimes(histogram_prefix + ".LongestStep", longest_step_);
+  base::UmaHistogramMediumTimes(histogram_prefix + ".TotalTime", total_time_);
+  if (bytes_before_ > 0) {
+    base::UmaHistogramPercentage(
+        histogram_prefix + ".SizeKeptPercent",
+        static_cast<int>(std::min<uint64_t>(bytes_after_ * 100 / bytes_before_,
+                                            100)));
+  }
+}
+
+uint64_t LevelDBIncrementalCompactor::GetApproximateSize(
+    const std::string& begin,
+    const std::string& limit) const {
+  leveldb::Range range(begin, limit);
+  uint64_t size = 0;
+  db_->GetApproximateSizes(&range, 1, &size);
+  return size;
+}
+
+}  // namespace storage
@@ -0,0 +1,83 @@
+// Copyright 2020 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef COMPONENTS_SERVICES_STORAGE_LEVELDB_INCREMENTAL_COMPACTOR_H_
+#define COMPONENTS_SERVICES_STORAGE_LEVELDB_INCREMENTAL_COMPACTOR_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <string>
+
+#include "base/macros.h"
+#include "base/time/time.h"
+
+namespace leveldb {
+class DB;
+}  // namespace leveldb
+
+namespace storage {
+
+// Compacts a LevelDB database one key range at a time, so that compaction can
+// be interleaved with other work on the database's sequence instead of
+// blocking it for the whole of a CompactRange(nullptr, nullptr) call. Used by
+// both IndexedDB and DOM storage.
+//
+// Each step walks up to |keys_per_step| keys forward from where the previous
+// step stopped and compacts that range. Keys written behind the cursor after
+// it has passed them are left for the next pass.
+//
+// Must be used on the sequence that owns the database, which must outlive
+// this object.
+class LevelDBIncrementalCompactor {
+ public:
+  static constexpr size_t kDefaultKeysPerStep = 4096;
+
+  explicit LevelDBIncrementalCompactor(
+      leveldb::DB* db,
+      size_t keys_per_step = kDefaultKeysPerStep);
+  ~LevelDBIncrementalCompactor();
+
+  // Compacts the next key range. Returns true once the whole key space has
+  // been covered, or if reading the database failed.
+  bool CompactNextRange();
+
+  bool done() const { return done_; }
+  int steps() const { return steps_; }
+  base::TimeDelta longest_step() const { return longest_step_; }
+  base::TimeDelta total_time() const { return total_time_; }
+
+  // Approximate on-disk size of the compacted ranges before and after
+  // compaction.
+  uint64_t bytes_before() const { return bytes_before_; }
+  uint64_t bytes_after() const { return bytes_after_; }
+
+  // Records the number of steps, the longest step (the longest time the
+  // sequence was blocked), the total time, and how much of the on-disk size
+  // was kept, under |histogram_prefix|.
+  void RecordMetrics(const std::string& histogram_prefix) const;
+
+ private:
+  uint64_t GetApproximateSize(const std::string& begin,
+                              const std::string& limit) const;
+
+  leveldb::DB* const db_;
+  const size_t keys_per_step_;
+
+  // First key of the next range to compact.
+  std::string next_begin_;
+  bool done_ = false;
+
+  int steps_ = 0;
+  base::TimeDelta longest_step_;
+  base::TimeDelta total_time_;
+  uint64_t bytes_before_ = 0;
+  uint64_t bytes_after_ = 0;
+
+  DISALLOW_COPY_AND_ASSIGN(LevelDBIncrementalCompactor);
+};
+
+}  // namespace storage
+
+#endif  // COMPONENTS_SERVICES_STORAGE_LEVELDB_INCREMENTAL_COMPACTOR_H_
@@ -0,0 +1,97 @@
+// Copyright 2020 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "components/services/storage/leveldb_incremental_compactor.h"
+
+#include <memory>
+#include <string>
+
+#include "base/strings/stringprintf.h"
+#include "base/test/metrics/histogram_tester.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "third_party/leveldatabase/env_chromium.h"
+#include "third_party/leveldatabase/leveldb_chrome.h"
+#include "third_party/leveldatabase/src/include/leveldb/db.h"
+
+namespace storage {
+namespace {
+
+class LevelDBIncrementalCompactorTest : public testing::Test {
+ public:
+  void SetUp() override {
+    env_ = leveldb_chrome::NewMemEnv("LevelDBIncrementalCompactorTest");
+    leveldb_env::Options options;
+    options.create_if_missing = true;
+    options.env = env_.get();
+    leveldb::Status status = leveldb_env::OpenDB(options, "db", &db_);
+    ASSERT_TRUE(status.ok()) << status.ToString();
+  }
+
+  void TearDown() override {
+    db_.reset();
+    env_.reset();
+  }
+
+ protected:
+  void PutKeys(int count) {
+    for (int i = 0; i < count; ++i) {
+      ASSERT_TRUE(db_->Put(leveldb::WriteOptions(),
+                           base::StringPrintf("key%05d", i), "value")
+                      .ok());
+    }
+  }
+
+  std::unique_ptr<leveldb::Env> env_;
+  std::unique_ptr<leveldb::DB> db_;
+};
+
+TEST_F(LevelDBIncrementalCompactorTest, EmptyDatabase) {
+  LevelDBIncrementalCompactor compactor(db_.get());
+  EXPECT_TRUE(compactor.CompactNextRange());
+  EXPECT_TRUE(compactor.done());
+  EXPECT_EQ(1, compactor.steps());
+}
+
+TEST_F(LevelDBIncrementalCompactorTest, StepsThroughKeySpace) {
+  PutKeys(100);
+
+  LevelDBIncrementalCompactor compactor(db_.get(), /*keys_per_step=*/30);
+  int steps = 0;
+  while (!compactor.CompactNextRange())
+    ++steps;
+  ++steps;
+
+  // 100 keys at 30 per step: three full steps and a final partial one.
+  EXPECT_EQ(4, steps);
+  EXPECT_EQ(4, compactor.steps());
+  EXPECT_TRUE(compactor.done());
+  EXPECT_LE(compactor.longest_step(), compactor.total_time());
+
+  // Compaction must not lose data.
+  std::string value;
+  for (int i = 0; i < 100; ++i) {
+    EXPECT_TRUE(
+        db_->Get(leveldb::ReadOptions(), base::StringPrintf("key%05d", i),
+                 &value)
+            .ok());
+    EXPECT_EQ("value", value);
+  }
+}
+
+TEST_F(LevelDBIncrementalCompactorTest, RecordMetrics) {
+  PutKeys(10);
+
+  base::HistogramTester histograms;
+  LevelDBIncrementalCompactor compactor(db_.get(), /*keys_per_step=*/5);
+  while (!compactor.CompactNextRange()) {
+  }
+  compactor.RecordMetrics("Test.Compaction");
+
+  histograms.ExpectUniqueSample("Test.Compaction.Steps", 2, 1);
+  histograms.ExpectTotalCount("Test.Compaction.LongestStep", 1);
+  histograms.ExpectTotalCount("Test.Compaction.TotalTime", 1);
+}
+
+}  // namespace
+}  // namespace storage
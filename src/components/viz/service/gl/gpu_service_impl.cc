@@ -548,6 +548,14 @@ void GpuServiceImpl::InitializeWithHost(
       image_decode_accelerator_worker_.get(), vulkan_context_provider(),
       metal_context_provider_.get(), dawn_context_provider());
 
+  const base::CommandLine* command_line =
+      base::CommandLine::ForCurrentProcess();
+  if (command_line->HasSwitch(switches::kGpuProgramDiskCacheDir)) {
+    gpu_channel_manager_->InitProgramDiskCache(
+        command_line->GetSwitchValuePath(switches::kGpuProgramDiskCacheDir),
+        gpu_info_);
+  }
+
   media_gpu_channel_manager_.reset(
       new media::MediaGpuChannelManager(gpu_channel_manager_.get()));
   if (watchdog_thread())
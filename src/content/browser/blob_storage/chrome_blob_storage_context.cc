@@ -18,6 +18,7 @@
 #include "base/supports_user_data.h"
 #include "base/task/thread_pool.h"
 #include "base/task_runner.h"
+#include "base/time/time.h"
 #include "content/browser/blob_storage/blob_registry_wrapper.h"
 #include "content/browser/storage_partition_impl.h"
 #include "content/public/browser/blob_handle.h"
@@ -212,6 +213,28 @@ std::unique_ptr<BlobHandle> ChromeBlobStorageContext::CreateMemoryBackedBlob(
   return blob_handle;
 }
 
+std::unique_ptr<BlobHandle> ChromeBlobStorageContext::CreateFileBackedBlob(
+    const FilePath& path,
+    uint64_t offset,
+    uint64_t length,
+    const base::Time& expected_modification_time,
+    const std::string& content_type) {
+  DCHECK_CURRENTLY_ON(BrowserThread::IO);
+
+  std::string uuid(base::GenerateGUID());
+  auto blob_data_builder = std::make_unique<storage::BlobDataBuilder>(uuid);
+  blob_data_builder->set_content_type(content_type);
+  blob_data_builder->AppendFile(path, offset, length,
+                                expected_modification_time);
+
+  std::unique_ptr<storage::BlobDataHandle> blob_data_handle =
+      context_->AddFinishedBlob(std::move(blob_data_builder));
+  if (!blob_data_handle)
+    return std::unique_ptr<BlobHandle>();
+
+  return std::make_unique<BlobHandleImpl>(std::move(blob_data_handle));
+}
+
 // static
 scoped_refptr<network::SharedURLLoaderFactory>
 ChromeBlobStorageContext::URLLoaderFactoryForToken(
@@ -23,6 +23,7 @@
 
 namespace base {
 class TaskRunner;
+class Time;
 }
 
 namespace storage {
@@ -74,6 +75,15 @@ class CONTENT_EXPORT ChromeBlobStorageContext
       base::span<const uint8_t> data,
       const std::string& content_type);
 
+  // Returns a blob referring to a range of the file at |path| without reading
+  // it. Returns nullptr on failure.
+  std::unique_ptr<BlobHandle> CreateFileBackedBlob(
+      const base::FilePath& path,
+      uint64_t offset,
+      uint64_t length,
+      const base::Time& expected_modification_time,
+      const std::string& content_type);
+
   // Returns a SharedURLLoaderFactory capable of creating URLLoaders for exactly
   // the one URL associated with the passed in |token|. Attempting to load any
   // other URL through the factory will result in an error. If the |token|
@@ -0,0 +1,121 @@
+// Copyright 2020 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "content/browser/blob_storage/chrome_blob_storage_context.h"
+
+#include <stdint.h>
+
+#include <memory>
+#include <string>
+#include <utility>
+
+#include "base/files/file.h"
+#include "base/files/file_path.h"
+#include "base/files/file_util.h"
+#include "base/files/scoped_temp_dir.h"
+#include "base/memory/ref_counted.h"
+#include "base/run_loop.h"
+#include "base/test/bind_test_util.h"
+#include "base/time/time.h"
+#include "content/public/browser/blob_handle.h"
+#include "content/public/browser/browser_context.h"
+#include "content/public/test/browser_task_environment.h"
+#include "content/public/test/test_browser_context.h"
+#include "storage/browser/blob/blob_data_handle.h"
+#include "storage/browser/blob/blob_data_item.h"
+#include "storage/browser/blob/blob_data_snapshot.h"
+#include "storage/browser/blob/blob_storage_context.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace content {
+
+namespace {
+
+const char kFileContents[] = "0123456789";
+const char kContentType[] = "text/plain";
+
+}  // namespace
+
+class ChromeBlobStorageContextTest : public testing::Test {
+ public:
+  ChromeBlobStorageContextTest()
+      : task_environment_(BrowserTaskEnvironment::IO_MAINLOOP) {}
+
+  void SetUp() override {
+    ASSERT_TRUE(temp_dir_.CreateUniqueTempDir());
+    file_path_ = temp_dir_.GetPath().AppendASCII("data");
+    ASSERT_TRUE(base::WriteFile(file_path_, kFileContents));
+    base::File::Info info;
+    ASSERT_TRUE(base::GetFileInfo(file_path_, &info));
+    modification_time_ = info.last_modified;
+
+    blob_context_ = ChromeBlobStorageContext::GetFor(&browser_context_);
+    // Wait for ChromeBlobStorageContext to finish initializing.
+    base::RunLoop().RunUntilIdle();
+  }
+
+  // Returns the single item of the blob behind |handle|.
+  scoped_refptr<storage::BlobDataItem> GetOnlyItem(BlobHandle* handle) {
+    std::unique_ptr<storage::BlobDataHandle> data =
+        blob_context_->context()->GetBlobDataFromUUID(handle->GetUUID());
+    EXPECT_TRUE(data);
+    if (!data)
+      return nullptr;
+    EXPECT_EQ(kContentType, data->content_type());
+    std::unique_ptr<storage::BlobDataSnapshot> snapshot =
+        data->CreateSnapshot();
+    EXPECT_EQ(1u, snapshot->items().size());
+    if (snapshot->items().size() != 1u)
+      return nullptr;
+    return snapshot->items()[0];
+  }
+
+ protected:
+  BrowserTaskEnvironment task_environment_;
+  TestBrowserContext browser_context_;
+  base::ScopedTempDir temp_dir_;
+  base::FilePath file_path_;
+  base::Time modification_time_;
+  scoped_refptr<ChromeBlobStorageContext> blob_context_;
+};
+
+TEST_F(ChromeBlobStorageContextTest, CreateFileBackedBlob) {
+  std::unique_ptr<BlobHandle> handle = blob_context_->CreateFileBackedBlob(
+      file_path_, /*offset=*/2, /*length=*/5, modification_time_,
+      kContentType);
+  ASSERT_TRUE(handle);
+
+  // The blob refers to the file range instead of holding a copy of it.
+  scoped_refptr<storage::BlobDataItem> item = GetOnlyItem(handle.get());
+  ASSERT_TRUE(item);
+  EXPECT_EQ(storage::BlobDataItem::Type::kFile, item->type());
+  EXPECT_EQ(file_path_, item->path());
+  EXPECT_EQ(2u, item->offset());
+  EXPECT_EQ(5u, item->length());
+  EXPECT_EQ(modification_time_, item->expected_modification_time());
+}
+
+TEST_F(ChromeBlobStorageContextTest, CreateFileBackedBlobFromBrowserContext) {
+  std::unique_ptr<BlobHandle> handle;
+  base::RunLoop run_loop;
+  BrowserContext::CreateFileBackedBlob(
+      &browser_context_, file_path_, /*offset=*/0,
+      /*length=*/sizeof(kFileContents) - 1, base::Time(), kContentType,
+      base::BindLambdaForTesting([&](std::unique_ptr<BlobHandle> result) {
+        handle = std::move(result);
+        run_loop.Quit();
+      }));
+  run_loop.Run();
+  ASSERT_TRUE(handle);
+
+  scoped_refptr<storage::BlobDataItem> item = GetOnlyItem(handle.get());
+  ASSERT_TRUE(item);
+  EXPECT_EQ(storage::BlobDataItem::Type::kFile, item->type());
+  EXPECT_EQ(file_path_, item->path());
+  EXPECT_EQ(0u, item->offset());
+  EXPECT_EQ(sizeof(kFileContents) - 1, item->length());
+  EXPECT_TRUE(item->expected_modification_time().is_null());
+}
+
+}  // namespace content
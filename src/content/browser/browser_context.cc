@@ -30,6 +30,7 @@
 #include "base/supports_user_data.h"
 #include "base/threading/sequenced_task_runner_handle.h"
 #include "base/threading/thread_task_runner_handle.h"
+#include "base/time/time.h"
 #include "base/unguessable_token.h"
 #include "build/build_config.h"
 #include "content/browser/background_sync/background_sync_scheduler.h"
@@ -311,6 +312,27 @@ void BrowserContext::CreateMemoryBackedBlob(BrowserContext* browser_context,
       std::move(callback));
 }
 
+// static
+void BrowserContext::CreateFileBackedBlob(
+    BrowserContext* browser_context,
+    const base::FilePath& path,
+    uint64_t offset,
+    uint64_t length,
+    const base::Time& expected_modification_time,
+    const std::string& content_type,
+    BlobCallback callback) {
+  DCHECK_CURRENTLY_ON(BrowserThread::UI);
+
+  ChromeBlobStorageContext* blob_context =
+      ChromeBlobStorageContext::GetFor(browser_context);
+  GetIOThreadTaskRunner({})->PostTaskAndReplyWithResult(
+      FROM_HERE,
+      base::BindOnce(&ChromeBlobStorageContext::CreateFileBackedBlob,
+                     base::WrapRefCounted(blob_context), path, offset, length,
+                     expected_modification_time, content_type),
+      std::move(callback));
+}
+
 // static
 BrowserContext::BlobContextGetter BrowserContext::GetBlobStorageContext(
     BrowserContext* browser_context) {
@@ -17,6 +17,7 @@
 namespace content {
 
 const int CacheStorageBlobToDiskCache::kBufferSize = 1024 * 512;
+const int CacheStorageBlobToDiskCache::kMaxBytesPerTask = 1024 * 1024 * 8;
 
 CacheStorageBlobToDiskCache::CacheStorageBlobToDiskCache(
     scoped_refptr<storage::QuotaManagerProxy> quota_manager_proxy,
@@ -109,6 +110,20 @@ void CacheStorageBlobToDiskCache::RunCallback(bool success) {
 }
 
 void CacheStorageBlobToDiskCache::OnDataPipeReadable(MojoResult unused) {
+  // Keep copying while the entry completes writes synchronously so that large
+  // bodies don't pay for a task round trip per chunk, but yield once in a
+  // while to avoid starving other work on the sequence.
+  int bytes_written = 0;
+  while (bytes_written < kMaxBytesPerTask) {
+    int rv = WriteAvailableDataToEntry();
+    if (rv == 0)
+      return;
+    bytes_written += rv;
+  }
+  ReadFromBlob();
+}
+
+int CacheStorageBlobToDiskCache::WriteAvailableDataToEntry() {
   // Get the handle_ from a previous read operation if we have one.
   if (pending_read_) {
     DCHECK(pending_read_->IsComplete());
@@ -123,7 +138,7 @@ void CacheStorageBlobToDiskCache::OnDataPipeReadable(MojoResult unused) {
 
   if (result == MOJO_RESULT_SHOULD_WAIT) {
     handle_watcher_.ArmOrNotify();
-    return;
+    return 0;
   }
 
   if (result == MOJO_RESULT_FAILED_PRECONDITION) {
@@ -133,28 +148,42 @@ void CacheStorageBlobToDiskCache::OnDataPipeReadable(MojoResult unused) {
       RunCallback(static_cast<uint64_t>(cache_entry_offset_) ==
                   expected_total_size_);
     }
-    return;
+    return 0;
   }
 
   if (result != MOJO_RESULT_OK) {
     RunCallback(false /* success */);
-    return;
+    return 0;
   }
 
   int bytes_to_read = std::min<int>(kBufferSize, available);
 
-  auto buffer = base::MakeRefCounted<network::MojoToNetIOBuffer>(
-      pending_read_.get(), bytes_to_read);
+  int rv;
+  {
+    auto buffer = base::MakeRefCounted<network::MojoToNetIOBuffer>(
+        pending_read_.get(), bytes_to_read);
+
+    net::CompletionOnceCallback cache_write_callback =
+        base::BindOnce(&CacheStorageBlobToDiskCache::DidWriteDataToEntry,
+                       weak_ptr_factory_.GetWeakPtr(), bytes_to_read);
 
-  net::CompletionOnceCallback cache_write_callback =
-      base::BindOnce(&CacheStorageBlobToDiskCache::DidWriteDataToEntry,
-                     weak_ptr_factory_.GetWeakPtr(), bytes_to_read);
+    rv = entry_->WriteData(disk_cache_body_index_, cache_entry_offset_,
+                           buffer.get(), bytes_to_read,
+                           std::move(cache_write_callback),
+                           true /* truncate */);
+  }
+  if (rv == net::ERR_IO_PENDING)
+    return 0;
 
-  int rv = entry_->WriteData(
-      disk_cache_body_index_, cache_entry_offset_, buffer.get(), bytes_to_read,
-      std::move(cache_write_callback), true /* truncate */);
-  if (rv != net::ERR_IO_PENDING)
+  if (rv != bytes_to_read || !pending_read_->IsComplete()) {
+    // Either the write failed or the entry still holds on to the buffer, in
+    // which case the next chunk is read once the watcher fires again.
     CacheStorageBlobToDiskCache::DidWriteDataToEntry(bytes_to_read, rv);
+    return 0;
+  }
+
+  cache_entry_offset_ += rv;
+  return rv;
 }
 
 }  // namespace content
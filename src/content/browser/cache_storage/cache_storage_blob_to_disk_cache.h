@@ -35,6 +35,10 @@ class CONTENT_EXPORT CacheStorageBlobToDiskCache
   // The buffer size used for reading from blobs and writing to disk cache.
   static const int kBufferSize;
 
+  // The maximum number of bytes copied from the data pipe to the entry
+  // within a single task when the entry completes writes synchronously.
+  static const int kMaxBytesPerTask;
+
   CacheStorageBlobToDiskCache(
       scoped_refptr<storage::QuotaManagerProxy> quota_manager_proxy,
       const url::Origin& origin);
@@ -65,6 +69,11 @@ class CONTENT_EXPORT CacheStorageBlobToDiskCache
 
   void OnDataPipeReadable(MojoResult result);
 
+  // Writes the currently readable data to the entry. Returns the number of
+  // bytes written if the write completed synchronously and the next chunk can
+  // be read right away, otherwise 0.
+  int WriteAvailableDataToEntry();
+
   int cache_entry_offset_ = 0;
   ScopedWritableEntry entry_;
 
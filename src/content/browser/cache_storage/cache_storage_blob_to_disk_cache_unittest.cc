@@ -58,8 +58,11 @@ class TestCacheStorageBlobToDiskCache : public CacheStorageBlobToDiskCache {
 
   const url::Origin& origin() { return CacheStorageBlobToDiskCache::origin(); }
 
+  int read_from_blob_count() const { return read_from_blob_count_; }
+
  protected:
   void ReadFromBlob() override {
+    ++read_from_blob_count_;
     if (delay_blob_reads_)
       return;
     ContinueReadFromBlob();
@@ -67,6 +70,7 @@ class TestCacheStorageBlobToDiskCache : public CacheStorageBlobToDiskCache {
 
  private:
   bool delay_blob_reads_ = false;
+  int read_from_blob_count_ = 0;
 
   DISALLOW_COPY_AND_ASSIGN(TestCacheStorageBlobToDiskCache);
 };
@@ -216,6 +220,20 @@ TEST_F(CacheStorageBlobToDiskCacheTest, StreamLarge) {
   EXPECT_STREQ(data_.c_str(), ReadCacheContent().c_str());
 }
 
+TEST_F(CacheStorageBlobToDiskCacheTest, StreamLargeWithSynchronousWrites) {
+  blob_handle_.reset();
+  base::RunLoop().RunUntilIdle();
+
+  data_ = std::string(CacheStorageBlobToDiskCache::kBufferSize * 4, '.');
+  InitBlob();
+
+  // The memory cache completes writes synchronously, so the chunks should be
+  // copied without going back through ReadFromBlob() after the initial read.
+  EXPECT_TRUE(Stream());
+  EXPECT_EQ(1, cache_storage_blob_to_disk_cache_->read_from_blob_count());
+  EXPECT_STREQ(data_.c_str(), ReadCacheContent().c_str());
+}
+
 TEST_F(CacheStorageBlobToDiskCacheTest, TestDelayMidStream) {
   cache_storage_blob_to_disk_cache_->set_delay_blob_reads(true);
 
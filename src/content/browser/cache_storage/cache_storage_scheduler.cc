@@ -75,17 +75,19 @@ void CacheStorageScheduler::ScheduleOperation(
     CacheStorageSchedulerOp op_type,
     CacheStorageSchedulerPriority priority,
     base::OnceClosure closure) {
-  DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
-  RecordCacheStorageSchedulerUMA(CacheStorageSchedulerUMA::kQueueLength,
-                                 client_type_, op_type,
-                                 pending_operations_.size());
+  ScheduleOperationImpl(id, mode, op_type, priority, std::string(),
+                        std::move(closure));
+}
 
-  pending_operations_.push_back(std::make_unique<CacheStorageOperation>(
-      std::move(closure), id, client_type_, mode, op_type, priority,
-      task_runner_));
-  std::push_heap(pending_operations_.begin(), pending_operations_.end(),
-                 &OpPointerLessThan);
-  MaybeRunOperation();
+void CacheStorageScheduler::ScheduleKeyedOperation(
+    CacheStorageSchedulerId id,
+    CacheStorageSchedulerMode mode,
+    CacheStorageSchedulerOp op_type,
+    CacheStorageSchedulerPriority priority,
+    const std::string& key,
+    base::OnceClosure closure) {
+  DCHECK(!key.empty());
+  ScheduleOperationImpl(id, mode, op_type, priority, key, std::move(closure));
 }
 
 void CacheStorageScheduler::CompleteOperationAndRunNext(
@@ -96,12 +98,10 @@ void CacheStorageScheduler::CompleteOperationAndRunNext(
   DCHECK_EQ(it->second->id(), id);
 
   if (it->second->mode() == CacheStorageSchedulerMode::kShared) {
-    DCHECK_EQ(num_running_exclusive_, 0);
     DCHECK_GT(num_running_shared_, 0);
     num_running_shared_ -= 1;
   } else {
-    DCHECK_EQ(num_running_shared_, 0);
-    DCHECK_EQ(num_running_exclusive_, 1);
+    DCHECK_GT(num_running_exclusive_, 0);
     num_running_exclusive_ -= 1;
   }
 
@@ -135,18 +135,11 @@ void CacheStorageScheduler::MaybeRunOperation() {
 
   auto* next_operation = pending_operations_.front().get();
 
-  // Determine if we can run the next operation based on its mode
-  // and the current state of executing operations.  We allow multiple
-  // kShared operations to run in parallel, but a kExclusive operation
-  // must not overlap with any other operation.
-  if (next_operation->mode() == CacheStorageSchedulerMode::kShared) {
-    if (num_running_exclusive_ > 0 ||
-        num_running_shared_ >= kCacheStorageMaxSharedOps.Get()) {
-      DoneStartingAvailableOperations();
-      return;
-    }
-  } else if (num_running_shared_ > 0 || num_running_exclusive_ > 0) {
-    DCHECK_EQ(next_operation->mode(), CacheStorageSchedulerMode::kExclusive);
+  // Determine if we can run the next operation based on its mode and key
+  // and the current state of executing operations.  Operations are started
+  // strictly in queue order so that a blocked operation is not starved by
+  // later ones.
+  if (!CanRunOperation(*next_operation)) {
     DoneStartingAvailableOperations();
     return;
   }
@@ -162,25 +155,77 @@ void CacheStorageScheduler::MaybeRunOperation() {
       next_operation->op_type(),
       base::TimeTicks::Now() - next_operation->creation_ticks());
 
-  if (next_operation->mode() == CacheStorageSchedulerMode::kShared) {
-    DCHECK_EQ(num_running_exclusive_, 0);
+  if (next_operation->mode() == CacheStorageSchedulerMode::kShared)
     num_running_shared_ += 1;
-  } else {
-    DCHECK_EQ(num_running_exclusive_, 0);
-    DCHECK_EQ(num_running_shared_, 0);
+  else
     num_running_exclusive_ += 1;
-  }
 
   DispatchOperationTask(
       base::BindOnce(&CacheStorageOperation::Run, next_operation->AsWeakPtr()));
 
-  // If we just executed a kShared operation, then we may be able to schedule
-  // additional kShared parallel operations.  Recurse to process the next
+  // If we just executed a kShared or keyed operation, then we may be able to
+  // schedule additional parallel operations.  Recurse to process the next
   // pending operation.
-  if (next_operation->mode() == CacheStorageSchedulerMode::kShared)
+  if (next_operation->mode() == CacheStorageSchedulerMode::kShared ||
+      !next_operation->key().empty()) {
     MaybeRunOperation();
-  else
+  } else {
     DoneStartingAvailableOperations();
+  }
+}
+
+void CacheStorageScheduler::ScheduleOperationImpl(
+    CacheStorageSchedulerId id,
+    CacheStorageSchedulerMode mode,
+    CacheStorageSchedulerOp op_type,
+    CacheStorageSchedulerPriority priority,
+    const std::string& key,
+    base::OnceClosure closure) {
+  DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+  RecordCacheStorageSchedulerUMA(CacheStorageSchedulerUMA::kQueueLength,
+                                 client_type_, op_type,
+                                 pending_operations_.size());
+
+  pending_operations_.push_back(std::make_unique<CacheStorageOperation>(
+      std::move(closure), id, client_type_, mode, op_type, priority, key,
+      task_runner_));
+  std::push_heap(pending_operations_.begin(), pending_operations_.end(),
+                 &OpPointerLessThan);
+  MaybeRunOperation();
+}
+
+bool CacheStorageScheduler::CanRunOperation(
+    const CacheStorageOperation& operation) const {
+  DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+  if (running_operations_.empty())
+    return true;
+
+  // An unkeyed kExclusive operation must not overlap with any other
+  // operation.
+  if (operation.mode() == CacheStorageSchedulerMode::kExclusive &&
+      operation.key().empty()) {
+    return false;
+  }
+
+  if (running_operations_.size() >=
+      static_cast<size_t>(kCacheStorageMaxSharedOps.Get())) {
+    return false;
+  }
+
+  // Shared operations never conflict with each other.  Otherwise two
+  // operations may only overlap if both are limited to different keys.
+  for (const auto& entry : running_operations_) {
+    const CacheStorageOperation& running = *entry.second;
+    if (operation.mode() == CacheStorageSchedulerMode::kShared &&
+        running.mode() == CacheStorageSchedulerMode::kShared) {
+      continue;
+    }
+    if (operation.key().empty() || running.key().empty() ||
+        operation.key() == running.key()) {
+      return false;
+    }
+  }
+  return true;
 }
 
 }  // namespace content
@@ -6,6 +6,7 @@
 #define CONTENT_BROWSER_CACHE_STORAGE_CACHE_STORAGE_SCHEDULER_H_
 
 #include <map>
+#include <string>
 #include <vector>
 
 #include "base/bind.h"
@@ -27,6 +28,10 @@ class CacheStorageOperation;
 // operation by calling ScheduleOperation() with your callback. Once your
 // operation is done be sure to call CompleteOperationAndRunNext() to schedule
 // the next operation.
+//
+// Operations that only touch the entries of a single request can be scheduled
+// with ScheduleKeyedOperation() instead.  These act as reader/writer locks on
+// that key, so matches and puts of distinct requests may run in parallel.
 class CONTENT_EXPORT CacheStorageScheduler {
  public:
   CacheStorageScheduler(CacheStorageSchedulerClient client_type,
@@ -48,6 +53,17 @@ class CONTENT_EXPORT CacheStorageScheduler {
                          CacheStorageSchedulerPriority priority,
                          base::OnceClosure closure);
 
+  // Like ScheduleOperation(), but limits the operation to the entries of
+  // |key|.  Two operations conflict unless both are kShared or both are keyed
+  // with different keys, so puts and matches of distinct requests can run in
+  // parallel.  |key| must not be empty.
+  void ScheduleKeyedOperation(CacheStorageSchedulerId id,
+                              CacheStorageSchedulerMode mode,
+                              CacheStorageSchedulerOp op_type,
+                              CacheStorageSchedulerPriority priority,
+                              const std::string& key,
+                              base::OnceClosure closure);
+
   // Call this after each operation completes. It cleans up the operation
   // associated with the given id.  If may also start the next set of
   // operations.
@@ -56,7 +72,8 @@ class CONTENT_EXPORT CacheStorageScheduler {
   // Returns true if there are any running or pending operations.
   bool ScheduledOperations() const;
 
-  // Returns true if the scheduler is currently running an exclusive operation.
+  // Returns true if the scheduler is currently running an exclusive operation,
+  // keyed or not.
   bool IsRunningExclusiveOperation() const;
 
   // Wraps |callback| to also call CompleteOperationAndRunNext.
@@ -81,6 +98,17 @@ class CONTENT_EXPORT CacheStorageScheduler {
   // set of running operations and the mode of the next operation.
   void MaybeRunOperation();
 
+  void ScheduleOperationImpl(CacheStorageSchedulerId id,
+                             CacheStorageSchedulerMode mode,
+                             CacheStorageSchedulerOp op_type,
+                             CacheStorageSchedulerPriority priority,
+                             const std::string& key,
+                             base::OnceClosure closure);
+
+  // Returns true if |operation| does not conflict with any running operation
+  // and there is room for another parallel operation.
+  bool CanRunOperation(const CacheStorageOperation& operation) const;
+
   template <typename... Args>
   void RunNextContinuation(CacheStorageSchedulerId id,
                            base::OnceCallback<void(Args...)> callback,
@@ -533,5 +533,124 @@ TEST_F(CacheStorageSchedulerTest, ScheduleByPriorityTwoNormalOneHigh) {
   EXPECT_EQ(1, task3_.callback_count());
 }
 
+TEST_F(CacheStorageSchedulerTest, ScheduleTwoKeyedExclusiveDistinctKeys) {
+  base::test::ScopedFeatureList scoped_feature_list;
+  scoped_feature_list.InitAndEnableFeatureWithParameters(
+      features::kCacheStorageParallelOps, {{"max_shared_ops", "3"}});
+
+  scheduler_.ScheduleKeyedOperation(
+      task1_.id(), CacheStorageSchedulerMode::kExclusive,
+      CacheStorageSchedulerOp::kPut, CacheStorageSchedulerPriority::kNormal,
+      "https://example.com/a",
+      base::BindOnce(&TestTask::Run, base::Unretained(&task1_)));
+  base::RunLoop done_loop1;
+  scheduler_.SetDoneStartingClosure(done_loop1.QuitClosure());
+  scheduler_.ScheduleKeyedOperation(
+      task2_.id(), CacheStorageSchedulerMode::kExclusive,
+      CacheStorageSchedulerOp::kPut, CacheStorageSchedulerPriority::kNormal,
+      "https://example.com/b",
+      base::BindOnce(&TestTask::Run, base::Unretained(&task2_)));
+
+  // Writes to different keys should run in parallel.
+  task1_.run_loop().Run();
+  task2_.run_loop().Run();
+  done_loop1.Run();
+  EXPECT_EQ(1, task1_.callback_count());
+  EXPECT_EQ(1, task2_.callback_count());
+  EXPECT_TRUE(scheduler_.IsRunningExclusiveOperation());
+
+  task1_.Done();
+  EXPECT_TRUE(scheduler_.IsRunningExclusiveOperation());
+  task2_.Done();
+  EXPECT_FALSE(scheduler_.IsRunningExclusiveOperation());
+  EXPECT_FALSE(scheduler_.ScheduledOperations());
+}
+
+TEST_F(CacheStorageSchedulerTest, ScheduleTwoKeyedExclusiveSameKey) {
+  base::test::ScopedFeatureList scoped_feature_list;
+  scoped_feature_list.InitAndEnableFeatureWithParameters(
+      features::kCacheStorageParallelOps, {{"max_shared_ops", "3"}});
+
+  scheduler_.ScheduleKeyedOperation(
+      task1_.id(), CacheStorageSchedulerMode::kExclusive,
+      CacheStorageSchedulerOp::kPut, CacheStorageSchedulerPriority::kNormal,
+      "https://example.com/a",
+      base::BindOnce(&TestTask::Run, base::Unretained(&task1_)));
+  base::RunLoop done_loop1;
+  scheduler_.SetDoneStartingClosure(done_loop1.QuitClosure());
+  scheduler_.ScheduleKeyedOperation(
+      task2_.id(), CacheStorageSchedulerMode::kShared,
+      CacheStorageSchedulerOp::kMatch, CacheStorageSchedulerPriority::kNormal,
+      "https://example.com/a",
+      base::BindOnce(&TestTask::Run, base::Unretained(&task2_)));
+
+  // A match must not observe a write in progress to the same key.
+  task1_.run_loop().Run();
+  done_loop1.Run();
+  EXPECT_EQ(1, task1_.callback_count());
+  EXPECT_EQ(0, task2_.callback_count());
+
+  base::RunLoop done_loop2;
+  scheduler_.SetDoneStartingClosure(done_loop2.QuitClosure());
+
+  // Should run the match once the write completes.
+  task1_.Done();
+  task2_.run_loop().Run();
+  done_loop2.Run();
+  EXPECT_EQ(1, task2_.callback_count());
+  EXPECT_FALSE(scheduler_.IsRunningExclusiveOperation());
+
+  task2_.Done();
+  EXPECT_FALSE(scheduler_.ScheduledOperations());
+}
+
+TEST_F(CacheStorageSchedulerTest, ScheduleHighPriorityMatchDuringKeyedWrite) {
+  base::test::ScopedFeatureList scoped_feature_list;
+  scoped_feature_list.InitAndEnableFeatureWithParameters(
+      features::kCacheStorageParallelOps, {{"max_shared_ops", "3"}});
+
+  // A background write of one entry followed by a write of the whole cache.
+  scheduler_.ScheduleKeyedOperation(
+      task1_.id(), CacheStorageSchedulerMode::kExclusive,
+      CacheStorageSchedulerOp::kPut, CacheStorageSchedulerPriority::kNormal,
+      "https://example.com/a",
+      base::BindOnce(&TestTask::Run, base::Unretained(&task1_)));
+  scheduler_.ScheduleOperation(
+      task2_.id(), CacheStorageSchedulerMode::kExclusive,
+      CacheStorageSchedulerOp::kDelete, CacheStorageSchedulerPriority::kNormal,
+      base::BindOnce(&TestTask::Run, base::Unretained(&task2_)));
+  base::RunLoop done_loop1;
+  scheduler_.SetDoneStartingClosure(done_loop1.QuitClosure());
+  scheduler_.ScheduleKeyedOperation(
+      task3_.id(), CacheStorageSchedulerMode::kShared,
+      CacheStorageSchedulerOp::kMatch, CacheStorageSchedulerPriority::kHigh,
+      "https://example.com/b",
+      base::BindOnce(&TestTask::Run, base::Unretained(&task3_)));
+
+  // The high priority match jumps ahead of the queued exclusive op and runs
+  // alongside the write to another key.
+  task1_.run_loop().Run();
+  task3_.run_loop().Run();
+  done_loop1.Run();
+  EXPECT_EQ(1, task1_.callback_count());
+  EXPECT_EQ(0, task2_.callback_count());
+  EXPECT_EQ(1, task3_.callback_count());
+
+  // The unkeyed exclusive op waits for both to complete.
+  task3_.Done();
+  EXPECT_EQ(0, task2_.callback_count());
+
+  base::RunLoop done_loop2;
+  scheduler_.SetDoneStartingClosure(done_loop2.QuitClosure());
+  task1_.Done();
+  task2_.run_loop().Run();
+  done_loop2.Run();
+  EXPECT_EQ(1, task2_.callback_count());
+  EXPECT_TRUE(scheduler_.IsRunningExclusiveOperation());
+
+  task2_.Done();
+  EXPECT_FALSE(scheduler_.ScheduledOperations());
+}
+
 }  // namespace cache_storage_scheduler_unittest
 }  // namespace content
@@ -8,7 +8,10 @@
 #include "base/memory/ptr_util.h"
 #include "base/metrics/field_trial_params.h"
 #include "base/metrics/histogram_macros.h"
+#include "base/stl_util.h"
 #include "base/strings/string_number_conversions.h"
+#include "base/strings/string_split.h"
+#include "base/strings/string_util.h"
 #include "content/public/common/url_constants.h"
 #include "crypto/sha2.h"
 #include "net/base/completion_once_callback.h"
@@ -17,6 +20,9 @@
 
 namespace content {
 
+const base::Feature kCodeCachePrefetch{"CodeCachePrefetch",
+                                       base::FEATURE_DISABLED_BY_DEFAULT};
+
 #if defined(USE_FILESCHEME_CODECACHE)
 namespace neva {
 bool IsFileSchemeSupportedForCodeCache(const GURL& url) {
@@ -31,6 +37,23 @@ namespace {
 
 constexpr char kPrefix[] = "_key";
 constexpr char kSeparator[] = " \n";
+// Prefix of the entries holding an origin lock's hot script set. It has the
+// same length as |kPrefix|, so GetResourceURLFromKey() returns the origin lock
+// for these entries and clearing an origin's data also clears its manifest.
+constexpr char kHotScriptManifestPrefix[] = "_hot";
+static_assert(sizeof(kHotScriptManifestPrefix) == sizeof(kPrefix),
+              "Manifest keys must parse like resource keys");
+
+// Upper bounds for the hot script set recorded per origin lock, and for the
+// total size of the entries prefetched into memory.
+constexpr size_t kMaxHotScripts = 100;
+constexpr size_t kMaxPrefetchedBytes = 8 * 1024 * 1024;
+// How long after the last new hot script the manifests are written.
+constexpr base::TimeDelta kManifestWriteDelay =
+    base::TimeDelta::FromSeconds(10);
+// Prefetched entries not requested within this time are dropped.
+constexpr base::TimeDelta kPrefetchExpiryDelay =
+    base::TimeDelta::FromSeconds(30);
 
 // We always expect to receive valid URLs that can be used as keys to the code
 // cache. The relevant checks (for ex: resource_url is valid, origin_lock is
@@ -99,6 +122,25 @@ std::string GetCacheKey(const GURL& resource_url, const GURL& origin_lock) {
   return key;
 }
 
+std::string GetHotScriptManifestKey(const GURL& origin_lock) {
+  std::string key(kHotScriptManifestPrefix);
+  key.append(net::SimplifyUrlForRequest(origin_lock).spec());
+  key.append(kSeparator);
+  return key;
+}
+
+// Resource URLs read back from a manifest are not trusted to be valid cache
+// keys, since the file may be stale or corrupt.
+bool IsValidResourceURL(const GURL& resource_url) {
+#if defined(USE_FILESCHEME_CODECACHE)
+  return resource_url.is_valid() &&
+         (resource_url.SchemeIsHTTPOrHTTPS() ||
+          content::neva::IsFileSchemeSupportedForCodeCache(resource_url));
+#else
+  return resource_url.is_valid() && resource_url.SchemeIsHTTPOrHTTPS();
+#endif
+}
+
 constexpr size_t kResponseTimeSizeInBytes = sizeof(int64_t);
 constexpr size_t kDataSizeInBytes = sizeof(uint32_t);
 constexpr size_t kHeaderSizeInBytes =
@@ -214,6 +256,8 @@ class BigIOBuffer : public net::IOBufferWithSize {
 
 }  // namespace
 
+constexpr size_t GeneratedCodeCache::kMaxHotScriptOrigins;
+
 std::string GeneratedCodeCache::GetResourceURLFromKey(const std::string& key) {
   constexpr size_t kPrefixStringLen = base::size(kPrefix) - 1;
   // |key| may not have a prefix and separator (e.g. for deduplicated entries).
@@ -314,6 +358,11 @@ class GeneratedCodeCache::PendingOperation {
     return response_time_;
   }
 
+  // Prefetches read entries ahead of the renderer's requests, so they are
+  // left out of the hit/miss statistics.
+  bool is_prefetch() const { return is_prefetch_; }
+  void set_is_prefetch(bool is_prefetch) { is_prefetch_ = is_prefetch; }
+
   // These are called by write and fetch operations to track buffer completions
   // and signal when the operation has finished, and whether it was successful.
   bool succeeded() const { return succeeded_; }
@@ -338,10 +387,22 @@ class GeneratedCodeCache::PendingOperation {
   GetBackendCallback backend_callback_;
   int completions_ = 0;
   bool succeeded_ = true;
+  bool is_prefetch_ = false;
 };
 
 GeneratedCodeCache::PendingOperation::~PendingOperation() = default;
 
+GeneratedCodeCache::PrefetchedEntry::PrefetchedEntry() = default;
+GeneratedCodeCache::PrefetchedEntry::PrefetchedEntry(PrefetchedEntry&& other) =
+    default;
+GeneratedCodeCache::PrefetchedEntry::~PrefetchedEntry() = default;
+GeneratedCodeCache::PrefetchedEntry&
+GeneratedCodeCache::PrefetchedEntry::operator=(PrefetchedEntry&& other) =
+    default;
+
+GeneratedCodeCache::HotScriptSet::HotScriptSet() = default;
+GeneratedCodeCache::HotScriptSet::~HotScriptSet() = default;
+
 GeneratedCodeCache::GeneratedCodeCache(const base::FilePath& path,
                                        int max_size_bytes,
                                        CodeCacheType cache_type)
@@ -373,6 +434,13 @@ void GeneratedCodeCache::WriteEntry(const GURL& url,
                                     const GURL& origin_lock,
                                     const base::Time& response_time,
                                     mojo_base::BigBuffer data) {
+  WriteEntryWithKey(GetCacheKey(url, origin_lock), response_time,
+                    std::move(data));
+}
+
+void GeneratedCodeCache::WriteEntryWithKey(const std::string& key,
+                                           const base::Time& response_time,
+                                           mojo_base::BigBuffer data) {
   if (backend_state_ == kFailed) {
     // Silently fail the request.
     CollectStatistics(CacheEntryStatus::kError);
@@ -436,7 +504,6 @@ void GeneratedCodeCache::WriteEntry(const GURL& url,
   WriteCommonDataHeader(small_buffer, response_time, data_size);
 
   // Create the write operation.
-  std::string key = GetCacheKey(url, origin_lock);
   auto op = std::make_unique<PendingOperation>(Operation::kWrite, key,
                                                small_buffer, large_buffer);
   EnqueueOperation(std::move(op));
@@ -445,16 +512,33 @@ void GeneratedCodeCache::WriteEntry(const GURL& url,
 void GeneratedCodeCache::FetchEntry(const GURL& url,
                                     const GURL& origin_lock,
                                     ReadDataCallback read_data_callback) {
+  if (!origin_lock.is_empty() &&
+      base::FeatureList::IsEnabled(kCodeCachePrefetch)) {
+    PrefetchHotEntries(origin_lock);
+    // Only scripts found in the cache are worth prefetching on the next run.
+    // Fetch callbacks are only run by this cache, so |this| outlives it.
+    read_data_callback = base::BindRepeating(
+        &GeneratedCodeCache::RecordHotScriptIfFound, base::Unretained(this),
+        origin_lock, url, std::move(read_data_callback));
+  }
+  FetchEntryWithKey(GetCacheKey(url, origin_lock),
+                    std::move(read_data_callback), /*is_prefetch=*/false);
+}
+
+void GeneratedCodeCache::FetchEntryWithKey(const std::string& key,
+                                           ReadDataCallback read_data_callback,
+                                           bool is_prefetch) {
   if (backend_state_ == kFailed) {
-    CollectStatistics(CacheEntryStatus::kError);
+    if (!is_prefetch)
+      CollectStatistics(CacheEntryStatus::kError);
     // Fail the request.
     std::move(read_data_callback).Run(base::Time(), mojo_base::BigBuffer());
     return;
   }
 
-  std::string key = GetCacheKey(url, origin_lock);
   auto op = std::make_unique<PendingOperation>(Operation::kFetch, key,
                                                std::move(read_data_callback));
+  op->set_is_prefetch(is_prefetch);
   EnqueueOperation(std::move(op));
 }
 
@@ -470,6 +554,160 @@ void GeneratedCodeCache::DeleteEntry(const GURL& url, const GURL& origin_lock) {
   EnqueueOperation(std::move(op));
 }
 
+void GeneratedCodeCache::PrefetchHotEntries(const GURL& origin_lock) {
+  // Processes that are not locked to an origin share the empty origin lock,
+  // so there is no per-origin set to record.
+  if (origin_lock.is_empty() ||
+      !base::FeatureList::IsEnabled(kCodeCachePrefetch) ||
+      backend_state_ == kFailed) {
+    return;
+  }
+  if (hot_scripts_.Get(origin_lock) != hot_scripts_.end())
+    return;
+  // Write out the set that is about to be evicted, so what it recorded isn't
+  // lost. That origin lock is prefetched again if it comes back this run.
+  if (hot_scripts_.size() == hot_scripts_.max_size()) {
+    auto lru = hot_scripts_.rbegin();
+    WriteHotScriptManifest(lru->first, &lru->second);
+  }
+  hot_scripts_.Put(origin_lock, HotScriptSet());
+
+  FetchEntryWithKey(
+      GetHotScriptManifestKey(origin_lock),
+      base::BindRepeating(&GeneratedCodeCache::OnHotScriptManifestRead,
+                          weak_ptr_factory_.GetWeakPtr(), origin_lock),
+      /*is_prefetch=*/true);
+}
+
+void GeneratedCodeCache::RecordHotScriptIfFound(
+    const GURL& origin_lock,
+    const GURL& resource_url,
+    const ReadDataCallback& read_data_callback,
+    const base::Time& response_time,
+    mojo_base::BigBuffer data) {
+  auto it = hot_scripts_.Peek(origin_lock);
+  if (data.size() != 0 && it != hot_scripts_.end()) {
+    HotScriptSet& hot_scripts = it->second;
+    if (hot_scripts.resource_urls.size() < kMaxHotScripts &&
+        !base::Contains(hot_scripts.resource_urls, resource_url)) {
+      hot_scripts.resource_urls.push_back(resource_url);
+      hot_scripts.dirty = true;
+      // Restart the timer so that the manifest is written once the page has
+      // stopped requesting new scripts.
+      manifest_write_timer_.Start(FROM_HERE, kManifestWriteDelay, this,
+                                  &GeneratedCodeCache::WriteHotScriptManifests);
+    }
+  }
+  read_data_callback.Run(response_time, std::move(data));
+}
+
+void GeneratedCodeCache::WriteHotScriptManifests() {
+  for (auto& it : hot_scripts_)
+    WriteHotScriptManifest(it.first, &it.second);
+}
+
+void GeneratedCodeCache::WriteHotScriptManifest(const GURL& origin_lock,
+                                                HotScriptSet* hot_scripts) {
+  // The manifest for the next run is the set this run used, so scripts that
+  // are no longer requested age out after one run.
+  if (!hot_scripts->dirty)
+    return;
+  hot_scripts->dirty = false;
+  std::vector<std::string> specs;
+  specs.reserve(hot_scripts->resource_urls.size());
+  for (const GURL& resource_url : hot_scripts->resource_urls)
+    specs.push_back(resource_url.spec());
+  std::string manifest = base::JoinString(specs, "\n");
+  WriteEntryWithKey(
+      GetHotScriptManifestKey(origin_lock), base::Time::Now(),
+      mojo_base::BigBuffer(base::as_bytes(base::make_span(manifest))));
+}
+
+void GeneratedCodeCache::WriteHotScriptManifestsForTesting() {
+  manifest_write_timer_.Stop();
+  WriteHotScriptManifests();
+}
+
+void GeneratedCodeCache::ExpirePrefetchedEntriesForTesting(
+    const GURL& origin_lock) {
+  auto it = prefetch_expiry_timers_.find(origin_lock);
+  if (it != prefetch_expiry_timers_.end())
+    it->second->FireNow();
+}
+
+void GeneratedCodeCache::OnHotScriptManifestRead(
+    const GURL& origin_lock,
+    const base::Time& response_time,
+    mojo_base::BigBuffer data) {
+  if (data.size() == 0)
+    return;
+
+  base::StringPiece manifest(reinterpret_cast<const char*>(data.data()),
+                             data.size());
+  size_t prefetch_count = 0;
+  for (const base::StringPiece& spec : base::SplitStringPiece(
+           manifest, "\n", base::TRIM_WHITESPACE, base::SPLIT_WANT_NONEMPTY)) {
+    GURL resource_url(spec);
+    if (!IsValidResourceURL(resource_url))
+      continue;
+    std::string key = GetCacheKey(resource_url, origin_lock);
+    FetchEntryWithKey(
+        key,
+        base::BindRepeating(&GeneratedCodeCache::OnEntryPrefetched,
+                            weak_ptr_factory_.GetWeakPtr(), origin_lock, key),
+        /*is_prefetch=*/true);
+    if (++prefetch_count == kMaxHotScripts)
+      break;
+  }
+
+  // Each origin lock's entries expire on their own, so that prefetching for
+  // one origin doesn't drop what another origin hasn't used yet.
+  std::unique_ptr<base::OneShotTimer>& timer =
+      prefetch_expiry_timers_[origin_lock];
+  if (!timer)
+    timer = std::make_unique<base::OneShotTimer>();
+  timer->Start(FROM_HERE, kPrefetchExpiryDelay,
+               base::BindOnce(&GeneratedCodeCache::ClearPrefetchedEntries,
+                              base::Unretained(this), origin_lock));
+}
+
+void GeneratedCodeCache::OnEntryPrefetched(const GURL& origin_lock,
+                                           const std::string& key,
+                                           const base::Time& response_time,
+                                           mojo_base::BigBuffer data) {
+  if (data.size() == 0 || prefetched_entries_.count(key) ||
+      prefetched_bytes_ + data.size() > kMaxPrefetchedBytes) {
+    return;
+  }
+  prefetched_bytes_ += data.size();
+  PrefetchedEntry& entry = prefetched_entries_[key];
+  entry.origin_lock = origin_lock;
+  entry.response_time = response_time;
+  entry.data = std::move(data);
+}
+
+void GeneratedCodeCache::ErasePrefetchedEntry(const std::string& key) {
+  auto it = prefetched_entries_.find(key);
+  if (it == prefetched_entries_.end())
+    return;
+  prefetched_bytes_ -= it->second.data.size();
+  prefetched_entries_.erase(it);
+}
+
+void GeneratedCodeCache::ClearPrefetchedEntries(const GURL& origin_lock) {
+  for (auto it = prefetched_entries_.begin();
+       it != prefetched_entries_.end();) {
+    if (it->second.origin_lock == origin_lock) {
+      prefetched_bytes_ -= it->second.data.size();
+      it = prefetched_entries_.erase(it);
+    } else {
+      ++it;
+    }
+  }
+  // This runs from the timer's own task, which allows deleting the timer.
+  prefetch_expiry_timers_.erase(origin_lock);
+}
+
 void GeneratedCodeCache::CreateBackend() {
   // Create a new Backend pointer that cleans itself if the GeneratedCodeCache
   // instance is not live when the CreateCacheBackend finishes.
@@ -558,6 +796,9 @@ void GeneratedCodeCache::IssueOperation(PendingOperation* op) {
 void GeneratedCodeCache::WriteEntryImpl(PendingOperation* op) {
   DCHECK(Operation::kWrite == op->operation() ||
          Operation::kWriteWithSHAKey == op->operation());
+  // A prefetched copy of this entry is stale now.
+  ErasePrefetchedEntry(op->key());
+
   if (backend_state_ != kInitialized) {
     // Silently fail the request.
     CloseOperationAndIssueNext(op);
@@ -672,6 +913,19 @@ void GeneratedCodeCache::FetchEntryImpl(PendingOperation* op) {
     return;
   }
 
+  auto prefetched = prefetched_entries_.find(op->key());
+  if (op->operation() == Operation::kFetch && !op->is_prefetch() &&
+      prefetched != prefetched_entries_.end()) {
+    // Hand the prefetched data out once; the renderer keeps its own copy.
+    PrefetchedEntry entry = std::move(prefetched->second);
+    prefetched_entries_.erase(prefetched);
+    prefetched_bytes_ -= entry.data.size();
+    CollectStatistics(CacheEntryStatus::kHit);
+    op->TakeReadCallback().Run(entry.response_time, std::move(entry.data));
+    CloseOperationAndIssueNext(op);
+    return;
+  }
+
   // This is a part of loading cycle and hence should run with a high priority.
   disk_cache::EntryResult result = backend_->OpenEntry(
       op->key(), net::HIGHEST,
@@ -688,7 +942,8 @@ void GeneratedCodeCache::OpenCompleteForRead(
   DCHECK(Operation::kFetch == op->operation() ||
          Operation::kFetchWithSHAKey == op->operation());
   if (entry_result.net_error() != net::OK) {
-    CollectStatistics(CacheEntryStatus::kMiss);
+    if (!op->is_prefetch())
+      CollectStatistics(CacheEntryStatus::kMiss);
     op->TakeReadCallback().Run(base::Time(), mojo_base::BigBuffer());
     CloseOperationAndIssueNext(op);
     return;
@@ -744,8 +999,10 @@ void GeneratedCodeCache::ReadSmallBufferComplete(PendingOperation* op, int rv) {
   bool no_header = op->operation() == Operation::kFetchWithSHAKey;
   bool succeeded = (rv == op->small_buffer()->size() &&
                     (no_header || IsValidHeader(op->small_buffer())));
-  CollectStatistics(succeeded ? CacheEntryStatus::kHit
-                              : CacheEntryStatus::kMiss);
+  if (!op->is_prefetch()) {
+    CollectStatistics(succeeded ? CacheEntryStatus::kHit
+                                : CacheEntryStatus::kMiss);
+  }
 
   if (op->AddBufferCompletion(succeeded))
     ReadComplete(op);
@@ -797,6 +1054,7 @@ void GeneratedCodeCache::ReadComplete(PendingOperation* op) {
         auto op2 = std::make_unique<PendingOperation>(
             Operation::kFetchWithSHAKey, checksum_key, response_time,
             small_buffer, large_buffer, op->TakeReadCallback());
+        op2->set_is_prefetch(op->is_prefetch());
         EnqueueOperation(std::move(op2));
       }
     } else {
@@ -810,6 +1068,7 @@ void GeneratedCodeCache::ReadComplete(PendingOperation* op) {
 
 void GeneratedCodeCache::DeleteEntryImpl(PendingOperation* op) {
   DCHECK_EQ(Operation::kDelete, op->operation());
+  ErasePrefetchedEntry(op->key());
   DoomEntry(op);
   CloseOperationAndIssueNext(op);
 }
@@ -5,17 +5,26 @@
 #ifndef CONTENT_BROWSER_CODE_CACHE_GENERATED_CODE_CACHE_H_
 #define CONTENT_BROWSER_CODE_CACHE_GENERATED_CODE_CACHE_H_
 
+#include <map>
+#include <memory>
 #include <queue>
+#include <string>
+#include <vector>
 
+#include "base/containers/mru_cache.h"
 #include "base/containers/queue.h"
 #include "base/containers/span.h"
+#include "base/feature_list.h"
 #include "base/files/file_path.h"
 #include "base/macros.h"
 #include "base/memory/weak_ptr.h"
+#include "base/time/time.h"
+#include "base/timer/timer.h"
 #include "content/common/content_export.h"
 #include "mojo/public/cpp/base/big_buffer.h"
 #include "net/base/io_buffer.h"
 #include "net/disk_cache/disk_cache.h"
+#include "url/gurl.h"
 #include "url/origin.h"
 
 #if defined(USE_FILESCHEME_CODECACHE)
@@ -31,6 +40,11 @@ bool IsFileSchemeSupportedForCodeCache(const GURL& url);
 }  // namespace neva
 #endif
 
+// When enabled, GeneratedCodeCache records which scripts each origin lock
+// finds in the cache and, on the next run, reads them into memory as soon as
+// that origin starts using the cache. See PrefetchHotEntries().
+CONTENT_EXPORT extern const base::Feature kCodeCachePrefetch;
+
 // Cache for storing generated code from the renderer on the disk. This cache
 // uses |resource_url| + |origin_lock| as a key for storing the generated code.
 // |resource_url| is the url corresponding to the requested resource.
@@ -113,6 +127,19 @@ class CONTENT_EXPORT GeneratedCodeCache {
   // Delete the entry corresponding to <resource_url, origin_lock>
   void DeleteEntry(const GURL& resource_url, const GURL& origin_lock);
 
+  // Reads the list of resources that |origin_lock| found in the cache during
+  // the previous run (its "hot script set") and fetches all of those entries
+  // into memory, so that the renderer's requests during page load don't each
+  // wait for a disk read behind the resource response. Prefetched entries are
+  // handed out once and dropped after a short while if unused. This runs once
+  // per origin lock while its hot script set is tracked, and is a no-op unless
+  // kCodeCachePrefetch is enabled. It is also triggered by FetchEntry().
+  void PrefetchHotEntries(const GURL& origin_lock);
+
+  // Hot script sets are tracked for at most this many origin locks. The least
+  // recently used one is written out and dropped to make room for another.
+  static constexpr size_t kMaxHotScriptOrigins = 64;
+
   // Should be only used for tests. Sets the last accessed timestamp of an
   // entry.
   void SetLastUsedTimeForTest(const GURL& resource_url,
@@ -122,6 +149,16 @@ class CONTENT_EXPORT GeneratedCodeCache {
 
   const base::FilePath& path() const { return path_; }
 
+  size_t PrefetchedEntryCountForTesting() const {
+    return prefetched_entries_.size();
+  }
+  size_t HotScriptOriginCountForTesting() const { return hot_scripts_.size(); }
+  // Writes the hot script sets recorded so far without waiting for the timer.
+  void WriteHotScriptManifestsForTesting();
+  // Drops the unused entries prefetched for |origin_lock| without waiting for
+  // the timer.
+  void ExpirePrefetchedEntriesForTesting(const GURL& origin_lock);
+
  private:
   class PendingOperation;
   using ScopedBackendPtr = std::unique_ptr<disk_cache::Backend>;
@@ -142,6 +179,55 @@ class CONTENT_EXPORT GeneratedCodeCache {
   // Data streams corresponding to each entry.
   enum { kSmallDataStream = 0, kLargeDataStream = 1 };
 
+  struct PrefetchedEntry {
+    PrefetchedEntry();
+    PrefetchedEntry(PrefetchedEntry&& other);
+    ~PrefetchedEntry();
+    PrefetchedEntry& operator=(PrefetchedEntry&& other);
+
+    GURL origin_lock;
+    base::Time response_time;
+    mojo_base::BigBuffer data;
+  };
+
+  // Resources fetched by one origin lock during this run.
+  struct HotScriptSet {
+    HotScriptSet();
+    ~HotScriptSet();
+
+    std::vector<GURL> resource_urls;
+    // Whether |resource_urls| changed since the manifest was last written.
+    bool dirty = false;
+  };
+
+  void WriteEntryWithKey(const std::string& key,
+                         const base::Time& response_time,
+                         mojo_base::BigBuffer data);
+  // |is_prefetch| fetches are left out of the hit/miss statistics.
+  void FetchEntryWithKey(const std::string& key,
+                         ReadDataCallback read_data_callback,
+                         bool is_prefetch);
+
+  // Hot script set bookkeeping for PrefetchHotEntries().
+  void RecordHotScriptIfFound(const GURL& origin_lock,
+                              const GURL& resource_url,
+                              const ReadDataCallback& read_data_callback,
+                              const base::Time& response_time,
+                              mojo_base::BigBuffer data);
+  void WriteHotScriptManifests();
+  void WriteHotScriptManifest(const GURL& origin_lock,
+                              HotScriptSet* hot_scripts);
+  void OnHotScriptManifestRead(const GURL& origin_lock,
+                               const base::Time& response_time,
+                               mojo_base::BigBuffer data);
+  void OnEntryPrefetched(const GURL& origin_lock,
+                         const std::string& key,
+                         const base::Time& response_time,
+                         mojo_base::BigBuffer data);
+  void ErasePrefetchedEntry(const std::string& key);
+  // Drops the entries prefetched for |origin_lock| that are still unused.
+  void ClearPrefetchedEntries(const GURL& origin_lock);
+
   // Creates a simple_disk_cache backend.
   void CreateBackend();
   void DidCreateBackend(
@@ -210,6 +296,18 @@ class CONTENT_EXPORT GeneratedCodeCache {
   int max_size_bytes_;
   CodeCacheType cache_type_;
 
+  // Keyed by origin lock. An origin lock has an entry once its manifest has
+  // been requested, so it is not prefetched again while it has one.
+  base::MRUCache<GURL, HotScriptSet> hot_scripts_{kMaxHotScriptOrigins};
+  base::OneShotTimer manifest_write_timer_;
+
+  // Keyed by cache key. Consulted and updated only when an operation is
+  // issued, so it stays ordered with the writes and deletes for that key.
+  std::map<std::string, PrefetchedEntry> prefetched_entries_;
+  size_t prefetched_bytes_ = 0;
+  // Keyed by origin lock.
+  std::map<GURL, std::unique_ptr<base::OneShotTimer>> prefetch_expiry_timers_;
+
   base::WeakPtrFactory<GeneratedCodeCache> weak_ptr_factory_{this};
 
   DISALLOW_COPY_AND_ASSIGN(GeneratedCodeCache);
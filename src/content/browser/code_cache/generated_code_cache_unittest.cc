@@ -7,6 +7,9 @@
 #include "base/bind.h"
 #include "base/files/scoped_temp_dir.h"
 #include "base/strings/string_number_conversions.h"
+#include "base/strings/stringprintf.h"
+#include "base/test/metrics/histogram_tester.h"
+#include "base/test/scoped_feature_list.h"
 #include "base/test/task_environment.h"
 #include "content/public/test/browser_task_environment.h"
 #include "content/public/test/test_utils.h"
@@ -666,4 +669,161 @@ TEST_F(GeneratedCodeCacheTest, TestFailedBackendOpening) {
   // We shouldn't receive any data.
   ASSERT_TRUE(received_null_);
 }
+
+TEST_F(GeneratedCodeCacheTest, PrefetchHotEntriesFromPreviousRun) {
+  base::test::ScopedFeatureList feature_list;
+  feature_list.InitAndEnableFeature(kCodeCachePrefetch);
+  GURL url(kInitialUrl);
+  GURL url2("http://example.com/script2.js");
+  GURL unused_url("http://example.com/unused.js");
+  GURL origin_lock = GURL(kInitialOrigin);
+
+  InitializeCache(GeneratedCodeCache::CodeCacheType::kJavaScript);
+  std::string large_data(kLargeSizeInBytes, 'x');
+  WriteToCache(url, origin_lock, "FirstData", base::Time::Now());
+  WriteToCache(url2, origin_lock, large_data, base::Time::Now());
+  WriteToCache(unused_url, origin_lock, "UnusedData", base::Time::Now());
+  task_environment_.RunUntilIdle();
+
+  // The first run requests two of the three scripts.
+  FetchFromCache(url, origin_lock);
+  task_environment_.RunUntilIdle();
+  FetchFromCache(url2, origin_lock);
+  task_environment_.RunUntilIdle();
+  generated_code_cache_->WriteHotScriptManifestsForTesting();
+  task_environment_.RunUntilIdle();
+
+  // The next run prefetches exactly those.
+  disk_cache::FlushCacheThreadForTesting();
+  InitializeCacheAndReOpen(GeneratedCodeCache::CodeCacheType::kJavaScript);
+  generated_code_cache_->PrefetchHotEntries(origin_lock);
+  task_environment_.RunUntilIdle();
+  EXPECT_EQ(2u, generated_code_cache_->PrefetchedEntryCountForTesting());
+
+  FetchFromCache(url2, origin_lock);
+  task_environment_.RunUntilIdle();
+  ASSERT_TRUE(received_);
+  EXPECT_EQ(large_data, received_data_);
+  // Prefetched entries are handed out once.
+  EXPECT_EQ(1u, generated_code_cache_->PrefetchedEntryCountForTesting());
+
+  // A write replaces the prefetched copy.
+  WriteToCache(url, origin_lock, "NewData", base::Time::Now());
+  task_environment_.RunUntilIdle();
+  EXPECT_EQ(0u, generated_code_cache_->PrefetchedEntryCountForTesting());
+  FetchFromCache(url, origin_lock);
+  task_environment_.RunUntilIdle();
+  ASSERT_TRUE(received_);
+  EXPECT_EQ("NewData", received_data_);
+}
+
+TEST_F(GeneratedCodeCacheTest, PrefetchedEntriesExpirePerOrigin) {
+  base::test::ScopedFeatureList feature_list;
+  feature_list.InitAndEnableFeature(kCodeCachePrefetch);
+  GURL url(kInitialUrl);
+  GURL origin_lock = GURL(kInitialOrigin);
+  GURL other_url("http://other.com/script.js");
+  GURL other_origin_lock("http://other.com");
+
+  InitializeCache(GeneratedCodeCache::CodeCacheType::kJavaScript);
+  WriteToCache(url, origin_lock, "Data", base::Time::Now());
+  WriteToCache(other_url, other_origin_lock, "OtherData", base::Time::Now());
+  task_environment_.RunUntilIdle();
+  FetchFromCache(url, origin_lock);
+  task_environment_.RunUntilIdle();
+  FetchFromCache(other_url, other_origin_lock);
+  task_environment_.RunUntilIdle();
+  generated_code_cache_->WriteHotScriptManifestsForTesting();
+  task_environment_.RunUntilIdle();
+
+  disk_cache::FlushCacheThreadForTesting();
+  InitializeCacheAndReOpen(GeneratedCodeCache::CodeCacheType::kJavaScript);
+  base::HistogramTester histograms;
+  generated_code_cache_->PrefetchHotEntries(origin_lock);
+  generated_code_cache_->PrefetchHotEntries(other_origin_lock);
+  task_environment_.RunUntilIdle();
+  EXPECT_EQ(2u, generated_code_cache_->PrefetchedEntryCountForTesting());
+  // Prefetch reads are not renderer requests.
+  histograms.ExpectTotalCount("SiteIsolatedCodeCache.JS.Behaviour", 0);
+
+  // Expiring one origin's entries keeps the other origin's.
+  generated_code_cache_->ExpirePrefetchedEntriesForTesting(origin_lock);
+  EXPECT_EQ(1u, generated_code_cache_->PrefetchedEntryCountForTesting());
+
+  FetchFromCache(other_url, other_origin_lock);
+  task_environment_.RunUntilIdle();
+  ASSERT_TRUE(received_);
+  EXPECT_EQ("OtherData", received_data_);
+  histograms.ExpectUniqueSample("SiteIsolatedCodeCache.JS.Behaviour",
+                                GeneratedCodeCache::CacheEntryStatus::kHit, 1);
+}
+
+TEST_F(GeneratedCodeCacheTest, MissesAreNotRecordedAsHotScripts) {
+  base::test::ScopedFeatureList feature_list;
+  feature_list.InitAndEnableFeature(kCodeCachePrefetch);
+  GURL url(kInitialUrl);
+  GURL missing_url("http://example.com/missing.js");
+  GURL origin_lock = GURL(kInitialOrigin);
+
+  InitializeCache(GeneratedCodeCache::CodeCacheType::kJavaScript);
+  WriteToCache(url, origin_lock, "Data", base::Time::Now());
+  task_environment_.RunUntilIdle();
+  FetchFromCache(url, origin_lock);
+  task_environment_.RunUntilIdle();
+  FetchFromCache(missing_url, origin_lock);
+  task_environment_.RunUntilIdle();
+  ASSERT_TRUE(received_null_);
+  generated_code_cache_->WriteHotScriptManifestsForTesting();
+  task_environment_.RunUntilIdle();
+
+  // Only the entry that was found is prefetched.
+  disk_cache::FlushCacheThreadForTesting();
+  InitializeCacheAndReOpen(GeneratedCodeCache::CodeCacheType::kJavaScript);
+  generated_code_cache_->PrefetchHotEntries(origin_lock);
+  task_environment_.RunUntilIdle();
+  EXPECT_EQ(1u, generated_code_cache_->PrefetchedEntryCountForTesting());
+}
+
+TEST_F(GeneratedCodeCacheTest, HotScriptOriginsAreBounded) {
+  base::test::ScopedFeatureList feature_list;
+  feature_list.InitAndEnableFeature(kCodeCachePrefetch);
+  GURL url("http://script.com/script.js");
+  GURL first_origin_lock("http://origin0.com");
+
+  InitializeCache(GeneratedCodeCache::CodeCacheType::kJavaScript);
+  WriteToCache(url, first_origin_lock, "Data", base::Time::Now());
+  task_environment_.RunUntilIdle();
+  FetchFromCache(url, first_origin_lock);
+  task_environment_.RunUntilIdle();
+
+  for (size_t i = 1; i <= GeneratedCodeCache::kMaxHotScriptOrigins; ++i) {
+    generated_code_cache_->PrefetchHotEntries(
+        GURL(base::StringPrintf("http://origin%zu.com", i)));
+  }
+  task_environment_.RunUntilIdle();
+  EXPECT_EQ(GeneratedCodeCache::kMaxHotScriptOrigins,
+            generated_code_cache_->HotScriptOriginCountForTesting());
+
+  // The evicted set was written out, so the next run still prefetches it.
+  disk_cache::FlushCacheThreadForTesting();
+  InitializeCacheAndReOpen(GeneratedCodeCache::CodeCacheType::kJavaScript);
+  generated_code_cache_->PrefetchHotEntries(first_origin_lock);
+  task_environment_.RunUntilIdle();
+  EXPECT_EQ(1u, generated_code_cache_->PrefetchedEntryCountForTesting());
+}
+
+TEST_F(GeneratedCodeCacheTest, NoPrefetchWithoutFeature) {
+  GURL url(kInitialUrl);
+  GURL origin_lock = GURL(kInitialOrigin);
+
+  InitializeCache(GeneratedCodeCache::CodeCacheType::kJavaScript);
+  FetchFromCache(url, origin_lock);
+  task_environment_.RunUntilIdle();
+  generated_code_cache_->WriteHotScriptManifestsForTesting();
+  task_environment_.RunUntilIdle();
+
+  generated_code_cache_->PrefetchHotEntries(origin_lock);
+  task_environment_.RunUntilIdle();
+  EXPECT_EQ(0u, generated_code_cache_->PrefetchedEntryCountForTesting());
+}
 }  // namespace content
@@ -247,6 +247,7 @@ static const char* const kSwitchNames[] = {
     switches::kDeJellyScreenWidth,
     switches::kDoubleBufferCompositing,
     switches::kEnableVizDevTools,
+    switches::kGpuProgramDiskCacheDir,
     switches::kHeadless,
     switches::kLoggingLevel,
     switches::kEnableLowEndDeviceMode,
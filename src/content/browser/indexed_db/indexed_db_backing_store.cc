@@ -8,6 +8,7 @@
 #include <utility>
 
 #include "base/bind.h"
+#include "base/feature_list.h"
 #include "base/files/file_path.h"
 #include "base/format_macros.h"
 #include "base/json/json_reader.h"
@@ -60,6 +61,8 @@
 #include "third_party/blink/public/common/indexeddb/web_idb_types.h"
 #include "third_party/blink/public/mojom/blob/blob.mojom.h"
 #include "third_party/leveldatabase/env_chromium.h"
+#include "third_party/leveldatabase/src/include/leveldb/db.h"
+#include "third_party/leveldatabase/src/include/leveldb/write_batch.h"
 
 using base::FilePath;
 using base::StringPiece;
@@ -70,6 +73,10 @@ using leveldb::Status;
 using url::Origin;
 
 namespace content {
+
+const base::Feature kIndexedDBGroupCommit{"IndexedDBGroupCommit",
+                                          base::FEATURE_DISABLED_BY_DEFAULT};
+
 using indexed_db::CheckIndexAndMetaDataKey;
 using indexed_db::CheckObjectStoreAndMetaDataType;
 using indexed_db::FindGreatestKeyLessThanOrEqual;
@@ -638,6 +645,9 @@ IndexedDBBackingStore::IndexedDBBackingStore(
       origin_identifier_(ComputeOriginIdentifier(origin)),
       idb_task_runner_(idb_task_runner),
       io_task_runner_(io_task_runner),
+      group_commit_enabled_(
+          backing_store_mode == Mode::kOnDisk &&
+          base::FeatureList::IsEnabled(kIndexedDBGroupCommit)),
       db_(std::move(db)),
       blob_files_cleaned_(std::move(blob_files_cleaned)) {
   DCHECK(idb_task_runner_->RunsTasksInCurrentSequence());
@@ -654,6 +664,10 @@ IndexedDBBackingStore::IndexedDBBackingStore(
 
 IndexedDBBackingStore::~IndexedDBBackingStore() {
   DCHECK_CALLED_ON_VALID_SEQUENCE(idb_sequence_checker_);
+  // Don't leave committed transactions unreported: they are reported
+  // complete if the sync succeeds, and failed otherwise.
+  if (!group_commit_callbacks_.empty())
+    RunGroupCommit();
 }
 
 IndexedDBBackingStore::RecordIdentifier::RecordIdentifier(
@@ -671,6 +685,8 @@ constexpr const base::TimeDelta
     IndexedDBBackingStore::kMaxJournalCleaningWindowTime;
 constexpr const base::TimeDelta
     IndexedDBBackingStore::kInitialJournalCleaningWindowTime;
+constexpr const int IndexedDBBackingStore::kMaxGroupCommitTransactions;
+constexpr const base::TimeDelta IndexedDBBackingStore::kGroupCommitWindowTime;
 
 leveldb::Status IndexedDBBackingStore::Initialize(bool clean_active_journal) {
 #if DCHECK_IS_ON()
@@ -1068,6 +1084,74 @@ bool IndexedDBBackingStore::ShouldSyncOnCommit(
   }
 }
 
+void IndexedDBBackingStore::RunWhenCommitsAreDurable(bool needs_sync,
+                                                     DurableCallback callback) {
+  DCHECK_CALLED_ON_VALID_SEQUENCE(idb_sequence_checker_);
+  DCHECK(group_commit_enabled_);
+  if (!needs_sync && group_commit_callbacks_.empty()) {
+    std::move(callback).Run(leveldb::Status::OK());
+    return;
+  }
+
+  group_commit_sync_needed_ |= needs_sync;
+  group_commit_callbacks_.push_back(std::move(callback));
+
+  if (group_commit_callbacks_.size() >=
+      static_cast<size_t>(kMaxGroupCommitTransactions)) {
+    group_commit_timer_.AbandonAndStop();
+    RunGroupCommit();
+    return;
+  }
+
+  // The window starts at the first waiting commit and is not extended by
+  // later ones, so no commit waits longer than kGroupCommitWindowTime.
+  if (!group_commit_timer_.IsRunning()) {
+    group_commit_timer_.Start(FROM_HERE, kGroupCommitWindowTime, this,
+                              &IndexedDBBackingStore::RunGroupCommit);
+  }
+}
+
+void IndexedDBBackingStore::RunGroupCommit() {
+  DCHECK_CALLED_ON_VALID_SEQUENCE(idb_sequence_checker_);
+  IDB_TRACE("IndexedDBBackingStore::RunGroupCommit");
+  group_commit_timer_.AbandonAndStop();
+
+  leveldb::Status s = SyncGroupCommit();
+  base::UmaHistogramCounts100("WebCore.IndexedDB.GroupCommit.Transactions",
+                              group_commit_callbacks_.size());
+
+  std::vector<DurableCallback> callbacks;
+  callbacks.swap(group_commit_callbacks_);
+  for (auto& callback : callbacks)
+    std::move(callback).Run(s);
+}
+
+leveldb::Status IndexedDBBackingStore::SyncGroupCommit() {
+  DCHECK_CALLED_ON_VALID_SEQUENCE(idb_sequence_checker_);
+  if (!group_commit_sync_needed_)
+    return leveldb::Status::OK();
+  group_commit_sync_needed_ = false;
+
+  // LevelDB appends every write to the current log, so one synced write makes
+  // all earlier unsynced writes to that log durable as well. Writes to an
+  // earlier log were synced when LevelDB closed it (see IndexedDBLevelDBEnv).
+  leveldb::WriteBatch empty_batch;
+  leveldb::WriteOptions write_options;
+  write_options.sync = true;
+  return db_->db()->Write(write_options, &empty_batch);
+}
+
+bool IndexedDBBackingStore::IsGroupCommitPending() {
+  DCHECK_CALLED_ON_VALID_SEQUENCE(idb_sequence_checker_);
+  return group_commit_timer_.IsRunning();
+}
+
+void IndexedDBBackingStore::ForceRunGroupCommit() {
+  DCHECK_CALLED_ON_VALID_SEQUENCE(idb_sequence_checker_);
+  if (group_commit_timer_.IsRunning())
+    group_commit_timer_.FireNow();
+}
+
 leveldb::Status IndexedDBBackingStore::GetCompleteMetadata(
     std::vector<IndexedDBDatabaseMetadata>* output) {
 #if DCHECK_IS_ON()
@@ -3246,8 +3330,13 @@ Status IndexedDBBackingStore::Transaction::CommitPhaseTwo() {
   // Actually commit. If this succeeds, the journals will appropriately
   // reflect pending blob work - dead files that should be deleted
   // immediately, and live files to monitor.
-  s = transaction_->Commit(
-      IndexedDBBackingStore::ShouldSyncOnCommit(durability_));
+  bool sync_on_commit = IndexedDBBackingStore::ShouldSyncOnCommit(durability_);
+  if (sync_on_commit && backing_store_->is_group_commit_enabled()) {
+    // The caller waits for RunWhenCommitsAreDurable() instead.
+    sync_on_commit = false;
+    committed_without_sync_ = true;
+  }
+  s = transaction_->Commit(sync_on_commit);
   transaction_ = nullptr;
 
   if (!s.ok()) {
@@ -15,6 +15,8 @@
 #include <utility>
 #include <vector>
 
+#include "base/callback.h"
+#include "base/feature_list.h"
 #include "base/files/file_path.h"
 #include "base/gtest_prod_util.h"
 #include "base/macros.h"
@@ -51,6 +53,12 @@ struct IndexedDBDatabaseMetadata;
 }  // namespace blink
 
 namespace content {
+
+// When enabled, durable readwrite transactions of an origin are written to
+// LevelDB without syncing, and the LevelDB log is synced once for all commits
+// made within a short window before their completion is reported.
+CONTENT_EXPORT extern const base::Feature kIndexedDBGroupCommit;
+
 class AutoDidCommitTransaction;
 class IndexedDBActiveBlobRegistry;
 class LevelDBWriteBatch;
@@ -157,6 +165,12 @@ class CONTENT_EXPORT IndexedDBBackingStore {
 
     IndexedDBBackingStore* backing_store() { return backing_store_.get(); }
 
+    // True if CommitPhaseTwo() skipped the LevelDB sync this transaction's
+    // durability asked for, because the backing store is group committing.
+    // The caller must then wait for RunWhenCommitsAreDurable() before
+    // reporting the transaction as complete.
+    bool committed_without_sync() const { return committed_without_sync_; }
+
    private:
     // Called by CommitPhaseOne: Identifies the blob entries to write and adds
     // them to the recovery blob journal directly (i.e. not as part of the
@@ -215,6 +229,8 @@ class CONTENT_EXPORT IndexedDBBackingStore {
     // has been bumped, and journal cleaning should be deferred.
     bool committing_;
 
+    bool committed_without_sync_ = false;
+
     // This flag is passed to LevelDBScopes as |sync_on_commit|, converted
     // via ShouldSyncOnCommit.
     blink::mojom::IDBTransactionDurability durability_;
@@ -339,6 +355,17 @@ class CONTENT_EXPORT IndexedDBBackingStore {
   // Default to a 2 second timer delay before we clean up blobs.
   static constexpr const base::TimeDelta kInitialJournalCleaningWindowTime =
       base::TimeDelta::FromSeconds(2);
+  // With kIndexedDBGroupCommit, sync immediately once this many transactions
+  // are waiting for durability.
+  static constexpr const int kMaxGroupCommitTransactions = 32;
+  // With kIndexedDBGroupCommit, wait at most this long after the first
+  // unsynced commit before syncing.
+  static constexpr const base::TimeDelta kGroupCommitWindowTime =
+      base::TimeDelta::FromMilliseconds(4);
+
+  // Called with the result of the sync that made the commits durable. On
+  // failure the commits may be lost and must not be reported as complete.
+  using DurableCallback = base::OnceCallback<void(leveldb::Status)>;
 
   IndexedDBBackingStore(
       Mode backing_store_mode,
@@ -509,6 +536,10 @@ class CONTENT_EXPORT IndexedDBBackingStore {
   // Stops the journal_cleaning_timer_ and runs its pending task.
   void ForceRunBlobCleanup();
 
+  bool IsGroupCommitPending();
+  // Stops the group_commit_timer_ and runs its pending task.
+  void ForceRunGroupCommit();
+
   // HasV2SchemaCorruption() returns whether the backing store is v2 and
   // has blob references.
   V2SchemaCorruptionStatus HasV2SchemaCorruption();
@@ -531,6 +562,16 @@ class CONTENT_EXPORT IndexedDBBackingStore {
   static bool ShouldSyncOnCommit(
       blink::mojom::IDBTransactionDurability durability);
 
+  bool is_group_commit_enabled() const { return group_commit_enabled_; }
+
+  // Only valid when is_group_commit_enabled(). Runs |callback| once every
+  // transaction committed so far is durable. |needs_sync| is the caller's
+  // Transaction::committed_without_sync(); if true, a sync of the LevelDB log
+  // is scheduled, shared with every other commit in the window. Callbacks run
+  // in the order they were added, so completions are reported in commit order
+  // even for transactions that did not need a sync.
+  void RunWhenCommitsAreDurable(bool needs_sync, DurableCallback callback);
+
  protected:
   friend class IndexedDBOriginState;
 
@@ -550,6 +591,12 @@ class CONTENT_EXPORT IndexedDBBackingStore {
   // Remove the referenced file on disk.
   virtual bool RemoveBlobFile(int64_t database_id, int64_t key) const;
 
+  // Syncs the LevelDB log if any commit skipped its sync, then runs the
+  // callbacks waiting in group_commit_callbacks_.
+  void RunGroupCommit();
+  // Syncs the LevelDB log if any commit skipped its sync since the last call.
+  leveldb::Status SyncGroupCommit();
+
   // Schedule a call to CleanRecoveryJournalIgnoreReturn() via
   // an owned timer. If this object is destroyed, the timer
   // will automatically be cancelled.
@@ -629,6 +676,11 @@ class CONTENT_EXPORT IndexedDBBackingStore {
   base::OneShotTimer journal_cleaning_timer_;
   base::TimeTicks journal_cleaning_timer_window_start_;
 
+  const bool group_commit_enabled_;
+  bool group_commit_sync_needed_ = false;
+  std::vector<DurableCallback> group_commit_callbacks_;
+  base::OneShotTimer group_commit_timer_;
+
 #if DCHECK_IS_ON()
   mutable int num_blob_files_deleted_ = 0;
 #endif
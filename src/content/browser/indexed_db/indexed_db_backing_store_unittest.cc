@@ -7,6 +7,7 @@
 #include <stddef.h>
 #include <stdint.h>
 
+#include <atomic>
 #include <string>
 #include <utility>
 
@@ -23,14 +24,17 @@
 #include "base/stl_util.h"
 #include "base/strings/string16.h"
 #include "base/strings/string_number_conversions.h"
+#include "base/strings/string_util.h"
 #include "base/strings/utf_string_conversions.h"
 #include "base/synchronization/waitable_event.h"
 #include "base/synchronization/waitable_event_watcher.h"
 #include "base/task/post_task.h"
 #include "base/task/thread_pool.h"
 #include "base/test/bind_test_util.h"
+#include "base/test/scoped_feature_list.h"
 #include "base/test/task_environment.h"
 #include "base/time/default_clock.h"
+#include "components/services/storage/indexed_db/leveldb/leveldb_factory.h"
 #include "components/services/storage/indexed_db/scopes/disjoint_range_lock_manager.h"
 #include "components/services/storage/indexed_db/scopes/varint_coding.h"
 #include "components/services/storage/indexed_db/transactional_leveldb/leveldb_write_batch.h"
@@ -40,6 +44,7 @@
 #include "content/browser/indexed_db/indexed_db_context_impl.h"
 #include "content/browser/indexed_db/indexed_db_factory_impl.h"
 #include "content/browser/indexed_db/indexed_db_leveldb_coding.h"
+#include "content/browser/indexed_db/indexed_db_leveldb_env.h"
 #include "content/browser/indexed_db/indexed_db_leveldb_operations.h"
 #include "content/browser/indexed_db/indexed_db_metadata_coding.h"
 #include "content/browser/indexed_db/indexed_db_origin_state.h"
@@ -52,6 +57,7 @@
 #include "testing/gtest/include/gtest/gtest.h"
 #include "third_party/blink/public/common/indexeddb/web_idb_types.h"
 #include "third_party/blink/public/mojom/indexeddb/indexeddb.mojom.h"
+#include "third_party/leveldatabase/src/include/leveldb/env.h"
 
 using base::ASCIIToUTF16;
 using blink::IndexedDBDatabaseMetadata;
@@ -813,6 +819,197 @@ TEST_F(IndexedDBBackingStoreTest, PutGetConsistency) {
   CycleIDBTaskRunner();
 }
 
+// Counts the syncs of LevelDB log files, i.e. the commits that hit the disk.
+class LogSyncCountingEnv : public leveldb::EnvWrapper {
+ public:
+  LogSyncCountingEnv() : EnvWrapper(IndexedDBLevelDBEnv::Get()) {}
+  ~LogSyncCountingEnv() override = default;
+
+  leveldb::Status NewWritableFile(const std::string& fname,
+                                  leveldb::WritableFile** result) override {
+    leveldb::Status s = target()->NewWritableFile(fname, result);
+    if (s.ok() && base::EndsWith(fname, ".log", base::CompareCase::SENSITIVE))
+      *result = new CountingFile(*result, &log_syncs_);
+    return s;
+  }
+  leveldb::Status NewAppendableFile(const std::string& fname,
+                                    leveldb::WritableFile** result) override {
+    leveldb::Status s = target()->NewAppendableFile(fname, result);
+    if (s.ok() && base::EndsWith(fname, ".log", base::CompareCase::SENSITIVE))
+      *result = new CountingFile(*result, &log_syncs_);
+    return s;
+  }
+
+  int log_syncs() const { return log_syncs_; }
+  void ResetLogSyncs() { log_syncs_ = 0; }
+
+ private:
+  class CountingFile : public leveldb::WritableFile {
+   public:
+    CountingFile(leveldb::WritableFile* file, std::atomic<int>* syncs)
+        : file_(file), syncs_(syncs) {}
+    ~CountingFile() override = default;
+
+    leveldb::Status Append(const leveldb::Slice& data) override {
+      return file_->Append(data);
+    }
+    leveldb::Status Close() override { return file_->Close(); }
+    leveldb::Status Flush() override { return file_->Flush(); }
+    leveldb::Status Sync() override {
+      ++*syncs_;
+      return file_->Sync();
+    }
+
+   private:
+    std::unique_ptr<leveldb::WritableFile> file_;
+    std::atomic<int>* syncs_;
+  };
+
+  std::atomic<int> log_syncs_{0};
+
+  DISALLOW_COPY_AND_ASSIGN(LogSyncCountingEnv);
+};
+
+class IndexedDBBackingStoreTestWithGroupCommit
+    : public IndexedDBBackingStoreTest {
+ public:
+  IndexedDBBackingStoreTestWithGroupCommit() {
+    feature_list_.InitAndEnableFeature(kIndexedDBGroupCommit);
+  }
+
+  void SetUp() override {
+    leveldb_env::Options options = IndexedDBClassFactory::GetLevelDBOptions();
+    options.env = &env_;
+    leveldb_factory_ =
+        std::make_unique<DefaultLevelDBFactory>(options, "indexed-db");
+    IndexedDBClassFactory::Get()->SetLevelDBFactoryForTesting(
+        leveldb_factory_.get());
+    IndexedDBBackingStoreTest::SetUp();
+  }
+
+  void TearDown() override {
+    IndexedDBBackingStoreTest::TearDown();
+    IndexedDBClassFactory::Get()->SetLevelDBFactoryForTesting(nullptr);
+  }
+
+  // Commits a durable readwrite transaction that writes one record, and
+  // returns whether the commit skipped the sync.
+  bool CommitDurableTransaction() {
+    IndexedDBBackingStore::Transaction transaction(
+        backing_store()->AsWeakPtr(),
+        blink::mojom::IDBTransactionDurability::Default,
+        blink::mojom::IDBTransactionMode::ReadWrite);
+    transaction.Begin(CreateDummyLock());
+    IndexedDBBackingStore::RecordIdentifier record;
+    IndexedDBValue value = value1_;
+    EXPECT_TRUE(
+        backing_store()->PutRecord(&transaction, 1, 1, key1_, &value, &record)
+            .ok());
+    bool succeeded = false;
+    EXPECT_TRUE(
+        transaction.CommitPhaseOne(CreateBlobWriteCallback(&succeeded)).ok());
+    EXPECT_TRUE(succeeded);
+    EXPECT_TRUE(transaction.CommitPhaseTwo().ok());
+    return transaction.committed_without_sync();
+  }
+
+ protected:
+  LogSyncCountingEnv env_;
+
+ private:
+  base::test::ScopedFeatureList feature_list_;
+  std::unique_ptr<DefaultLevelDBFactory> leveldb_factory_;
+};
+
+TEST_F(IndexedDBBackingStoreTestWithGroupCommit, DurableCommitsShareOneSync) {
+  ASSERT_TRUE(backing_store()->is_group_commit_enabled());
+  std::vector<int> completed;
+  auto record_completion = [&completed](int i) {
+    return base::BindLambdaForTesting([&completed, i](leveldb::Status s) {
+      EXPECT_TRUE(s.ok());
+      completed.push_back(i);
+    });
+  };
+
+  env_.ResetLogSyncs();
+  for (int i = 0; i < 3; ++i) {
+    bool committed_without_sync = CommitDurableTransaction();
+    EXPECT_TRUE(committed_without_sync);
+    backing_store()->RunWhenCommitsAreDurable(committed_without_sync,
+                                              record_completion(i));
+  }
+  EXPECT_EQ(0, env_.log_syncs());
+
+  // A completion that needs no sync of its own still waits for the earlier
+  // ones, so completions are reported in commit order.
+  backing_store()->RunWhenCommitsAreDurable(false, record_completion(3));
+  EXPECT_TRUE(completed.empty());
+  EXPECT_TRUE(backing_store()->IsGroupCommitPending());
+
+  backing_store()->ForceRunGroupCommit();
+  EXPECT_EQ((std::vector<int>{0, 1, 2, 3}), completed);
+  EXPECT_FALSE(backing_store()->IsGroupCommitPending());
+  EXPECT_EQ(1, env_.log_syncs());
+
+  // With nothing waiting, a completion that needs no sync runs immediately.
+  backing_store()->RunWhenCommitsAreDurable(false, record_completion(4));
+  EXPECT_EQ(5u, completed.size());
+  EXPECT_EQ(1, env_.log_syncs());
+}
+
+TEST_F(IndexedDBBackingStoreTestWithGroupCommit, RelaxedCommitIsNotDeferred) {
+  IndexedDBBackingStore::Transaction transaction(
+      backing_store()->AsWeakPtr(),
+      blink::mojom::IDBTransactionDurability::Relaxed,
+      blink::mojom::IDBTransactionMode::ReadWrite);
+  transaction.Begin(CreateDummyLock());
+  IndexedDBBackingStore::RecordIdentifier record;
+  IndexedDBValue value = value1_;
+  EXPECT_TRUE(
+      backing_store()->PutRecord(&transaction, 1, 1, key1_, &value, &record)
+          .ok());
+  bool succeeded = false;
+  EXPECT_TRUE(
+      transaction.CommitPhaseOne(CreateBlobWriteCallback(&succeeded)).ok());
+  EXPECT_TRUE(succeeded);
+  EXPECT_TRUE(transaction.CommitPhaseTwo().ok());
+  EXPECT_FALSE(transaction.committed_without_sync());
+}
+
+TEST_F(IndexedDBBackingStoreTestWithGroupCommit, FullGroupSyncsImmediately) {
+  env_.ResetLogSyncs();
+  int completed = 0;
+  for (int i = 0; i < IndexedDBBackingStore::kMaxGroupCommitTransactions;
+       ++i) {
+    EXPECT_EQ(0, completed);
+    backing_store()->RunWhenCommitsAreDurable(
+        CommitDurableTransaction(),
+        base::BindLambdaForTesting([&completed](leveldb::Status s) {
+          EXPECT_TRUE(s.ok());
+          ++completed;
+        }));
+  }
+  EXPECT_EQ(IndexedDBBackingStore::kMaxGroupCommitTransactions, completed);
+  EXPECT_FALSE(backing_store()->IsGroupCommitPending());
+  EXPECT_EQ(1, env_.log_syncs());
+}
+
+TEST_F(IndexedDBBackingStoreTestWithGroupCommit, DestructionSyncsPendingGroup) {
+  env_.ResetLogSyncs();
+  bool completed = false;
+  backing_store()->RunWhenCommitsAreDurable(
+      CommitDurableTransaction(),
+      base::BindLambdaForTesting([&completed](leveldb::Status s) {
+        EXPECT_TRUE(s.ok());
+        completed = true;
+      }));
+  EXPECT_FALSE(completed);
+
+  DestroyFactoryAndBackingStore();
+  EXPECT_TRUE(completed);
+  EXPECT_EQ(1, env_.log_syncs());
+}
+
 TEST_P(IndexedDBBackingStoreTestWithExternalObjects, PutGetConsistency) {
   // Initiate transaction1 - writing blobs.
   std::unique_ptr<IndexedDBBackingStore::Transaction> transaction1 =
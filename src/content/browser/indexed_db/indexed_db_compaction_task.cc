@@ -4,12 +4,14 @@
 
 #include "content/browser/indexed_db/indexed_db_compaction_task.h"
 
+#include "base/metrics/histogram_functions.h"
 #include "third_party/leveldatabase/src/include/leveldb/db.h"
 
 namespace content {
 
 IndexedDBCompactionTask::IndexedDBCompactionTask(leveldb::DB* database)
-    : IndexedDBPreCloseTaskQueue::PreCloseTask(database) {}
+    : IndexedDBPreCloseTaskQueue::PreCloseTask(database),
+      compactor_(database) {}
 
 IndexedDBCompactionTask::~IndexedDBCompactionTask() = default;
 
@@ -18,10 +20,15 @@ bool IndexedDBCompactionTask::RequiresMetadata() const {
 }
 
 void IndexedDBCompactionTask::Stop(
-    IndexedDBPreCloseTaskQueue::StopReason reason) {}
+    IndexedDBPreCloseTaskQueue::StopReason reason) {
+  base::UmaHistogramCounts1000("WebCore.IndexedDB.Compaction.StepsBeforeStop",
+                               compactor_.steps());
+}
 
 bool IndexedDBCompactionTask::RunRound() {
-  database()->CompactRange(nullptr, nullptr);
+  if (!compactor_.CompactNextRange())
+    return false;
+  compactor_.RecordMetrics("WebCore.IndexedDB.Compaction");
   return true;
 }
 
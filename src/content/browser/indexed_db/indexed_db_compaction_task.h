@@ -5,6 +5,7 @@
 #ifndef CONTENT_BROWSER_INDEXED_DB_INDEXED_DB_COMPACTION_TASK_H_
 #define CONTENT_BROWSER_INDEXED_DB_INDEXED_DB_COMPACTION_TASK_H_
 
+#include "components/services/storage/leveldb_incremental_compactor.h"
 #include "content/browser/indexed_db/indexed_db_pre_close_task_queue.h"
 
 namespace leveldb {
@@ -13,6 +14,10 @@ class DB;
 
 namespace content {
 
+// Compacts the backing store while it is idle before closing. Each round
+// compacts one key range so that the pre-close queue can stop the task
+// between rounds as soon as a new connection comes in, rather than the
+// connection waiting on a compaction of the whole database.
 class IndexedDBCompactionTask
     : public IndexedDBPreCloseTaskQueue::PreCloseTask {
  public:
@@ -24,6 +29,9 @@ class IndexedDBCompactionTask
   void Stop(IndexedDBPreCloseTaskQueue::StopReason reason) override;
 
   bool RunRound() override;
+
+ private:
+  storage::LevelDBIncrementalCompactor compactor_;
 };
 
 }  // namespace content
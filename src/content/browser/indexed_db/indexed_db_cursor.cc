@@ -267,8 +267,8 @@ leveldb::Status IndexedDBCursor::CursorPrefetchIterationOperation(
   std::vector<IndexedDBValue> found_values;
 
   saved_cursor_.reset();
-  // TODO(cmumford): Use IPC::Channel::kMaximumMessageSize
-  const size_t max_size_estimate = 10 * 1024 * 1024;
+  prefetch_budget_.OnPrefetchRequested();
+  const size_t max_size_estimate = prefetch_budget_.max_bytes();
   size_t size_estimate = 0;
 
   // TODO(cmumford): Handle this error (crbug.com/363397). Although this will
@@ -306,10 +306,11 @@ leveldb::Status IndexedDBCursor::CursorPrefetchIterationOperation(
         found_values.push_back(IndexedDBValue());
         break;
       case indexed_db::CURSOR_KEY_AND_VALUE: {
-        IndexedDBValue value;
-        value.swap(*cursor_->value());
-        size_estimate += value.SizeEstimate();
-        found_values.push_back(value);
+        // Swap rather than copy; the cursor's value is replaced on the next
+        // Continue() anyway.
+        found_values.emplace_back();
+        found_values.back().swap(*cursor_->value());
+        size_estimate += found_values.back().SizeEstimate();
         break;
       }
       default:
@@ -327,6 +328,8 @@ leveldb::Status IndexedDBCursor::CursorPrefetchIterationOperation(
     return s;
   }
 
+  prefetch_budget_.OnPrefetchSent(size_estimate);
+
   DCHECK_EQ(found_keys.size(), found_primary_keys.size());
   DCHECK_EQ(found_keys.size(), found_values.size());
 
@@ -348,8 +351,9 @@ leveldb::Status IndexedDBCursor::CursorPrefetchIterationOperation(
 }
 
 leveldb::Status IndexedDBCursor::PrefetchReset(int used_prefetches,
-                                               int /* unused_prefetches */) {
+                                               int unused_prefetches) {
   IDB_TRACE("IndexedDBCursor::PrefetchReset");
+  prefetch_budget_.OnPrefetchReset(used_prefetches, unused_prefetches);
   cursor_.swap(saved_cursor_);
   saved_cursor_.reset();
   leveldb::Status s;
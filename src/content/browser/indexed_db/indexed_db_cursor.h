@@ -14,6 +14,7 @@
 #include "base/memory/ref_counted.h"
 #include "base/memory/weak_ptr.h"
 #include "content/browser/indexed_db/indexed_db_backing_store.h"
+#include "content/browser/indexed_db/indexed_db_cursor_prefetch_budget.h"
 #include "content/browser/indexed_db/indexed_db_database.h"
 #include "content/browser/indexed_db/indexed_db_transaction.h"
 #include "third_party/blink/public/common/indexeddb/web_idb_types.h"
@@ -89,6 +90,8 @@ class CONTENT_EXPORT IndexedDBCursor {
 
   base::OnceClosure remove_binding_cb_;
 
+  IndexedDBCursorPrefetchBudget prefetch_budget_;
+
   bool closed_;
 
   base::WeakPtrFactory<IndexedDBCursor> ptr_factory_{this};
@@ -0,0 +1,43 @@
+// Copyright 2020 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "content/browser/indexed_db/indexed_db_cursor_prefetch_budget.h"
+
+#include <algorithm>
+
+namespace content {
+
+constexpr size_t IndexedDBCursorPrefetchBudget::kMinBytes;
+constexpr size_t IndexedDBCursorPrefetchBudget::kInitialBytes;
+constexpr size_t IndexedDBCursorPrefetchBudget::kMaxBytes;
+
+IndexedDBCursorPrefetchBudget::IndexedDBCursorPrefetchBudget() = default;
+IndexedDBCursorPrefetchBudget::~IndexedDBCursorPrefetchBudget() = default;
+
+void IndexedDBCursorPrefetchBudget::OnPrefetchRequested() {
+  // The previous batch was fully consumed. Only grow if the byte budget was
+  // what limited it; otherwise the renderer's record count was the limit and
+  // a larger budget would not change anything.
+  if (batch_outstanding_ && last_batch_hit_budget_)
+    max_bytes_ = std::min(max_bytes_ * 2, kMaxBytes);
+  batch_outstanding_ = false;
+  last_batch_hit_budget_ = false;
+}
+
+void IndexedDBCursorPrefetchBudget::OnPrefetchSent(size_t bytes) {
+  batch_outstanding_ = true;
+  last_batch_hit_budget_ = bytes > max_bytes_;
+}
+
+void IndexedDBCursorPrefetchBudget::OnPrefetchReset(int used_prefetches,
+                                                    int unused_prefetches) {
+  // Discarding more than was used means the values were read from LevelDB and
+  // copied for nothing, so send less next time.
+  if (unused_prefetches > used_prefetches)
+    max_bytes_ = std::max(max_bytes_ / 2, kMinBytes);
+  batch_outstanding_ = false;
+  last_batch_hit_budget_ = false;
+}
+
+}  // namespace content
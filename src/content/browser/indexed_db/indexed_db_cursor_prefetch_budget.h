@@ -0,0 +1,59 @@
+// Copyright 2020 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef CONTENT_BROWSER_INDEXED_DB_INDEXED_DB_CURSOR_PREFETCH_BUDGET_H_
+#define CONTENT_BROWSER_INDEXED_DB_INDEXED_DB_CURSOR_PREFETCH_BUDGET_H_
+
+#include <stddef.h>
+
+#include "base/macros.h"
+#include "content/common/content_export.h"
+
+namespace content {
+
+// Decides how many bytes of keys and values a single cursor prefetch batch may
+// contain. The renderer picks the number of records it wants, but a fixed byte
+// cap either wastes work on large records that are thrown away by a
+// PrefetchReset(), or sends many tiny batches for consumers that iterate a
+// whole store. The budget starts small, doubles each time the renderer comes
+// back for more without discarding anything, and halves when most of a batch
+// was discarded.
+class CONTENT_EXPORT IndexedDBCursorPrefetchBudget {
+ public:
+  static constexpr size_t kMinBytes = 64 * 1024;
+  static constexpr size_t kInitialBytes = 1024 * 1024;
+  // TODO(cmumford): Use IPC::Channel::kMaximumMessageSize
+  static constexpr size_t kMaxBytes = 10 * 1024 * 1024;
+
+  IndexedDBCursorPrefetchBudget();
+  ~IndexedDBCursorPrefetchBudget();
+
+  // The byte budget for the next prefetch batch.
+  size_t max_bytes() const { return max_bytes_; }
+
+  // Called when a prefetch request arrives. A request that follows a batch
+  // which was not reset means the consumer used all of it.
+  void OnPrefetchRequested();
+
+  // Called after a batch whose keys and values total |bytes| has been sent to
+  // the renderer.
+  void OnPrefetchSent(size_t bytes);
+
+  // Called when the renderer discards the unused tail of the last batch.
+  void OnPrefetchReset(int used_prefetches, int unused_prefetches);
+
+ private:
+  size_t max_bytes_ = kInitialBytes;
+  // True while a batch is outstanding in the renderer and has not been reset.
+  bool batch_outstanding_ = false;
+  // Whether the outstanding batch was cut short by the byte budget, rather
+  // than by the requested record count or the end of the range.
+  bool last_batch_hit_budget_ = false;
+
+  DISALLOW_COPY_AND_ASSIGN(IndexedDBCursorPrefetchBudget);
+};
+
+}  // namespace content
+
+#endif  // CONTENT_BROWSER_INDEXED_DB_INDEXED_DB_CURSOR_PREFETCH_BUDGET_H_
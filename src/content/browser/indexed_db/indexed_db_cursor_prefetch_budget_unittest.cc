@@ -0,0 +1,66 @@
+// Copyright 2020 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "content/browser/indexed_db/indexed_db_cursor_prefetch_budget.h"
+
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace content {
+
+using Budget = IndexedDBCursorPrefetchBudget;
+
+TEST(IndexedDBCursorPrefetchBudgetTest, StartsAtInitialBudget) {
+  Budget budget;
+  EXPECT_EQ(Budget::kInitialBytes, budget.max_bytes());
+}
+
+TEST(IndexedDBCursorPrefetchBudgetTest, GrowsWhenConsumedBatchHitBudget) {
+  Budget budget;
+  budget.OnPrefetchRequested();
+  budget.OnPrefetchSent(Budget::kInitialBytes + 1);
+  budget.OnPrefetchRequested();
+  EXPECT_EQ(Budget::kInitialBytes * 2, budget.max_bytes());
+
+  // Growth is capped.
+  for (int i = 0; i < 10; ++i) {
+    budget.OnPrefetchSent(budget.max_bytes() + 1);
+    budget.OnPrefetchRequested();
+  }
+  EXPECT_EQ(Budget::kMaxBytes, budget.max_bytes());
+}
+
+TEST(IndexedDBCursorPrefetchBudgetTest, NoGrowthWhenCountLimited) {
+  Budget budget;
+  budget.OnPrefetchRequested();
+  budget.OnPrefetchSent(1024);
+  budget.OnPrefetchRequested();
+  EXPECT_EQ(Budget::kInitialBytes, budget.max_bytes());
+}
+
+TEST(IndexedDBCursorPrefetchBudgetTest, ShrinksWhenMostlyDiscarded) {
+  Budget budget;
+  budget.OnPrefetchRequested();
+  budget.OnPrefetchSent(Budget::kInitialBytes + 1);
+  budget.OnPrefetchReset(/*used_prefetches=*/1, /*unused_prefetches=*/9);
+  EXPECT_EQ(Budget::kInitialBytes / 2, budget.max_bytes());
+
+  // A reset batch does not count as consumed by the next request.
+  budget.OnPrefetchRequested();
+  EXPECT_EQ(Budget::kInitialBytes / 2, budget.max_bytes());
+
+  // Shrinking is floored.
+  for (int i = 0; i < 10; ++i)
+    budget.OnPrefetchReset(1, 9);
+  EXPECT_EQ(Budget::kMinBytes, budget.max_bytes());
+}
+
+TEST(IndexedDBCursorPrefetchBudgetTest, MostlyUsedResetKeepsBudget) {
+  Budget budget;
+  budget.OnPrefetchRequested();
+  budget.OnPrefetchSent(Budget::kInitialBytes + 1);
+  budget.OnPrefetchReset(/*used_prefetches=*/8, /*unused_prefetches=*/2);
+  EXPECT_EQ(Budget::kInitialBytes, budget.max_bytes());
+}
+
+}  // namespace content
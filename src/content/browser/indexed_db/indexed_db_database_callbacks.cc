@@ -77,13 +77,30 @@ void IndexedDBDatabaseCallbacks::OnAbort(
 
 void IndexedDBDatabaseCallbacks::OnComplete(
     const IndexedDBTransaction& transaction) {
+  OnCompleteAfterDurable(transaction.database()->origin(), transaction.id());
+}
+
+void IndexedDBDatabaseCallbacks::OnCompleteAfterDurable(
+    const url::Origin& origin,
+    int64_t transaction_id) {
+  DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
+  if (complete_)
+    return;
+
+  indexed_db_context_->TransactionComplete(origin);
+  if (callbacks_)
+    callbacks_->Complete(transaction_id);
+}
+
+void IndexedDBDatabaseCallbacks::OnDurableCommitFailed(
+    int64_t transaction_id,
+    const IndexedDBDatabaseError& error) {
   DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
   if (complete_)
     return;
 
-  indexed_db_context_->TransactionComplete(transaction.database()->origin());
   if (callbacks_)
-    callbacks_->Complete(transaction.id());
+    callbacks_->Abort(transaction_id, error.code(), error.message());
 }
 
 void IndexedDBDatabaseCallbacks::OnDatabaseChange(
@@ -16,6 +16,7 @@
 #include "mojo/public/cpp/bindings/associated_remote.h"
 #include "mojo/public/cpp/bindings/pending_associated_remote.h"
 #include "third_party/blink/public/mojom/indexeddb/indexeddb.mojom.h"
+#include "url/origin.h"
 
 namespace content {
 class IndexedDBContextImpl;
@@ -38,6 +39,14 @@ class CONTENT_EXPORT IndexedDBDatabaseCallbacks
   virtual void OnAbort(const IndexedDBTransaction& transaction,
                        const IndexedDBDatabaseError& error);
   virtual void OnComplete(const IndexedDBTransaction& transaction);
+  // Same as OnComplete(), for a transaction whose completion was held back
+  // until its commit was durable. The transaction may be gone by then.
+  virtual void OnCompleteAfterDurable(const url::Origin& origin,
+                                      int64_t transaction_id);
+  // Reports the failure of a transaction whose commit was written but could
+  // not be made durable.
+  virtual void OnDurableCommitFailed(int64_t transaction_id,
+                                     const IndexedDBDatabaseError& error);
   virtual void OnDatabaseChange(blink::mojom::IDBObserverChangesPtr changes);
 
   void OnConnectionError();
@@ -16,11 +16,13 @@
 #include "base/test/bind_test_util.h"
 #include "base/test/gmock_callback_support.h"
 #include "base/test/mock_callback.h"
+#include "base/test/scoped_feature_list.h"
 #include "base/test/task_environment.h"
 #include "base/test/test_simple_task_runner.h"
 #include "base/threading/thread.h"
 #include "base/time/default_clock.h"
 #include "build/build_config.h"
+#include "content/browser/indexed_db/indexed_db_backing_store.h"
 #include "content/browser/indexed_db/indexed_db_callbacks.h"
 #include "content/browser/indexed_db/indexed_db_context_impl.h"
 #include "content/browser/indexed_db/indexed_db_database_callbacks.h"
@@ -230,6 +232,19 @@ class IndexedDBDispatcherHostTest : public testing::Test {
   DISALLOW_COPY_AND_ASSIGN(IndexedDBDispatcherHostTest);
 };
 
+class IndexedDBDispatcherHostTestWithGroupCommit
+    : public IndexedDBDispatcherHostTest {
+ public:
+  IndexedDBDispatcherHostTestWithGroupCommit() {
+    feature_list_.InitAndEnableFeature(kIndexedDBGroupCommit);
+  }
+
+ private:
+  base::test::ScopedFeatureList feature_list_;
+
+  DISALLOW_COPY_AND_ASSIGN(IndexedDBDispatcherHostTestWithGroupCommit);
+};
+
 TEST_F(IndexedDBDispatcherHostTest, CloseConnectionBeforeUpgrade) {
   const int64_t kDBVersion = 1;
   const int64_t kTransactionId = 1;
@@ -843,6 +858,70 @@ TEST_F(IndexedDBDispatcherHostTest,
   loop3.Run();
 }
 
+// The complete event of an upgrade transaction waits for the group commit
+// sync, and the success of the open request must still come after it.
+TEST_F(IndexedDBDispatcherHostTestWithGroupCommit, UpgradeEventOrder) {
+  const int64_t kDBVersion = 1;
+  const int64_t kTransactionId = 1;
+  std::unique_ptr<TestDatabaseConnection> connection;
+  IndexedDBDatabaseMetadata metadata;
+  mojo::PendingAssociatedRemote<blink::mojom::IDBDatabase> pending_database;
+
+  base::RunLoop loop;
+  context_impl_->IDBTaskRunner()->PostTask(
+      FROM_HERE, base::BindLambdaForTesting([&]() {
+        // Open connection.
+        connection = std::make_unique<TestDatabaseConnection>(
+            context_impl_->IDBTaskRunner(), ToOrigin(kOrigin),
+            base::UTF8ToUTF16(kDatabaseName), kDBVersion, kTransactionId);
+        EXPECT_CALL(*connection->open_callbacks,
+                    MockedUpgradeNeeded(IsAssociatedInterfacePtrInfoValid(true),
+                                        IndexedDBDatabaseMetadata::NO_VERSION,
+                                        blink::mojom::IDBDataLoss::None,
+                                        std::string(), _))
+            .WillOnce(testing::DoAll(MoveArgPointee<0>(&pending_database),
+                                     testing::SaveArg<4>(&metadata),
+                                     QuitLoop(&loop)));
+
+        // Queue open request message.
+        connection->Open(idb_mojo_factory_.get());
+      }));
+  loop.Run();
+
+  ASSERT_TRUE(pending_database.is_valid());
+  EXPECT_EQ(connection->version, metadata.version);
+
+  base::RunLoop loop2;
+  base::RepeatingClosure quit_closure2 =
+      base::BarrierClosure(2, loop2.QuitClosure());
+  context_impl_->IDBTaskRunner()->PostTask(
+      FROM_HERE, base::BindLambdaForTesting([&]() {
+        ::testing::InSequence dummy;
+        EXPECT_CALL(*connection->connection_callbacks, Complete(kTransactionId))
+            .Times(1)
+            .WillOnce(RunClosure(quit_closure2));
+        EXPECT_CALL(
+            *connection->open_callbacks,
+            MockedSuccessDatabase(IsAssociatedInterfacePtrInfoValid(false), _))
+            .Times(1)
+            .WillOnce(RunClosure(quit_closure2));
+
+        connection->database.Bind(std::move(pending_database));
+        ASSERT_TRUE(connection->database.is_bound());
+        ASSERT_TRUE(connection->version_change_transaction.is_bound());
+        connection->version_change_transaction->Commit(0);
+      }));
+  loop2.Run();
+
+  base::RunLoop loop3;
+  context_impl_->IDBTaskRunner()->PostTask(FROM_HERE,
+                                           base::BindLambdaForTesting([&]() {
+                                             connection.reset();
+                                             loop3.Quit();
+                                           }));
+  loop3.Run();
+}
+
 TEST_F(IndexedDBDispatcherHostTest, AbortTransactionsWhileDoingTransaction) {
   const int64_t kDBVersion = 1;
   const int64_t kTransactionId = 1;
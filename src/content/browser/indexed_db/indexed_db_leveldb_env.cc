@@ -4,10 +4,53 @@
 
 #include "content/browser/indexed_db/indexed_db_leveldb_env.h"
 
+#include "base/feature_list.h"
+#include "base/macros.h"
+#include "base/strings/string_util.h"
 #include "components/services/storage/filesystem_proxy_factory.h"
+#include "content/browser/indexed_db/indexed_db_backing_store.h"
 
 namespace content {
 
+namespace {
+
+// Syncs |file| before closing it. The destructor syncs too, for LevelDB
+// versions that delete the old log without closing it first.
+class SyncOnCloseWritableFile : public leveldb::WritableFile {
+ public:
+  explicit SyncOnCloseWritableFile(leveldb::WritableFile* file)
+      : file_(file) {}
+  ~SyncOnCloseWritableFile() override {
+    if (!closed_)
+      file_->Sync();
+  }
+
+  leveldb::Status Append(const leveldb::Slice& data) override {
+    return file_->Append(data);
+  }
+  leveldb::Status Close() override {
+    closed_ = true;
+    leveldb::Status s = file_->Sync();
+    leveldb::Status close_status = file_->Close();
+    return s.ok() ? close_status : s;
+  }
+  leveldb::Status Flush() override { return file_->Flush(); }
+  leveldb::Status Sync() override { return file_->Sync(); }
+
+ private:
+  std::unique_ptr<leveldb::WritableFile> file_;
+  bool closed_ = false;
+
+  DISALLOW_COPY_AND_ASSIGN(SyncOnCloseWritableFile);
+};
+
+bool ShouldSyncOnClose(const std::string& fname) {
+  return base::EndsWith(fname, ".log", base::CompareCase::SENSITIVE) &&
+         base::FeatureList::IsEnabled(kIndexedDBGroupCommit);
+}
+
+}  // namespace
+
 IndexedDBLevelDBEnv::IndexedDBLevelDBEnv()
     : ChromiumEnv("LevelDBEnv.IDB", storage::CreateFilesystemProxy()) {}
 
@@ -16,4 +59,22 @@ IndexedDBLevelDBEnv* IndexedDBLevelDBEnv::Get() {
   return g_leveldb_env.get();
 }
 
+leveldb::Status IndexedDBLevelDBEnv::NewWritableFile(
+    const std::string& fname,
+    leveldb::WritableFile** result) {
+  leveldb::Status s = ChromiumEnv::NewWritableFile(fname, result);
+  if (s.ok() && ShouldSyncOnClose(fname))
+    *result = new SyncOnCloseWritableFile(*result);
+  return s;
+}
+
+leveldb::Status IndexedDBLevelDBEnv::NewAppendableFile(
+    const std::string& fname,
+    leveldb::WritableFile** result) {
+  leveldb::Status s = ChromiumEnv::NewAppendableFile(fname, result);
+  if (s.ok() && ShouldSyncOnClose(fname))
+    *result = new SyncOnCloseWritableFile(*result);
+  return s;
+}
+
 }  // namespace content
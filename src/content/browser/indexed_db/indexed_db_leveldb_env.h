@@ -6,6 +6,7 @@
 #define CONTENT_BROWSER_INDEXED_DB_INDEXED_DB_LEVELDB_ENV_H_
 
 #include <memory>
+#include <string>
 #include <tuple>
 
 #include "base/no_destructor.h"
@@ -19,6 +20,15 @@ class IndexedDBLevelDBEnv : public leveldb_env::ChromiumEnv {
  public:
   CONTENT_EXPORT static IndexedDBLevelDBEnv* Get();
 
+  // With kIndexedDBGroupCommit, LevelDB log files are synced when they are
+  // closed. LevelDB closes the old log without a sync when it switches to a
+  // new one, and group commit relies on a synced write to the new log making
+  // the unsynced writes to the old one durable too.
+  leveldb::Status NewWritableFile(const std::string& fname,
+                                  leveldb::WritableFile** result) override;
+  leveldb::Status NewAppendableFile(const std::string& fname,
+                                    leveldb::WritableFile** result) override;
+
  private:
   friend class base::NoDestructor<IndexedDBLevelDBEnv>;
   IndexedDBLevelDBEnv();
@@ -65,6 +65,35 @@ UmaIDBException ExceptionCodeToUmaEnum(blink::mojom::IDBException code) {
   return UmaIDBExceptionUnknownError;
 }
 
+// Reports a committed transaction whose completion was held back until the
+// backing store synced its commit. The transaction may be gone by then.
+void ReportDurableCommit(
+    scoped_refptr<IndexedDBDatabaseCallbacks> callbacks,
+    base::WeakPtr<IndexedDBDatabase> database,
+    const url::Origin& origin,
+    int64_t transaction_id,
+    blink::mojom::IDBTransactionMode mode,
+    IndexedDBTransaction::TearDownCallback tear_down_callback,
+    leveldb::Status s) {
+  if (s.ok()) {
+    callbacks->OnCompleteAfterDurable(origin, transaction_id);
+  } else {
+    // The commit can't be undone, but it may not have reached the disk, so
+    // it must not be reported complete. Fail it explicitly: force-closing the
+    // connections doesn't abort a transaction that has already committed.
+    callbacks->OnDurableCommitFailed(
+        transaction_id,
+        IndexedDBDatabaseError(blink::mojom::IDBException::kUnknownError,
+                               "Internal error committing transaction."));
+    // This may run while the backing store is being destroyed, so tear the
+    // origin down from a new task.
+    base::SequencedTaskRunnerHandle::Get()->PostTask(
+        FROM_HERE, base::BindOnce(tear_down_callback, s));
+  }
+  if (database)
+    database->TransactionFinished(mode, s.ok());
+}
+
 }  // namespace
 
 IndexedDBTransaction::TaskQueue::TaskQueue() = default;
@@ -360,6 +389,7 @@ leveldb::Status IndexedDBTransaction::CommitPhaseTwo() {
 
   leveldb::Status s;
   bool committed;
+  bool needs_sync = false;
   if (!used_) {
     committed = true;
   } else {
@@ -393,7 +423,9 @@ leveldb::Status IndexedDBTransaction::CommitPhaseTwo() {
 
     s = transaction_->CommitPhaseTwo();
     committed = s.ok();
+    needs_sync = transaction_->committed_without_sync();
   }
+  IndexedDBBackingStore* backing_store = transaction_->backing_store();
 
   // Backing store resources (held via cursors) must be released
   // before script callbacks are fired, as the script callbacks may
@@ -417,7 +449,9 @@ leveldb::Status IndexedDBTransaction::CommitPhaseTwo() {
         database_->SendObservations(std::move(connection_changes_map_));
       connection_changes_map_.clear();
     }
-    {
+    const bool report_when_durable =
+        backing_store && backing_store->is_group_commit_enabled() && database_;
+    if (!report_when_durable) {
       IDB_TRACE1(
           "IndexedDBTransaction::CommitPhaseTwo.TransactionCompleteCallbacks",
           "txn.id", id());
@@ -425,8 +459,19 @@ leveldb::Status IndexedDBTransaction::CommitPhaseTwo() {
     }
     if (!pending_observers_.empty() && connection_)
       connection_->ActivatePendingObservers(std::move(pending_observers_));
-    if (database_)
+    if (report_when_durable) {
+      // Locks are already released, so later transactions can proceed while
+      // this one waits for the shared sync. The complete event and
+      // TransactionFinished() both wait, so that the complete event of an
+      // upgrade transaction still precedes the success of its open request.
+      backing_store->RunWhenCommitsAreDurable(
+          needs_sync,
+          base::BindOnce(&ReportDurableCommit, callbacks_, database_,
+                         database_->origin(), id(), mode_,
+                         tear_down_callback_));
+    } else if (database_) {
       database_->TransactionFinished(mode_, true);
+    }
     return s;
   } else {
     while (!abort_task_stack_.empty())
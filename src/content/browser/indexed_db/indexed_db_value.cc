@@ -19,8 +19,9 @@ blink::mojom::IDBValuePtr IndexedDBValue::ConvertAndEraseValue(
     const char* value_data = value->bits.data();
     mojo_value->bits =
         std::vector<uint8_t>(value_data, value_data + value->bits.length());
-    // Release value->bits std::string.
-    value->bits.clear();
+    // Release value->bits std::string. clear() would keep the allocation
+    // alive until the whole prefetched batch of values is destroyed.
+    std::string().swap(value->bits);
   }
   IndexedDBExternalObject::ConvertToMojo(value->external_objects,
                                          &mojo_value->external_objects);
@@ -35,8 +36,11 @@ IndexedDBValue::IndexedDBValue(
   DCHECK(external_objects.empty() || input_bits.size());
 }
 IndexedDBValue::IndexedDBValue(const IndexedDBValue& other) = default;
+IndexedDBValue::IndexedDBValue(IndexedDBValue&& other) noexcept = default;
 IndexedDBValue::~IndexedDBValue() = default;
 IndexedDBValue& IndexedDBValue::operator=(const IndexedDBValue& other) =
     default;
+IndexedDBValue& IndexedDBValue::operator=(IndexedDBValue&& other) noexcept =
+    default;
 
 }  // namespace content
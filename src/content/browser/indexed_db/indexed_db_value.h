@@ -25,8 +25,12 @@ struct CONTENT_EXPORT IndexedDBValue {
   IndexedDBValue(const std::string& input_bits,
                  const std::vector<IndexedDBExternalObject>& external_objects);
   IndexedDBValue(const IndexedDBValue& other);
+  // noexcept so that growing a std::vector<IndexedDBValue> moves the bits
+  // instead of copying them.
+  IndexedDBValue(IndexedDBValue&& other) noexcept;
   ~IndexedDBValue();
   IndexedDBValue& operator=(const IndexedDBValue& other);
+  IndexedDBValue& operator=(IndexedDBValue&& other) noexcept;
 
   void swap(IndexedDBValue& value) {
     bits.swap(value.bits);
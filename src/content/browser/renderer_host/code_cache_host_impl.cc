@@ -52,17 +52,7 @@ void NoOpCacheStorageErrorCallback(CacheStorageCacheHandle cache_handle,
 // key.
 // Case 3: origin_lock if the scheme of origin_lock is Http/Https/chrome.
 // Case 4. base::nullopt otherwise.
-base::Optional<GURL> GetSecondaryKeyForCodeCache(const GURL& resource_url,
-                                                 int render_process_id) {
-#if defined(USE_FILESCHEME_CODECACHE)
-  if (!resource_url.is_valid() ||
-      (!resource_url.SchemeIsHTTPOrHTTPS() &&
-       !content::neva::IsFileSchemeSupportedForCodeCache(resource_url)))
-#else
-  if (!resource_url.is_valid() || !resource_url.SchemeIsHTTPOrHTTPS())
-#endif
-    return base::nullopt;
-
+base::Optional<GURL> GetSecondaryKeyForProcess(int render_process_id) {
   ProcessLock process_lock =
       ChildProcessSecurityPolicyImpl::GetInstance()->GetProcessLock(
           render_process_id);
@@ -103,6 +93,23 @@ base::Optional<GURL> GetSecondaryKeyForCodeCache(const GURL& resource_url,
   return base::nullopt;
 }
 
+// Returns the secondary key for |resource_url| requested by the renderer, or
+// base::nullopt if the resource's code should not be cached. See
+// GetSecondaryKeyForProcess().
+base::Optional<GURL> GetSecondaryKeyForCodeCache(const GURL& resource_url,
+                                                 int render_process_id) {
+#if defined(USE_FILESCHEME_CODECACHE)
+  if (!resource_url.is_valid() ||
+      (!resource_url.SchemeIsHTTPOrHTTPS() &&
+       !content::neva::IsFileSchemeSupportedForCodeCache(resource_url)))
+#else
+  if (!resource_url.is_valid() || !resource_url.SchemeIsHTTPOrHTTPS())
+#endif
+    return base::nullopt;
+
+  return GetSecondaryKeyForProcess(render_process_id);
+}
+
 }  // namespace
 
 CodeCacheHostImpl::CodeCacheHostImpl(
@@ -113,7 +120,21 @@ CodeCacheHostImpl::CodeCacheHostImpl(
     : render_process_id_(render_process_id),
       cache_storage_context_(std::move(cache_storage_context)),
       generated_code_cache_context_(std::move(generated_code_cache_context)),
-      receiver_(this, std::move(receiver)) {}
+      receiver_(this, std::move(receiver)) {
+  // If the process is already locked to its origin, start reading that
+  // origin's hot scripts now, while the renderer is still starting up,
+  // rather than at its first script fetch.
+  GeneratedCodeCache* js_code_cache =
+      GetCodeCache(blink::mojom::CodeCacheType::kJavascript);
+  if (!js_code_cache)
+    return;
+  // Use the same secondary key as the renderer's fetches, so that both
+  // agree on which processes have a per-origin cache.
+  base::Optional<GURL> origin_lock =
+      GetSecondaryKeyForProcess(render_process_id_);
+  if (origin_lock && !origin_lock->is_empty())
+    js_code_cache->PrefetchHotEntries(*origin_lock);
+}
 
 CodeCacheHostImpl::~CodeCacheHostImpl() {
   DCHECK_CURRENTLY_ON(BrowserThread::UI);
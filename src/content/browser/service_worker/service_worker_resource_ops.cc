@@ -4,6 +4,9 @@
 
 #include "content/browser/service_worker/service_worker_resource_ops.h"
 
+#include <algorithm>
+#include <string>
+
 #include "base/numerics/checked_math.h"
 #include "base/pickle.h"
 #include "mojo/public/cpp/bindings/remote.h"
@@ -91,9 +94,11 @@ class ServiceWorkerResourceReaderImpl::DataReader {
       size_t total_bytes_to_read,
       mojo::PendingRemote<storage::mojom::ServiceWorkerDataPipeStateNotifier>
           notifier,
-      mojo::ScopedDataPipeProducerHandle producer_handle)
+      mojo::ScopedDataPipeProducerHandle producer_handle,
+      scoped_refptr<base::RefCountedString> cached_body)
       : owner_(std::move(owner)),
         total_bytes_to_read_(total_bytes_to_read),
+        cached_body_(std::move(cached_body)),
         notifier_(std::move(notifier)),
         producer_handle_(std::move(producer_handle)),
         watcher_(FROM_HERE,
@@ -113,6 +118,12 @@ class ServiceWorkerResourceReaderImpl::DataReader {
     state_ = State::kStarted;
 #endif
 
+    // A cached body doesn't need the disk cache entry.
+    if (cached_body_) {
+      ContinueReadData();
+      return;
+    }
+
     owner_->EnsureEntryIsOpen(base::BindOnce(&DataReader::ContinueReadData,
                                              weak_factory_.GetWeakPtr()));
   }
@@ -129,9 +140,22 @@ class ServiceWorkerResourceReaderImpl::DataReader {
       return;
     }
 
-    if (!owner_->entry_) {
-      Complete(net::ERR_CACHE_MISS);
-      return;
+    if (!cached_body_) {
+      if (!owner_->entry_) {
+        Complete(net::ERR_CACHE_MISS);
+        return;
+      }
+
+      // Keep a copy of the body while streaming it so that the next reader
+      // of this resource can be served from memory.
+      int64_t body_size = owner_->entry_->GetSize(kResponseContentIndex);
+      should_cache_body_ =
+          owner_->memory_cache_ && body_size >= 0 &&
+          static_cast<uint64_t>(body_size) <=
+              ServiceWorkerScriptMemoryCache::kMaxBodyBytes &&
+          static_cast<uint64_t>(body_size) <= total_bytes_to_read_;
+      if (should_cache_body_)
+        body_to_cache_.reserve(body_size);
     }
 
     watcher_.Watch(producer_handle_.get(), MOJO_HANDLE_SIGNAL_WRITABLE,
@@ -149,7 +173,7 @@ class ServiceWorkerResourceReaderImpl::DataReader {
     DCHECK(producer_handle_.is_valid());
     DCHECK(!pending_buffer_);
 
-    if (!owner_ || !owner_->entry_) {
+    if (!owner_ || (!cached_body_ && !owner_->entry_)) {
       Complete(net::ERR_ABORTED);
       return;
     }
@@ -179,6 +203,15 @@ class ServiceWorkerResourceReaderImpl::DataReader {
     scoped_refptr<network::NetToMojoIOBuffer> buffer =
         base::MakeRefCounted<network::NetToMojoIOBuffer>(pending_buffer_.get());
 
+    if (cached_body_) {
+      size_t body_size = std::min(cached_body_->size(), total_bytes_to_read_);
+      num_bytes = std::min<size_t>(num_bytes, body_size - current_bytes_read_);
+      memcpy(buffer->data(), cached_body_->front() + current_bytes_read_,
+             num_bytes);
+      DidReadData(std::move(buffer), num_bytes);
+      return;
+    }
+
     net::IOBuffer* raw_buffer = buffer.get();
     int read_bytes = owner_->entry_->Read(
         kResponseContentIndex, current_bytes_read_, raw_buffer, num_bytes,
@@ -201,6 +234,9 @@ class ServiceWorkerResourceReaderImpl::DataReader {
       return;
     }
 
+    if (should_cache_body_)
+      body_to_cache_.append(buffer->data(), read_bytes);
+
     producer_handle_ = pending_buffer_->Complete(read_bytes);
     DCHECK(producer_handle_.is_valid());
     pending_buffer_.reset();
@@ -228,13 +264,33 @@ class ServiceWorkerResourceReaderImpl::DataReader {
     }
 
     if (owner_) {
+      MaybeCacheBody(status);
       owner_->DidReadDataComplete();
     }
   }
 
+  void MaybeCacheBody(int status) {
+    DCHECK(owner_);
+    if (!should_cache_body_ || !owner_->memory_cache_ || !owner_->entry_ ||
+        status < 0 ||
+        status != owner_->entry_->GetSize(kResponseContentIndex)) {
+      return;
+    }
+    owner_->memory_cache_->PutBody(
+        owner_->resource_id_, owner_->memory_cache_generation_,
+        base::RefCountedString::TakeString(&body_to_cache_));
+  }
+
   base::WeakPtr<ServiceWorkerResourceReaderImpl> owner_;
   const size_t total_bytes_to_read_;
   size_t current_bytes_read_ = 0;
+  // Set when the body is served from the memory cache instead of the disk
+  // cache entry.
+  scoped_refptr<base::RefCountedString> cached_body_;
+  // Set when the body read from the disk cache is small enough to be copied
+  // into the memory cache. The copy is kept in |body_to_cache_|.
+  bool should_cache_body_ = false;
+  std::string body_to_cache_;
   mojo::Remote<storage::mojom::ServiceWorkerDataPipeStateNotifier> notifier_;
   mojo::ScopedDataPipeProducerHandle producer_handle_;
   mojo::SimpleWatcher watcher_;
@@ -257,8 +313,11 @@ class ServiceWorkerResourceReaderImpl::DataReader {
 
 ServiceWorkerResourceReaderImpl::ServiceWorkerResourceReaderImpl(
     int64_t resource_id,
-    base::WeakPtr<AppCacheDiskCache> disk_cache)
-    : resource_id_(resource_id), disk_cache_(std::move(disk_cache)) {
+    base::WeakPtr<AppCacheDiskCache> disk_cache,
+    base::WeakPtr<ServiceWorkerScriptMemoryCache> memory_cache)
+    : resource_id_(resource_id),
+      disk_cache_(std::move(disk_cache)),
+      memory_cache_(std::move(memory_cache)) {
   DCHECK_NE(resource_id_, blink::mojom::kInvalidServiceWorkerResourceId);
   DCHECK(disk_cache_);
 }
@@ -280,6 +339,22 @@ void ServiceWorkerResourceReaderImpl::ReadResponseHead(
   DCHECK(!metadata_buffer_);
   DCHECK(!data_reader_);
 
+  if (memory_cache_) {
+    int result;
+    network::mojom::URLResponseHeadPtr response_head;
+    base::Optional<mojo_base::BigBuffer> metadata;
+    if (memory_cache_->GetResponseHead(resource_id_, &result, &response_head,
+                                       &metadata)) {
+#if DCHECK_IS_ON()
+      state_ = State::kIdle;
+#endif
+      std::move(callback).Run(result, std::move(response_head),
+                              std::move(metadata));
+      return;
+    }
+    memory_cache_generation_ = memory_cache_->generation();
+  }
+
   read_response_head_callback_ = std::move(callback);
   EnsureEntryIsOpen(
       base::BindOnce(&ServiceWorkerResourceReaderImpl::ContinueReadResponseHead,
@@ -315,9 +390,15 @@ void ServiceWorkerResourceReaderImpl::ReadData(
     return;
   }
 
-  data_reader_ = std::make_unique<DataReader>(weak_factory_.GetWeakPtr(), size,
-                                              std::move(notifier),
-                                              std::move(producer_handle));
+  scoped_refptr<base::RefCountedString> cached_body;
+  if (memory_cache_) {
+    cached_body = memory_cache_->GetBody(resource_id_);
+    memory_cache_generation_ = memory_cache_->generation();
+  }
+
+  data_reader_ = std::make_unique<DataReader>(
+      weak_factory_.GetWeakPtr(), size, std::move(notifier),
+      std::move(producer_handle), std::move(cached_body));
   data_reader_->Start();
   std::move(callback).Run(std::move(consumer_handle));
 }
@@ -438,6 +519,11 @@ void ServiceWorkerResourceReaderImpl::CompleteReadResponseHead(int status) {
 
   metadata_buffer_ = nullptr;
 
+  if (memory_cache_ && status >= 0 && response_head_) {
+    memory_cache_->PutResponseHead(resource_id_, memory_cache_generation_,
+                                   status, *response_head_, metadata);
+  }
+
   std::move(read_response_head_callback_)
       .Run(status, std::move(response_head_), std::move(metadata));
 }
@@ -532,8 +618,12 @@ void ServiceWorkerResourceWriterImpl::WriteData(mojo_base::BigBuffer data,
 
 ServiceWorkerResourceMetadataWriterImpl::
     ServiceWorkerResourceMetadataWriterImpl(
-        std::unique_ptr<ServiceWorkerResponseMetadataWriter> writer)
-    : writer_(std::move(writer)) {
+        int64_t resource_id,
+        std::unique_ptr<ServiceWorkerResponseMetadataWriter> writer,
+        base::WeakPtr<ServiceWorkerScriptMemoryCache> memory_cache)
+    : resource_id_(resource_id),
+      writer_(std::move(writer)),
+      memory_cache_(std::move(memory_cache)) {
   DCHECK(writer_);
 }
 
@@ -545,7 +635,18 @@ void ServiceWorkerResourceMetadataWriterImpl::WriteMetadata(
     WriteMetadataCallback callback) {
   int buf_len = data.size();
   auto buffer = base::MakeRefCounted<BigIOBuffer>(std::move(data));
-  writer_->WriteMetadata(buffer.get(), buf_len, std::move(callback));
+  writer_->WriteMetadata(
+      buffer.get(), buf_len,
+      base::BindOnce(&ServiceWorkerResourceMetadataWriterImpl::DidWriteMetadata,
+                     weak_factory_.GetWeakPtr(), std::move(callback)));
+}
+
+void ServiceWorkerResourceMetadataWriterImpl::DidWriteMetadata(
+    WriteMetadataCallback callback,
+    int result) {
+  if (memory_cache_)
+    memory_cache_->Erase(resource_id_);
+  std::move(callback).Run(result);
 }
 
 }  // namespace content
@@ -8,17 +8,22 @@
 #include "base/memory/weak_ptr.h"
 #include "components/services/storage/public/mojom/service_worker_storage_control.mojom.h"
 #include "content/browser/service_worker/service_worker_disk_cache.h"
+#include "content/browser/service_worker/service_worker_script_memory_cache.h"
 
 namespace content {
 
 class BigIOBuffer;
 
 // The implementation of storage::mojom::ServiceWorkerResourceReader.
+// When |memory_cache| is given, the response head and body are served from it
+// if present, and are added to it after being read from |disk_cache|.
 class ServiceWorkerResourceReaderImpl
     : public storage::mojom::ServiceWorkerResourceReader {
  public:
-  ServiceWorkerResourceReaderImpl(int64_t resource_id,
-                                  base::WeakPtr<AppCacheDiskCache> disk_cache);
+  ServiceWorkerResourceReaderImpl(
+      int64_t resource_id,
+      base::WeakPtr<AppCacheDiskCache> disk_cache,
+      base::WeakPtr<ServiceWorkerScriptMemoryCache> memory_cache);
 
   ServiceWorkerResourceReaderImpl(const ServiceWorkerResourceReaderImpl&) =
       delete;
@@ -63,6 +68,10 @@ class ServiceWorkerResourceReaderImpl
   base::WeakPtr<AppCacheDiskCache> disk_cache_;
   AppCacheDiskCacheEntry* entry_ = nullptr;
 
+  base::WeakPtr<ServiceWorkerScriptMemoryCache> memory_cache_;
+  // The generation of |memory_cache_| when the current disk read started.
+  uint64_t memory_cache_generation_ = 0;
+
   // Used to read metadata from disk cache.
   scoped_refptr<BigIOBuffer> metadata_buffer_;
   // Holds the return value of ReadResponseHead(). Stored as a member field
@@ -124,14 +133,18 @@ class ServiceWorkerResourceWriterImpl
 
 // The implementation of storage::mojom::ServiceWorkerResourceMetadataWriter.
 // Currently this class is an adaptor that uses
-// ServiceWorkerResponseMetadataWriter internally.
+// ServiceWorkerResponseMetadataWriter internally. The resource is erased from
+// |memory_cache| once the write completes so that readers that raced with the
+// write don't keep serving the old metadata.
 // TODO(crbug.com/1055677): Fork the implementation of
 // ServiceWorkerResponseMetadataWriter and stop using it.
 class ServiceWorkerResourceMetadataWriterImpl
     : public storage::mojom::ServiceWorkerResourceMetadataWriter {
  public:
-  explicit ServiceWorkerResourceMetadataWriterImpl(
-      std::unique_ptr<ServiceWorkerResponseMetadataWriter> writer);
+  ServiceWorkerResourceMetadataWriterImpl(
+      int64_t resource_id,
+      std::unique_ptr<ServiceWorkerResponseMetadataWriter> writer,
+      base::WeakPtr<ServiceWorkerScriptMemoryCache> memory_cache);
 
   ServiceWorkerResourceMetadataWriterImpl(
       const ServiceWorkerResourceMetadataWriterImpl&) = delete;
@@ -145,7 +158,14 @@ class ServiceWorkerResourceMetadataWriterImpl
   void WriteMetadata(mojo_base::BigBuffer data,
                      WriteMetadataCallback callback) override;
 
+  void DidWriteMetadata(WriteMetadataCallback callback, int result);
+
+  const int64_t resource_id_;
   const std::unique_ptr<ServiceWorkerResponseMetadataWriter> writer_;
+  base::WeakPtr<ServiceWorkerScriptMemoryCache> memory_cache_;
+
+  base::WeakPtrFactory<ServiceWorkerResourceMetadataWriterImpl> weak_factory_{
+      this};
 };
 
 }  // namespace content
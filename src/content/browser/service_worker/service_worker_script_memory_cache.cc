@@ -0,0 +1,161 @@
+// Copyright 2020 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "content/browser/service_worker/service_worker_script_memory_cache.h"
+
+#include <utility>
+
+#include "base/bind.h"
+#include "net/http/http_response_headers.h"
+
+namespace content {
+
+const base::Feature kServiceWorkerScriptMemoryCache{
+    "ServiceWorkerScriptMemoryCache", base::FEATURE_DISABLED_BY_DEFAULT};
+
+// static
+const size_t ServiceWorkerScriptMemoryCache::kMaxTotalBytes = 8 * 1024 * 1024;
+// static
+const size_t ServiceWorkerScriptMemoryCache::kMaxBodyBytes = 1024 * 1024;
+
+ServiceWorkerScriptMemoryCache::Entry::Entry() = default;
+ServiceWorkerScriptMemoryCache::Entry::~Entry() = default;
+
+size_t ServiceWorkerScriptMemoryCache::Entry::GetSize() const {
+  size_t size = sizeof(Entry);
+  if (response_head) {
+    size += sizeof(network::mojom::URLResponseHead);
+    if (response_head->headers)
+      size += response_head->headers->raw_headers().size();
+  }
+  if (metadata)
+    size += metadata->size();
+  if (body)
+    size += body->size();
+  return size;
+}
+
+ServiceWorkerScriptMemoryCache::ServiceWorkerScriptMemoryCache()
+    : entries_(EntryMap::NO_AUTO_EVICT) {
+  memory_pressure_listener_ = std::make_unique<base::MemoryPressureListener>(
+      FROM_HERE,
+      base::BindRepeating(&ServiceWorkerScriptMemoryCache::OnMemoryPressure,
+                          base::Unretained(this)));
+}
+
+ServiceWorkerScriptMemoryCache::~ServiceWorkerScriptMemoryCache() = default;
+
+bool ServiceWorkerScriptMemoryCache::GetResponseHead(
+    int64_t resource_id,
+    int* out_result,
+    network::mojom::URLResponseHeadPtr* out_response_head,
+    base::Optional<mojo_base::BigBuffer>* out_metadata) {
+  auto it = entries_.Get(resource_id);
+  if (it == entries_.end() || !it->second->response_head)
+    return false;
+
+  const Entry& entry = *it->second;
+  *out_result = entry.response_head_result;
+  *out_response_head = entry.response_head.Clone();
+  if (entry.metadata)
+    out_metadata->emplace(base::make_span(*entry.metadata));
+  else
+    out_metadata->reset();
+  return true;
+}
+
+scoped_refptr<base::RefCountedString> ServiceWorkerScriptMemoryCache::GetBody(
+    int64_t resource_id) {
+  auto it = entries_.Get(resource_id);
+  if (it == entries_.end())
+    return nullptr;
+  return it->second->body;
+}
+
+void ServiceWorkerScriptMemoryCache::PutResponseHead(
+    int64_t resource_id,
+    uint64_t generation,
+    int result,
+    const network::mojom::URLResponseHead& response_head,
+    const base::Optional<mojo_base::BigBuffer>& metadata) {
+  if (generation != generation_)
+    return;
+  if (metadata && metadata->size() > kMaxBodyBytes)
+    return;
+
+  DCHECK_GE(result, 0);
+  Entry* entry = GetOrCreateEntryForUpdate(resource_id);
+  entry->response_head_result = result;
+  entry->response_head = response_head.Clone();
+  if (metadata) {
+    entry->metadata.emplace(metadata->data(),
+                            metadata->data() + metadata->size());
+  } else {
+    entry->metadata.reset();
+  }
+  DidUpdateEntry(entry);
+}
+
+void ServiceWorkerScriptMemoryCache::PutBody(
+    int64_t resource_id,
+    uint64_t generation,
+    scoped_refptr<base::RefCountedString> body) {
+  DCHECK(body);
+  if (generation != generation_)
+    return;
+  if (body->size() > kMaxBodyBytes)
+    return;
+
+  Entry* entry = GetOrCreateEntryForUpdate(resource_id);
+  entry->body = std::move(body);
+  DidUpdateEntry(entry);
+}
+
+void ServiceWorkerScriptMemoryCache::Erase(int64_t resource_id) {
+  ++generation_;
+  auto it = entries_.Peek(resource_id);
+  if (it == entries_.end())
+    return;
+  total_bytes_ -= it->second->GetSize();
+  entries_.Erase(it);
+}
+
+void ServiceWorkerScriptMemoryCache::Clear() {
+  ++generation_;
+  entries_.Clear();
+  total_bytes_ = 0;
+}
+
+ServiceWorkerScriptMemoryCache::Entry*
+ServiceWorkerScriptMemoryCache::GetOrCreateEntryForUpdate(int64_t resource_id) {
+  auto it = entries_.Get(resource_id);
+  if (it == entries_.end())
+    it = entries_.Put(resource_id, std::make_unique<Entry>());
+  else
+    total_bytes_ -= it->second->GetSize();
+  return it->second.get();
+}
+
+void ServiceWorkerScriptMemoryCache::DidUpdateEntry(Entry* entry) {
+  total_bytes_ += entry->GetSize();
+  EvictIfNeeded();
+}
+
+void ServiceWorkerScriptMemoryCache::EvictIfNeeded() {
+  // The most recently updated entry is at the front, so it survives unless it
+  // alone exceeds the budget, which kMaxBodyBytes prevents.
+  while (total_bytes_ > kMaxTotalBytes && !entries_.empty()) {
+    auto oldest = entries_.rbegin();
+    total_bytes_ -= oldest->second->GetSize();
+    entries_.Erase(oldest);
+  }
+}
+
+void ServiceWorkerScriptMemoryCache::OnMemoryPressure(
+    base::MemoryPressureListener::MemoryPressureLevel level) {
+  if (level == base::MemoryPressureListener::MEMORY_PRESSURE_LEVEL_CRITICAL)
+    Clear();
+}
+
+}  // namespace content
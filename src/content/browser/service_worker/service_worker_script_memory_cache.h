@@ -0,0 +1,125 @@
+// Copyright 2020 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef CONTENT_BROWSER_SERVICE_WORKER_SERVICE_WORKER_SCRIPT_MEMORY_CACHE_H_
+#define CONTENT_BROWSER_SERVICE_WORKER_SERVICE_WORKER_SCRIPT_MEMORY_CACHE_H_
+
+#include <stdint.h>
+
+#include <memory>
+#include <vector>
+
+#include "base/containers/mru_cache.h"
+#include "base/feature_list.h"
+#include "base/memory/memory_pressure_listener.h"
+#include "base/memory/ref_counted_memory.h"
+#include "base/memory/weak_ptr.h"
+#include "base/optional.h"
+#include "content/common/content_export.h"
+#include "mojo/public/cpp/base/big_buffer.h"
+#include "services/network/public/mojom/url_response_head.mojom.h"
+
+namespace content {
+
+// Enables keeping recently read installed scripts in memory so that service
+// workers which are stopped and restarted frequently don't hit the disk cache
+// on every start.
+CONTENT_EXPORT extern const base::Feature kServiceWorkerScriptMemoryCache;
+
+// A bounded in-memory cache of installed service worker scripts, owned by
+// ServiceWorkerStorage and shared by all ServiceWorkerResourceReaderImpls it
+// creates. Entries are keyed by resource id. A resource id identifies one
+// script of one version and is never reused, so the only way an entry goes
+// stale is a metadata (V8 code cache) write or the resource being purged;
+// both call Erase().
+//
+// An entry holds the decoded response head with its metadata and, once a
+// reader has streamed the whole body from disk, the body itself. The two are
+// filled in independently because the installed scripts sender reads both
+// through one reader, while other callers may read only one of them.
+//
+// Readers populate the cache after an asynchronous disk read. To avoid
+// re-inserting data that was invalidated while the read was in flight, a
+// reader captures generation() before it starts reading and passes it back
+// to Put*(); the put is dropped if any Erase() happened in between.
+class CONTENT_EXPORT ServiceWorkerScriptMemoryCache {
+ public:
+  // Upper bound on the total bytes held by the cache.
+  static const size_t kMaxTotalBytes;
+  // Bodies and metadata larger than this are never cached.
+  static const size_t kMaxBodyBytes;
+
+  ServiceWorkerScriptMemoryCache();
+  ServiceWorkerScriptMemoryCache(const ServiceWorkerScriptMemoryCache&) =
+      delete;
+  ServiceWorkerScriptMemoryCache& operator=(
+      const ServiceWorkerScriptMemoryCache&) = delete;
+  ~ServiceWorkerScriptMemoryCache();
+
+  // Returns a copy of the cached response head and metadata for
+  // |resource_id|, along with the result ReadResponseHead() reported when
+  // they were read from disk. Returns false if the head is not cached.
+  bool GetResponseHead(int64_t resource_id,
+                       int* out_result,
+                       network::mojom::URLResponseHeadPtr* out_response_head,
+                       base::Optional<mojo_base::BigBuffer>* out_metadata);
+
+  // Returns the cached body of |resource_id|, or nullptr.
+  scoped_refptr<base::RefCountedString> GetBody(int64_t resource_id);
+
+  void PutResponseHead(int64_t resource_id,
+                       uint64_t generation,
+                       int result,
+                       const network::mojom::URLResponseHead& response_head,
+                       const base::Optional<mojo_base::BigBuffer>& metadata);
+  void PutBody(int64_t resource_id,
+               uint64_t generation,
+               scoped_refptr<base::RefCountedString> body);
+
+  void Erase(int64_t resource_id);
+  void Clear();
+
+  uint64_t generation() const { return generation_; }
+  size_t total_bytes() const { return total_bytes_; }
+
+  base::WeakPtr<ServiceWorkerScriptMemoryCache> GetWeakPtr() {
+    return weak_factory_.GetWeakPtr();
+  }
+
+ private:
+  struct Entry {
+    Entry();
+    ~Entry();
+
+    size_t GetSize() const;
+
+    int response_head_result = 0;
+    network::mojom::URLResponseHeadPtr response_head;
+    base::Optional<std::vector<uint8_t>> metadata;
+    scoped_refptr<base::RefCountedString> body;
+  };
+  using EntryMap = base::MRUCache<int64_t, std::unique_ptr<Entry>>;
+
+  // Returns the entry for |resource_id|, creating it if needed, and removes
+  // its current size from |total_bytes_|. The caller must call
+  // DidUpdateEntry() once it's done modifying the entry.
+  Entry* GetOrCreateEntryForUpdate(int64_t resource_id);
+  void DidUpdateEntry(Entry* entry);
+  void EvictIfNeeded();
+
+  void OnMemoryPressure(
+      base::MemoryPressureListener::MemoryPressureLevel level);
+
+  EntryMap entries_;
+  size_t total_bytes_ = 0;
+  uint64_t generation_ = 0;
+
+  std::unique_ptr<base::MemoryPressureListener> memory_pressure_listener_;
+
+  base::WeakPtrFactory<ServiceWorkerScriptMemoryCache> weak_factory_{this};
+};
+
+}  // namespace content
+
+#endif  // CONTENT_BROWSER_SERVICE_WORKER_SERVICE_WORKER_SCRIPT_MEMORY_CACHE_H_
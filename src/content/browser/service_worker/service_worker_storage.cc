@@ -10,6 +10,7 @@
 #include <utility>
 
 #include "base/bind_helpers.h"
+#include "base/feature_list.h"
 #include "base/files/file_util.h"
 #include "base/memory/ptr_util.h"
 #include "base/metrics/histogram_functions.h"
@@ -589,21 +590,32 @@ void ServiceWorkerStorage::PerformStorageCleanup(base::OnceClosure callback) {
 std::unique_ptr<ServiceWorkerResourceReaderImpl>
 ServiceWorkerStorage::CreateResourceReader(int64_t resource_id) {
   return std::make_unique<ServiceWorkerResourceReaderImpl>(
-      resource_id, disk_cache()->GetWeakPtr());
+      resource_id, disk_cache()->GetWeakPtr(), GetScriptMemoryCache());
 }
 
 std::unique_ptr<ServiceWorkerResponseWriter>
 ServiceWorkerStorage::CreateResponseWriter(int64_t resource_id) {
+  if (script_memory_cache_)
+    script_memory_cache_->Erase(resource_id);
   return base::WrapUnique(
       new ServiceWorkerResponseWriter(resource_id, disk_cache()->GetWeakPtr()));
 }
 
 std::unique_ptr<ServiceWorkerResponseMetadataWriter>
 ServiceWorkerStorage::CreateResponseMetadataWriter(int64_t resource_id) {
+  if (script_memory_cache_)
+    script_memory_cache_->Erase(resource_id);
   return base::WrapUnique(new ServiceWorkerResponseMetadataWriter(
       resource_id, disk_cache()->GetWeakPtr()));
 }
 
+base::WeakPtr<ServiceWorkerScriptMemoryCache>
+ServiceWorkerStorage::GetScriptMemoryCache() {
+  if (!script_memory_cache_)
+    return nullptr;
+  return script_memory_cache_->GetWeakPtr();
+}
+
 void ServiceWorkerStorage::StoreUncommittedResourceId(
     int64_t resource_id,
     const GURL& origin,
@@ -1062,6 +1074,8 @@ void ServiceWorkerStorage::Disable() {
   state_ = STORAGE_STATE_DISABLED;
   if (disk_cache_)
     disk_cache_->Disable();
+  if (script_memory_cache_)
+    script_memory_cache_->Clear();
 }
 
 void ServiceWorkerStorage::PurgeResources(const ResourceList& resources) {
@@ -1104,6 +1118,8 @@ ServiceWorkerStorage::ServiceWorkerStorage(
       is_purge_pending_(false),
       has_checked_for_stale_resources_(false) {
   database_.reset(new ServiceWorkerDatabase(GetDatabasePath()));
+  if (base::FeatureList::IsEnabled(kServiceWorkerScriptMemoryCache))
+    script_memory_cache_ = std::make_unique<ServiceWorkerScriptMemoryCache>();
 }
 
 base::FilePath ServiceWorkerStorage::GetDatabasePath() {
@@ -1335,16 +1351,22 @@ void ServiceWorkerStorage::OnDiskCacheInitialized(int rv) {
 void ServiceWorkerStorage::StartPurgingResources(
     const std::vector<int64_t>& resource_ids) {
   DCHECK(has_checked_for_stale_resources_);
-  for (int64_t resource_id : resource_ids)
+  for (int64_t resource_id : resource_ids) {
     purgeable_resource_ids_.push_back(resource_id);
+    if (script_memory_cache_)
+      script_memory_cache_->Erase(resource_id);
+  }
   ContinuePurgingResources();
 }
 
 void ServiceWorkerStorage::StartPurgingResources(
     const ResourceList& resources) {
   DCHECK(has_checked_for_stale_resources_);
-  for (const auto& resource : resources)
+  for (const auto& resource : resources) {
     purgeable_resource_ids_.push_back(resource->resource_id);
+    if (script_memory_cache_)
+      script_memory_cache_->Erase(resource->resource_id);
+  }
   ContinuePurgingResources();
 }
 
@@ -25,6 +25,7 @@
 #include "components/services/storage/public/mojom/service_worker_storage_control.mojom.h"
 #include "content/browser/service_worker/service_worker_database.h"
 #include "content/browser/service_worker/service_worker_resource_ops.h"
+#include "content/browser/service_worker/service_worker_script_memory_cache.h"
 #include "content/common/content_export.h"
 #include "url/gurl.h"
 
@@ -196,6 +197,10 @@ class CONTENT_EXPORT ServiceWorkerStorage {
   std::unique_ptr<ServiceWorkerResponseMetadataWriter>
   CreateResponseMetadataWriter(int64_t resource_id);
 
+  // Returns the in-memory cache of installed scripts shared by resource
+  // readers. Null unless kServiceWorkerScriptMemoryCache is enabled.
+  base::WeakPtr<ServiceWorkerScriptMemoryCache> GetScriptMemoryCache();
+
   // Adds |resource_id| to the set of resources that are in the disk cache
   // but not yet stored with a registration.
   void StoreUncommittedResourceId(int64_t resource_id,
@@ -552,6 +557,7 @@ class CONTENT_EXPORT ServiceWorkerStorage {
   scoped_refptr<storage::QuotaManagerProxy> quota_manager_proxy_;
 
   std::unique_ptr<ServiceWorkerDiskCache> disk_cache_;
+  std::unique_ptr<ServiceWorkerScriptMemoryCache> script_memory_cache_;
 
   base::circular_deque<int64_t> purgeable_resource_ids_;
   bool is_purge_pending_;
@@ -274,7 +274,8 @@ void ServiceWorkerStorageControlImpl::CreateResourceMetadataWriter(
   DCHECK_NE(resource_id, blink::mojom::kInvalidServiceWorkerResourceId);
   mojo::MakeSelfOwnedReceiver(
       std::make_unique<ServiceWorkerResourceMetadataWriterImpl>(
-          storage_->CreateResponseMetadataWriter(resource_id)),
+          resource_id, storage_->CreateResponseMetadataWriter(resource_id),
+          storage_->GetScriptMemoryCache()),
       std::move(writer));
 }
 
@@ -17,6 +17,7 @@
 #include "base/stl_util.h"
 #include "base/test/bind_test_util.h"
 #include "base/test/metrics/histogram_tester.h"
+#include "base/test/scoped_feature_list.h"
 #include "base/threading/thread_task_runner_handle.h"
 #include "build/build_config.h"
 #include "content/browser/service_worker/embedded_worker_test_helper.h"
@@ -185,6 +186,29 @@ ReadResponseHeadResult ReadResponseHead(
   return out;
 }
 
+std::string ReadResponseBody(
+    mojo::Remote<storage::mojom::ServiceWorkerStorageControl>& storage,
+    int64_t id) {
+  mojo::Remote<storage::mojom::ServiceWorkerResourceReader> reader;
+  storage->CreateResourceReader(id, reader.BindNewPipeAndPassReceiver());
+
+  const int kBigEnough = 512;
+  MockServiceWorkerDataPipeStateNotifier notifier;
+  mojo::ScopedDataPipeConsumerHandle data_consumer;
+  base::RunLoop loop;
+  reader->ReadData(
+      kBigEnough, notifier.BindNewPipeAndPassRemote(),
+      base::BindLambdaForTesting([&](mojo::ScopedDataPipeConsumerHandle pipe) {
+        data_consumer = std::move(pipe);
+        loop.Quit();
+      }));
+  loop.Run();
+
+  std::string body = ReadDataPipe(std::move(data_consumer));
+  EXPECT_EQ(static_cast<int>(body.size()), notifier.WaitUntilComplete());
+  return body;
+}
+
 bool VerifyBasicResponse(
     mojo::Remote<storage::mojom::ServiceWorkerStorageControl>& storage,
     int64_t id,
@@ -1540,6 +1564,87 @@ TEST_F(ServiceWorkerResourceStorageTest, DeleteRegistration_ActiveVersion) {
   EXPECT_FALSE(VerifyBasicResponse(storage_control(), resource_id2_, false));
 }
 
+class ServiceWorkerResourceStorageMemoryCacheTest
+    : public ServiceWorkerResourceStorageTest {
+ public:
+  ServiceWorkerResourceStorageMemoryCacheTest() {
+    feature_list_.InitAndEnableFeature(kServiceWorkerScriptMemoryCache);
+  }
+
+  ServiceWorkerScriptMemoryCache* memory_cache() {
+    return storage()->GetScriptMemoryCache().get();
+  }
+
+ private:
+  base::test::ScopedFeatureList feature_list_;
+};
+
+TEST_F(ServiceWorkerResourceStorageMemoryCacheTest, ServeFromMemory) {
+  ASSERT_TRUE(memory_cache());
+
+  // SetUp() read both resources from disk, which populated the cache.
+  scoped_refptr<base::RefCountedString> body =
+      memory_cache()->GetBody(resource_id1_);
+  ASSERT_TRUE(body);
+  EXPECT_EQ("Hello", body->data());
+  EXPECT_TRUE(memory_cache()->GetBody(resource_id2_));
+  EXPECT_LT(0u, memory_cache()->total_bytes());
+
+  // Replace the cached body. Readers must serve it instead of the disk cache
+  // entry.
+  std::string replacement("World");
+  memory_cache()->PutBody(resource_id1_, memory_cache()->generation(),
+                          base::RefCountedString::TakeString(&replacement));
+  EXPECT_EQ("World", ReadResponseBody(storage_control(), resource_id1_));
+
+  ReadResponseHeadResult out =
+      ReadResponseHead(storage_control(), resource_id1_);
+  EXPECT_LT(0, out.result);
+  ASSERT_TRUE(out.response_head);
+  EXPECT_EQ("HONKYDORY", out.response_head->headers->GetStatusText());
+}
+
+TEST_F(ServiceWorkerResourceStorageMemoryCacheTest, InvalidateOnMetadataWrite) {
+  const char kMetadata1[] = "Test metadata";
+  const char kMetadata2[] = "small";
+
+  EXPECT_EQ(
+      static_cast<int>(strlen(kMetadata1)),
+      WriteResponseMetadata(storage_control(), resource_id1_, kMetadata1));
+  EXPECT_FALSE(memory_cache()->GetBody(resource_id1_));
+  EXPECT_TRUE(
+      VerifyResponseMetadata(storage_control(), resource_id1_, kMetadata1));
+
+  // The head is cached again along with the new metadata. Writing metadata
+  // must drop it so that the next read doesn't see |kMetadata1|.
+  EXPECT_EQ(
+      static_cast<int>(strlen(kMetadata2)),
+      WriteResponseMetadata(storage_control(), resource_id1_, kMetadata2));
+  ReadResponseHeadResult out =
+      ReadResponseHead(storage_control(), resource_id1_);
+  ASSERT_TRUE(out.metadata.has_value());
+  EXPECT_EQ(std::string(kMetadata2),
+            std::string(out.metadata->data(),
+                        out.metadata->data() + out.metadata->size()));
+  EXPECT_TRUE(VerifyBasicResponse(storage_control(), resource_id1_, true));
+}
+
+TEST_F(ServiceWorkerResourceStorageMemoryCacheTest, InvalidateOnPurge) {
+  ASSERT_TRUE(memory_cache()->GetBody(resource_id1_));
+
+  base::RunLoop loop;
+  storage()->SetPurgingCompleteCallbackForTest(loop.QuitClosure());
+  EXPECT_EQ(blink::ServiceWorkerStatusCode::kOk,
+            DeleteRegistration(registration_, scope_.GetOrigin()));
+  registration_->SetWaitingVersion(nullptr);
+  loop.Run();
+
+  EXPECT_FALSE(memory_cache()->GetBody(resource_id1_));
+  EXPECT_FALSE(memory_cache()->GetBody(resource_id2_));
+  EXPECT_FALSE(VerifyBasicResponse(storage_control(), resource_id1_, false));
+  EXPECT_FALSE(VerifyBasicResponse(storage_control(), resource_id2_, false));
+}
+
 TEST_F(ServiceWorkerResourceStorageDiskTest, CleanupOnRestart) {
   // Promote the worker to active and add a controllee.
   registration_->SetActiveVersion(registration_->waiting_version());
@@ -246,6 +246,14 @@ void ZygoteCommunication::Init(
   };
   cmd_line.CopySwitchesFrom(browser_command_line, kForwardSwitches,
                             base::size(kForwardSwitches));
+  // Only the sandboxed zygote launches renderers.
+  if (type_ == ZygoteType::kSandboxed) {
+    static const char* const kSandboxedForwardSwitches[] = {
+        switches::kZygotePrespawnedRenderers,
+    };
+    cmd_line.CopySwitchesFrom(browser_command_line, kSandboxedForwardSwitches,
+                              base::size(kSandboxedForwardSwitches));
+  }
 
   pid_ = std::move(launcher).Run(&cmd_line, &control_fd_);
 
@@ -36,6 +36,7 @@ class GURL;
 
 namespace base {
 class FilePath;
+class Time;
 }  // namespace base
 
 namespace download {
@@ -169,6 +170,21 @@ class CONTENT_EXPORT BrowserContext : public base::SupportsUserData {
                                      const std::string& content_type,
                                      BlobCallback callback);
 
+  // Like CreateMemoryBackedBlob(), but the blob refers to |length| bytes of
+  // the file at |path| starting at |offset| instead of holding a copy of
+  // them. The bytes are read from the file only when the blob is read, and
+  // slices of the blob refer to the same file range, so this is the cheaper
+  // choice for large payloads that already live on disk. Reads fail if the
+  // file's modification time no longer matches |expected_modification_time|,
+  // unless it is null. |callback| returns a nullptr on failure.
+  static void CreateFileBackedBlob(BrowserContext* browser_context,
+                                   const base::FilePath& path,
+                                   uint64_t offset,
+                                   uint64_t length,
+                                   const base::Time& expected_modification_time,
+                                   const std::string& content_type,
+                                   BlobCallback callback);
+
   // Get a BlobStorageContext getter that needs to run on IO thread.
   static BlobContextGetter GetBlobStorageContext(
       BrowserContext* browser_context);
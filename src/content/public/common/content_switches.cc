@@ -834,6 +834,11 @@ const char kWebglMSAASampleCount[] = "webgl-msaa-sample-count";
 // The prefix used when starting the zygote process. (i.e. 'gdb --args')
 const char kZygoteCmdPrefix[] = "zygote-cmd-prefix";
 
+// Number of renderer processes the zygote keeps forked ahead of time so that
+// renderer launches don't have to wait for fork() and PID namespace setup.
+// The pool is not refilled while the system is low on memory.
+const char kZygotePrespawnedRenderers[] = "zygote-prespawned-renderers";
+
 // Causes the process to run as a zygote.
 const char kZygoteProcess[] = "zygote";
 
@@ -227,6 +227,7 @@ CONTENT_EXPORT extern const char kWaitForDebuggerChildren[];
 CONTENT_EXPORT extern const char kWebglAntialiasingMode[];
 CONTENT_EXPORT extern const char kWebglMSAASampleCount[];
 CONTENT_EXPORT extern const char kZygoteCmdPrefix[];
+CONTENT_EXPORT extern const char kZygotePrespawnedRenderers[];
 CONTENT_EXPORT extern const char kZygoteProcess[];
 
 CONTENT_EXPORT extern const char kWebOtpBackend[];
@@ -11,9 +11,12 @@
 #include <stdint.h>
 #include <string.h>
 #include <sys/socket.h>
+#include <sys/sysinfo.h>
 #include <sys/types.h>
 #include <sys/wait.h>
+#include <unistd.h>
 
+#include <algorithm>
 #include <utility>
 
 #include "base/command_line.h"
@@ -29,6 +32,9 @@
 #include "base/process/launch.h"
 #include "base/process/process.h"
 #include "base/process/process_handle.h"
+#include "base/process/process_metrics.h"
+#include "base/strings/string_number_conversions.h"
+#include "base/strings/string_piece.h"
 #include "base/time/time.h"
 #include "base/trace_event/trace_event.h"
 #include "build/build_config.h"
@@ -57,6 +63,14 @@ namespace content {
 
 namespace {
 
+// Upper bound for --zygote-prespawned-renderers.
+constexpr size_t kMaxPrespawnedChildren = 4;
+
+// Prespawned children are not kept while less memory than this is available,
+// since each one pins a PID namespace, page tables and any zygote page the
+// zygote writes to afterwards.
+constexpr uint64_t kMinAvailableMemoryForPrespawnMB = 512;
+
 // NOP function. See below where this handler is installed.
 void SIGCHLDHandler(int signal) {}
 
@@ -85,18 +99,123 @@ void KillAndReap(pid_t pid, ZygoteForkDelegate* helper) {
   PCHECK(pid == HANDLE_EINTR(waitpid(pid, nullptr, 0)));
 }
 
+// Returns the memory available for new processes, i.e. MemAvailable from
+// /proc/meminfo, which counts the reclaimable page cache. |meminfo_fd| is
+// /proc/meminfo opened before the sandbox was entered, since /proc is not
+// reachable from inside it.
+uint64_t GetAvailableMemoryMB(int meminfo_fd) {
+  if (meminfo_fd >= 0) {
+    char buf[8192];
+    const ssize_t len =
+        HANDLE_EINTR(pread(meminfo_fd, buf, sizeof(buf), /*offset=*/0));
+    base::SystemMemoryInfoKB meminfo;
+    if (len > 0 &&
+        base::ParseProcMeminfo(base::StringPiece(buf, len), &meminfo)) {
+      // Kernels before 3.14 don't report MemAvailable.
+      const int available_kb =
+          meminfo.available ? meminfo.available
+                            : meminfo.free + meminfo.buffers + meminfo.cached;
+      return static_cast<uint64_t>(available_kb) / 1024;
+    }
+  }
+
+  // sysinfo(2) leaves out the page cache, so this undercounts and keeps the
+  // pool small unless plenty of memory is free.
+  struct sysinfo info;
+  if (sysinfo(&info) != 0)
+    return 0;
+  return (static_cast<uint64_t>(info.freeram) + info.bufferram) *
+         info.mem_unit / (1024 * 1024);
+}
+
+// If the process is the init process inside a PID namespace, it must have
+// explicit signal handlers.
+void InstallInitProcessSignalHandlers() {
+  if (getpid() != 1)
+    return;
+  static const int kTerminationSignals[] = {
+      SIGINT, SIGTERM, SIGHUP, SIGQUIT, SIGABRT, SIGPIPE, SIGUSR1, SIGUSR2};
+  for (const int sig : kTerminationSignals) {
+    sandbox::NamespaceSandbox::InstallTerminationSignalHandler(
+        sig, sandbox::NamespaceSandbox::SignalExitCode(sig));
+  }
+}
+
+// Runs in a new child process. Pings the PID oracle socket so the browser can
+// find our PID, then reads back our real PID from the zygote on |real_pid_fd|.
+void ReceiveRealPidInChild(int pid_oracle, int real_pid_fd) {
+  CHECK(SendZygoteChildPing(pid_oracle));
+
+  base::ProcessId real_pid;
+  if (!base::ReadFromFD(real_pid_fd, reinterpret_cast<char*>(&real_pid),
+                        sizeof(real_pid))) {
+    LOG(FATAL) << "Failed to synchronise with parent zygote process";
+  }
+  if (real_pid <= 0) {
+    LOG(FATAL) << "Invalid pid from parent zygote";
+  }
+  // Sandboxed processes need to send the global, non-namespaced PID when
+  // setting up an IPC channel to their parent.
+  IPC::Channel::SetGlobalPid(real_pid);
+  // Force the real PID so chrome event data have a PID that corresponds
+  // to system trace event data.
+  base::trace_event::TraceLog::GetInstance()->SetProcessID(
+      static_cast<int>(real_pid));
+  base::InitUniqueIdForProcessInPidNamespace(real_pid);
+#if defined(USE_LTTNG)
+  content::neva::LttngInit();
+#endif
+}
+
+// Sets up the state of a new child process for its fork request, taking
+// ownership of |fds|.
+void SetUpChildProcess(std::vector<base::ScopedFD> fds,
+                       const base::GlobalDescriptors::Mapping& mapping,
+                       const std::vector<std::string>& args) {
+  // Pass ownership of file descriptors from fds to GlobalDescriptors.
+  for (base::ScopedFD& fd : fds)
+    ignore_result(fd.release());
+  base::GlobalDescriptors::GetInstance()->Reset(mapping);
+
+  // Reset the process-wide command line to our new command line.
+  base::CommandLine::Reset();
+  base::CommandLine::Init(0, nullptr);
+  base::CommandLine::ForCurrentProcess()->InitFromArgv(args);
+
+  // Update the process title. The argv was already cached by the call to
+  // SetProcessTitleFromCommandLine in ChromeMain, so we can pass NULL here
+  // (we don't have the original argv at this point).
+  SetProcessTitleFromCommandLine(nullptr);
+}
+
 }  // namespace
 
+Zygote::PrespawnedChild::PrespawnedChild(base::ProcessHandle internal_pid,
+                                         base::ScopedFD channel)
+    : internal_pid(internal_pid), channel(std::move(channel)) {}
+
+Zygote::PrespawnedChild::PrespawnedChild(PrespawnedChild&& other) = default;
+
+Zygote::PrespawnedChild& Zygote::PrespawnedChild::operator=(
+    PrespawnedChild&& other) = default;
+
+Zygote::PrespawnedChild::~PrespawnedChild() = default;
+
 Zygote::Zygote(int sandbox_flags,
                std::vector<std::unique_ptr<ZygoteForkDelegate>> helpers,
-               const base::GlobalDescriptors::Descriptor& ipc_backchannel)
+               const base::GlobalDescriptors::Descriptor& ipc_backchannel,
+               base::ScopedFD meminfo_fd)
     : sandbox_flags_(sandbox_flags),
       helpers_(std::move(helpers)),
       initial_uma_index_(0),
       to_reap_(),
-      ipc_backchannel_(ipc_backchannel) {}
+      ipc_backchannel_(ipc_backchannel),
+      meminfo_fd_(std::move(meminfo_fd)) {}
 
-Zygote::~Zygote() {}
+Zygote::~Zygote() {
+  for (const PrespawnedChild& child : prespawned_children_)
+    KillAndReap(child.internal_pid, nullptr);
+}
 
 bool Zygote::ProcessRequests() {
   // A SOCK_SEQPACKET socket is installed in fd 3. We get commands from the
@@ -149,6 +268,13 @@ bool Zygote::ProcessRequests() {
   timeout.tv_nsec = 0;
 
   for (;;) {
+    // This function call can return multiple times, once per prespawned child
+    // that receives a fork request.
+    if (MaintainPrespawnedChildren()) {
+      PCHECK(sigprocmask(SIG_SETMASK, &orig_sigmask, nullptr) == 0);
+      return true;
+    }
+
     struct timespec* timeout_ptr = nullptr;
     if (!to_reap_.empty())
       timeout_ptr = &timeout;
@@ -253,7 +379,7 @@ bool Zygote::HandleRequestFromBrowser(int fd) {
     switch (kind) {
       case kZygoteCommandFork:
         // This function call can return multiple times, once per fork().
-        return HandleForkRequest(fd, iter, std::move(fds));
+        return HandleForkRequest(fd, pickle, iter, std::move(fds));
 
       case kZygoteCommandReap:
         if (!fds.empty())
@@ -393,6 +519,68 @@ void Zygote::HandleGetTerminationStatus(int fd, base::PickleIterator iter) {
     PLOG(ERROR) << "write";
 }
 
+base::ProcessId Zygote::ForkChild() {
+  if (sandbox_flags_ & sandbox::policy::SandboxLinux::kPIDNS &&
+      sandbox_flags_ & sandbox::policy::SandboxLinux::kUserNS) {
+    return sandbox::NamespaceSandbox::ForkInNewPidNamespace(
+        /*drop_capabilities_in_child=*/true);
+  }
+  return sandbox::Credentials::ForkAndDropCapabilitiesInChild();
+}
+
+base::ProcessId Zygote::ReceiveRealPidAndTrackChild(base::ProcessId pid,
+                                                    ZygoteForkDelegate* helper,
+                                                    int real_pid_fd) {
+  // Always receive a real PID from the zygote host, though it might
+  // be invalid (see below).
+  base::ProcessId real_pid = -1;
+  {
+    std::vector<base::ScopedFD> recv_fds;
+    char buf[kZygoteMaxMessageLength];
+    const ssize_t len = base::UnixDomainSocket::RecvMsg(
+        kZygoteSocketPairFd, buf, sizeof(buf), &recv_fds);
+
+    if (len > 0) {
+      CHECK(recv_fds.empty());
+
+      base::Pickle pickle(buf, len);
+      base::PickleIterator iter(pickle);
+
+      int kind;
+      CHECK(iter.ReadInt(&kind));
+      CHECK(kind == kZygoteCommandForkRealPID);
+      CHECK(iter.ReadInt(&real_pid));
+    }
+  }
+
+  // If we successfully forked a child, but it crashed without sending
+  // a message to the browser, the browser won't have found its PID.
+  if (real_pid < 0) {
+    KillAndReap(pid, helper);
+    return -1;
+  }
+
+  // If we're not using a helper, send the PID back to the child process.
+  if (!helper) {
+    ssize_t written =
+        HANDLE_EINTR(write(real_pid_fd, &real_pid, sizeof(real_pid)));
+    if (written != sizeof(real_pid)) {
+      KillAndReap(pid, helper);
+      return -1;
+    }
+  }
+
+  // Now set-up this process to be tracked by the Zygote.
+  if (process_info_map_.find(real_pid) != process_info_map_.end()) {
+    LOG(ERROR) << "Already tracking PID " << real_pid;
+    NOTREACHED();
+  }
+  process_info_map_[real_pid].internal_pid = pid;
+  process_info_map_[real_pid].started_from_helper = helper;
+
+  return real_pid;
+}
+
 int Zygote::ForkWithRealPid(const std::string& process_type,
                             const base::GlobalDescriptors::Mapping& fd_mapping,
                             base::ScopedFD pid_oracle,
@@ -424,54 +612,19 @@ int Zygote::ForkWithRealPid(const std::string& process_type,
     CHECK_NE(pid, 0);
   } else {
     PCHECK(base::CreatePipe(&read_pipe, &write_pipe));
-    if (sandbox_flags_ & sandbox::policy::SandboxLinux::kPIDNS &&
-        sandbox_flags_ & sandbox::policy::SandboxLinux::kUserNS) {
-      pid = sandbox::NamespaceSandbox::ForkInNewPidNamespace(
-          /*drop_capabilities_in_child=*/true);
-    } else {
-      pid = sandbox::Credentials::ForkAndDropCapabilitiesInChild();
-    }
+    pid = ForkChild();
   }
 
   if (pid == 0) {
     // In the child process.
 
-    // If the process is the init process inside a PID namespace, it must have
-    // explicit signal handlers.
-    if (getpid() == 1) {
-      static const int kTerminationSignals[] = {
-          SIGINT, SIGTERM, SIGHUP, SIGQUIT, SIGABRT, SIGPIPE, SIGUSR1, SIGUSR2};
-      for (const int sig : kTerminationSignals) {
-        sandbox::NamespaceSandbox::InstallTerminationSignalHandler(
-            sig, sandbox::NamespaceSandbox::SignalExitCode(sig));
-      }
-    }
+    // The channels to prespawned children belong to the zygote.
+    prespawned_children_.clear();
+    meminfo_fd_.reset();
+    InstallInitProcessSignalHandlers();
 
     write_pipe.reset();
-
-    // Ping the PID oracle socket so the browser can find our PID.
-    CHECK(SendZygoteChildPing(pid_oracle.get()));
-
-    // Now read back our real PID from the zygote.
-    base::ProcessId real_pid;
-    if (!base::ReadFromFD(read_pipe.get(), reinterpret_cast<char*>(&real_pid),
-                          sizeof(real_pid))) {
-      LOG(FATAL) << "Failed to synchronise with parent zygote process";
-    }
-    if (real_pid <= 0) {
-      LOG(FATAL) << "Invalid pid from parent zygote";
-    }
-    // Sandboxed processes need to send the global, non-namespaced PID when
-    // setting up an IPC channel to their parent.
-    IPC::Channel::SetGlobalPid(real_pid);
-    // Force the real PID so chrome event data have a PID that corresponds
-    // to system trace event data.
-    base::trace_event::TraceLog::GetInstance()->SetProcessID(
-        static_cast<int>(real_pid));
-    base::InitUniqueIdForProcessInPidNamespace(real_pid);
-#if defined(USE_LTTNG)
-    content::neva::LttngInit();
-#endif
+    ReceiveRealPidInChild(pid_oracle.get(), read_pipe.get());
     return 0;
   }
 
@@ -484,77 +637,27 @@ int Zygote::ForkWithRealPid(const std::string& process_type,
   read_pipe.reset();
   pid_oracle.reset();
 
-  // Always receive a real PID from the zygote host, though it might
-  // be invalid (see below).
-  base::ProcessId real_pid = -1;
-  {
-    std::vector<base::ScopedFD> recv_fds;
-    char buf[kZygoteMaxMessageLength];
-    const ssize_t len = base::UnixDomainSocket::RecvMsg(
-        kZygoteSocketPairFd, buf, sizeof(buf), &recv_fds);
-
-    if (len > 0) {
-      CHECK(recv_fds.empty());
-
-      base::Pickle pickle(buf, len);
-      base::PickleIterator iter(pickle);
-
-      int kind;
-      CHECK(iter.ReadInt(&kind));
-      CHECK(kind == kZygoteCommandForkRealPID);
-      CHECK(iter.ReadInt(&real_pid));
-    }
-  }
-
-  // If we successfully forked a child, but it crashed without sending
-  // a message to the browser, the browser won't have found its PID.
-  if (real_pid < 0) {
-    KillAndReap(pid, helper);
-    return -1;
-  }
-
-  // If we're not using a helper, send the PID back to the child process.
-  if (!helper) {
-    ssize_t written =
-        HANDLE_EINTR(write(write_pipe.get(), &real_pid, sizeof(real_pid)));
-    if (written != sizeof(real_pid)) {
-      KillAndReap(pid, helper);
-      return -1;
-    }
-  }
-
-  // Now set-up this process to be tracked by the Zygote.
-  if (process_info_map_.find(real_pid) != process_info_map_.end()) {
-    LOG(ERROR) << "Already tracking PID " << real_pid;
-    NOTREACHED();
-  }
-  process_info_map_[real_pid].internal_pid = pid;
-  process_info_map_[real_pid].started_from_helper = helper;
-
-  return real_pid;
+  return ReceiveRealPidAndTrackChild(pid, helper, write_pipe.get());
 }
 
-base::ProcessId Zygote::ReadArgsAndFork(base::PickleIterator iter,
-                                        std::vector<base::ScopedFD> fds,
-                                        std::string* uma_name,
-                                        int* uma_sample,
-                                        int* uma_boundary_value) {
-  std::vector<std::string> args;
+bool Zygote::ReadArgs(base::PickleIterator iter,
+                      const std::vector<base::ScopedFD>& fds,
+                      std::string* process_type,
+                      std::vector<std::string>* args,
+                      base::GlobalDescriptors::Mapping* mapping) {
   int argc = 0;
   int numfds = 0;
-  base::GlobalDescriptors::Mapping mapping;
-  std::string process_type;
 
-  if (!iter.ReadString(&process_type))
-    return -1;
+  if (!iter.ReadString(process_type))
+    return false;
   if (!iter.ReadInt(&argc))
-    return -1;
+    return false;
 
   for (int i = 0; i < argc; ++i) {
     std::string arg;
     if (!iter.ReadString(&arg))
-      return -1;
-    args.push_back(arg);
+      return false;
+    args->push_back(arg);
   }
 
   // timezone_id is obtained from ICU in zygote host so that it can't be
@@ -562,69 +665,77 @@ base::ProcessId Zygote::ReadArgsAndFork(base::PickleIterator iter,
   // worst result would be that timezone would be set to Etc/Unknown.
   base::string16 timezone_id;
   if (!iter.ReadString16(&timezone_id))
-    return -1;
+    return false;
   icu::TimeZone::adoptDefault(icu::TimeZone::createTimeZone(
       icu::UnicodeString(FALSE, timezone_id.data(), timezone_id.length())));
 
   if (!iter.ReadInt(&numfds))
-    return -1;
+    return false;
   if (numfds != static_cast<int>(fds.size()))
-    return -1;
+    return false;
 
   // First FD is the PID oracle socket.
   if (fds.size() < 1)
-    return -1;
-  base::ScopedFD pid_oracle(std::move(fds[0]));
+    return false;
 
   // Remaining FDs are for the global descriptor mapping.
   for (int i = 1; i < numfds; ++i) {
     base::GlobalDescriptors::Key key;
     if (!iter.ReadUInt32(&key))
-      return -1;
-    mapping.push_back(base::GlobalDescriptors::Descriptor(key, fds[i].get()));
+      return false;
+    mapping->push_back(base::GlobalDescriptors::Descriptor(key, fds[i].get()));
   }
 
-  mapping.push_back(ipc_backchannel_);
+  mapping->push_back(ipc_backchannel_);
+  return true;
+}
+
+base::ProcessId Zygote::ReadArgsAndFork(const base::Pickle& request,
+                                        base::PickleIterator iter,
+                                        std::vector<base::ScopedFD> fds,
+                                        std::string* uma_name,
+                                        int* uma_sample,
+                                        int* uma_boundary_value) {
+  std::vector<std::string> args;
+  base::GlobalDescriptors::Mapping mapping;
+  std::string process_type;
+
+  if (!ReadArgs(iter, fds, &process_type, &args, &mapping))
+    return -1;
+
+  base::ProcessId child_pid;
+  if (process_type == switches::kRendererProcess &&
+      ForkFromPrespawnedChild(request, fds, &child_pid)) {
+    return child_pid;
+  }
 
   // Returns twice, once per process.
-  base::ProcessId child_pid =
-      ForkWithRealPid(process_type, mapping, std::move(pid_oracle), uma_name,
-                      uma_sample, uma_boundary_value);
+  child_pid = ForkWithRealPid(process_type, mapping, std::move(fds[0]),
+                              uma_name, uma_sample, uma_boundary_value);
   if (!child_pid) {
     // This is the child process.
 
     // Our socket from the browser.
     PCHECK(0 == IGNORE_EINTR(close(kZygoteSocketPairFd)));
 
-    // Pass ownership of file descriptors from fds to GlobalDescriptors.
-    for (base::ScopedFD& fd : fds)
-      ignore_result(fd.release());
-    base::GlobalDescriptors::GetInstance()->Reset(mapping);
-
-    // Reset the process-wide command line to our new command line.
-    base::CommandLine::Reset();
-    base::CommandLine::Init(0, nullptr);
-    base::CommandLine::ForCurrentProcess()->InitFromArgv(args);
-
-    // Update the process title. The argv was already cached by the call to
-    // SetProcessTitleFromCommandLine in ChromeMain, so we can pass NULL here
-    // (we don't have the original argv at this point).
-    SetProcessTitleFromCommandLine(nullptr);
+    SetUpChildProcess(std::move(fds), mapping, args);
   } else if (child_pid < 0) {
     LOG(ERROR) << "Zygote could not fork: process_type " << process_type
-               << " numfds " << numfds << " child_pid " << child_pid;
+               << " numfds " << fds.size() << " child_pid " << child_pid;
   }
   return child_pid;
 }
 
 bool Zygote::HandleForkRequest(int fd,
+                               const base::Pickle& request,
                                base::PickleIterator iter,
                                std::vector<base::ScopedFD> fds) {
   std::string uma_name;
   int uma_sample;
   int uma_boundary_value;
-  base::ProcessId child_pid = ReadArgsAndFork(iter, std::move(fds), &uma_name,
-                                              &uma_sample, &uma_boundary_value);
+  base::ProcessId child_pid =
+      ReadArgsAndFork(request, iter, std::move(fds), &uma_name, &uma_sample,
+                      &uma_boundary_value);
   if (child_pid == 0)
     return true;
   // If there's no UMA report for this particular fork, then check if any
@@ -656,4 +767,108 @@ bool Zygote::HandleGetSandboxStatus(int fd, base::PickleIterator iter) {
   return false;
 }
 
+size_t Zygote::GetPrespawnedChildTarget() const {
+  unsigned count = 0;
+  if (!base::StringToUint(
+          base::CommandLine::ForCurrentProcess()->GetSwitchValueASCII(
+              switches::kZygotePrespawnedRenderers),
+          &count) ||
+      count == 0) {
+    return 0;
+  }
+  if (GetAvailableMemoryMB(meminfo_fd_.get()) <
+      kMinAvailableMemoryForPrespawnMB) {
+    return 0;
+  }
+  return std::min<size_t>(count, kMaxPrespawnedChildren);
+}
+
+bool Zygote::MaintainPrespawnedChildren() {
+  const size_t target = GetPrespawnedChildTarget();
+  while (prespawned_children_.size() > target) {
+    KillAndReap(prespawned_children_.back().internal_pid, nullptr);
+    prespawned_children_.pop_back();
+  }
+
+  while (prespawned_children_.size() < target) {
+    base::ScopedFD parent_channel, child_channel;
+    if (!base::CreateSocketPair(&parent_channel, &child_channel))
+      return false;
+
+    base::ProcessId pid = ForkChild();
+    if (pid == 0) {
+      parent_channel.reset();
+      WaitForForkRequestInPrespawnedChild(std::move(child_channel));
+      return true;
+    }
+    if (pid < 0) {
+      DPLOG(ERROR) << "Failed to prespawn a child";
+      return false;
+    }
+    prespawned_children_.emplace_back(pid, std::move(parent_channel));
+  }
+  return false;
+}
+
+void Zygote::WaitForForkRequestInPrespawnedChild(base::ScopedFD channel) {
+  // The channels to the other prespawned children and the socket from the
+  // browser belong to the zygote.
+  prespawned_children_.clear();
+  meminfo_fd_.reset();
+  PCHECK(0 == IGNORE_EINTR(close(kZygoteSocketPairFd)));
+  InstallInitProcessSignalHandlers();
+
+  std::vector<base::ScopedFD> fds;
+  char buf[kZygoteMaxMessageLength];
+  const ssize_t len =
+      base::UnixDomainSocket::RecvMsg(channel.get(), buf, sizeof(buf), &fds);
+  // The zygote closes the channel when it no longer needs this child or has
+  // exited itself.
+  if (len <= 0)
+    _exit(0);
+
+  // The zygote has already validated the request before forwarding it.
+  base::Pickle pickle(buf, len);
+  base::PickleIterator iter(pickle);
+  int kind;
+  CHECK(iter.ReadInt(&kind));
+  CHECK_EQ(kZygoteCommandFork, kind);
+
+  std::vector<std::string> args;
+  base::GlobalDescriptors::Mapping mapping;
+  std::string process_type;
+  CHECK(ReadArgs(iter, fds, &process_type, &args, &mapping));
+
+  ReceiveRealPidInChild(fds[0].get(), channel.get());
+  fds[0].reset();
+
+  SetUpChildProcess(std::move(fds), mapping, args);
+}
+
+bool Zygote::ForkFromPrespawnedChild(const base::Pickle& request,
+                                     const std::vector<base::ScopedFD>& fds,
+                                     base::ProcessId* child_pid) {
+  std::vector<int> raw_fds;
+  for (const base::ScopedFD& fd : fds)
+    raw_fds.push_back(fd.get());
+
+  while (!prespawned_children_.empty()) {
+    PrespawnedChild child = std::move(prespawned_children_.back());
+    prespawned_children_.pop_back();
+
+    if (!base::UnixDomainSocket::SendMsg(child.channel.get(), request.data(),
+                                         request.size(), raw_fds)) {
+      // The child died while waiting; try the next one.
+      KillAndReap(child.internal_pid, nullptr);
+      continue;
+    }
+
+    // The child now pings the PID oracle like a freshly forked one would.
+    *child_pid = ReceiveRealPidAndTrackChild(child.internal_pid, nullptr,
+                                             child.channel.get());
+    return true;
+  }
+  return false;
+}
+
 }  // namespace content
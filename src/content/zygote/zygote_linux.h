@@ -20,6 +20,7 @@
 #include "base/time/time.h"
 
 namespace base {
+class Pickle;
 class PickleIterator;
 }
 
@@ -32,14 +33,19 @@ class ZygoteForkDelegate;
 // runs it.
 class Zygote {
  public:
+  // |meminfo_fd| is /proc/meminfo, opened before the sandbox was entered. It
+  // is used to size the pool of prespawned renderers and may be invalid.
   Zygote(int sandbox_flags,
          std::vector<std::unique_ptr<ZygoteForkDelegate>> helpers,
-         const base::GlobalDescriptors::Descriptor& ipc_backchannel);
+         const base::GlobalDescriptors::Descriptor& ipc_backchannel,
+         base::ScopedFD meminfo_fd);
   ~Zygote();
 
   bool ProcessRequests();
 
  private:
+  friend class ZygoteTest;
+
   struct ZygoteProcessInfo {
     // Pid from inside the Zygote's PID namespace.
     base::ProcessHandle internal_pid;
@@ -53,6 +59,19 @@ class Zygote {
   using ZygoteProcessMap =
       base::small_map<std::map<base::ProcessHandle, ZygoteProcessInfo>>;
 
+  // A child forked ahead of time that waits on |channel| for the fork request
+  // it should serve.
+  struct PrespawnedChild {
+    PrespawnedChild(base::ProcessHandle internal_pid, base::ScopedFD channel);
+    PrespawnedChild(PrespawnedChild&& other);
+    PrespawnedChild& operator=(PrespawnedChild&& other);
+    ~PrespawnedChild();
+
+    // Pid from inside the Zygote's PID namespace.
+    base::ProcessHandle internal_pid;
+    base::ScopedFD channel;
+  };
+
   // Retrieve a ZygoteProcessInfo from the process_info_map_.
   // Returns true and write to process_info if |pid| can be found, return
   // false otherwise.
@@ -83,6 +102,17 @@ class Zygote {
 
   void HandleGetTerminationStatus(int fd, base::PickleIterator iter);
 
+  // Forks a child without a helper, in a new PID namespace if the sandbox
+  // uses one.
+  base::ProcessId ForkChild();
+
+  // Waits in the parent for the browser to report the real PID of the child
+  // |pid| and forwards it to the child through |real_pid_fd| unless the child
+  // was started by |helper|. Returns the real PID or -1 on error.
+  base::ProcessId ReceiveRealPidAndTrackChild(base::ProcessId pid,
+                                              ZygoteForkDelegate* helper,
+                                              int real_pid_fd);
+
   // This is equivalent to fork(), except that, when using the SUID sandbox, it
   // returns the real PID of the child process as it appears outside the
   // sandbox, rather than returning the PID inside the sandbox.  The child's
@@ -99,10 +129,21 @@ class Zygote {
                       int* uma_sample,
                       int* uma_boundary_value);
 
-  // Unpacks process type and arguments from |iter| and forks a new process.
+  // Unpacks process type, arguments and the descriptor mapping of a fork
+  // request from |iter|. |fds| are the descriptors sent with the request, the
+  // first of which is the PID oracle. Returns false if the request is invalid.
+  bool ReadArgs(base::PickleIterator iter,
+                const std::vector<base::ScopedFD>& fds,
+                std::string* process_type,
+                std::vector<std::string>* args,
+                base::GlobalDescriptors::Mapping* mapping);
+
+  // Unpacks process type and arguments from |iter| and forks a new process,
+  // or hands |request| over to a prespawned child if one is available.
   // Returns -1 on error, otherwise returns twice, returning 0 to the child
   // process and the child process ID to the parent process, like fork().
-  base::ProcessId ReadArgsAndFork(base::PickleIterator iter,
+  base::ProcessId ReadArgsAndFork(const base::Pickle& request,
+                                  base::PickleIterator iter,
                                   std::vector<base::ScopedFD> fds,
                                   std::string* uma_name,
                                   int* uma_sample,
@@ -113,9 +154,34 @@ class Zygote {
   // otherwise writes the child_pid back to the browser via |fd|. Writes a
   // child_pid of -1 on error.
   bool HandleForkRequest(int fd,
+                         const base::Pickle& request,
                          base::PickleIterator iter,
                          std::vector<base::ScopedFD> fds);
 
+  // ---------------------------------------------------------------------------
+  // Prespawned renderers...
+
+  // Returns the number of renderers to keep prespawned, which is zero unless
+  // requested on the command line and enough memory is available.
+  size_t GetPrespawnedChildTarget() const;
+
+  // Forks or kills prespawned children until the pool has the target size.
+  // Returns true if we are in a new process that received a fork request and
+  // thus need to unwind back into ChromeMain.
+  bool MaintainPrespawnedChildren();
+
+  // Runs in a prespawned child. Waits for the zygote to forward a fork request
+  // over |channel| and sets the process up for it. Exits if the zygote closes
+  // the channel instead.
+  void WaitForForkRequestInPrespawnedChild(base::ScopedFD channel);
+
+  // Forwards |request| and its |fds| to a prespawned child. Returns false if
+  // no prespawned child could take the request, otherwise sets |child_pid| to
+  // the real PID of the child or -1 on error.
+  bool ForkFromPrespawnedChild(const base::Pickle& request,
+                               const std::vector<base::ScopedFD>& fds,
+                               base::ProcessId* child_pid);
+
   bool HandleGetSandboxStatus(int fd, base::PickleIterator iter);
 
   // Attempt to reap the child process by calling waitpid, and return
@@ -141,6 +207,13 @@ class Zygote {
   // The vector contains the child processes that need to be reaped.
   std::vector<ZygoteProcessInfo> to_reap_;
 
+  // Children forked ahead of time that are waiting for a renderer fork
+  // request.
+  std::vector<PrespawnedChild> prespawned_children_;
+
+  // /proc/meminfo, for GetPrespawnedChildTarget().
+  base::ScopedFD meminfo_fd_;
+
   // Sandbox IPC channel for renderers to invoke services from the browser. See
   // https://chromium.googlesource.com/chromium/src/+/master/docs/linux/sandbox_ipc.md
   base::GlobalDescriptors::Descriptor ipc_backchannel_;
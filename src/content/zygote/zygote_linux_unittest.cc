@@ -0,0 +1,253 @@
+// Copyright 2020 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "content/zygote/zygote_linux.h"
+
+#include <fcntl.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "base/command_line.h"
+#include "base/files/file_path.h"
+#include "base/files/file_util.h"
+#include "base/files/scoped_temp_dir.h"
+#include "base/pickle.h"
+#include "base/posix/eintr_wrapper.h"
+#include "base/posix/global_descriptors.h"
+#include "base/posix/unix_domain_socket.h"
+#include "base/strings/string_number_conversions.h"
+#include "base/strings/stringprintf.h"
+#include "base/strings/utf_string_conversions.h"
+#include "base/test/scoped_command_line.h"
+#include "content/common/zygote/zygote_commands_linux.h"
+#include "content/public/common/content_descriptors.h"
+#include "content/public/common/content_switches.h"
+#include "content/public/common/zygote/zygote_fork_delegate_linux.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace content {
+
+namespace {
+
+// Exit codes of a prespawned child that served a test fork request.
+const int kChildSuccess = 42;
+const int kChildFailure = 43;
+
+const char kTestChildSwitch[] = "prespawned-test-child";
+const base::GlobalDescriptors::Key kTestDescriptorKey = 100;
+
+}  // namespace
+
+class ZygoteTest : public testing::Test {
+ protected:
+  void SetUp() override {
+    ASSERT_TRUE(temp_dir_.CreateUniqueTempDir());
+    meminfo_path_ = temp_dir_.GetPath().AppendASCII("meminfo");
+    SetMemoryMB(/*free_mb=*/4096, /*available_mb=*/4096);
+  }
+
+  void TearDown() override {
+    if (!saved_zygote_socket_)
+      return;
+    if (saved_zygote_socket_->is_valid())
+      PCHECK(HANDLE_EINTR(dup2(saved_zygote_socket_->get(),
+                               kZygoteSocketPairFd)) == kZygoteSocketPairFd);
+    else
+      IGNORE_EINTR(close(kZygoteSocketPairFd));
+  }
+
+  // Writes a /proc/meminfo for the zygote to read. The difference between
+  // |free_mb| and |available_mb| is reported as page cache.
+  void SetMemoryMB(int free_mb, int available_mb) {
+    const std::string meminfo = base::StringPrintf(
+        "MemTotal:       %d kB\n"
+        "MemFree:        %d kB\n"
+        "MemAvailable:   %d kB\n"
+        "Buffers:        0 kB\n"
+        "Cached:         %d kB\n",
+        8192 * 1024, free_mb * 1024, available_mb * 1024,
+        (available_mb - free_mb) * 1024);
+    ASSERT_TRUE(base::WriteFile(meminfo_path_, meminfo));
+  }
+
+  void SetPrespawnedRenderers(const std::string& count) {
+    scoped_command_line_.GetProcessCommandLine()->AppendSwitchASCII(
+        switches::kZygotePrespawnedRenderers, count);
+  }
+
+  std::unique_ptr<Zygote> CreateZygote() {
+    base::ScopedFD meminfo_fd(HANDLE_EINTR(
+        open(meminfo_path_.value().c_str(), O_RDONLY | O_CLOEXEC)));
+    EXPECT_TRUE(meminfo_fd.is_valid());
+    return std::make_unique<Zygote>(
+        /*sandbox_flags=*/0, std::vector<std::unique_ptr<ZygoteForkDelegate>>(),
+        base::GlobalDescriptors::Descriptor(
+            static_cast<uint32_t>(kSandboxIPCChannel), STDERR_FILENO),
+        std::move(meminfo_fd));
+  }
+
+  // Installs a socket in place of the zygote's socket from the browser, and
+  // returns the browser's end of it.
+  base::ScopedFD InstallZygoteSocket() {
+    saved_zygote_socket_ = std::make_unique<base::ScopedFD>(
+        HANDLE_EINTR(dup(kZygoteSocketPairFd)));
+    base::ScopedFD browser_end, zygote_end;
+    EXPECT_TRUE(base::CreateSocketPair(&browser_end, &zygote_end));
+    EXPECT_EQ(kZygoteSocketPairFd,
+              HANDLE_EINTR(dup2(zygote_end.get(), kZygoteSocketPairFd)));
+    return browser_end;
+  }
+
+  // Builds a renderer fork request for a child started with
+  // --prespawned-test-child, and the descriptors sent with it.
+  base::Pickle CreateForkRequest(std::vector<base::ScopedFD>* fds,
+                                 base::ScopedFD* pid_oracle) {
+    base::ScopedFD child_oracle;
+    EXPECT_TRUE(base::CreateSocketPair(pid_oracle, &child_oracle));
+    base::ScopedFD read_pipe, write_pipe;
+    EXPECT_TRUE(base::CreatePipe(&read_pipe, &write_pipe));
+    fds->push_back(std::move(child_oracle));
+    fds->push_back(std::move(read_pipe));
+
+    base::Pickle request;
+    request.WriteInt(kZygoteCommandFork);
+    request.WriteString(switches::kRendererProcess);
+    request.WriteInt(2);
+    request.WriteString("renderer");
+    request.WriteString(std::string("--") + kTestChildSwitch);
+    request.WriteString16(base::ASCIIToUTF16("UTC"));
+    request.WriteInt(fds->size());
+    request.WriteUInt32(kTestDescriptorKey);
+    return request;
+  }
+
+  // Accessors for the private parts of Zygote.
+  size_t GetPrespawnedChildTarget(Zygote* zygote) {
+    return zygote->GetPrespawnedChildTarget();
+  }
+  bool MaintainPrespawnedChildren(Zygote* zygote) {
+    return zygote->MaintainPrespawnedChildren();
+  }
+  size_t GetPrespawnedChildCount(Zygote* zygote) {
+    return zygote->prespawned_children_.size();
+  }
+  // The child that serves the next request.
+  base::ProcessHandle GetNextPrespawnedChild(Zygote* zygote) {
+    return zygote->prespawned_children_.back().internal_pid;
+  }
+  bool ForkFromPrespawnedChild(Zygote* zygote,
+                               const base::Pickle& request,
+                               const std::vector<base::ScopedFD>& fds,
+                               base::ProcessId* child_pid) {
+    return zygote->ForkFromPrespawnedChild(request, fds, child_pid);
+  }
+
+ private:
+  base::ScopedTempDir temp_dir_;
+  base::FilePath meminfo_path_;
+  base::test::ScopedCommandLine scoped_command_line_;
+  std::unique_ptr<base::ScopedFD> saved_zygote_socket_;
+};
+
+TEST_F(ZygoteTest, PoolSize) {
+  std::unique_ptr<Zygote> zygote = CreateZygote();
+  EXPECT_EQ(0u, GetPrespawnedChildTarget(zygote.get()));
+
+  SetPrespawnedRenderers("2");
+  EXPECT_EQ(2u, GetPrespawnedChildTarget(zygote.get()));
+
+  SetPrespawnedRenderers("100");
+  EXPECT_EQ(4u, GetPrespawnedChildTarget(zygote.get()));
+
+  SetPrespawnedRenderers("invalid");
+  EXPECT_EQ(0u, GetPrespawnedChildTarget(zygote.get()));
+}
+
+TEST_F(ZygoteTest, PoolSizeCountsPageCacheAsAvailable) {
+  SetPrespawnedRenderers("2");
+  std::unique_ptr<Zygote> zygote = CreateZygote();
+
+  // Little free memory, but plenty of reclaimable page cache.
+  SetMemoryMB(/*free_mb=*/64, /*available_mb=*/2048);
+  EXPECT_EQ(2u, GetPrespawnedChildTarget(zygote.get()));
+
+  SetMemoryMB(/*free_mb=*/64, /*available_mb=*/256);
+  EXPECT_EQ(0u, GetPrespawnedChildTarget(zygote.get()));
+}
+
+TEST_F(ZygoteTest, PoolShrinksWhenMemoryIsLow) {
+  base::ScopedFD browser_socket = InstallZygoteSocket();
+  SetPrespawnedRenderers("2");
+  std::unique_ptr<Zygote> zygote = CreateZygote();
+
+  // Pooled children exit when their channel is closed, without ever
+  // returning from MaintainPrespawnedChildren().
+  ASSERT_FALSE(MaintainPrespawnedChildren(zygote.get()));
+  EXPECT_EQ(2u, GetPrespawnedChildCount(zygote.get()));
+
+  SetMemoryMB(/*free_mb=*/64, /*available_mb=*/256);
+  EXPECT_FALSE(MaintainPrespawnedChildren(zygote.get()));
+  EXPECT_EQ(0u, GetPrespawnedChildCount(zygote.get()));
+}
+
+TEST_F(ZygoteTest, PrespawnedChildServesForkRequestAndPoolRefills) {
+  base::ScopedFD browser_socket = InstallZygoteSocket();
+  SetPrespawnedRenderers("1");
+  std::unique_ptr<Zygote> zygote = CreateZygote();
+
+  if (MaintainPrespawnedChildren(zygote.get())) {
+    // In the prespawned child, set up for the forwarded request.
+    const bool set_up =
+        base::CommandLine::ForCurrentProcess()->HasSwitch(kTestChildSwitch) &&
+        base::GlobalDescriptors::GetInstance()->MaybeGet(kTestDescriptorKey) >=
+            0;
+    _exit(set_up ? kChildSuccess : kChildFailure);
+  }
+  ASSERT_EQ(1u, GetPrespawnedChildCount(zygote.get()));
+  const base::ProcessHandle prespawned_pid =
+      GetNextPrespawnedChild(zygote.get());
+
+  // The browser reports the real PID of the child after its ping on the PID
+  // oracle. Without a PID namespace, that is the PID the zygote sees.
+  base::Pickle real_pid_message;
+  real_pid_message.WriteInt(kZygoteCommandForkRealPID);
+  real_pid_message.WriteInt(prespawned_pid);
+  ASSERT_TRUE(base::UnixDomainSocket::SendMsg(
+      browser_socket.get(), real_pid_message.data(), real_pid_message.size(),
+      std::vector<int>()));
+
+  std::vector<base::ScopedFD> fds;
+  base::ScopedFD pid_oracle;
+  base::Pickle request = CreateForkRequest(&fds, &pid_oracle);
+  base::ProcessId child_pid = -1;
+  ASSERT_TRUE(
+      ForkFromPrespawnedChild(zygote.get(), request, fds, &child_pid));
+  EXPECT_EQ(prespawned_pid, child_pid);
+  EXPECT_EQ(0u, GetPrespawnedChildCount(zygote.get()));
+
+  // The child pinged the PID oracle like a freshly forked child.
+  std::vector<base::ScopedFD> ping_fds;
+  char buf[kZygoteMaxMessageLength];
+  EXPECT_GT(base::UnixDomainSocket::RecvMsg(pid_oracle.get(), buf,
+                                            sizeof(buf), &ping_fds),
+            0);
+
+  int status = 0;
+  ASSERT_EQ(child_pid, HANDLE_EINTR(waitpid(child_pid, &status, 0)));
+  ASSERT_TRUE(WIFEXITED(status));
+  EXPECT_EQ(kChildSuccess, WEXITSTATUS(status));
+
+  // The pool is refilled for the next request.
+  EXPECT_FALSE(MaintainPrespawnedChildren(zygote.get()));
+  EXPECT_EQ(1u, GetPrespawnedChildCount(zygote.get()));
+  EXPECT_NE(prespawned_pid, GetNextPrespawnedChild(zygote.get()));
+}
+
+}  // namespace content
@@ -220,6 +220,11 @@ bool ZygoteMain(
     fork_delegate->Init(GetSandboxFD(), using_layer1_sandbox);
   }
 
+  // /proc is not reachable from inside the sandbox, so keep /proc/meminfo open
+  // for sizing the pool of prespawned renderers.
+  base::ScopedFD meminfo_fd(
+      HANDLE_EINTR(open("/proc/meminfo", O_RDONLY | O_CLOEXEC)));
+
   // Turn on the first layer of the sandbox if the configuration warrants it.
   EnterLayerOneSandbox(
       linux_sandbox, using_layer1_sandbox,
@@ -236,7 +241,8 @@ bool ZygoteMain(
 
   Zygote zygote(sandbox_flags, std::move(fork_delegates),
                 base::GlobalDescriptors::Descriptor(
-                    static_cast<uint32_t>(kSandboxIPCChannel), GetSandboxFD()));
+                    static_cast<uint32_t>(kSandboxIPCChannel), GetSandboxFD()),
+                std::move(meminfo_fd));
 
   // This function call can return multiple times, once per fork().
   return zygote.ProcessRequests();
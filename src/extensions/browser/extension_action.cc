@@ -48,9 +48,9 @@ class GetAttentionImageSource : public gfx::ImageSkiaSource {
   gfx::ImageSkiaRep GetImageForScale(float scale) override {
     gfx::ImageSkiaRep icon_rep = icon_.GetRepresentation(scale);
     color_utils::HSL shift = {-1, 0, 0.5};
-    return gfx::ImageSkiaRep(
-        SkBitmapOperations::CreateHSLShiftedBitmap(icon_rep.GetBitmap(), shift),
-        icon_rep.scale());
+    return gfx::ImageSkiaRep(SkBitmapOperations::GetOrCreateHSLShiftedBitmap(
+                                 icon_rep.GetBitmap(), shift),
+                             icon_rep.scale());
   }
 
  private:
@@ -214,6 +214,17 @@ bool ImplementationBase::OnMemoryDump(
   if (args.level_of_detail != MemoryDumpLevelOfDetail::BACKGROUND) {
     dump->AddScalar("free_size", MemoryAllocatorDump::kUnitsBytes,
                     transfer_buffer_->GetFragmentedFreeSize());
+    TransferBufferInterface::Stats stats = transfer_buffer_->GetStats();
+    dump->AddScalar("allocated_size", MemoryAllocatorDump::kUnitsBytes,
+                    stats.bytes_allocated);
+    dump->AddScalar("allocation_count", MemoryAllocatorDump::kUnitsObjects,
+                    stats.num_allocations);
+    dump->AddScalar("stall_count", MemoryAllocatorDump::kUnitsObjects,
+                    stats.num_stalls);
+    dump->AddScalar("expansion_count", MemoryAllocatorDump::kUnitsObjects,
+                    stats.num_expansions);
+    dump->AddScalar("shrink_count", MemoryAllocatorDump::kUnitsObjects,
+                    stats.num_shrinks);
     auto shared_memory_guid = transfer_buffer_->shared_memory_guid();
     const int kImportance = 2;
     if (!shared_memory_guid.is_empty()) {
@@ -139,6 +139,10 @@ unsigned int MockTransferBuffer::GetMaxSize() const {
   return 0;
 }
 
+TransferBufferInterface::Stats MockTransferBuffer::GetStats() const {
+  return Stats();
+}
+
 void MockTransferBuffer::ShrinkLastBlock(unsigned int new_size) {}
 
 uint32_t MockTransferBuffer::MaxTransferBufferSize() {
@@ -51,6 +51,7 @@ class MockTransferBuffer : public TransferBufferInterface {
   unsigned int GetFragmentedFreeSize() const override;
   void ShrinkLastBlock(unsigned int new_size) override;
   unsigned int GetMaxSize() const override;
+  Stats GetStats() const override;
 
   uint32_t MaxTransferBufferSize();
   unsigned int RoundToAlignment(unsigned int size);
@@ -39,8 +39,12 @@ void RingBuffer::FreeOldestBlock() {
   Block& block = blocks_.front();
   DCHECK(block.state != IN_USE)
       << "attempt to allocate more than maximum memory";
-  if (block.state == FREE_PENDING_TOKEN) {
+  if (block.state == FREE_PENDING_TOKEN &&
+      !helper_->HasTokenPassed(block.token)) {
+    base::TimeTicks start = base::TimeTicks::Now();
     helper_->WaitForToken(block.token);
+    num_stalls_++;
+    stall_time_ += base::TimeTicks::Now() - start;
   }
   in_use_offset_ += block.size;
   if (in_use_offset_ == size_) {
@@ -11,6 +11,7 @@
 
 #include "base/containers/circular_deque.h"
 #include "base/macros.h"
+#include "base/time/time.h"
 #include "gpu/gpu_export.h"
 
 namespace gpu {
@@ -89,6 +90,11 @@ class GPU_EXPORT RingBuffer {
 
   uint32_t NumUsedBlocks() const { return num_used_blocks_; }
 
+  // Number of times an allocation had to wait for the service to pass a token
+  // before reusing memory, and the total time spent waiting.
+  uint32_t num_stalls() const { return num_stalls_; }
+  base::TimeDelta stall_time() const { return stall_time_; }
+
   // Gets a pointer to a memory block given the base memory and the offset.
   void* GetPointer(RingBuffer::Offset offset) const {
     return static_cast<int8_t*>(base_) + offset;
@@ -157,6 +163,9 @@ class GPU_EXPORT RingBuffer {
   // The physical address that corresponds to base_offset.
   void* base_;
 
+  uint32_t num_stalls_ = 0;
+  base::TimeDelta stall_time_;
+
   DISALLOW_IMPLICIT_CONSTRUCTORS(RingBuffer);
 };
 
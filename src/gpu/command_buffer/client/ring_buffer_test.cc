@@ -181,6 +181,29 @@ TEST_F(RingBufferTest, TestFreePendingToken) {
   allocator_->FreePendingToken(pointer1, helper_->InsertToken());
 }
 
+// Checks that allocations that wait for a token are counted as stalls.
+TEST_F(RingBufferTest, TestCountsStalls) {
+  const unsigned int kSize = kBufferSize / 2;
+  helper_->SetAutomaticFlushes(false);
+
+  // Fill the buffer with blocks whose tokens haven't been flushed.
+  for (int i = 0; i < 2; ++i) {
+    void* pointer = allocator_->Alloc(kSize);
+    allocator_->FreePendingToken(pointer, helper_->InsertToken());
+  }
+  EXPECT_EQ(0u, allocator_->num_stalls());
+
+  // Reusing the first block waits for its token, which flushes both.
+  void* pointer = allocator_->Alloc(kSize);
+  EXPECT_EQ(1u, allocator_->num_stalls());
+  allocator_->FreePendingToken(pointer, helper_->InsertToken());
+
+  // The second block's token has already passed.
+  pointer = allocator_->Alloc(kSize);
+  EXPECT_EQ(1u, allocator_->num_stalls());
+  allocator_->FreePendingToken(pointer, helper_->InsertToken());
+}
+
 // Tests GetLargestFreeSizeNoWaiting
 TEST_F(RingBufferTest, TestGetLargestFreeSizeNoWaiting) {
   EXPECT_EQ(kBufferSize, allocator_->GetLargestFreeSizeNoWaiting());
@@ -12,11 +12,16 @@
 
 #include "base/bits.h"
 #include "base/check_op.h"
+#include "base/metrics/histogram_macros.h"
 #include "base/trace_event/trace_event.h"
 #include "gpu/command_buffer/client/cmd_buffer_helper.h"
 
 namespace gpu {
 
+constexpr uint32_t TransferBuffer::kGrowStallCount;
+constexpr base::TimeDelta TransferBuffer::kGrowStallTime;
+constexpr base::TimeDelta TransferBuffer::kGrowStallWindow;
+
 TransferBuffer::TransferBuffer(CommandBufferHelper* helper)
     : helper_(helper),
       result_size_(0),
@@ -71,6 +76,8 @@ void TransferBuffer::Free() {
     result_buffer_ = nullptr;
     result_shm_offset_ = 0;
     DCHECK_EQ(ring_buffer_->NumUsedBlocks(), 0u);
+    stats_.num_stalls += ring_buffer_->num_stalls();
+    stats_.stall_time += ring_buffer_->stall_time();
     previous_ring_buffers_.push_back(std::move(ring_buffer_));
     last_allocated_size_ = 0;
     high_water_mark_ = GetPreviousRingBufferUsedBytes();
@@ -115,6 +122,15 @@ unsigned int TransferBuffer::GetMaxSize() const {
   return max_buffer_size_ - result_size_;
 }
 
+TransferBufferInterface::Stats TransferBuffer::GetStats() const {
+  Stats stats = stats_;
+  if (HaveBuffer()) {
+    stats.num_stalls += ring_buffer_->num_stalls();
+    stats.stall_time += ring_buffer_->stall_time();
+  }
+  return stats;
+}
+
 void TransferBuffer::AllocateRingBuffer(unsigned int size) {
   for (;size >= min_buffer_size_; size /= 2) {
     int32_t id = -1;
@@ -131,6 +147,7 @@ void TransferBuffer::AllocateRingBuffer(unsigned int size) {
       result_buffer_ = buffer_->memory();
       result_shm_offset_ = 0;
       bytes_since_last_shrink_ = 0;
+      ResetStallCheck();
       return;
     }
     // we failed so don't try larger than this.
@@ -170,6 +187,10 @@ void TransferBuffer::ReallocateRingBuffer(unsigned int size, bool shrink) {
     // pointer that hasn't been released. This would cause a use-after-free.
     DCHECK(!outstanding_result_pointer_);
     if (HaveBuffer()) {
+      if (needed_buffer_size > current_size)
+        stats_.num_expansions++;
+      else
+        stats_.num_shrinks++;
       Free();
     }
     AllocateRingBuffer(needed_buffer_size);
@@ -188,6 +209,23 @@ unsigned int TransferBuffer::GetPreviousRingBufferUsedBytes() {
   return total;
 }
 
+bool TransferBuffer::IsStalling() const {
+  return ring_buffer_->num_stalls() - num_stalls_at_last_check_ >=
+             kGrowStallCount ||
+         ring_buffer_->stall_time() - stall_time_at_last_check_ >=
+             kGrowStallTime;
+}
+
+bool TransferBuffer::HasStalledSinceLastCheck() const {
+  return ring_buffer_->num_stalls() != num_stalls_at_last_check_;
+}
+
+void TransferBuffer::ResetStallCheck() {
+  num_stalls_at_last_check_ = ring_buffer_->num_stalls();
+  stall_time_at_last_check_ = ring_buffer_->stall_time();
+  stall_check_start_time_ = base::TimeTicks::Now();
+}
+
 void TransferBuffer::ShrinkOrExpandRingBufferIfNecessary(
     unsigned int size_to_allocate) {
   // We should never attempt to shrink the buffer if someone has a result
@@ -203,9 +241,24 @@ void TransferBuffer::ShrinkOrExpandRingBufferIfNecessary(
       std::max(high_water_mark_, last_allocated_size_ - available_size +
                                      size_to_allocate +
                                      GetPreviousRingBufferUsedBytes());
+  // Only stalls within the current window count toward growing the buffer.
+  if (HaveBuffer() &&
+      base::TimeTicks::Now() - stall_check_start_time_ >= kGrowStallWindow) {
+    ResetStallCheck();
+  }
   if (size_to_allocate > available_size) {
     // Try to expand the ring buffer.
     ReallocateRingBuffer(high_water_mark_);
+  } else if (HaveBuffer() && last_allocated_size_ < max_buffer_size_ &&
+             IsStalling()) {
+    // Allocations fit, but keep waiting for the service to consume earlier
+    // uploads before the ring buffer wraps. Doubling the buffer lets the
+    // client run further ahead. The stalls happened while earlier blocks were
+    // still pending, so keep the high water mark at least at the stalled
+    // size to avoid shrinking back to it.
+    unsigned int stalled_size = last_allocated_size_;
+    ReallocateRingBuffer(stalled_size * 2 - result_size_);
+    high_water_mark_ = std::max(high_water_mark_, stalled_size);
   } else if (bytes_since_last_shrink_ > high_water_mark_ * kShrinkThreshold) {
     // The intent of the above check is to limit the frequency of buffer shrink
     // attempts. Unfortunately if an application uploads a large amount of data
@@ -216,6 +269,11 @@ void TransferBuffer::ShrinkOrExpandRingBufferIfNecessary(
     // instead, and consider shrinking at the end of each frame (for clients
     // that have a notion of frames).
     bytes_since_last_shrink_ = 0;
+    // A ring buffer that recently stalled is too small already.
+    if (HaveBuffer() && HasStalledSinceLastCheck()) {
+      ResetStallCheck();
+      return;
+    }
     ReallocateRingBuffer(high_water_mark_ + high_water_mark_ / 4,
                          true /* shrink */);
     high_water_mark_ = size_to_allocate + GetPreviousRingBufferUsedBytes();
@@ -234,8 +292,7 @@ void* TransferBuffer::AllocUpTo(
 
   unsigned int max_size = ring_buffer_->GetLargestFreeOrPendingSize();
   *size_allocated = std::min(max_size, size);
-  bytes_since_last_shrink_ += *size_allocated;
-  return ring_buffer_->Alloc(*size_allocated);
+  return AllocFromRingBuffer(*size_allocated);
 }
 
 void* TransferBuffer::Alloc(unsigned int size) {
@@ -249,8 +306,25 @@ void* TransferBuffer::Alloc(unsigned int size) {
   if (size > max_size) {
     return nullptr;
   }
+  return AllocFromRingBuffer(size);
+}
+
+void* TransferBuffer::AllocFromRingBuffer(unsigned int size) {
   bytes_since_last_shrink_ += size;
-  return ring_buffer_->Alloc(size);
+  stats_.bytes_allocated += size;
+  stats_.num_allocations++;
+
+  uint32_t num_stalls = ring_buffer_->num_stalls();
+  base::TimeDelta stall_time = ring_buffer_->stall_time();
+  void* pointer = ring_buffer_->Alloc(size);
+  if (ring_buffer_->num_stalls() != num_stalls) {
+    UMA_HISTOGRAM_CUSTOM_MICROSECONDS_TIMES(
+        "GPU.TransferBuffer.AllocStallTime",
+        ring_buffer_->stall_time() - stall_time,
+        base::TimeDelta::FromMicroseconds(1), base::TimeDelta::FromSeconds(1),
+        50);
+  }
+  return pointer;
 }
 
 void* TransferBuffer::AcquireResultBuffer() {
@@ -13,6 +13,7 @@
 #include "base/compiler_specific.h"
 #include "base/containers/circular_deque.h"
 #include "base/macros.h"
+#include "base/time/time.h"
 #include "base/unguessable_token.h"
 #include "gpu/command_buffer/client/ring_buffer.h"
 #include "gpu/command_buffer/common/buffer.h"
@@ -27,6 +28,20 @@ class ScopedResultPtr;
 // Interface for managing the transfer buffer.
 class GPU_EXPORT TransferBufferInterface {
  public:
+  // Counters describing how well the transfer buffer is sized for its usage.
+  struct Stats {
+    // Bytes handed out by Alloc and AllocUpTo, and the number of calls.
+    uint64_t bytes_allocated = 0;
+    uint32_t num_allocations = 0;
+    // Allocations that waited for the service to release memory, and the
+    // total time spent waiting.
+    uint32_t num_stalls = 0;
+    base::TimeDelta stall_time;
+    // Number of times the buffer was reallocated to grow or shrink it.
+    uint32_t num_expansions = 0;
+    uint32_t num_shrinks = 0;
+  };
+
   TransferBufferInterface() = default;
   virtual ~TransferBufferInterface() = default;
 
@@ -69,6 +84,8 @@ class GPU_EXPORT TransferBufferInterface {
 
   virtual unsigned int GetMaxSize() const = 0;
 
+  virtual Stats GetStats() const = 0;
+
  protected:
   template <typename>
   friend class ScopedResultPtr;
@@ -110,6 +127,7 @@ class GPU_EXPORT TransferBuffer : public TransferBufferInterface {
   unsigned int GetFragmentedFreeSize() const override;
   void ShrinkLastBlock(unsigned int new_size) override;
   unsigned int GetMaxSize() const override;
+  Stats GetStats() const override;
 
   // These are for testing.
   unsigned int GetCurrentMaxAllocationWithoutRealloc() const;
@@ -118,6 +136,17 @@ class GPU_EXPORT TransferBuffer : public TransferBufferInterface {
   // allocated reaches this threshold times the high water mark.
   static const int kShrinkThreshold = 120;
 
+  // We will grow the ring buffer when allocations have waited for the service
+  // this many times, or for this long, within one kGrowStallWindow.
+  static constexpr uint32_t kGrowStallCount = 4;
+  static constexpr base::TimeDelta kGrowStallTime =
+      base::TimeDelta::FromMilliseconds(4);
+
+  // Stalls are counted over windows of this length, so that occasional stalls
+  // spread over a long time don't grow the ring buffer.
+  static constexpr base::TimeDelta kGrowStallWindow =
+      base::TimeDelta::FromSeconds(1);
+
  private:
   // Tries to reallocate the ring buffer if it's not large enough for size.
   void ReallocateRingBuffer(unsigned int size, bool shrink = false);
@@ -126,6 +155,20 @@ class GPU_EXPORT TransferBuffer : public TransferBufferInterface {
 
   void ShrinkOrExpandRingBufferIfNecessary(unsigned int size);
 
+  // Allocates |size| bytes from |ring_buffer_| and updates the usage counters.
+  void* AllocFromRingBuffer(unsigned int size);
+
+  // Returns true if allocations have waited for the service enough since the
+  // last check to make a larger ring buffer worthwhile.
+  bool IsStalling() const;
+
+  // Returns true if allocations have waited for the service at all since the
+  // last check.
+  bool HasStalledSinceLastCheck() const;
+
+  // Starts a new check window for the current ring buffer.
+  void ResetStallCheck();
+
   // Returns the number of bytes that are still in use in ring buffers that we
   // previously freed.
   unsigned int GetPreviousRingBufferUsedBytes();
@@ -158,6 +201,15 @@ class GPU_EXPORT TransferBuffer : public TransferBufferInterface {
   // Number of bytes since we last attempted to shrink the ring buffer.
   unsigned int bytes_since_last_shrink_ = 0;
 
+  // Stall counters of |ring_buffer_| when we last checked whether to grow or
+  // shrink it, and when that check window started.
+  uint32_t num_stalls_at_last_check_ = 0;
+  base::TimeDelta stall_time_at_last_check_;
+  base::TimeTicks stall_check_start_time_;
+
+  // Usage counters. Stalls only include ring buffers that were freed.
+  Stats stats_;
+
   // the current buffer.
   scoped_refptr<gpu::Buffer> buffer_;
 
@@ -13,9 +13,13 @@
 
 #include "base/compiler_specific.h"
 #include "base/memory/aligned_memory.h"
+#include "base/test/metrics/histogram_tester.h"
+#include "base/test/task_environment.h"
 #include "gpu/command_buffer/client/client_test_helper.h"
 #include "gpu/command_buffer/client/cmd_buffer_helper.h"
 #include "gpu/command_buffer/common/command_buffer.h"
+#include "gpu/command_buffer/service/command_buffer_direct.h"
+#include "gpu/command_buffer/service/mocks.h"
 #include "testing/gmock/include/gmock/gmock.h"
 #include "testing/gtest/include/gtest/gtest.h"
 
@@ -749,6 +753,158 @@ TEST_F(TransferBufferTest, MultipleAllocsAndFrees) {
   EXPECT_EQ(transfer_buffer_->GetFragmentedFreeSize(), original_free_size);
 }
 
+// Test fixture for the adaptive sizing of TransferBuffer. Uses a
+// CommandBufferDirect, so tokens pass once the helper flushes.
+class TransferBufferAutotuneTest : public testing::Test {
+ protected:
+  static const uint32_t kCommandBufferSizeBytes = 1024;
+  static const uint32_t kStartingOffset = 64;
+  static const uint32_t kAlignment = 4;
+  static const uint32_t kStartTransferBufferSize = 256;
+  static const uint32_t kMaxTransferBufferSize = 1024;
+  static const uint32_t kMinTransferBufferSize = 128;
+
+  void SetUp() override {
+    command_buffer_.reset(new CommandBufferDirect());
+    api_mock_.reset(new AsyncAPIMock(true, command_buffer_->service()));
+    command_buffer_->set_handler(api_mock_.get());
+
+    // ignore noops in the mock - we don't want to inspect the internals of the
+    // helper.
+    EXPECT_CALL(*api_mock_, DoCommand(cmd::kNoop, 0, _))
+        .WillRepeatedly(Return(error::kNoError));
+    // Forward the SetToken calls to the engine
+    EXPECT_CALL(*api_mock_.get(), DoCommand(cmd::kSetToken, 1, _))
+        .WillRepeatedly(DoAll(Invoke(api_mock_.get(), &AsyncAPIMock::SetToken),
+                              Return(error::kNoError)));
+
+    helper_.reset(new CommandBufferHelper(command_buffer_.get()));
+    helper_->Initialize(kCommandBufferSizeBytes);
+    // Tokens should only pass when a test flushes or an allocation waits.
+    helper_->SetAutomaticFlushes(false);
+    transfer_buffer_.reset(new TransferBuffer(helper_.get()));
+  }
+
+  void TearDown() override { transfer_buffer_.reset(); }
+
+  void Initialize(uint32_t start_size) {
+    ASSERT_TRUE(transfer_buffer_->Initialize(
+        start_size, kStartingOffset, kMinTransferBufferSize,
+        kMaxTransferBufferSize, kAlignment));
+  }
+
+  // Uploads three blocks of |size| bytes, the last one while still holding the
+  // second, then flushes as a client would at the end of a frame. The last
+  // allocation waits for the first block's token if the ring buffer can't hold
+  // all three.
+  void RunFrame(uint32_t size) {
+    void* first = transfer_buffer_->Alloc(size);
+    ASSERT_TRUE(first);
+    transfer_buffer_->FreePendingToken(first, helper_->InsertToken());
+    void* held = transfer_buffer_->Alloc(size);
+    ASSERT_TRUE(held);
+    void* last = transfer_buffer_->Alloc(size);
+    ASSERT_TRUE(last);
+    transfer_buffer_->FreePendingToken(last, helper_->InsertToken());
+    transfer_buffer_->FreePendingToken(held, helper_->InsertToken());
+    helper_->Flush();
+  }
+
+  std::unique_ptr<CommandBufferDirect> command_buffer_;
+  std::unique_ptr<AsyncAPIMock> api_mock_;
+  std::unique_ptr<CommandBufferHelper> helper_;
+  std::unique_ptr<TransferBuffer> transfer_buffer_;
+  base::test::SingleThreadTaskEnvironment task_environment_{
+      base::test::TaskEnvironment::TimeSource::MOCK_TIME};
+};
+
+#ifndef _MSC_VER
+const uint32_t TransferBufferAutotuneTest::kCommandBufferSizeBytes;
+const uint32_t TransferBufferAutotuneTest::kStartingOffset;
+const uint32_t TransferBufferAutotuneTest::kAlignment;
+const uint32_t TransferBufferAutotuneTest::kStartTransferBufferSize;
+const uint32_t TransferBufferAutotuneTest::kMaxTransferBufferSize;
+const uint32_t TransferBufferAutotuneTest::kMinTransferBufferSize;
+#endif
+
+TEST_F(TransferBufferAutotuneTest, GrowsWhenStalling) {
+  base::HistogramTester histogram_tester;
+  Initialize(kStartTransferBufferSize);
+  const uint32_t kBlockSize = (kStartTransferBufferSize - kStartingOffset) / 2;
+
+  // Every frame stalls, but each one starts with enough free space, so the
+  // ring buffer doesn't need to grow to fit allocations.
+  for (uint32_t i = 0; i < TransferBuffer::kGrowStallCount; ++i)
+    RunFrame(kBlockSize);
+  EXPECT_EQ(kStartTransferBufferSize - kStartingOffset,
+            transfer_buffer_->GetCurrentMaxAllocationWithoutRealloc());
+  EXPECT_EQ(TransferBuffer::kGrowStallCount,
+            transfer_buffer_->GetStats().num_stalls);
+  histogram_tester.ExpectTotalCount("GPU.TransferBuffer.AllocStallTime",
+                                    TransferBuffer::kGrowStallCount);
+
+  // The next frame starts by doubling the ring buffer, which then holds all
+  // three blocks.
+  RunFrame(kBlockSize);
+  RunFrame(kBlockSize);
+  EXPECT_EQ(kStartTransferBufferSize * 2 - kStartingOffset,
+            transfer_buffer_->GetCurrentMaxAllocationWithoutRealloc());
+
+  TransferBufferInterface::Stats stats = transfer_buffer_->GetStats();
+  EXPECT_EQ(TransferBuffer::kGrowStallCount, stats.num_stalls);
+  EXPECT_EQ(1u, stats.num_expansions);
+  EXPECT_EQ(0u, stats.num_shrinks);
+  EXPECT_EQ(3 * (TransferBuffer::kGrowStallCount + 2), stats.num_allocations);
+  EXPECT_EQ(3 * (TransferBuffer::kGrowStallCount + 2) * kBlockSize,
+            stats.bytes_allocated);
+}
+
+TEST_F(TransferBufferAutotuneTest, DoesNotGrowOnOccasionalStalls) {
+  Initialize(kStartTransferBufferSize);
+  const uint32_t kBlockSize = (kStartTransferBufferSize - kStartingOffset) / 2;
+
+  // Every frame stalls, but frames are further apart than the stall window.
+  for (uint32_t i = 0; i < 2 * TransferBuffer::kGrowStallCount; ++i) {
+    RunFrame(kBlockSize);
+    task_environment_.FastForwardBy(TransferBuffer::kGrowStallWindow);
+  }
+  EXPECT_EQ(kStartTransferBufferSize - kStartingOffset,
+            transfer_buffer_->GetCurrentMaxAllocationWithoutRealloc());
+
+  TransferBufferInterface::Stats stats = transfer_buffer_->GetStats();
+  EXPECT_EQ(2 * TransferBuffer::kGrowStallCount, stats.num_stalls);
+  EXPECT_EQ(0u, stats.num_expansions);
+}
+
+TEST_F(TransferBufferAutotuneTest, DoesNotGrowPastMax) {
+  Initialize(kMaxTransferBufferSize);
+  const uint32_t kBlockSize = (kMaxTransferBufferSize - kStartingOffset) / 2;
+
+  for (uint32_t i = 0; i < 2 * TransferBuffer::kGrowStallCount; ++i)
+    RunFrame(kBlockSize);
+  EXPECT_EQ(kMaxTransferBufferSize - kStartingOffset,
+            transfer_buffer_->GetCurrentMaxAllocationWithoutRealloc());
+
+  TransferBufferInterface::Stats stats = transfer_buffer_->GetStats();
+  EXPECT_EQ(2 * TransferBuffer::kGrowStallCount, stats.num_stalls);
+  EXPECT_EQ(0u, stats.num_expansions);
+  EXPECT_EQ(0u, stats.num_shrinks);
+}
+
+TEST_F(TransferBufferAutotuneTest, NoStallsWhenBufferIsLargeEnough) {
+  Initialize(kStartTransferBufferSize);
+  const uint32_t kBlockSize = (kStartTransferBufferSize - kStartingOffset) / 4;
+
+  for (uint32_t i = 0; i < 2 * TransferBuffer::kGrowStallCount; ++i)
+    RunFrame(kBlockSize);
+  EXPECT_EQ(kStartTransferBufferSize - kStartingOffset,
+            transfer_buffer_->GetCurrentMaxAllocationWithoutRealloc());
+
+  TransferBufferInterface::Stats stats = transfer_buffer_->GetStats();
+  EXPECT_EQ(0u, stats.num_stalls);
+  EXPECT_EQ(0u, stats.num_expansions);
+}
+
 #if defined(GTEST_HAS_DEATH_TEST) && DCHECK_IS_ON()
 
 TEST_F(TransferBufferTest, ResizeDuringScopedResultPtr) {
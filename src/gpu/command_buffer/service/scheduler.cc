@@ -12,7 +12,8 @@
 #include "base/metrics/histogram_macros.h"
 #include "base/single_thread_task_runner.h"
 #include "base/stl_util.h"
-#include "base/timer/elapsed_timer.h"
+#include "base/time/default_tick_clock.h"
+#include "base/time/tick_clock.h"
 #include "base/trace_event/trace_event.h"
 #include "base/trace_event/traced_value.h"
 #include "gpu/command_buffer/service/sync_point_manager.h"
@@ -20,6 +21,9 @@
 
 namespace gpu {
 
+constexpr base::TimeDelta Scheduler::kBudgetWindow;
+constexpr base::TimeDelta Scheduler::kStreamBudget;
+
 Scheduler::Task::Task(SequenceId sequence_id,
                       base::OnceClosure closure,
                       std::vector<SyncToken> sync_token_fences)
@@ -41,6 +45,7 @@ Scheduler::SchedulingState::AsValue() const {
       new base::trace_event::TracedValue());
   state->SetInteger("sequence_id", sequence_id.GetUnsafeValue());
   state->SetString("priority", SchedulingPriorityToString(priority));
+  state->SetBoolean("over_budget", over_budget);
   state->SetInteger("order_num", order_num);
   return std::move(state);
 }
@@ -147,6 +152,7 @@ Scheduler::SchedulingState Scheduler::Sequence::SetScheduled() {
 
   scheduling_state_.sequence_id = sequence_id_;
   scheduling_state_.priority = current_priority();
+  scheduling_state_.over_budget = IsOverBudget(base::TimeDelta());
   scheduling_state_.order_num = tasks_.front().order_num;
 
   return scheduling_state_;
@@ -157,6 +163,12 @@ void Scheduler::Sequence::UpdateRunningPriority() {
   scheduling_state_.priority = current_priority();
 }
 
+bool Scheduler::Sequence::ResetBudget() {
+  bool was_over_budget = IsOverBudget(base::TimeDelta());
+  budget_used_ = base::TimeDelta();
+  return was_over_budget;
+}
+
 void Scheduler::Sequence::ContinueTask(base::OnceClosure closure) {
   DCHECK_EQ(running_state_, RUNNING);
   uint32_t order_num = order_data_->current_order_num();
@@ -300,6 +312,7 @@ Scheduler::Scheduler(scoped_refptr<base::SingleThreadTaskRunner> task_runner,
                      const GpuPreferences& gpu_preferences)
     : task_runner_(std::move(task_runner)),
       sync_point_manager_(sync_point_manager),
+      tick_clock_(base::DefaultTickClock::GetInstance()),
       blocked_time_collection_enabled_(
           gpu_preferences.enable_gpu_blocked_time_metric) {
   DCHECK(thread_checker_.CalledOnValidThread());
@@ -381,6 +394,17 @@ void Scheduler::ResetPriorityForClientWait(SequenceId sequence_id,
   sequence->RemoveClientWait(command_buffer_id);
 }
 
+void Scheduler::SetSequenceBudget(SequenceId sequence_id,
+                                  base::TimeDelta budget) {
+  base::AutoLock auto_lock(lock_);
+  Sequence* sequence = GetSequence(sequence_id);
+  DCHECK(sequence);
+  sequence->set_budget(budget);
+  // Whether the sequence is over budget may have changed.
+  if (sequence->scheduled())
+    rebuild_scheduling_queue_ = true;
+}
+
 void Scheduler::ScheduleTask(Task task) {
   base::AutoLock auto_lock(lock_);
   ScheduleTaskHelper(std::move(task));
@@ -437,6 +461,14 @@ bool Scheduler::ShouldYield(SequenceId sequence_id) {
   DCHECK(running_sequence);
   DCHECK(running_sequence->running());
 
+  // Account for the time the current task has run so far, so that a long
+  // task yields to sequences of the same priority once it exceeds its budget.
+  if (running_sequence->has_budget()) {
+    running_sequence->scheduling_state_.over_budget =
+        running_sequence->IsOverBudget(tick_clock_->NowTicks() -
+                                       task_start_time_);
+  }
+
   Sequence* next_sequence = GetSequence(scheduling_queue_.front().sequence_id);
   DCHECK(next_sequence);
   DCHECK(next_sequence->scheduled());
@@ -511,6 +543,16 @@ void Scheduler::RunNextTask() {
   DCHECK(thread_checker_.CalledOnValidThread());
   base::AutoLock auto_lock(lock_);
 
+  base::TimeTicks now = tick_clock_->NowTicks();
+  if (now - budget_window_start_ >= kBudgetWindow) {
+    budget_window_start_ = now;
+    for (const auto& kv : sequences_) {
+      // Sequences that were over budget move up in the scheduling queue.
+      if (kv.second->ResetBudget() && kv.second->scheduled())
+        rebuild_scheduling_queue_ = true;
+    }
+  }
+
   RebuildSchedulingQueue();
 
   if (scheduling_queue_.empty()) {
@@ -525,7 +567,7 @@ void Scheduler::RunNextTask() {
   scheduling_queue_.pop_back();
 
   TRACE_EVENT1("gpu", "Scheduler::RunNextTask", "state", state.AsValue());
-  base::ElapsedTimer task_timer;
+  task_start_time_ = now;
 
   Sequence* sequence = GetSequence(state.sequence_id);
   DCHECK(sequence);
@@ -563,10 +605,13 @@ void Scheduler::RunNextTask() {
       order_data->FinishProcessingOrderNumber(order_num);
   }
 
+  base::TimeDelta task_time = tick_clock_->NowTicks() - task_start_time_;
+
   // Check if sequence hasn't been destroyed.
   sequence = GetSequence(state.sequence_id);
   if (sequence) {
     sequence->FinishTask();
+    sequence->ChargeBudget(task_time);
     if (sequence->IsRunnable()) {
       SchedulingState scheduling_state = sequence->SetScheduled();
       scheduling_queue_.push_back(scheduling_state);
@@ -576,7 +621,7 @@ void Scheduler::RunNextTask() {
   }
 
   UMA_HISTOGRAM_CUSTOM_MICROSECONDS_TIMES(
-      "GPU.Scheduler.RunTaskTime", task_timer.Elapsed(),
+      "GPU.Scheduler.RunTaskTime", task_time,
       base::TimeDelta::FromMicroseconds(10), base::TimeDelta::FromSeconds(30),
       100);
 
@@ -584,6 +629,10 @@ void Scheduler::RunNextTask() {
                          base::BindOnce(&Scheduler::RunNextTask, weak_ptr_));
 }
 
+void Scheduler::SetTickClockForTesting(const base::TickClock* tick_clock) {
+  tick_clock_ = tick_clock;
+}
+
 base::TimeDelta Scheduler::TakeTotalBlockingTime() {
   if (!blocked_time_collection_enabled_ || !base::ThreadTicks::IsSupported())
     return base::TimeDelta::Min();
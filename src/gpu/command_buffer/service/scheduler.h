@@ -17,6 +17,7 @@
 #include "base/memory/weak_ptr.h"
 #include "base/synchronization/lock.h"
 #include "base/threading/thread_checker.h"
+#include "base/time/time.h"
 #include "gpu/command_buffer/common/command_buffer_id.h"
 #include "gpu/command_buffer/common/scheduling_priority.h"
 #include "gpu/command_buffer/common/sync_token.h"
@@ -25,6 +26,7 @@
 
 namespace base {
 class SingleThreadTaskRunner;
+class TickClock;
 namespace trace_event {
 class ConvertableToTraceFormat;
 }
@@ -49,6 +51,17 @@ class GPU_EXPORT Scheduler {
     std::vector<SyncToken> sync_token_fences;
   };
 
+  // Length of the window over which sequences' GPU thread time is budgeted,
+  // roughly one frame.
+  static constexpr base::TimeDelta kBudgetWindow =
+      base::TimeDelta::FromMilliseconds(16);
+
+  // Budget that GpuChannel gives its low and normal priority streams when the
+  // GpuSchedulerSequenceBudgets feature is enabled. Sequences are not limited
+  // unless SetSequenceBudget() is called.
+  static constexpr base::TimeDelta kStreamBudget =
+      base::TimeDelta::FromMilliseconds(8);
+
   Scheduler(scoped_refptr<base::SingleThreadTaskRunner> task_runner,
             SyncPointManager* sync_point_manager,
             const GpuPreferences& gpu_preferences);
@@ -80,6 +93,12 @@ class GPU_EXPORT Scheduler {
   void ResetPriorityForClientWait(SequenceId sequence_id,
                                   CommandBufferId command_buffer_id);
 
+  // Sets how much GPU thread time the sequence may use per |kBudgetWindow|.
+  // Once over budget, the sequence runs after and yields to sequences of the
+  // same priority that are still within theirs. Pass TimeDelta::Max() for no
+  // limit.
+  void SetSequenceBudget(SequenceId sequence_id, base::TimeDelta budget);
+
   // Schedules task (closure) to run on the sequence. The task is blocked until
   // the sync token fences are released or determined to be invalid. Tasks are
   // run in the order in which they are submitted.
@@ -101,6 +120,8 @@ class GPU_EXPORT Scheduler {
   // Returns TimeDelta::Min() when not available.
   base::TimeDelta TakeTotalBlockingTime();
 
+  void SetTickClockForTesting(const base::TickClock* tick_clock);
+
  private:
 
   struct SchedulingState {
@@ -114,8 +135,8 @@ class GPU_EXPORT Scheduler {
     ~SchedulingState();
 
     bool RunsBefore(const SchedulingState& other) const {
-      return std::tie(priority, order_num) <
-             std::tie(other.priority, other.order_num);
+      return std::tie(priority, over_budget, order_num) <
+             std::tie(other.priority, other.over_budget, other.order_num);
     }
 
     std::unique_ptr<base::trace_event::ConvertableToTraceFormat> AsValue()
@@ -123,6 +144,8 @@ class GPU_EXPORT Scheduler {
 
     SequenceId sequence_id;
     SchedulingPriority priority = SchedulingPriority::kLow;
+    // Sequences that used up their budget run after those that haven't.
+    bool over_budget = false;
     uint32_t order_num = 0;
   };
 
@@ -169,6 +192,23 @@ class GPU_EXPORT Scheduler {
     // Update cached scheduling priority while running.
     void UpdateRunningPriority();
 
+    void set_budget(base::TimeDelta budget) { budget_ = budget; }
+
+    // Charges GPU thread time to the current budget window.
+    void ChargeBudget(base::TimeDelta elapsed) { budget_used_ += elapsed; }
+
+    // Starts a new budget window. Returns true if the sequence was over
+    // budget.
+    bool ResetBudget();
+
+    // Returns true if the sequence used up its budget, counting
+    // |running_time| of the current task.
+    bool IsOverBudget(base::TimeDelta running_time) const {
+      return budget_used_ + running_time >= budget_;
+    }
+
+    bool has_budget() const { return !budget_.is_max(); }
+
     // Returns the next order number and closure. Sets running state to RUNNING.
     uint32_t BeginTask(base::OnceClosure* closure);
 
@@ -289,6 +329,11 @@ class GPU_EXPORT Scheduler {
 
     scoped_refptr<SyncPointOrderData> order_data_;
 
+    // GPU thread time the sequence may use, and has used, in the current
+    // budget window.
+    base::TimeDelta budget_ = base::TimeDelta::Max();
+    base::TimeDelta budget_used_;
+
     // Deque of tasks. Tasks are inserted at the back with increasing order
     // number generated from SyncPointOrderData. If a running task needs to be
     // continued, it is inserted at the front with the same order number.
@@ -343,6 +388,12 @@ class GPU_EXPORT Scheduler {
   // priority.
   bool rebuild_scheduling_queue_ = false;
 
+  const base::TickClock* tick_clock_;
+
+  // Start of the current budget window, and of the running task.
+  base::TimeTicks budget_window_start_;
+  base::TimeTicks task_start_time_;
+
   // Accumulated time the thread was blocked during running task
   base::TimeDelta total_blocked_time_;
   const bool blocked_time_collection_enabled_;
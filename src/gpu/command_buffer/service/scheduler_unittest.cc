@@ -5,8 +5,10 @@
 #include "gpu/command_buffer/service/scheduler.h"
 
 #include <algorithm>
+#include <memory>
 
 #include "base/bind.h"
+#include "base/test/simple_test_tick_clock.h"
 #include "base/test/test_simple_task_runner.h"
 #include "gpu/command_buffer/service/sync_point_manager.h"
 #include "gpu/config/gpu_preferences.h"
@@ -32,11 +34,18 @@ class SchedulerTest : public testing::Test {
         sync_point_manager_(new SyncPointManager),
         scheduler_(new Scheduler(task_runner_,
                                  sync_point_manager_.get(),
-                                 GpuPreferences())) {}
+                                 GpuPreferences())) {
+    // Task run times are simulated so that budgets don't depend on how fast
+    // the tests run.
+    tick_clock_.SetNowTicks(base::TimeTicks::Now());
+    scheduler_->SetTickClockForTesting(&tick_clock_);
+  }
 
  protected:
   base::TestSimpleTaskRunner* task_runner() const { return task_runner_.get(); }
 
+  base::SimpleTestTickClock* tick_clock() { return &tick_clock_; }
+
   SyncPointManager* sync_point_manager() const {
     return sync_point_manager_.get();
   }
@@ -46,6 +55,7 @@ class SchedulerTest : public testing::Test {
  private:
   scoped_refptr<base::TestSimpleTaskRunner> task_runner_;
   std::unique_ptr<SyncPointManager> sync_point_manager_;
+  base::SimpleTestTickClock tick_clock_;
   std::unique_ptr<Scheduler> scheduler_;
 };
 
@@ -588,6 +598,101 @@ TEST_F(SchedulerTest, ClientWaitIsPrioritized) {
   EXPECT_TRUE(ran2);
 }
 
+TEST_F(SchedulerTest, SequenceOverBudgetRunsLast) {
+  SequenceId sequence_id1 =
+      scheduler()->CreateSequence(SchedulingPriority::kNormal);
+  SequenceId sequence_id2 =
+      scheduler()->CreateSequence(SchedulingPriority::kNormal);
+  scheduler()->SetSequenceBudget(sequence_id1,
+                                 base::TimeDelta::FromMilliseconds(4));
+
+  // Tasks on sequence 1 exceed its budget.
+  std::vector<int> tasks_executed;
+  auto schedule_task = [&](SequenceId sequence_id, int id) {
+    auto closure = GetClosure([this, &tasks_executed, id] {
+      tick_clock()->Advance(base::TimeDelta::FromMilliseconds(5));
+      tasks_executed.push_back(id);
+    });
+    scheduler()->ScheduleTask(Scheduler::Task(sequence_id, std::move(closure),
+                                              std::vector<SyncToken>()));
+  };
+  schedule_task(sequence_id1, 1);
+  schedule_task(sequence_id1, 2);
+  schedule_task(sequence_id2, 3);
+  schedule_task(sequence_id2, 4);
+
+  while (task_runner()->HasPendingTask())
+    task_runner()->RunPendingTasks();
+
+  // Task 2 runs after sequence 2, which isn't limited.
+  const int expected_task_order[] = {1, 3, 4, 2};
+  EXPECT_THAT(tasks_executed, testing::ElementsAreArray(expected_task_order));
+
+  // The budget is restored in the next window.
+  tasks_executed.clear();
+  tick_clock()->Advance(Scheduler::kBudgetWindow);
+  schedule_task(sequence_id1, 5);
+  schedule_task(sequence_id2, 6);
+  while (task_runner()->HasPendingTask())
+    task_runner()->RunPendingTasks();
+
+  const int expected_task_order2[] = {5, 6};
+  EXPECT_THAT(tasks_executed, testing::ElementsAreArray(expected_task_order2));
+
+  scheduler()->DestroySequence(sequence_id1);
+  scheduler()->DestroySequence(sequence_id2);
+}
+
+TEST_F(SchedulerTest, ShouldYieldWhenOverBudget) {
+  SequenceId sequence_id1 =
+      scheduler()->CreateSequence(SchedulingPriority::kNormal);
+  SequenceId sequence_id2 =
+      scheduler()->CreateSequence(SchedulingPriority::kNormal);
+  scheduler()->SetSequenceBudget(sequence_id1, Scheduler::kStreamBudget);
+
+  bool ran1 = false;
+  scheduler()->ScheduleTask(Scheduler::Task(
+      sequence_id1, GetClosure([&] {
+        scheduler()->ScheduleTask(Scheduler::Task(
+            sequence_id2, base::DoNothing(), std::vector<SyncToken>()));
+        EXPECT_FALSE(scheduler()->ShouldYield(sequence_id1));
+        tick_clock()->Advance(Scheduler::kStreamBudget);
+        EXPECT_TRUE(scheduler()->ShouldYield(sequence_id1));
+        ran1 = true;
+      }),
+      std::vector<SyncToken>()));
+
+  task_runner()->RunPendingTasks();
+  EXPECT_TRUE(ran1);
+
+  scheduler()->DestroySequence(sequence_id1);
+  scheduler()->DestroySequence(sequence_id2);
+}
+
+TEST_F(SchedulerTest, NoBudgetByDefault) {
+  SequenceId sequence_id1 =
+      scheduler()->CreateSequence(SchedulingPriority::kNormal);
+  SequenceId sequence_id2 =
+      scheduler()->CreateSequence(SchedulingPriority::kNormal);
+
+  bool ran1 = false;
+  scheduler()->ScheduleTask(Scheduler::Task(
+      sequence_id1, GetClosure([&] {
+        scheduler()->ScheduleTask(Scheduler::Task(
+            sequence_id2, base::DoNothing(), std::vector<SyncToken>()));
+        tick_clock()->Advance(Scheduler::kBudgetWindow);
+        EXPECT_FALSE(scheduler()->ShouldYield(sequence_id1));
+        ran1 = true;
+      }),
+      std::vector<SyncToken>()));
+
+  task_runner()->RunPendingTasks();
+  EXPECT_TRUE(ran1);
+
+  scheduler()->DestroySequence(sequence_id1);
+  scheduler()->DestroySequence(sequence_id2);
+}
+
 TEST_F(SchedulerTest, StreamPriorities) {
   SequenceId seq_id1 = scheduler()->CreateSequence(SchedulingPriority::kLow);
   SequenceId seq_id2 = scheduler()->CreateSequence(SchedulingPriority::kNormal);
@@ -6,10 +6,12 @@
 
 #include <inttypes.h>
 
+#include <algorithm>
 #include <utility>
 
 #include "base/auto_reset.h"
 #include "base/bind.h"
+#include "base/stl_util.h"
 #include "base/strings/stringprintf.h"
 #include "base/system/sys_info.h"
 #include "base/threading/thread_task_runner_handle.h"
@@ -28,6 +30,20 @@ namespace {
 // unbounded handle growth with tiny entries.
 static size_t kMaxCacheEntries = 2000;
 
+// Share of the cache size limit, in sixteenths, reserved for entries of each
+// type. Images make up most of the cache and have no reserve, so that a few
+// large images can't evict every shader and path.
+constexpr size_t kReservedSixteenths[] = {
+    2,  // kRawMemory
+    0,  // kImage
+    2,  // kShader
+    4,  // kSkottie
+};
+static_assert(
+    base::size(kReservedSixteenths) ==
+        static_cast<size_t>(cc::TransferCacheEntryType::kLast) + 1,
+    "Update kReservedSixteenths for the new entry type.");
+
 // Alias the image entry to its skia counterpart, taking ownership of the
 // memory and preventing double counting.
 //
@@ -130,9 +146,10 @@ ServiceTransferCache::CacheEntryInternal&
 ServiceTransferCache::CacheEntryInternal::operator=(
     CacheEntryInternal&& other) = default;
 
+constexpr size_t ServiceTransferCache::kNumEntryTypes;
+
 ServiceTransferCache::ServiceTransferCache(const GpuPreferences& preferences)
-    : entries_(EntryCache::NO_AUTO_EVICT),
-      cache_size_limit_(preferences.force_gpu_mem_discardable_limit_bytes
+    : cache_size_limit_(preferences.force_gpu_mem_discardable_limit_bytes
                             ? preferences.force_gpu_mem_discardable_limit_bytes
                             : DiscardableCacheSizeLimit()),
       max_cache_entries_(kMaxCacheEntries) {
@@ -153,7 +170,7 @@ bool ServiceTransferCache::CreateLockedEntry(const EntryKey& key,
                                              ServiceDiscardableHandle handle,
                                              GrDirectContext* context,
                                              base::span<uint8_t> data) {
-  auto found = entries_.Peek(key);
+  auto found = entries_.find(key);
   if (found != entries_.end())
     return false;
 
@@ -165,13 +182,7 @@ bool ServiceTransferCache::CreateLockedEntry(const EntryKey& key,
   if (!entry->Deserialize(context, data))
     return false;
 
-  total_size_ += entry->CachedSize();
-  if (key.entry_type == cc::TransferCacheEntryType::kImage) {
-    total_image_count_++;
-    total_image_size_ += entry->CachedSize();
-  }
-  entries_.Put(key, CacheEntryInternal(handle, std::move(entry)));
-  EnforceLimits();
+  AddEntry(key, CacheEntryInternal(handle, std::move(entry)));
   return true;
 }
 
@@ -184,18 +195,37 @@ void ServiceTransferCache::CreateLocalEntry(
   DCHECK_EQ(entry->Type(), key.entry_type);
   DeleteEntry(key);
 
-  total_size_ += entry->CachedSize();
-  if (key.entry_type == cc::TransferCacheEntryType::kImage) {
+  AddEntry(key, CacheEntryInternal(base::nullopt, std::move(entry)));
+}
+
+void ServiceTransferCache::AddEntry(const EntryKey& key,
+                                    CacheEntryInternal entry) {
+  entry.size = entry.entry->CachedSize();
+  total_size_ += entry.size;
+  type_sizes_[static_cast<size_t>(key.entry_type)] += entry.size;
+  if (key.entry_type == cc::TransferCacheEntryType::kImage)
     total_image_count_++;
-    total_image_size_ += entry->CachedSize();
-  }
 
-  entries_.Put(key, CacheEntryInternal(base::nullopt, std::move(entry)));
-  EnforceLimits();
+  auto result = entries_.emplace(key, std::move(entry));
+  DCHECK(result.second);
+  UpdatePriority(result.first);
+  EnforceLimits(&result.first->second);
+}
+
+void ServiceTransferCache::UpdatePriority(EntryMap::iterator it) {
+  CacheEntryInternal& entry = it->second;
+  eviction_queue_.erase({entry.priority, entry.last_use, it->first});
+
+  // Entries are considered equally costly to recreate, so the priority only
+  // depends on how often each byte of the entry is used.
+  entry.priority = eviction_clock_ + static_cast<double>(entry.hit_count) /
+                                         std::max<size_t>(entry.size, 1u);
+  entry.last_use = next_use_++;
+  eviction_queue_.insert({entry.priority, entry.last_use, it->first});
 }
 
 bool ServiceTransferCache::UnlockEntry(const EntryKey& key) {
-  auto found = entries_.Peek(key);
+  auto found = entries_.find(key);
   if (found == entries_.end())
     return false;
 
@@ -205,22 +235,30 @@ bool ServiceTransferCache::UnlockEntry(const EntryKey& key) {
   return true;
 }
 
-template <typename Iterator>
-Iterator ServiceTransferCache::ForceDeleteEntry(Iterator it) {
+ServiceTransferCache::EntryMap::iterator ServiceTransferCache::EraseEntry(
+    EntryMap::iterator it) {
+  const CacheEntryInternal& entry = it->second;
+  eviction_queue_.erase({entry.priority, entry.last_use, it->first});
+
+  size_t& type_size = type_sizes_[static_cast<size_t>(it->first.entry_type)];
+  DCHECK_GE(total_size_, entry.size);
+  DCHECK_GE(type_size, entry.size);
+  total_size_ -= entry.size;
+  type_size -= entry.size;
+  if (it->first.entry_type == cc::TransferCacheEntryType::kImage)
+    total_image_count_--;
+  return entries_.erase(it);
+}
+
+ServiceTransferCache::EntryMap::iterator ServiceTransferCache::ForceDeleteEntry(
+    EntryMap::iterator it) {
   if (it->second.handle)
     it->second.handle->ForceDelete();
-
-  DCHECK_GE(total_size_, it->second.entry->CachedSize());
-  total_size_ -= it->second.entry->CachedSize();
-  if (it->first.entry_type == cc::TransferCacheEntryType::kImage) {
-    total_image_count_--;
-    total_image_size_ -= it->second.entry->CachedSize();
-  }
-  return entries_.Erase(it);
+  return EraseEntry(it);
 }
 
 bool ServiceTransferCache::DeleteEntry(const EntryKey& key) {
-  auto found = entries_.Peek(key);
+  auto found = entries_.find(key);
   if (found == entries_.end())
     return false;
 
@@ -230,29 +268,50 @@ bool ServiceTransferCache::DeleteEntry(const EntryKey& key) {
 
 cc::ServiceTransferCacheEntry* ServiceTransferCache::GetEntry(
     const EntryKey& key) {
-  auto found = entries_.Get(key);
+  auto found = entries_.find(key);
   if (found == entries_.end())
     return nullptr;
+  found->second.hit_count++;
+  UpdatePriority(found);
   return found->second.entry.get();
 }
 
-void ServiceTransferCache::EnforceLimits() {
-  for (auto it = entries_.rbegin(); it != entries_.rend();) {
-    if (total_size_ <= cache_size_limit_ &&
-        entries_.size() <= max_cache_entries_) {
-      return;
-    }
-    if (it->second.handle && !it->second.handle->Delete()) {
-      ++it;
-      continue;
-    }
+bool ServiceTransferCache::IsOverReservedSize(
+    cc::TransferCacheEntryType type,
+    size_t cache_size_limit) const {
+  size_t index = static_cast<size_t>(type);
+  return type_sizes_[index] >
+         cache_size_limit / 16 * kReservedSixteenths[index];
+}
 
-    total_size_ -= it->second.entry->CachedSize();
-    if (it->first.entry_type == cc::TransferCacheEntryType::kImage) {
-      total_image_count_--;
-      total_image_size_ -= it->second.entry->CachedSize();
+void ServiceTransferCache::EnforceLimits(
+    const CacheEntryInternal* new_entry) {
+  // Evict from types using more than their reserved share first, and only
+  // then from types within their reserve.
+  for (bool keep_reserved : {true, false}) {
+    for (auto it = eviction_queue_.begin(); it != eviction_queue_.end();) {
+      if (total_size_ <= cache_size_limit_ &&
+          entries_.size() <= max_cache_entries_) {
+        return;
+      }
+      if (keep_reserved &&
+          !IsOverReservedSize(it->key.entry_type, cache_size_limit_)) {
+        ++it;
+        continue;
+      }
+      auto found = entries_.find(it->key);
+      DCHECK(found != entries_.end());
+      if (&found->second == new_entry ||
+          (found->second.handle && !found->second.handle->Delete())) {
+        ++it;
+        continue;
+      }
+
+      eviction_clock_ = std::max(eviction_clock_, it->priority);
+      // Erasing the entry also removes it from |eviction_queue_|.
+      ++it;
+      EraseEntry(found);
     }
-    it = entries_.Erase(it);
   }
 }
 
@@ -265,7 +324,7 @@ void ServiceTransferCache::PurgeMemory(
 }
 
 void ServiceTransferCache::DeleteAllEntriesForDecoder(int decoder_id) {
-  for (auto it = entries_.rbegin(); it != entries_.rend();) {
+  for (auto it = entries_.begin(); it != entries_.end();) {
     if (it->first.decoder_id != decoder_id) {
       ++it;
       continue;
@@ -285,7 +344,7 @@ bool ServiceTransferCache::CreateLockedHardwareDecodedImageEntry(
     size_t buffer_byte_size,
     bool needs_mips) {
   EntryKey key(decoder_id, cc::TransferCacheEntryType::kImage, entry_id);
-  auto found = entries_.Peek(key);
+  auto found = entries_.find(key);
   if (found != entries_.end())
     return false;
 
@@ -298,13 +357,7 @@ bool ServiceTransferCache::CreateLockedHardwareDecodedImageEntry(
   }
 
   // Insert it in the transfer cache.
-  total_size_ += entry->CachedSize();
-  if (key.entry_type == cc::TransferCacheEntryType::kImage) {
-    total_image_count_++;
-    total_image_size_ += entry->CachedSize();
-  }
-  entries_.Put(key, CacheEntryInternal(handle, std::move(entry)));
-  EnforceLimits();
+  AddEntry(key, CacheEntryInternal(handle, std::move(entry)));
   return true;
 }
 
@@ -314,19 +367,21 @@ bool ServiceTransferCache::OnMemoryDump(
   using base::trace_event::MemoryAllocatorDump;
   using base::trace_event::MemoryDumpLevelOfDetail;
 
+  const size_t total_image_size =
+      type_sizes_[static_cast<size_t>(cc::TransferCacheEntryType::kImage)];
   if (args.level_of_detail == MemoryDumpLevelOfDetail::BACKGROUND) {
     std::string dump_name =
         base::StringPrintf("gpu/transfer_cache/cache_0x%" PRIXPTR,
                            reinterpret_cast<uintptr_t>(this));
     MemoryAllocatorDump* dump = pmd->CreateAllocatorDump(dump_name);
     dump->AddScalar(MemoryAllocatorDump::kNameSize,
-                    MemoryAllocatorDump::kUnitsBytes, total_image_size_);
+                    MemoryAllocatorDump::kUnitsBytes, total_image_size);
 
     if (total_image_count_ > 0) {
       MemoryAllocatorDump* dump_avg_size =
           pmd->CreateAllocatorDump(dump_name + "/avg_image_size");
       const size_t avg_image_size =
-          total_image_size_ / (total_image_count_ * 1.0);
+          total_image_size / (total_image_count_ * 1.0);
       dump_avg_size->AddScalar("average_size", MemoryAllocatorDump::kUnitsBytes,
                                avg_image_size);
     }
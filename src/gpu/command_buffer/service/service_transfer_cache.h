@@ -8,10 +8,11 @@
 #include <stddef.h>
 #include <stdint.h>
 
+#include <map>
 #include <memory>
+#include <set>
 #include <vector>
 
-#include "base/containers/mru_cache.h"
 #include "base/containers/span.h"
 #include "base/memory/memory_pressure_listener.h"
 #include "cc/paint/image_transfer_cache_entry.h"
@@ -36,6 +37,13 @@ namespace gpu {
 // unlocking and deleting entries when no longer needed, as well as enforcing
 // cache limits. If the cache exceeds its specified limits, unlocked transfer
 // cache entries may be deleted.
+//
+// Entries are evicted in Greedy-Dual-Size-Frequency order: an entry's priority
+// is its hit count divided by its size, plus the priority of the last evicted
+// entry so that entries which stop being used eventually age out. This keeps
+// small, frequently used entries such as shaders over large images. Each
+// non-image entry type also has a share of the cache reserved for it, which
+// other types can't evict it from.
 class GPU_GLES2_EXPORT ServiceTransferCache
     : public base::trace_event::MemoryDumpProvider {
  public:
@@ -96,6 +104,9 @@ class GPU_GLES2_EXPORT ServiceTransferCache
     EnforceLimits();
   }
   size_t cache_size_for_testing() const { return total_size_; }
+  size_t cache_size_for_testing(cc::TransferCacheEntryType type) const {
+    return type_sizes_[static_cast<size_t>(type)];
+  }
   size_t entries_count_for_testing() const { return entries_.size(); }
 
  private:
@@ -107,6 +118,13 @@ class GPU_GLES2_EXPORT ServiceTransferCache
     ~CacheEntryInternal();
     base::Optional<ServiceDiscardableHandle> handle;
     std::unique_ptr<cc::ServiceTransferCacheEntry> entry;
+    // Size of |entry| when it was added, used for bookkeeping.
+    size_t size = 0;
+    // Number of times the entry was used, including its creation.
+    uint32_t hit_count = 1;
+    // The entry's position in |eviction_queue_|.
+    double priority = 0;
+    uint64_t last_use = 0;
   };
 
   struct EntryKeyComp {
@@ -119,22 +137,63 @@ class GPU_GLES2_EXPORT ServiceTransferCache
     }
   };
 
-  using EntryCache = base::MRUCache<EntryKey, CacheEntryInternal, EntryKeyComp>;
+  using EntryMap = std::map<EntryKey, CacheEntryInternal, EntryKeyComp>;
+
+  // Orders entries from the first to the last to be evicted. Entries with
+  // equal priority are evicted least recently used first.
+  struct EvictionKey {
+    double priority;
+    uint64_t last_use;
+    EntryKey key;
+  };
+  struct EvictionKeyComp {
+    bool operator()(const EvictionKey& lhs, const EvictionKey& rhs) const {
+      if (lhs.priority != rhs.priority)
+        return lhs.priority < rhs.priority;
+      if (lhs.last_use != rhs.last_use)
+        return lhs.last_use < rhs.last_use;
+      return EntryKeyComp()(lhs.key, rhs.key);
+    }
+  };
+
+  static constexpr size_t kNumEntryTypes =
+      static_cast<size_t>(cc::TransferCacheEntryType::kLast) + 1;
+
+  void AddEntry(const EntryKey& key, CacheEntryInternal entry);
+
+  // Recomputes the eviction priority of the entry at |it| after a use.
+  void UpdatePriority(EntryMap::iterator it);
+
+  // Removes the entry at |it| without touching its handle.
+  EntryMap::iterator EraseEntry(EntryMap::iterator it);
+
+  EntryMap::iterator ForceDeleteEntry(EntryMap::iterator it);
+
+  // Returns true if entries of |type| use more than the share of
+  // |cache_size_limit| reserved for them, so they may be evicted in favor of
+  // other types.
+  bool IsOverReservedSize(cc::TransferCacheEntryType type,
+                          size_t cache_size_limit) const;
 
-  void EnforceLimits();
+  // Evicts entries until the cache is within its limits. |new_entry|, if
+  // given, was just added and is not evicted.
+  void EnforceLimits(const CacheEntryInternal* new_entry = nullptr);
 
-  template <typename Iterator>
-  Iterator ForceDeleteEntry(Iterator it);
+  EntryMap entries_;
+  std::set<EvictionKey, EvictionKeyComp> eviction_queue_;
 
-  EntryCache entries_;
+  // Priority of the last evicted entry, added to the priority of entries as
+  // they are used.
+  double eviction_clock_ = 0;
+  uint64_t next_use_ = 0;
 
   // Total size of all |entries_|. The same as summing
   // GpuDiscardableEntry::size for each entry.
   size_t total_size_ = 0;
-  // Total size of all |entries_| of TransferCacheEntryType::kImage.
-  size_t total_image_size_ = 0;
   // Number of |entries_| of TransferCacheEntryType::kImage.
   int total_image_count_ = 0;
+  // Total size of |entries_| of each type.
+  size_t type_sizes_[kNumEntryTypes] = {};
 
   // The limit above which the cache will start evicting resources.
   size_t cache_size_limit_;
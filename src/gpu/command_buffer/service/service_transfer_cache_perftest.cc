@@ -0,0 +1,120 @@
+// Copyright 2020 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <cmath>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "base/timer/elapsed_timer.h"
+#include "gpu/command_buffer/service/service_transfer_cache.h"
+#include "gpu/command_buffer/service/test_service_transfer_cache_entry.h"
+#include "gpu/config/gpu_preferences.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "testing/perf/perf_result_reporter.h"
+
+namespace gpu {
+namespace {
+
+constexpr int kDecoderId = 1;
+constexpr size_t kCacheSizeLimit = 64 * 1024 * 1024;
+constexpr int kFrames = 2000;
+constexpr int kLookupsPerFrame = 100;
+
+// A population of entries of one type, with sizes spread log-uniformly
+// between |min_size| and |max_size|.
+struct EntrySet {
+  EntrySet(cc::TransferCacheEntryType type,
+           const char* name,
+           size_t count,
+           size_t min_size,
+           size_t max_size,
+           std::mt19937* generator)
+      : type(type), name(name) {
+    std::uniform_real_distribution<double> distribution(std::log(min_size),
+                                                        std::log(max_size));
+    for (size_t i = 0; i < count; ++i)
+      sizes.push_back(static_cast<size_t>(std::exp(distribution(*generator))));
+  }
+
+  const cc::TransferCacheEntryType type;
+  const char* const name;
+  std::vector<size_t> sizes;
+  int lookups = 0;
+  int hits = 0;
+};
+
+// Replays raster lookups of images, shaders and paths (raw memory), where a
+// few entries of each type are used on most frames and the rest rarely, as on
+// a page that scrolls. Entries that miss are recreated, as a client would
+// upload them again.
+TEST(ServiceTransferCachePerfTest, ReplayEntryMix) {
+  std::mt19937 generator(0);
+  std::vector<EntrySet> sets;
+  sets.emplace_back(cc::TransferCacheEntryType::kImage, "image", 400,
+                    64 * 1024, 4 * 1024 * 1024, &generator);
+  sets.emplace_back(cc::TransferCacheEntryType::kShader, "shader", 300, 512,
+                    4 * 1024, &generator);
+  sets.emplace_back(cc::TransferCacheEntryType::kRawMemory, "path", 300,
+                    4 * 1024, 32 * 1024, &generator);
+  // Lookups per type, in percent.
+  const int kTypeMix[] = {40, 40, 20};
+
+  ServiceTransferCache cache{GpuPreferences()};
+  cache.SetCacheSizeLimitForTesting(kCacheSizeLimit);
+
+  std::uniform_int_distribution<int> type_distribution(0, 99);
+  std::uniform_real_distribution<double> skew_distribution(0.0, 1.0);
+  base::ElapsedTimer timer;
+  for (int frame = 0; frame < kFrames; ++frame) {
+    for (int i = 0; i < kLookupsPerFrame; ++i) {
+      int type_percentile = type_distribution(generator);
+      size_t set_index = 0;
+      while (type_percentile >= kTypeMix[set_index])
+        type_percentile -= kTypeMix[set_index++];
+      EntrySet& set = sets[set_index];
+
+      // Cubing skews lookups towards the first entries of the set.
+      double skew = skew_distribution(generator);
+      uint32_t entry_id =
+          static_cast<uint32_t>(set.sizes.size() * skew * skew * skew);
+
+      ServiceTransferCache::EntryKey key(kDecoderId, set.type, entry_id);
+      set.lookups++;
+      if (cache.GetEntry(key)) {
+        set.hits++;
+        continue;
+      }
+      cache.CreateLocalEntry(
+          key, std::make_unique<TestServiceTransferCacheEntry>(
+              set.type, set.sizes[entry_id]));
+    }
+  }
+  base::TimeDelta elapsed = timer.Elapsed();
+
+  perf_test::PerfResultReporter reporter("ServiceTransferCache",
+                                         "replay_entry_mix");
+  int total_lookups = 0;
+  int total_hits = 0;
+  for (const EntrySet& set : sets) {
+    std::string metric = std::string("_hit_rate_") + set.name;
+    reporter.RegisterImportantMetric(metric, "%");
+    reporter.AddResult(metric, 100.0 * set.hits / set.lookups);
+    total_lookups += set.lookups;
+    total_hits += set.hits;
+  }
+  reporter.RegisterImportantMetric("_hit_rate", "%");
+  reporter.AddResult("_hit_rate", 100.0 * total_hits / total_lookups);
+  reporter.RegisterImportantMetric("_time_per_lookup", "ns");
+  double time_per_lookup =
+      static_cast<double>(elapsed.InNanoseconds()) / total_lookups;
+  reporter.AddResult("_time_per_lookup", time_per_lookup);
+}
+
+}  // namespace
+}  // namespace gpu
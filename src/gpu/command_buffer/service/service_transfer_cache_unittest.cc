@@ -5,6 +5,7 @@
 #include "gpu/command_buffer/service/service_transfer_cache.h"
 
 #include "cc/paint/raw_memory_transfer_cache_entry.h"
+#include "gpu/command_buffer/service/test_service_transfer_cache_entry.h"
 #include "gpu/config/gpu_preferences.h"
 #include "testing/gtest/include/gtest/gtest.h"
 
@@ -21,6 +22,22 @@ std::unique_ptr<cc::ServiceTransferCacheEntry> CreateEntry(size_t size) {
   return entry;
 }
 
+void CreateFakeEntry(ServiceTransferCache* cache,
+                     cc::TransferCacheEntryType type,
+                     uint32_t entry_id,
+                     size_t size) {
+  cache->CreateLocalEntry(
+      ServiceTransferCache::EntryKey(kDecoderId, type, entry_id),
+      std::make_unique<TestServiceTransferCacheEntry>(type, size));
+}
+
+bool HasEntry(ServiceTransferCache* cache,
+              cc::TransferCacheEntryType type,
+              uint32_t entry_id) {
+  return cache->GetEntry(ServiceTransferCache::EntryKey(kDecoderId, type,
+                                                        entry_id)) != nullptr;
+}
+
 TEST(ServiceTransferCacheTest, EnforcesOnPurgeMemory) {
   ServiceTransferCache cache{GpuPreferences()};
   uint32_t entry_id = 0u;
@@ -112,5 +129,84 @@ TEST(ServiceTransferCache, DeleteEntriesForDecoder) {
             nullptr);
 }
 
+TEST(ServiceTransferCacheTest, EvictsLargeEntriesFirst) {
+  ServiceTransferCache cache{GpuPreferences()};
+  cache.SetCacheSizeLimitForTesting(10000u);
+
+  // The small entry is the oldest, but the least valuable per byte is the
+  // oldest large one.
+  CreateFakeEntry(&cache, kEntryType, 1, 100u);
+  CreateFakeEntry(&cache, kEntryType, 2, 4000u);
+  CreateFakeEntry(&cache, kEntryType, 3, 4000u);
+  CreateFakeEntry(&cache, kEntryType, 4, 4000u);
+
+  EXPECT_EQ(cache.cache_size_for_testing(), 8100u);
+  EXPECT_TRUE(HasEntry(&cache, kEntryType, 1));
+  EXPECT_FALSE(HasEntry(&cache, kEntryType, 2));
+  EXPECT_TRUE(HasEntry(&cache, kEntryType, 3));
+  EXPECT_TRUE(HasEntry(&cache, kEntryType, 4));
+}
+
+TEST(ServiceTransferCacheTest, KeepsFrequentlyUsedEntries) {
+  ServiceTransferCache cache{GpuPreferences()};
+  const size_t entry_size = 1024u;
+  cache.SetCacheSizeLimitForTesting(4 * entry_size);
+
+  for (uint32_t i = 1; i <= 4; i++)
+    CreateFakeEntry(&cache, kEntryType, i, entry_size);
+  EXPECT_TRUE(HasEntry(&cache, kEntryType, 1));
+  EXPECT_TRUE(HasEntry(&cache, kEntryType, 1));
+
+  // Entry 2 is the least used.
+  CreateFakeEntry(&cache, kEntryType, 5, entry_size);
+  EXPECT_EQ(cache.entries_count_for_testing(), 4u);
+  EXPECT_TRUE(HasEntry(&cache, kEntryType, 1));
+  EXPECT_FALSE(HasEntry(&cache, kEntryType, 2));
+}
+
+TEST(ServiceTransferCacheTest, UnusedEntriesAgeOut) {
+  ServiceTransferCache cache{GpuPreferences()};
+  const size_t entry_size = 1024u;
+  cache.SetCacheSizeLimitForTesting(2 * entry_size);
+
+  CreateFakeEntry(&cache, kEntryType, 1, entry_size);
+  for (int i = 0; i < 3; i++)
+    EXPECT_TRUE(HasEntry(&cache, kEntryType, 1));
+
+  // Entry 1 was used more than any other, but not since entries started being
+  // evicted, which raises the priority of entries used afterwards.
+  for (uint32_t i = 2; i <= 5; i++) {
+    CreateFakeEntry(&cache, kEntryType, i, entry_size);
+    EXPECT_TRUE(HasEntry(&cache, kEntryType, i));
+  }
+  EXPECT_EQ(cache.entries_count_for_testing(), 2u);
+  EXPECT_FALSE(HasEntry(&cache, kEntryType, 1));
+}
+
+TEST(ServiceTransferCacheTest, ImagesDoNotEvictReservedShaders) {
+  ServiceTransferCache cache{GpuPreferences()};
+  const size_t entry_size = 1024u;
+  cache.SetCacheSizeLimitForTesting(16 * entry_size);
+
+  // Two shaders fit in the share of the cache reserved for shaders.
+  CreateFakeEntry(&cache, cc::TransferCacheEntryType::kShader, 1, entry_size);
+  CreateFakeEntry(&cache, cc::TransferCacheEntryType::kShader, 2, entry_size);
+  for (uint32_t i = 1; i <= 16; i++) {
+    CreateFakeEntry(&cache, cc::TransferCacheEntryType::kImage, i,
+                    entry_size);
+  }
+
+  EXPECT_EQ(cache.cache_size_for_testing(), 16 * entry_size);
+  EXPECT_EQ(cache.cache_size_for_testing(cc::TransferCacheEntryType::kShader),
+            2 * entry_size);
+  EXPECT_EQ(cache.cache_size_for_testing(cc::TransferCacheEntryType::kImage),
+            14 * entry_size);
+
+  // The reserve doesn't apply under critical memory pressure.
+  cache.PurgeMemory(
+      base::MemoryPressureListener::MEMORY_PRESSURE_LEVEL_CRITICAL);
+  EXPECT_EQ(cache.cache_size_for_testing(), 0u);
+}
+
 }  // namespace
 }  // namespace gpu
@@ -0,0 +1,30 @@
+// Copyright 2020 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "gpu/command_buffer/service/test_service_transfer_cache_entry.h"
+
+namespace gpu {
+
+TestServiceTransferCacheEntry::TestServiceTransferCacheEntry(
+    cc::TransferCacheEntryType type,
+    size_t size)
+    : type_(type), size_(size) {}
+
+TestServiceTransferCacheEntry::~TestServiceTransferCacheEntry() = default;
+
+cc::TransferCacheEntryType TestServiceTransferCacheEntry::Type() const {
+  return type_;
+}
+
+size_t TestServiceTransferCacheEntry::CachedSize() const {
+  return size_;
+}
+
+bool TestServiceTransferCacheEntry::Deserialize(
+    GrDirectContext* context,
+    base::span<const uint8_t> data) {
+  return true;
+}
+
+}  // namespace gpu
@@ -0,0 +1,37 @@
+// Copyright 2020 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef GPU_COMMAND_BUFFER_SERVICE_TEST_SERVICE_TRANSFER_CACHE_ENTRY_H_
+#define GPU_COMMAND_BUFFER_SERVICE_TEST_SERVICE_TRANSFER_CACHE_ENTRY_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "base/macros.h"
+#include "cc/paint/transfer_cache_entry.h"
+
+namespace gpu {
+
+// Test implementation of a transfer cache entry of any type, which holds no
+// data but reports the given size.
+class TestServiceTransferCacheEntry : public cc::ServiceTransferCacheEntry {
+ public:
+  TestServiceTransferCacheEntry(cc::TransferCacheEntryType type, size_t size);
+  ~TestServiceTransferCacheEntry() override;
+
+  cc::TransferCacheEntryType Type() const override;
+  size_t CachedSize() const override;
+  bool Deserialize(GrDirectContext* context,
+                   base::span<const uint8_t> data) override;
+
+ private:
+  const cc::TransferCacheEntryType type_;
+  const size_t size_;
+
+  DISALLOW_COPY_AND_ASSIGN(TestServiceTransferCacheEntry);
+};
+
+}  // namespace gpu
+
+#endif  // GPU_COMMAND_BUFFER_SERVICE_TEST_SERVICE_TRANSFER_CACHE_ENTRY_H_
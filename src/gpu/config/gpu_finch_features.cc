@@ -59,6 +59,11 @@ const base::Feature kGpuProcessHighPriorityWin{
     "GpuProcessHighPriorityWin", base::FEATURE_ENABLED_BY_DEFAULT};
 #endif
 
+// Limits the GPU main thread time that each low or normal priority client
+// stream uses per frame before other streams of the same priority run first.
+const base::Feature kGpuSchedulerSequenceBudgets{
+    "GpuSchedulerSequenceBudgets", base::FEATURE_DISABLED_BY_DEFAULT};
+
 // Use ThreadPriority::DISPLAY for GPU main, viz compositor and IO threads.
 #if defined(OS_ANDROID) || defined(OS_CHROMEOS) || defined(OS_WIN)
 const base::Feature kGpuUseDisplayThreadPriority{
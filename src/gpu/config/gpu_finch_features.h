@@ -30,6 +30,8 @@ GPU_EXPORT extern const base::Feature kDefaultEnableOopRasterization;
 GPU_EXPORT extern const base::Feature kGpuProcessHighPriorityWin;
 #endif
 
+GPU_EXPORT extern const base::Feature kGpuSchedulerSequenceBudgets;
+
 GPU_EXPORT extern const base::Feature kGpuUseDisplayThreadPriority;
 
 GPU_EXPORT extern const base::Feature kGpuWatchdogV2;
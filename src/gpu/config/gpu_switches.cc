@@ -37,6 +37,11 @@ const char kIgnoreGpuBlacklist[] = "ignore-gpu-blacklist";
 // devices.
 const char kShaderDiskCacheSizeKB[] = "shader-disk-cache-size-kb";
 
+// Directory in which the GPU process persists linked program binaries and
+// Skia shaders itself, so that they are available at startup without being
+// sent back by the browser. The GPU process must be able to write to it.
+const char kGpuProgramDiskCacheDir[] = "gpu-program-disk-cache-dir";
+
 // Disables the non-sandboxed GPU process for DX12 info collection
 const char kDisableGpuProcessForDX12InfoCollection[] =
     "disable-gpu-process-for-dx12-info-collection";
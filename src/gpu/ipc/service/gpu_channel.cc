@@ -19,6 +19,7 @@
 #include "base/bind.h"
 #include "base/command_line.h"
 #include "base/containers/circular_deque.h"
+#include "base/feature_list.h"
 #include "base/location.h"
 #include "base/logging.h"
 #include "base/numerics/safe_conversions.h"
@@ -42,6 +43,7 @@
 #include "gpu/command_buffer/service/memory_tracking.h"
 #include "gpu/command_buffer/service/scheduler.h"
 #include "gpu/command_buffer/service/service_utils.h"
+#include "gpu/config/gpu_finch_features.h"
 #include "gpu/ipc/common/command_buffer_id.h"
 #include "gpu/ipc/common/gpu_messages.h"
 #include "gpu/ipc/service/gles2_command_buffer_stub.h"
@@ -731,6 +733,11 @@ void GpuChannel::OnCreateCommandBuffer(
   if (sequence_id.is_null()) {
     sequence_id = scheduler_->CreateSequence(init_params.stream_priority);
     stream_sequences_[stream_id] = sequence_id;
+    // Keep a busy client stream from starving others of the same priority.
+    if (init_params.stream_priority != SchedulingPriority::kHigh &&
+        base::FeatureList::IsEnabled(features::kGpuSchedulerSequenceBudgets)) {
+      scheduler_->SetSequenceBudget(sequence_id, Scheduler::kStreamBudget);
+    }
   }
 
   std::unique_ptr<CommandBufferStub> stub;
@@ -815,7 +822,7 @@ void GpuChannel::OnCreateStreamTexture(int32_t stream_id, bool* succeeded) {
 
 void GpuChannel::CacheShader(const std::string& key,
                              const std::string& shader) {
-  gpu_channel_manager_->delegate()->StoreShaderToDisk(client_id_, key, shader);
+  gpu_channel_manager_->StoreShaderToDisk(client_id_, key, shader);
 }
 
 void GpuChannel::AddFilter(IPC::MessageFilter* filter) {
@@ -35,6 +35,7 @@
 #include "gpu/ipc/service/gpu_channel_manager_delegate.h"
 #include "gpu/ipc/service/gpu_memory_ablation_experiment.h"
 #include "gpu/ipc/service/gpu_memory_buffer_factory.h"
+#include "gpu/ipc/service/gpu_program_disk_cache.h"
 #include "gpu/ipc/service/gpu_watchdog_thread.h"
 #include "third_party/skia/include/core/SkGraphics.h"
 #if defined(OS_WIN)
@@ -386,6 +387,7 @@ void GpuChannelManager::RemoveChannel(int client_id) {
     return;
 
   delegate_->DidDestroyChannel(client_id);
+  disk_cache_client_ids_.erase(client_id);
 
   // Erase the |gpu_channels_| entry before destroying the GpuChannel object to
   // avoid reentrancy problems from the GpuChannel destructor.
@@ -413,6 +415,8 @@ GpuChannel* GpuChannelManager::EstablishChannel(int client_id,
 
   if (gr_shader_cache_ && cache_shaders_on_disk)
     gr_shader_cache_->CacheClientIdOnDisk(client_id);
+  if (cache_shaders_on_disk)
+    disk_cache_client_ids_.insert(client_id);
 
   std::unique_ptr<GpuChannel> gpu_channel = GpuChannel::Create(
       this, scheduler_, sync_point_manager_, share_group_, task_runner_,
@@ -464,6 +468,48 @@ void GpuChannelManager::PopulateShaderCache(int32_t client_id,
     program_cache()->LoadProgram(key, program);
 }
 
+void GpuChannelManager::StoreShaderToDisk(int32_t client_id,
+                                          const std::string& key,
+                                          const std::string& shader) {
+  DCHECK_CALLED_ON_VALID_THREAD(thread_checker_);
+
+  delegate_->StoreShaderToDisk(client_id, key, shader);
+  if (program_disk_cache_ && disk_cache_client_ids_.contains(client_id)) {
+    program_disk_cache_->Store(GpuProgramDiskCache::ProgramType::kGLProgram,
+                               key, shader);
+  }
+}
+
+void GpuChannelManager::InitProgramDiskCache(const base::FilePath& directory,
+                                             const GPUInfo& gpu_info) {
+  DCHECK_CALLED_ON_VALID_THREAD(thread_checker_);
+  DCHECK(!program_disk_cache_);
+
+  if (gpu_preferences_.disable_gpu_shader_disk_cache)
+    return;
+  program_disk_cache_ = std::make_unique<GpuProgramDiskCache>(
+      directory, GpuProgramDiskCache::ComputeVersion(gpu_info),
+      gpu_preferences_.gpu_program_cache_size,
+      GpuProgramDiskCache::kDefaultMaxProgramsToPrefetch,
+      base::BindRepeating(&GpuChannelManager::OnProgramLoadedFromDisk,
+                          base::Unretained(this)));
+  program_disk_cache_->Init();
+}
+
+void GpuChannelManager::OnProgramLoadedFromDisk(GpuProgramType type,
+                                                const std::string& key,
+                                                const std::string& program) {
+  DCHECK_CALLED_ON_VALID_THREAD(thread_checker_);
+
+  if (type == GpuProgramDiskCache::ProgramType::kGrShader) {
+    if (gr_shader_cache_)
+      gr_shader_cache_->PopulateCache(key, program);
+    return;
+  }
+  if (program_cache())
+    program_cache()->LoadProgram(key, program);
+}
+
 void GpuChannelManager::LoseAllContexts() {
   DCHECK_CALLED_ON_VALID_THREAD(thread_checker_);
 
@@ -856,6 +902,11 @@ void GpuChannelManager::StoreShader(const std::string& key,
   DCHECK_CALLED_ON_VALID_THREAD(thread_checker_);
 
   delegate_->StoreShaderToDisk(kGrShaderCacheClientId, key, shader);
+  // GrShaderCache only stores shaders of clients that may be cached on disk.
+  if (program_disk_cache_) {
+    program_disk_cache_->Store(GpuProgramDiskCache::ProgramType::kGrShader,
+                               key, shader);
+  }
 }
 
 void GpuChannelManager::SetImageDecodeAcceleratorWorkerForTesting(
@@ -12,6 +12,7 @@
 #include <vector>
 
 #include "base/containers/flat_map.h"
+#include "base/containers/flat_set.h"
 #include "base/macros.h"
 #include "base/memory/memory_pressure_listener.h"
 #include "base/memory/ref_counted.h"
@@ -40,6 +41,7 @@
 #include "url/gurl.h"
 
 namespace base {
+class FilePath;
 namespace trace_event {
 class TracedValue;
 }  // namespace trace_event
@@ -58,12 +60,15 @@ class GpuChannel;
 class GpuChannelManagerDelegate;
 class GpuMemoryAblationExperiment;
 class GpuMemoryBufferFactory;
+class GpuProgramDiskCache;
 class GpuWatchdogThread;
 class ImageDecodeAcceleratorWorker;
 class MailboxManager;
 class Scheduler;
 class SyncPointManager;
+struct GPUInfo;
 struct VideoMemoryUsageStats;
+enum class GpuProgramType;
 
 namespace gles2 {
 class Outputter;
@@ -106,6 +111,22 @@ class GPU_IPC_SERVICE_EXPORT GpuChannelManager
   void PopulateShaderCache(int32_t client_id,
                            const std::string& key,
                            const std::string& program);
+
+  // Stores |shader| for |client_id| through the delegate, and in the GPU
+  // process's program disk cache if there is one and the client's shaders may
+  // be cached on disk.
+  void StoreShaderToDisk(int32_t client_id,
+                         const std::string& key,
+                         const std::string& shader);
+
+  // Starts persisting programs in the GPU process under |directory|. Programs
+  // stored there by an earlier run on the same driver are loaded into the
+  // program and Skia shader caches in the background.
+  void InitProgramDiskCache(const base::FilePath& directory,
+                            const GPUInfo& gpu_info);
+  GpuProgramDiskCache* program_disk_cache() {
+    return program_disk_cache_.get();
+  }
   void DestroyGpuMemoryBuffer(gfx::GpuMemoryBufferId id,
                               int client_id,
                               const SyncToken& sync_token);
@@ -268,6 +289,10 @@ class GPU_IPC_SERVICE_EXPORT GpuChannelManager
   void DoWakeUpGpu();
 #endif
 
+  void OnProgramLoadedFromDisk(GpuProgramType type,
+                               const std::string& key,
+                               const std::string& program);
+
   void HandleMemoryPressure(
       base::MemoryPressureListener::MemoryPressureLevel memory_pressure_level);
 
@@ -328,6 +353,9 @@ class GPU_IPC_SERVICE_EXPORT GpuChannelManager
   // alive until all clients have recovered, we use a ref-counted object and
   // allow the decoders to manage its lifetime.
   base::Optional<raster::GrShaderCache> gr_shader_cache_;
+  // Clients whose shaders may be written to disk.
+  base::flat_set<int32_t> disk_cache_client_ids_;
+  std::unique_ptr<GpuProgramDiskCache> program_disk_cache_;
   base::Optional<raster::GrCacheController> gr_cache_controller_;
   scoped_refptr<SharedContextState> shared_context_state_;
 
@@ -0,0 +1,331 @@
+// Copyright 2020 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "gpu/ipc/service/gpu_program_disk_cache.h"
+
+#include <algorithm>
+#include <utility>
+
+#include "base/bind.h"
+#include "base/files/file_enumerator.h"
+#include "base/files/file_util.h"
+#include "base/hash/sha1.h"
+#include "base/logging.h"
+#include "base/metrics/histogram_macros.h"
+#include "base/strings/string_number_conversions.h"
+#include "base/strings/string_util.h"
+#include "base/task/thread_pool.h"
+#include "gpu/config/gpu_info.h"
+#include "net/base/cache_type.h"
+#include "net/base/io_buffer.h"
+#include "net/base/net_errors.h"
+
+namespace gpu {
+
+namespace {
+
+// Bump when the layout of cached entries changes.
+constexpr char kFormatVersion[] = "1";
+
+constexpr char kGLProgramPrefix[] = "gl:";
+constexpr char kGrShaderPrefix[] = "gr:";
+
+// Programs are stored in the first data stream of each entry.
+constexpr int kDataIndex = 0;
+
+// The cache of each version is kept in a subdirectory named with this prefix,
+// which is the only kind of entry deleted from the given directory.
+constexpr base::FilePath::CharType kCacheDirectoryPrefix[] =
+    FILE_PATH_LITERAL("gpu_program_cache_");
+
+std::string GetCacheKey(GpuProgramDiskCache::ProgramType type,
+                        const std::string& key) {
+  return (type == GpuProgramDiskCache::ProgramType::kGrShader
+              ? kGrShaderPrefix
+              : kGLProgramPrefix) +
+         key;
+}
+
+// Splits a cache key back into the program type and key. Returns false for
+// keys this class did not write.
+bool ParseCacheKey(const std::string& cache_key,
+                   GpuProgramDiskCache::ProgramType* type,
+                   std::string* key) {
+  if (base::StartsWith(cache_key, kGLProgramPrefix,
+                       base::CompareCase::SENSITIVE)) {
+    *type = GpuProgramDiskCache::ProgramType::kGLProgram;
+    *key = cache_key.substr(sizeof(kGLProgramPrefix) - 1);
+    return true;
+  }
+  if (base::StartsWith(cache_key, kGrShaderPrefix,
+                       base::CompareCase::SENSITIVE)) {
+    *type = GpuProgramDiskCache::ProgramType::kGrShader;
+    *key = cache_key.substr(sizeof(kGrShaderPrefix) - 1);
+    return true;
+  }
+  return false;
+}
+
+base::FilePath GetCacheDirectory(const base::FilePath& directory,
+                                 const std::string& version) {
+  return directory.Append(kCacheDirectoryPrefix +
+                          base::FilePath::FromUTF8Unsafe(version).value());
+}
+
+// Deletes the caches of other versions under |directory|. Anything else in the
+// directory is left alone, as it may be shared with other data.
+void DeleteStaleVersions(const base::FilePath& directory,
+                         const base::FilePath& current) {
+  base::FileEnumerator enumerator(
+      directory, /*recursive=*/false, base::FileEnumerator::DIRECTORIES,
+      base::FilePath::StringType(kCacheDirectoryPrefix) +
+          FILE_PATH_LITERAL("*"));
+  for (base::FilePath path = enumerator.Next(); !path.empty();
+       path = enumerator.Next()) {
+    if (path != current)
+      base::DeletePathRecursively(path);
+  }
+}
+
+}  // namespace
+
+// static
+std::string GpuProgramDiskCache::ComputeVersion(const GPUInfo& gpu_info) {
+  // ANGLE reports its build in the GL version string.
+  std::string version = base::JoinString(
+      {kFormatVersion, gpu_info.gl_vendor, gpu_info.gl_renderer,
+       gpu_info.gl_version, gpu_info.active_gpu().driver_version,
+       gpu_info.passthrough_cmd_decoder ? "passthrough" : "validating"},
+      "\n");
+  return base::ToLowerASCII(
+      base::HexEncode(base::SHA1HashString(version).data(), base::kSHA1Length));
+}
+
+GpuProgramDiskCache::GpuProgramDiskCache(
+    const base::FilePath& directory,
+    const std::string& version,
+    size_t max_size_bytes,
+    size_t max_programs_to_prefetch,
+    ProgramLoadedCallback program_loaded_callback)
+    : directory_(directory),
+      version_(version),
+      max_size_bytes_(max_size_bytes),
+      max_programs_to_prefetch_(max_programs_to_prefetch),
+      program_loaded_callback_(std::move(program_loaded_callback)) {
+  DCHECK(!version_.empty());
+}
+
+GpuProgramDiskCache::~GpuProgramDiskCache() {
+  DCHECK_CALLED_ON_VALID_THREAD(thread_checker_);
+}
+
+void GpuProgramDiskCache::Init() {
+  DCHECK_CALLED_ON_VALID_THREAD(thread_checker_);
+
+  base::FilePath cache_directory = GetCacheDirectory(directory_, version_);
+  base::ThreadPool::PostTask(
+      FROM_HERE,
+      {base::MayBlock(), base::TaskPriority::BEST_EFFORT,
+       base::TaskShutdownBehavior::CONTINUE_ON_SHUTDOWN},
+      base::BindOnce(&DeleteStaleVersions, directory_, cache_directory));
+
+  int rv = disk_cache::CreateCacheBackend(
+      net::SHADER_CACHE, net::CACHE_BACKEND_SIMPLE, cache_directory,
+      max_size_bytes_,
+      disk_cache::ResetHandling::kResetOnError, /*net_log=*/nullptr,
+      &pending_backend_,
+      base::BindOnce(&GpuProgramDiskCache::OnBackendCreated,
+                     weak_factory_.GetWeakPtr()));
+  if (rv != net::ERR_IO_PENDING)
+    OnBackendCreated(rv);
+}
+
+void GpuProgramDiskCache::OnBackendCreated(int rv) {
+  DCHECK_CALLED_ON_VALID_THREAD(thread_checker_);
+  if (rv != net::OK) {
+    LOG(ERROR) << "GPU program disk cache creation failed: " << rv;
+    pending_backend_.reset();
+    FinishPrefetch();
+    return;
+  }
+  backend_ = std::move(pending_backend_);
+  IterateNextEntry();
+}
+
+void GpuProgramDiskCache::Store(ProgramType type,
+                                const std::string& key,
+                                const std::string& program) {
+  DCHECK_CALLED_ON_VALID_THREAD(thread_checker_);
+  if (!backend_)
+    return;
+
+  ++pending_writes_;
+  auto buffer = base::MakeRefCounted<net::StringIOBuffer>(program);
+  int size = static_cast<int>(program.size());
+  disk_cache::EntryResult result = backend_->OpenOrCreateEntry(
+      GetCacheKey(type, key), net::LOWEST,
+      base::BindOnce(&GpuProgramDiskCache::OnEntryOpenedForWrite,
+                     weak_factory_.GetWeakPtr(), buffer, size));
+  if (result.net_error() != net::ERR_IO_PENDING)
+    OnEntryOpenedForWrite(std::move(buffer), size, std::move(result));
+}
+
+void GpuProgramDiskCache::OnEntryOpenedForWrite(
+    scoped_refptr<net::IOBuffer> buffer,
+    int size,
+    disk_cache::EntryResult result) {
+  DCHECK_CALLED_ON_VALID_THREAD(thread_checker_);
+  if (result.net_error() != net::OK) {
+    OnWriteComplete(result.net_error());
+    return;
+  }
+
+  // Closing the entry does not cancel the write.
+  disk_cache::Entry* entry = result.ReleaseEntry();
+  int rv = entry->WriteData(
+      kDataIndex, 0, buffer.get(), size,
+      base::BindOnce(&GpuProgramDiskCache::OnWriteComplete,
+                     weak_factory_.GetWeakPtr()),
+      /*truncate=*/true);
+  entry->Close();
+  if (rv != net::ERR_IO_PENDING)
+    OnWriteComplete(rv);
+}
+
+void GpuProgramDiskCache::OnWriteComplete(int rv) {
+  DCHECK_CALLED_ON_VALID_THREAD(thread_checker_);
+  DCHECK_GT(pending_writes_, 0);
+  if (--pending_writes_ == 0 && writes_complete_callback_)
+    std::move(writes_complete_callback_).Run();
+}
+
+int32_t GpuProgramDiskCache::GetEntryCount() const {
+  return backend_ ? backend_->GetEntryCount() : 0;
+}
+
+void GpuProgramDiskCache::IterateNextEntry() {
+  if (!iterator_)
+    iterator_ = backend_->CreateIterator();
+
+  for (;;) {
+    disk_cache::EntryResult result = iterator_->OpenNextEntry(
+        base::BindOnce(&GpuProgramDiskCache::OnEntryIterated,
+                       weak_factory_.GetWeakPtr()));
+    if (result.net_error() == net::ERR_IO_PENDING)
+      return;
+    if (!HandleIteratedEntry(std::move(result)))
+      return;
+  }
+}
+
+void GpuProgramDiskCache::OnEntryIterated(disk_cache::EntryResult result) {
+  DCHECK_CALLED_ON_VALID_THREAD(thread_checker_);
+  if (HandleIteratedEntry(std::move(result)))
+    IterateNextEntry();
+}
+
+bool GpuProgramDiskCache::HandleIteratedEntry(disk_cache::EntryResult result) {
+  if (result.net_error() != net::OK) {
+    // ERR_FAILED marks the end of the iteration.
+    iterator_.reset();
+    UMA_HISTOGRAM_COUNTS_10000("GPU.ProgramDiskCache.EntriesAtStartup",
+                               candidates_.size());
+
+    // Most recently used first. The times are as of the previous session,
+    // since opening an entry during the iteration doesn't report a new use.
+    size_t count = std::min(candidates_.size(), max_programs_to_prefetch_);
+    std::partial_sort(candidates_.begin(), candidates_.begin() + count,
+                      candidates_.end(),
+                      [](const PrefetchCandidate& a,
+                         const PrefetchCandidate& b) {
+                        return a.last_used > b.last_used;
+                      });
+    candidates_.resize(count);
+    ReadNextCandidate();
+    return false;
+  }
+
+  disk_cache::Entry* entry = result.ReleaseEntry();
+  candidates_.push_back({entry->GetKey(), entry->GetLastUsed()});
+  entry->Close();
+  return true;
+}
+
+void GpuProgramDiskCache::ReadNextCandidate() {
+  if (next_candidate_ == candidates_.size()) {
+    FinishPrefetch();
+    return;
+  }
+
+  const std::string& cache_key = candidates_[next_candidate_++].cache_key;
+  disk_cache::EntryResult result = backend_->OpenEntry(
+      cache_key, net::LOWEST,
+      base::BindOnce(&GpuProgramDiskCache::OnCandidateOpened,
+                     weak_factory_.GetWeakPtr()));
+  if (result.net_error() != net::ERR_IO_PENDING)
+    OnCandidateOpened(std::move(result));
+}
+
+void GpuProgramDiskCache::OnCandidateOpened(disk_cache::EntryResult result) {
+  DCHECK_CALLED_ON_VALID_THREAD(thread_checker_);
+  if (result.net_error() != net::OK) {
+    ReadNextCandidate();
+    return;
+  }
+
+  candidate_entry_.reset(result.ReleaseEntry());
+  auto buffer = base::MakeRefCounted<net::IOBufferWithSize>(
+      candidate_entry_->GetDataSize(kDataIndex));
+  int rv = candidate_entry_->ReadData(
+      kDataIndex, 0, buffer.get(), buffer->size(),
+      base::BindOnce(&GpuProgramDiskCache::OnCandidateRead,
+                     weak_factory_.GetWeakPtr(), buffer));
+  if (rv != net::ERR_IO_PENDING)
+    OnCandidateRead(std::move(buffer), rv);
+}
+
+void GpuProgramDiskCache::OnCandidateRead(
+    scoped_refptr<net::IOBufferWithSize> buffer,
+    int rv) {
+  DCHECK_CALLED_ON_VALID_THREAD(thread_checker_);
+  ProgramType type;
+  std::string key;
+  if (rv > 0 && rv == buffer->size() &&
+      ParseCacheKey(candidate_entry_->GetKey(), &type, &key)) {
+    program_loaded_callback_.Run(type, key,
+                                 std::string(buffer->data(), buffer->size()));
+    ++programs_prefetched_;
+  }
+  candidate_entry_.reset();
+  ReadNextCandidate();
+}
+
+void GpuProgramDiskCache::FinishPrefetch() {
+  UMA_HISTOGRAM_COUNTS_1000("GPU.ProgramDiskCache.ProgramsPrefetched",
+                            programs_prefetched_);
+  candidates_.clear();
+  prefetch_complete_ = true;
+  if (prefetch_complete_callback_)
+    std::move(prefetch_complete_callback_).Run();
+}
+
+void GpuProgramDiskCache::SetPrefetchCompleteCallbackForTesting(
+    base::OnceClosure callback) {
+  if (prefetch_complete_) {
+    std::move(callback).Run();
+    return;
+  }
+  prefetch_complete_callback_ = std::move(callback);
+}
+
+void GpuProgramDiskCache::SetWritesCompleteCallbackForTesting(
+    base::OnceClosure callback) {
+  if (pending_writes_ == 0) {
+    std::move(callback).Run();
+    return;
+  }
+  writes_complete_callback_ = std::move(callback);
+}
+
+}  // namespace gpu
@@ -0,0 +1,144 @@
+// Copyright 2020 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef GPU_IPC_SERVICE_GPU_PROGRAM_DISK_CACHE_H_
+#define GPU_IPC_SERVICE_GPU_PROGRAM_DISK_CACHE_H_
+
+#include <stddef.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "base/callback.h"
+#include "base/files/file_path.h"
+#include "base/memory/scoped_refptr.h"
+#include "base/memory/weak_ptr.h"
+#include "base/threading/thread_checker.h"
+#include "base/time/time.h"
+#include "gpu/ipc/service/gpu_ipc_service_export.h"
+#include "net/disk_cache/disk_cache.h"
+
+namespace net {
+class IOBuffer;
+class IOBufferWithSize;
+}  // namespace net
+
+namespace gpu {
+
+struct GPUInfo;
+
+// Declared outside of GpuProgramDiskCache so that it can be forward-declared.
+enum class GpuProgramType { kGLProgram, kGrShader };
+
+// A persistent store of linked GL program binaries and Skia shaders that is
+// owned by the GPU process, so that programs survive restarts without the
+// browser having to send them back through the GPU host. Used in addition to
+// the browser's ShaderDiskCache when --gpu-program-disk-cache-dir is given.
+//
+// Programs are kept in a simple-backend disk cache, which evicts the least
+// recently used entries once the cache exceeds its size limit. The cache lives
+// in a "gpu_program_cache_<version>" subdirectory of the given directory, with
+// a version derived from the GL driver and ANGLE build, so binaries from
+// another driver are never loaded. Such subdirectories of other versions are
+// deleted in the background; nothing else in the directory is touched.
+//
+// Once the backend is open, the most recently used programs are read back and
+// handed to the ProgramLoadedCallback, so that the in-memory caches are warm
+// before clients start linking. Must be used on a single thread.
+class GPU_IPC_SERVICE_EXPORT GpuProgramDiskCache {
+ public:
+  using ProgramType = GpuProgramType;
+
+  using ProgramLoadedCallback =
+      base::RepeatingCallback<void(ProgramType type,
+                                   const std::string& key,
+                                   const std::string& program)>;
+
+  // Maximum number of programs read back at startup.
+  static constexpr size_t kDefaultMaxProgramsToPrefetch = 256;
+
+  // Returns the version that cached programs are valid for.
+  static std::string ComputeVersion(const GPUInfo& gpu_info);
+
+  GpuProgramDiskCache(const base::FilePath& directory,
+                      const std::string& version,
+                      size_t max_size_bytes,
+                      size_t max_programs_to_prefetch,
+                      ProgramLoadedCallback program_loaded_callback);
+  GpuProgramDiskCache(const GpuProgramDiskCache&) = delete;
+  GpuProgramDiskCache& operator=(const GpuProgramDiskCache&) = delete;
+  ~GpuProgramDiskCache();
+
+  // Opens the backend, then prefetches. Programs stored before the backend is
+  // open are dropped.
+  void Init();
+
+  void Store(ProgramType type,
+             const std::string& key,
+             const std::string& program);
+
+  bool is_available() const { return !!backend_; }
+  int32_t GetEntryCount() const;
+
+  // Runs |callback| once the prefetch at startup has finished, or immediately
+  // if it already has.
+  void SetPrefetchCompleteCallbackForTesting(base::OnceClosure callback);
+  // Runs |callback| once no writes are in flight.
+  void SetWritesCompleteCallbackForTesting(base::OnceClosure callback);
+
+ private:
+  struct PrefetchCandidate {
+    std::string cache_key;
+    base::Time last_used;
+  };
+
+  void OnBackendCreated(int rv);
+
+  void OnEntryOpenedForWrite(scoped_refptr<net::IOBuffer> buffer,
+                             int size,
+                             disk_cache::EntryResult result);
+  void OnWriteComplete(int rv);
+
+  // Walks all entries to find the most recently used ones, then reads them.
+  void IterateNextEntry();
+  void OnEntryIterated(disk_cache::EntryResult result);
+  // Returns false once the iteration is finished.
+  bool HandleIteratedEntry(disk_cache::EntryResult result);
+  void ReadNextCandidate();
+  void OnCandidateOpened(disk_cache::EntryResult result);
+  void OnCandidateRead(scoped_refptr<net::IOBufferWithSize> buffer, int rv);
+  void FinishPrefetch();
+
+  const base::FilePath directory_;
+  const std::string version_;
+  const size_t max_size_bytes_;
+  const size_t max_programs_to_prefetch_;
+  ProgramLoadedCallback program_loaded_callback_;
+
+  std::unique_ptr<disk_cache::Backend> backend_;
+  // Set while the backend is being created; |backend_| is only exposed once
+  // creation succeeded.
+  std::unique_ptr<disk_cache::Backend> pending_backend_;
+
+  std::unique_ptr<disk_cache::Backend::Iterator> iterator_;
+  std::vector<PrefetchCandidate> candidates_;
+  size_t next_candidate_ = 0;
+  // The candidate being read. Closed before |backend_| is destroyed.
+  disk_cache::ScopedEntryPtr candidate_entry_;
+  int programs_prefetched_ = 0;
+  bool prefetch_complete_ = false;
+  base::OnceClosure prefetch_complete_callback_;
+
+  int pending_writes_ = 0;
+  base::OnceClosure writes_complete_callback_;
+
+  THREAD_CHECKER(thread_checker_);
+
+  base::WeakPtrFactory<GpuProgramDiskCache> weak_factory_{this};
+};
+
+}  // namespace gpu
+
+#endif  // GPU_IPC_SERVICE_GPU_PROGRAM_DISK_CACHE_H_
@@ -0,0 +1,157 @@
+// Copyright 2020 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "gpu/ipc/service/gpu_program_disk_cache.h"
+
+#include <map>
+#include <memory>
+#include <string>
+#include <utility>
+
+#include "base/bind.h"
+#include "base/files/file_util.h"
+#include "base/files/scoped_temp_dir.h"
+#include "base/run_loop.h"
+#include "base/strings/string_number_conversions.h"
+#include "base/test/task_environment.h"
+#include "gpu/config/gpu_info.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace gpu {
+namespace {
+
+using ProgramType = GpuProgramDiskCache::ProgramType;
+
+constexpr char kVersion[] = "version1";
+constexpr size_t kMaxSizeBytes = 1024 * 1024;
+
+class GpuProgramDiskCacheTest : public testing::Test {
+ public:
+  GpuProgramDiskCacheTest() = default;
+  ~GpuProgramDiskCacheTest() override = default;
+
+  void SetUp() override { ASSERT_TRUE(temp_dir_.CreateUniqueTempDir()); }
+
+  void TearDown() override {
+    cache_.reset();
+    // Let the simple backend finish its work on the thread pool before the
+    // temporary directory is deleted.
+    task_environment_.RunUntilIdle();
+  }
+
+ protected:
+  // Creates and initializes a cache, and waits for its prefetch.
+  void CreateCache(const std::string& version,
+                   size_t max_programs_to_prefetch =
+                       GpuProgramDiskCache::kDefaultMaxProgramsToPrefetch) {
+    cache_.reset();
+    task_environment_.RunUntilIdle();
+    loaded_.clear();
+    cache_ = std::make_unique<GpuProgramDiskCache>(
+        temp_dir_.GetPath(), version, kMaxSizeBytes, max_programs_to_prefetch,
+        base::BindRepeating(&GpuProgramDiskCacheTest::OnProgramLoaded,
+                            base::Unretained(this)));
+    cache_->Init();
+
+    base::RunLoop run_loop;
+    cache_->SetPrefetchCompleteCallbackForTesting(run_loop.QuitClosure());
+    run_loop.Run();
+    ASSERT_TRUE(cache_->is_available());
+  }
+
+  void WaitForWrites() {
+    base::RunLoop run_loop;
+    cache_->SetWritesCompleteCallbackForTesting(run_loop.QuitClosure());
+    run_loop.Run();
+  }
+
+  void OnProgramLoaded(ProgramType type,
+                       const std::string& key,
+                       const std::string& program) {
+    loaded_[key] = std::make_pair(type, program);
+  }
+
+  base::test::TaskEnvironment task_environment_;
+  base::ScopedTempDir temp_dir_;
+  std::unique_ptr<GpuProgramDiskCache> cache_;
+  std::map<std::string, std::pair<ProgramType, std::string>> loaded_;
+};
+
+TEST_F(GpuProgramDiskCacheTest, ProgramsSurviveRestart) {
+  CreateCache(kVersion);
+  EXPECT_TRUE(loaded_.empty());
+
+  cache_->Store(ProgramType::kGLProgram, "program", "binary");
+  cache_->Store(ProgramType::kGrShader, "shader", "sksl");
+  WaitForWrites();
+  EXPECT_EQ(2, cache_->GetEntryCount());
+
+  CreateCache(kVersion);
+  ASSERT_EQ(2u, loaded_.size());
+  EXPECT_EQ(ProgramType::kGLProgram, loaded_["program"].first);
+  EXPECT_EQ("binary", loaded_["program"].second);
+  EXPECT_EQ(ProgramType::kGrShader, loaded_["shader"].first);
+  EXPECT_EQ("sksl", loaded_["shader"].second);
+}
+
+TEST_F(GpuProgramDiskCacheTest, StoreReplacesProgram) {
+  CreateCache(kVersion);
+  cache_->Store(ProgramType::kGLProgram, "program", "a longer old binary");
+  WaitForWrites();
+  cache_->Store(ProgramType::kGLProgram, "program", "new");
+  WaitForWrites();
+
+  CreateCache(kVersion);
+  ASSERT_EQ(1u, loaded_.size());
+  EXPECT_EQ("new", loaded_["program"].second);
+}
+
+TEST_F(GpuProgramDiskCacheTest, PrefetchIsBounded) {
+  CreateCache(kVersion);
+  for (int i = 0; i < 5; ++i)
+    cache_->Store(ProgramType::kGLProgram, base::NumberToString(i), "binary");
+  WaitForWrites();
+
+  CreateCache(kVersion, /*max_programs_to_prefetch=*/2);
+  EXPECT_EQ(2u, loaded_.size());
+  EXPECT_EQ(5, cache_->GetEntryCount());
+}
+
+TEST_F(GpuProgramDiskCacheTest, VersionChangeDiscardsPrograms) {
+  // Other data in the directory must survive the cleanup of old versions.
+  base::FilePath unrelated = temp_dir_.GetPath().AppendASCII("unrelated");
+  ASSERT_TRUE(base::CreateDirectory(unrelated));
+
+  CreateCache(kVersion);
+  cache_->Store(ProgramType::kGLProgram, "program", "binary");
+  WaitForWrites();
+
+  CreateCache("version2");
+  EXPECT_TRUE(loaded_.empty());
+  EXPECT_EQ(0, cache_->GetEntryCount());
+
+  // The old version's cache is deleted in the background.
+  task_environment_.RunUntilIdle();
+  EXPECT_FALSE(base::PathExists(
+      temp_dir_.GetPath().AppendASCII("gpu_program_cache_version1")));
+  EXPECT_TRUE(base::PathExists(
+      temp_dir_.GetPath().AppendASCII("gpu_program_cache_version2")));
+  EXPECT_TRUE(base::PathExists(unrelated));
+}
+
+TEST_F(GpuProgramDiskCacheTest, ComputeVersion) {
+  GPUInfo gpu_info;
+  gpu_info.gl_vendor = "vendor";
+  gpu_info.gl_renderer = "renderer";
+  gpu_info.gl_version = "OpenGL ES 3.0 (ANGLE 2.1.1 git hash: 0123456789ab)";
+  std::string version = GpuProgramDiskCache::ComputeVersion(gpu_info);
+  EXPECT_FALSE(version.empty());
+  EXPECT_EQ(version, GpuProgramDiskCache::ComputeVersion(gpu_info));
+
+  gpu_info.gl_version = "OpenGL ES 3.0 (ANGLE 2.1.2 git hash: ba9876543210)";
+  EXPECT_NE(version, GpuProgramDiskCache::ComputeVersion(gpu_info));
+}
+
+}  // namespace
+}  // namespace gpu
@@ -0,0 +1,139 @@
+// Copyright 2020 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "base/bind.h"
+#include "base/test/simple_test_tick_clock.h"
+#include "base/test/test_simple_task_runner.h"
+#include "gpu/command_buffer/service/scheduler.h"
+#include "gpu/command_buffer/service/sync_point_manager.h"
+#include "gpu/config/gpu_preferences.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "testing/perf/perf_result_reporter.h"
+
+namespace gpu {
+namespace {
+
+constexpr int kFrames = 600;
+constexpr base::TimeDelta kFrameInterval =
+    base::TimeDelta::FromMilliseconds(16);
+
+// A heavy client queues three 4ms tasks at the start of every frame, before a
+// light client queues a 2ms task that should finish within the frame. Task
+// run times are simulated with a test clock, so results are deterministic and
+// measure scheduling decisions only.
+constexpr int kHeavyTasksPerFrame = 3;
+constexpr base::TimeDelta kHeavyTaskTime =
+    base::TimeDelta::FromMilliseconds(4);
+constexpr base::TimeDelta kLightTaskTime =
+    base::TimeDelta::FromMilliseconds(2);
+
+class SchedulerContentionPerfTest : public testing::Test {
+ public:
+  SchedulerContentionPerfTest()
+      : task_runner_(new base::TestSimpleTaskRunner()),
+        scheduler_(task_runner_, &sync_point_manager_, GpuPreferences()) {
+    tick_clock_.SetNowTicks(base::TimeTicks::Now());
+    scheduler_.SetTickClockForTesting(&tick_clock_);
+  }
+
+ protected:
+  void ScheduleTask(SequenceId sequence_id,
+                    base::TimeDelta task_time,
+                    base::OnceClosure done) {
+    scheduler_.ScheduleTask(Scheduler::Task(
+        sequence_id,
+        base::BindOnce(
+            [](base::SimpleTestTickClock* tick_clock, base::TimeDelta task_time,
+               base::OnceClosure done) {
+              tick_clock->Advance(task_time);
+              std::move(done).Run();
+            },
+            &tick_clock_, task_time, std::move(done)),
+        std::vector<SyncToken>()));
+  }
+
+  // Runs |kFrames| frames of contention between |heavy_sequence_id| and
+  // |light_sequence_id| and reports when the light client's task finished
+  // relative to the start of its frame.
+  void RunFrames(SequenceId heavy_sequence_id,
+                 SequenceId light_sequence_id,
+                 const std::string& story) {
+    base::TimeTicks start = tick_clock_.NowTicks();
+    base::TimeDelta total_latency;
+    base::TimeDelta max_latency;
+    int missed_frames = 0;
+
+    for (int frame = 0; frame < kFrames; ++frame) {
+      base::TimeTicks frame_start = start + kFrameInterval * frame;
+      base::TimeTicks frame_end = frame_start + kFrameInterval;
+      if (tick_clock_.NowTicks() < frame_start)
+        tick_clock_.SetNowTicks(frame_start);
+
+      for (int i = 0; i < kHeavyTasksPerFrame; ++i)
+        ScheduleTask(heavy_sequence_id, kHeavyTaskTime, base::DoNothing());
+
+      base::TimeTicks light_done;
+      ScheduleTask(light_sequence_id, kLightTaskTime,
+                   base::BindOnce(
+                       [](base::SimpleTestTickClock* tick_clock,
+                          base::TimeTicks* light_done) {
+                         *light_done = tick_clock->NowTicks();
+                       },
+                       &tick_clock_, &light_done));
+
+      while (task_runner_->HasPendingTask() &&
+             (light_done.is_null() || tick_clock_.NowTicks() < frame_end)) {
+        task_runner_->RunPendingTasks();
+      }
+
+      base::TimeDelta latency = light_done - frame_start;
+      total_latency += latency;
+      max_latency = std::max(max_latency, latency);
+      if (light_done > frame_end)
+        missed_frames++;
+    }
+
+    perf_test::PerfResultReporter reporter("SchedulerContention", story);
+    reporter.RegisterImportantMetric("_mean_latency", "ms");
+    reporter.RegisterImportantMetric("_max_latency", "ms");
+    reporter.RegisterImportantMetric("_missed_frames", "count");
+    reporter.AddResult("_mean_latency",
+                       (total_latency / kFrames).InMillisecondsF());
+    reporter.AddResult("_max_latency", max_latency.InMillisecondsF());
+    reporter.AddResult("_missed_frames", static_cast<size_t>(missed_frames));
+
+    scheduler_.DestroySequence(heavy_sequence_id);
+    scheduler_.DestroySequence(light_sequence_id);
+  }
+
+  scoped_refptr<base::TestSimpleTaskRunner> task_runner_;
+  SyncPointManager sync_point_manager_;
+  base::SimpleTestTickClock tick_clock_;
+  Scheduler scheduler_;
+};
+
+// Baseline: sequences of equal priority run in submission order.
+TEST_F(SchedulerContentionPerfTest, NoBudgets) {
+  SequenceId heavy = scheduler_.CreateSequence(SchedulingPriority::kNormal);
+  SequenceId light = scheduler_.CreateSequence(SchedulingPriority::kNormal);
+  RunFrames(heavy, light, "no_budgets");
+}
+
+// The heavy client falls behind the light one once over its budget, as
+// GpuChannel sets up client streams with the GpuSchedulerSequenceBudgets
+// feature enabled.
+TEST_F(SchedulerContentionPerfTest, StreamBudgets) {
+  SequenceId heavy = scheduler_.CreateSequence(SchedulingPriority::kNormal);
+  SequenceId light = scheduler_.CreateSequence(SchedulingPriority::kNormal);
+  scheduler_.SetSequenceBudget(heavy, Scheduler::kStreamBudget);
+  scheduler_.SetSequenceBudget(light, Scheduler::kStreamBudget);
+  RunFrames(heavy, light, "stream_budgets");
+}
+
+}  // namespace
+}  // namespace gpu
@@ -0,0 +1,101 @@
+// Copyright 2020 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "remoting/base/audio_sample_util.h"
+
+#include <stdlib.h>
+
+#include "base/check_op.h"
+#include "build/build_config.h"
+
+#if defined(ARCH_CPU_X86_FAMILY)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON__) || defined(__ARM_NEON)
+#include <arm_neon.h>
+#define AUDIO_SAMPLE_UTIL_USE_NEON
+#endif
+
+namespace remoting {
+
+namespace {
+
+// The largest absolute value of a 16-bit sample.
+const int kMaxSampleMagnitude = 32768;
+
+// |level| value that leaves the samples unchanged.
+const int32_t kUnityLevel = 65536;
+
+}  // namespace
+
+bool IsSilentAudio(const int16_t* samples, size_t count, int threshold) {
+  DCHECK_GE(threshold, 0);
+  if (threshold >= kMaxSampleMagnitude)
+    return true;
+
+  size_t i = 0;
+#if defined(ARCH_CPU_X86_FAMILY)
+  const __m128i max = _mm_set1_epi16(static_cast<int16_t>(threshold));
+  const __m128i min = _mm_set1_epi16(static_cast<int16_t>(-threshold));
+  for (; i + 8 <= count; i += 8) {
+    __m128i s =
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(samples + i));
+    __m128i loud =
+        _mm_or_si128(_mm_cmpgt_epi16(s, max), _mm_cmplt_epi16(s, min));
+    if (_mm_movemask_epi8(loud))
+      return false;
+  }
+#elif defined(AUDIO_SAMPLE_UTIL_USE_NEON)
+  const int16x8_t max = vdupq_n_s16(threshold);
+  const int16x8_t min = vdupq_n_s16(-threshold);
+  for (; i + 8 <= count; i += 8) {
+    int16x8_t s = vld1q_s16(samples + i);
+    uint64x2_t loud = vreinterpretq_u64_u16(
+        vorrq_u16(vcgtq_s16(s, max), vcltq_s16(s, min)));
+    if (vgetq_lane_u64(loud, 0) | vgetq_lane_u64(loud, 1))
+      return false;
+  }
+#endif
+  for (; i < count; ++i) {
+    if (abs(samples[i]) > threshold)
+      return false;
+  }
+  return true;
+}
+
+void ScaleAudioSamples(int16_t* samples, size_t count, int32_t level) {
+  DCHECK_GE(level, 0);
+  DCHECK_LE(level, kUnityLevel);
+
+  size_t i = 0;
+  if (level < kUnityLevel) {
+#if defined(ARCH_CPU_X86_FAMILY)
+    // _mm_mulhi_epi16() takes a signed 16-bit factor. Levels of 0.5 and above
+    // are passed as |level| - 65536, and the sample is added back to the
+    // product, which gives the same result as the 32-bit multiplication.
+    const bool high_level = level >= kMaxSampleMagnitude;
+    const __m128i factor = _mm_set1_epi16(
+        static_cast<int16_t>(high_level ? level - kUnityLevel : level));
+    for (; i + 8 <= count; i += 8) {
+      __m128i* p = reinterpret_cast<__m128i*>(samples + i);
+      __m128i s = _mm_loadu_si128(p);
+      __m128i scaled = _mm_mulhi_epi16(s, factor);
+      if (high_level)
+        scaled = _mm_add_epi16(scaled, s);
+      _mm_storeu_si128(p, scaled);
+    }
+#elif defined(AUDIO_SAMPLE_UTIL_USE_NEON)
+    for (; i + 8 <= count; i += 8) {
+      int16x8_t s = vld1q_s16(samples + i);
+      int32x4_t low = vmulq_n_s32(vmovl_s16(vget_low_s16(s)), level);
+      int32x4_t high = vmulq_n_s32(vmovl_s16(vget_high_s16(s)), level);
+      vst1q_s16(samples + i,
+                vcombine_s16(vshrn_n_s32(low, 16), vshrn_n_s32(high, 16)));
+    }
+#endif
+  }
+  for (; i < count; ++i)
+    samples[i] = (static_cast<int32_t>(samples[i]) * level) >> 16;
+}
+
+}  // namespace remoting
@@ -0,0 +1,27 @@
+// Copyright 2020 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef REMOTING_BASE_AUDIO_SAMPLE_UTIL_H_
+#define REMOTING_BASE_AUDIO_SAMPLE_UTIL_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace remoting {
+
+// Helpers for processing 16-bit PCM audio samples. These are used for every
+// captured audio packet, so they are vectorized with SSE2 on x86 and NEON on
+// ARM.
+
+// Returns true if none of the |count| |samples| has an absolute value above
+// |threshold|.
+bool IsSilentAudio(const int16_t* samples, size_t count, int threshold);
+
+// Multiplies each of the |count| |samples| by |level|, a 16.16 fixed point
+// value in [0, 1], i.e. between 0 and 65536.
+void ScaleAudioSamples(int16_t* samples, size_t count, int32_t level);
+
+}  // namespace remoting
+
+#endif  // REMOTING_BASE_AUDIO_SAMPLE_UTIL_H_
@@ -0,0 +1,68 @@
+// Copyright 2020 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "remoting/base/audio_sample_util.h"
+
+#include <stdint.h>
+
+#include <vector>
+
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace remoting {
+
+namespace {
+
+// Not a multiple of the vector size, so that the scalar tail is exercised.
+const size_t kSampleCount = 1003;
+
+std::vector<int16_t> MakeNoise() {
+  std::vector<int16_t> samples(kSampleCount);
+  uint32_t seed = 1;
+  for (int16_t& sample : samples) {
+    seed = seed * 1103515245 + 12345;
+    sample = static_cast<int16_t>(seed >> 16);
+  }
+  samples[5] = INT16_MIN;
+  samples[6] = INT16_MAX;
+  return samples;
+}
+
+}  // namespace
+
+TEST(AudioSampleUtilTest, IsSilentAudio) {
+  std::vector<int16_t> samples(kSampleCount, 0);
+  EXPECT_TRUE(IsSilentAudio(samples.data(), samples.size(), 0));
+
+  samples[500] = -1;
+  EXPECT_FALSE(IsSilentAudio(samples.data(), samples.size(), 0));
+  EXPECT_TRUE(IsSilentAudio(samples.data(), samples.size(), 1));
+
+  samples[kSampleCount - 1] = 5;
+  EXPECT_FALSE(IsSilentAudio(samples.data(), samples.size(), 4));
+  EXPECT_TRUE(IsSilentAudio(samples.data(), samples.size(), 5));
+  EXPECT_TRUE(IsSilentAudio(samples.data(), samples.size() - 1, 4));
+}
+
+TEST(AudioSampleUtilTest, IsSilentAudioExtremes) {
+  std::vector<int16_t> samples(kSampleCount, 0);
+  samples[7] = INT16_MIN;
+  EXPECT_FALSE(IsSilentAudio(samples.data(), samples.size(), INT16_MAX));
+  EXPECT_TRUE(IsSilentAudio(samples.data(), samples.size(), 32768));
+}
+
+TEST(AudioSampleUtilTest, ScaleAudioSamples) {
+  const int32_t kLevels[] = {0, 1, 12345, 32767, 32768, 40000, 65535, 65536};
+  for (int32_t level : kLevels) {
+    std::vector<int16_t> samples = MakeNoise();
+    std::vector<int16_t> expected = samples;
+    for (int16_t& sample : expected)
+      sample = (static_cast<int32_t>(sample) * level) >> 16;
+
+    ScaleAudioSamples(samples.data(), samples.size(), level);
+    EXPECT_EQ(expected, samples) << "level " << level;
+  }
+}
+
+}  // namespace remoting
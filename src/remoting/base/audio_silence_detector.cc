@@ -2,11 +2,10 @@
 // Use of this source code is governed by a BSD-style license that can be
 // found in the LICENSE file.
 
-#include "remoting/host/audio_silence_detector.h"
-
-#include <stdlib.h>
+#include "remoting/base/audio_silence_detector.h"
 
 #include "base/check_op.h"
+#include "remoting/base/audio_sample_util.h"
 
 namespace remoting {
 
@@ -41,18 +40,7 @@ void AudioSilenceDetector::Reset(int sampling_rate, int channels) {
 bool AudioSilenceDetector::IsSilence(const int16_t* samples,
                                      size_t frames) {
   const int samples_count = frames * channels();
-  bool silent_packet = true;
-  // Potentially this loop can be optimized (e.g. using SSE or adding special
-  // case for threshold_==0), but it's not worth worrying about because the
-  // amount of data it processes is relaively small.
-  for (int i = 0; i < samples_count; ++i) {
-    if (abs(samples[i]) > threshold_) {
-      silent_packet = false;
-      break;
-    }
-  }
-
-  if (!silent_packet) {
+  if (!IsSilentAudio(samples, samples_count, threshold_)) {
     silence_length_ = 0;
     return false;
   }
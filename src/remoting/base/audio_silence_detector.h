@@ -2,8 +2,8 @@
 // Use of this source code is governed by a BSD-style license that can be
 // found in the LICENSE file.
 
-#ifndef REMOTING_HOST_AUDIO_SILENCE_DETECTOR_H_
-#define REMOTING_HOST_AUDIO_SILENCE_DETECTOR_H_
+#ifndef REMOTING_BASE_AUDIO_SILENCE_DETECTOR_H_
+#define REMOTING_BASE_AUDIO_SILENCE_DETECTOR_H_
 
 #include <stddef.h>
 #include <stdint.h>
@@ -11,7 +11,8 @@
 
 namespace remoting {
 
-// Helper used in audio capturers to detect and drop silent audio packets.
+// Helper used in audio capturers and AudioPump to detect and drop silent audio
+// packets.
 class AudioSilenceDetector {
  public:
   // |threshold| is used to specify maximum absolute sample value that should
@@ -46,4 +47,4 @@ class AudioSilenceDetector {
 
 }  // namespace remoting
 
-#endif  // REMOTING_HOST_AUDIO_SILENCE_DETECTOR_H_
+#endif  // REMOTING_BASE_AUDIO_SILENCE_DETECTOR_H_
@@ -2,7 +2,7 @@
 // Use of this source code is governed by a BSD-style license that can be
 // found in the LICENSE file.
 
-#include "remoting/host/audio_silence_detector.h"
+#include "remoting/base/audio_silence_detector.h"
 
 #include <stdint.h>
 
@@ -4,7 +4,11 @@
 
 #include "remoting/base/buffered_socket_writer.h"
 
+#include <string.h>
+
+#include <algorithm>
 #include <utility>
+#include <vector>
 
 #include "base/bind.h"
 #include "base/callback_helpers.h"
@@ -17,6 +21,13 @@ namespace remoting {
 
 namespace {
 
+// Packets smaller than this are copied together into a single write. Larger
+// packets are written directly from the buffers they were queued in.
+const int kMinDirectWriteSize = 4096;
+
+// Maximum size of a write that gathers small packets.
+const int kMaxGatheredWriteSize = 65536;
+
 int WriteNetSocket(net::Socket* socket,
                    const scoped_refptr<net::IOBuffer>& buf,
                    int buf_len,
@@ -90,15 +101,60 @@ void BufferedSocketWriter::DoWrite() {
   base::WeakPtr<BufferedSocketWriter> self = weak_factory_.GetWeakPtr();
   while (self && !write_pending_ && !write_callback_.is_null() &&
          !queue_.empty()) {
-    int result = write_callback_.Run(
-        queue_.front()->data.get(), queue_.front()->data->BytesRemaining(),
-        base::BindOnce(&BufferedSocketWriter::OnWritten,
-                       weak_factory_.GetWeakPtr()),
-        queue_.front()->traffic_annotation);
+    int size;
+    scoped_refptr<net::IOBuffer> buffer = GetNextWriteBuffer(&size);
+    // Empty packets are completed without writing to the socket.
+    int result = 0;
+    if (size > 0) {
+      result = write_callback_.Run(
+          buffer, size,
+          base::BindOnce(&BufferedSocketWriter::OnWritten,
+                         weak_factory_.GetWeakPtr()),
+          queue_.front()->traffic_annotation);
+    }
     HandleWriteResult(result);
   }
 }
 
+scoped_refptr<net::IOBuffer> BufferedSocketWriter::GetNextWriteBuffer(
+    int* size) {
+  const PendingPacket& front = *queue_.front();
+  if (front.data->BytesRemaining() >= kMinDirectWriteSize) {
+    *size = front.data->BytesRemaining();
+    return front.data;
+  }
+
+  // Find the small packets that can be gathered. Packets with a different
+  // traffic annotation are written separately.
+  int gathered_size = 0;
+  int gathered_packets = 0;
+  for (const std::unique_ptr<PendingPacket>& packet : queue_) {
+    int packet_size = packet->data->BytesRemaining();
+    if (!(packet->traffic_annotation == front.traffic_annotation) ||
+        packet_size >= kMinDirectWriteSize ||
+        gathered_size + packet_size > kMaxGatheredWriteSize) {
+      break;
+    }
+    gathered_size += packet_size;
+    ++gathered_packets;
+  }
+
+  *size = gathered_size;
+  if (gathered_packets == 1 || gathered_size == 0)
+    return front.data;
+
+  scoped_refptr<net::IOBuffer> buffer =
+      base::MakeRefCounted<net::IOBuffer>(gathered_size);
+  int position = 0;
+  auto it = queue_.begin();
+  for (int i = 0; i < gathered_packets; ++i, ++it) {
+    int packet_size = (*it)->data->BytesRemaining();
+    memcpy(buffer->data() + position, (*it)->data->data(), packet_size);
+    position += packet_size;
+  }
+  return buffer;
+}
+
 void BufferedSocketWriter::HandleWriteResult(int result) {
   if (result < 0) {
     if (result == net::ERR_IO_PENDING) {
@@ -114,12 +170,26 @@ void BufferedSocketWriter::HandleWriteResult(int result) {
 
   DCHECK(!queue_.empty());
 
-  queue_.front()->data->DidConsume(result);
-
-  if (queue_.front()->data->BytesRemaining() == 0) {
-    base::OnceClosure done_task = std::move(queue_.front()->done_task);
+  // A gathered write may complete several packets. Empty packets complete
+  // along with the packets written before them.
+  std::vector<base::OnceClosure> done_tasks;
+  while (!queue_.empty()) {
+    PendingPacket* packet = queue_.front().get();
+    int consumed = std::min(result, packet->data->BytesRemaining());
+    packet->data->DidConsume(consumed);
+    result -= consumed;
+    if (packet->data->BytesRemaining() > 0)
+      break;
+    done_tasks.push_back(std::move(packet->done_task));
     queue_.pop_front();
+  }
+  DCHECK_EQ(0, result);
 
+  base::WeakPtr<BufferedSocketWriter> self = weak_factory_.GetWeakPtr();
+  for (base::OnceClosure& done_task : done_tasks) {
+    // Stop if one of the tasks has destroyed the writer.
+    if (!self)
+      break;
     if (!done_task.is_null())
       std::move(done_task).Run();
   }
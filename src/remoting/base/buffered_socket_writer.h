@@ -23,6 +23,10 @@ class Socket;
 namespace remoting {
 
 // BufferedSocketWriter implement write data queue for stream sockets.
+//
+// Queued data is written without being copied, except that runs of small
+// packets (e.g. input events or control messages written in a burst) are
+// gathered into a single socket write.
 class BufferedSocketWriter {
  public:
   typedef base::RepeatingCallback<int(
@@ -59,6 +63,12 @@ class BufferedSocketWriter {
   struct PendingPacket;
 
   void DoWrite();
+
+  // Returns the buffer to pass to the next write, and its size in |size|.
+  // This is either the rest of the first queued packet, or a copy of the small
+  // packets at the front of the queue.
+  scoped_refptr<net::IOBuffer> GetNextWriteBuffer(int* size);
+
   void HandleWriteResult(int result);
   void OnWritten(int result);
 
@@ -34,6 +34,18 @@ int WriteNetSocket(net::Socket* socket,
                        traffic_annotation);
 }
 
+int CountWriteNetSocket(
+    int* write_count,
+    net::Socket* socket,
+    const scoped_refptr<net::IOBuffer>& buf,
+    int buf_len,
+    net::CompletionOnceCallback callback,
+    const net::NetworkTrafficAnnotationTag& traffic_annotation) {
+  ++*write_count;
+  return WriteNetSocket(socket, buf, buf_len, std::move(callback),
+                        traffic_annotation);
+}
+
 class SocketDataProvider: public net::SocketDataProvider {
  public:
   SocketDataProvider()
@@ -261,6 +273,72 @@ TEST_F(BufferedSocketWriterTest, TestWriteErrorAsync) {
             socket_data_provider_.written_data().size());
 }
 
+// Verify that small packets queued together are sent with one write.
+TEST_F(BufferedSocketWriterTest, GathersSmallPackets) {
+  const int kPacketSize = 100;
+  const int kPacketCount = 20;
+  std::string expected_data;
+  int done_count = 0;
+  for (int i = 0; i < kPacketCount; ++i) {
+    scoped_refptr<net::IOBufferWithSize> packet =
+        base::MakeRefCounted<net::IOBufferWithSize>(kPacketSize);
+    memset(packet->data(), i, kPacketSize);
+    expected_data.append(packet->data(), kPacketSize);
+    writer_->Write(packet,
+                   base::BindOnce([](int* done_count) { ++*done_count; },
+                                  &done_count),
+                   TRAFFIC_ANNOTATION_FOR_TESTS);
+  }
+
+  int write_count = 0;
+  writer_->Start(
+      base::BindRepeating(&CountWriteNetSocket, &write_count, socket_.get()),
+      base::BindOnce(&BufferedSocketWriterTest::OnWriteFailed,
+                     base::Unretained(this)));
+  base::RunLoop().RunUntilIdle();
+
+  EXPECT_EQ(1, write_count);
+  EXPECT_EQ(kPacketCount, done_count);
+  EXPECT_EQ(expected_data, socket_data_provider_.written_data());
+  EXPECT_FALSE(writer_->has_data_pending());
+}
+
+// Verify that empty packets complete without writing to the socket.
+TEST_F(BufferedSocketWriterTest, WriteEmpty) {
+  int write_count = 0;
+  writer_->Start(
+      base::BindRepeating(&CountWriteNetSocket, &write_count, socket_.get()),
+      base::BindOnce(&BufferedSocketWriterTest::OnWriteFailed,
+                     base::Unretained(this)));
+
+  int done_count = 0;
+  writer_->Write(base::MakeRefCounted<net::IOBufferWithSize>(0),
+                 base::BindOnce([](int* done_count) { ++*done_count; },
+                                &done_count),
+                 TRAFFIC_ANNOTATION_FOR_TESTS);
+  base::RunLoop().RunUntilIdle();
+
+  EXPECT_EQ(0, write_count);
+  EXPECT_EQ(1, done_count);
+  EXPECT_FALSE(writer_->has_data_pending());
+
+  // An empty packet between others completes with the write before it.
+  scoped_refptr<net::IOBufferWithSize> packet =
+      base::MakeRefCounted<net::IOBufferWithSize>(10);
+  memset(packet->data(), 1, 10);
+  writer_->Write(packet, base::OnceClosure(), TRAFFIC_ANNOTATION_FOR_TESTS);
+  writer_->Write(base::MakeRefCounted<net::IOBufferWithSize>(0),
+                 base::BindOnce([](int* done_count) { ++*done_count; },
+                                &done_count),
+                 TRAFFIC_ANNOTATION_FOR_TESTS);
+  writer_->Write(packet, base::OnceClosure(), TRAFFIC_ANNOTATION_FOR_TESTS);
+  base::RunLoop().RunUntilIdle();
+
+  EXPECT_EQ(2, done_count);
+  EXPECT_EQ(std::string(20, 1), socket_data_provider_.written_data());
+  EXPECT_FALSE(writer_->has_data_pending());
+}
+
 TEST_F(BufferedSocketWriterTest, WriteBeforeStart) {
   writer_->Write(test_buffer_, base::OnceClosure(),
                  TRAFFIC_ANNOTATION_FOR_TESTS);
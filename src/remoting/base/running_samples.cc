@@ -31,6 +31,13 @@ void RunningSamples::Record(int64_t value) {
   }
 }
 
+void RunningSamples::Reset() {
+  DCHECK(thread_checker_.CalledOnValidThread());
+
+  data_points_.clear();
+  sum_ = 0;
+}
+
 double RunningSamples::Average() const {
   DCHECK(thread_checker_.CalledOnValidThread());
 
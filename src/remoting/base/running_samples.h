@@ -27,6 +27,9 @@ class RunningSamples {
   // Records a point sample.
   void Record(int64_t value);
 
+  // Discards all recorded samples.
+  void Reset();
+
   // Returns the average over up to |window_size| of the most recent samples.
   // 0 if no sample available
   double Average() const;
@@ -89,4 +89,17 @@ TEST(RunningSamplesTest, MaxLongWindow) {
       });
 }
 
+TEST(RunningSamplesTest, Reset) {
+  RunningSamples samples(3);
+  samples.Record(10);
+  samples.Record(20);
+  samples.Reset();
+  EXPECT_TRUE(samples.IsEmpty());
+  EXPECT_EQ(0, samples.Average());
+  EXPECT_EQ(0, samples.Max());
+
+  samples.Record(30);
+  EXPECT_EQ(30, samples.Average());
+}
+
 }  // namespace remoting
@@ -34,6 +34,10 @@ const int kFrameSamples =
 const AudioPacket::BytesPerSample kBytesPerSample =
     AudioPacket::BYTES_PER_SAMPLE_2;
 
+// Encoded frames of this size or smaller are DTX frames, which only need to
+// be sent to signal the start of a pause in the transmission.
+const int kMaxDtxFrameBytes = 2;
+
 bool IsSupportedSampleRate(int rate) {
   return rate == 44100 || rate == 48000;
 }
@@ -65,6 +69,8 @@ void AudioEncoderOpus::InitEncoder() {
   }
 
   opus_encoder_ctl(encoder_, OPUS_SET_BITRATE(kOutputBitrateBps));
+  opus_encoder_ctl(encoder_, OPUS_SET_DTX(1));
+  in_dtx_ = false;
 
   frame_size_ = sampling_rate_ * kFrameSizeMs /
       base::Time::kMillisecondsPerSecond;
@@ -210,6 +216,13 @@ std::unique_ptr<AudioPacket> AudioEncoderOpus::Encode(
     DCHECK_LE(result, static_cast<int>(data->length()));
     data->resize(result);
 
+    // Only the first of consecutive DTX frames is sent. Silence that lasts
+    // longer is dropped by AudioPump, see AudioSilenceDetector.
+    bool dtx_frame = result <= kMaxDtxFrameBytes;
+    if (dtx_frame && in_dtx_)
+      encoded_packet->mutable_data()->RemoveLast();
+    in_dtx_ = dtx_frame;
+
     // Cleanup leftover buffer.
     if (samples_consumed >= leftover_samples_) {
       samples_consumed -= leftover_samples_;
@@ -60,6 +60,10 @@ class AudioEncoderOpus : public AudioEncoder {
   int leftover_buffer_size_;
   int leftover_samples_;
 
+  // Set when the last frame sent was a DTX frame, i.e. the encoder signalled
+  // a pause in the transmission.
+  bool in_dtx_ = false;
+
   DISALLOW_COPY_AND_ASSIGN(AudioEncoderOpus);
 };
 
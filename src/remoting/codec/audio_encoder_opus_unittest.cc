@@ -7,7 +7,9 @@
 #include <stddef.h>
 #include <stdint.h>
 
+#include <algorithm>
 #include <cmath>
+#include <string>
 #include <utility>
 
 #include "base/logging.h"
@@ -183,6 +185,45 @@ TEST_F(OpusAudioEncoderTest, Resampling) {
   TestEncodeDecode(2000, 10000, AudioPacket::SAMPLING_RATE_44100);
 }
 
+TEST_F(OpusAudioEncoderTest, RepeatedDtxFramesAreNotSent) {
+  const int kPacketSize = 2000;
+  const int kSignalPackets = 24;
+  const AudioPacket::SamplingRate kRate = AudioPacket::SAMPLING_RATE_48000;
+
+  encoder_.reset(new AudioEncoderOpus());
+  decoder_.reset(new AudioDecoderOpus());
+
+  // Encodes |count| packets, and returns the number of encoded frames.
+  int pos = 0;
+  auto encode_packets = [&](int count, bool silent) {
+    int frames = 0;
+    for (int i = 0; i < count; ++i, pos += kPacketSize) {
+      std::unique_ptr<AudioPacket> source_packet =
+          CreatePacket(kPacketSize, kRate, 3000, pos);
+      if (silent) {
+        std::string* data = source_packet->mutable_data(0);
+        std::fill(data->begin(), data->end(), 0);
+      }
+      std::unique_ptr<AudioPacket> encoded =
+          encoder_->Encode(std::move(source_packet));
+      if (encoded) {
+        frames += encoded->data_size();
+        EXPECT_TRUE(decoder_->Decode(std::move(encoded)));
+      }
+    }
+    return frames;
+  };
+
+  // One second of signal, then two seconds (100 frames) of silence. Once
+  // Opus switches to DTX, only the frames that start a pause or update the
+  // comfort noise are sent.
+  EXPECT_GT(encode_packets(kSignalPackets, false), 0);
+  EXPECT_LT(encode_packets(kSignalPackets * 2, true), 30);
+
+  // Frames are sent again when the signal is back.
+  EXPECT_GT(encode_packets(kSignalPackets, false), 0);
+}
+
 TEST_F(OpusAudioEncoderTest, BufferSizeAndResampling) {
   TestEncodeDecode(500, 3000, AudioPacket::SAMPLING_RATE_44100);
   TestEncodeDecode(1000, 3000, AudioPacket::SAMPLING_RATE_44100);
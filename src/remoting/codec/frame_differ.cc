@@ -0,0 +1,220 @@
+// Copyright 2020 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "remoting/codec/frame_differ.h"
+
+#include <string.h>
+
+#include <algorithm>
+#include <utility>
+
+#include "base/check_op.h"
+#include "build/build_config.h"
+#include "third_party/webrtc/modules/desktop_capture/desktop_frame.h"
+
+#if defined(ARCH_CPU_X86_FAMILY)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON__) || defined(__ARM_NEON)
+#include <arm_neon.h>
+#define FRAME_DIFFER_USE_NEON
+#endif
+
+namespace remoting {
+
+namespace {
+
+// Returns true if any of the first |row_bytes| bytes of the |rows| rows
+// starting at |a| and |b| differ. Stops at the first row that differs.
+bool RowsDiffer(const uint8_t* a,
+                int a_stride,
+                const uint8_t* b,
+                int b_stride,
+                int row_bytes,
+                int rows) {
+  for (int y = 0; y < rows; ++y, a += a_stride, b += b_stride) {
+    int i = 0;
+#if defined(ARCH_CPU_X86_FAMILY)
+    __m128i diff = _mm_setzero_si128();
+    for (; i + 16 <= row_bytes; i += 16) {
+      __m128i va = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i));
+      __m128i vb = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i));
+      diff = _mm_or_si128(diff, _mm_xor_si128(va, vb));
+    }
+    if (_mm_movemask_epi8(_mm_cmpeq_epi8(diff, _mm_setzero_si128())) !=
+        0xffff) {
+      return true;
+    }
+#elif defined(FRAME_DIFFER_USE_NEON)
+    uint8x16_t diff = vdupq_n_u8(0);
+    for (; i + 16 <= row_bytes; i += 16)
+      diff = vorrq_u8(diff, veorq_u8(vld1q_u8(a + i), vld1q_u8(b + i)));
+    uint64x2_t diff64 = vreinterpretq_u64_u8(diff);
+    if (vgetq_lane_u64(diff64, 0) | vgetq_lane_u64(diff64, 1))
+      return true;
+#endif
+    if (i < row_bytes && memcmp(a + i, b + i, row_bytes - i) != 0)
+      return true;
+  }
+  return false;
+}
+
+}  // namespace
+
+constexpr int FrameDiffer::kDefaultBlockSize;
+constexpr int FrameDiffer::kMaxRects;
+
+FrameDiffer::FrameDiffer() : FrameDiffer(kDefaultBlockSize) {}
+
+FrameDiffer::FrameDiffer(int block_size) : block_size_(block_size) {
+  DCHECK_GT(block_size_, 0);
+}
+
+FrameDiffer::~FrameDiffer() = default;
+
+void FrameDiffer::UpdateRegion(webrtc::DesktopFrame* frame) {
+  const webrtc::DesktopSize& size = frame->size();
+  webrtc::DesktopRect frame_rect = webrtc::DesktopRect::MakeSize(size);
+
+  if (!previous_frame_ || !previous_frame_->size().equals(size)) {
+    previous_frame_ = std::make_unique<webrtc::BasicDesktopFrame>(size);
+    previous_frame_->CopyPixelsFrom(*frame, webrtc::DesktopVector(),
+                                    frame_rect);
+    blocks_per_row_ = (size.width() + block_size_ - 1) / block_size_;
+    block_rows_ = (size.height() + block_size_ - 1) / block_size_;
+    frame->mutable_updated_region()->SetRect(frame_rect);
+    return;
+  }
+
+  block_states_.assign(blocks_per_row_ * block_rows_, BlockState::kUnchecked);
+  for (webrtc::DesktopRegion::Iterator it(frame->updated_region());
+       !it.IsAtEnd(); it.Advance()) {
+    webrtc::DesktopRect rect = it.rect();
+    rect.IntersectWith(frame_rect);
+    if (!rect.is_empty())
+      CompareBlocks(*frame, rect);
+  }
+
+  std::vector<webrtc::DesktopRect> rects = GetChangedRects(size);
+  if (rects.size() > static_cast<size_t>(kMaxRects))
+    rects = GetChangedBands(size);
+
+  webrtc::DesktopRegion* updated_region = frame->mutable_updated_region();
+  updated_region->Clear();
+  for (const webrtc::DesktopRect& rect : rects) {
+    updated_region->AddRect(rect);
+    previous_frame_->CopyPixelsFrom(*frame, rect.top_left(), rect);
+  }
+}
+
+void FrameDiffer::CompareBlocks(const webrtc::DesktopFrame& frame,
+                                const webrtc::DesktopRect& rect) {
+  webrtc::DesktopRect frame_rect = webrtc::DesktopRect::MakeSize(frame.size());
+  for (int y = rect.top() / block_size_; y <= (rect.bottom() - 1) / block_size_;
+       ++y) {
+    for (int x = rect.left() / block_size_;
+         x <= (rect.right() - 1) / block_size_; ++x) {
+      BlockState& state = block_states_[y * blocks_per_row_ + x];
+      if (state != BlockState::kUnchecked)
+        continue;
+
+      webrtc::DesktopRect block = webrtc::DesktopRect::MakeXYWH(
+          x * block_size_, y * block_size_, block_size_, block_size_);
+      block.IntersectWith(frame_rect);
+      bool changed = RowsDiffer(
+          frame.GetFrameDataAtPos(block.top_left()), frame.stride(),
+          previous_frame_->GetFrameDataAtPos(block.top_left()),
+          previous_frame_->stride(),
+          block.width() * webrtc::DesktopFrame::kBytesPerPixel,
+          block.height());
+      state = changed ? BlockState::kChanged : BlockState::kUnchanged;
+    }
+  }
+}
+
+std::vector<webrtc::DesktopRect> FrameDiffer::GetChangedRects(
+    const webrtc::DesktopSize& size) const {
+  std::vector<webrtc::DesktopRect> rects;
+
+  // Indices in |rects| of the runs of changed blocks ending on the previous
+  // and current rows, ordered by column. A run that spans the same columns as
+  // one on the previous row extends it downwards.
+  std::vector<size_t> previous_row;
+  std::vector<size_t> current_row;
+
+  for (int y = 0; y < block_rows_; ++y) {
+    current_row.clear();
+    size_t previous = 0;
+    int x = 0;
+    while (x < blocks_per_row_) {
+      if (block_states_[y * blocks_per_row_ + x] != BlockState::kChanged) {
+        ++x;
+        continue;
+      }
+      int run_start = x;
+      while (x < blocks_per_row_ &&
+             block_states_[y * blocks_per_row_ + x] == BlockState::kChanged) {
+        ++x;
+      }
+      webrtc::DesktopRect run = webrtc::DesktopRect::MakeLTRB(
+          run_start * block_size_, y * block_size_,
+          std::min(x * block_size_, size.width()),
+          std::min((y + 1) * block_size_, size.height()));
+
+      while (previous < previous_row.size() &&
+             rects[previous_row[previous]].left() < run.left()) {
+        ++previous;
+      }
+      if (previous < previous_row.size() &&
+          rects[previous_row[previous]].left() == run.left() &&
+          rects[previous_row[previous]].right() == run.right()) {
+        webrtc::DesktopRect& rect = rects[previous_row[previous]];
+        rect = webrtc::DesktopRect::MakeLTRB(rect.left(), rect.top(),
+                                             rect.right(), run.bottom());
+        current_row.push_back(previous_row[previous]);
+      } else {
+        current_row.push_back(rects.size());
+        rects.push_back(run);
+      }
+
+      // The caller falls back to bands, so there's no need to go on.
+      if (rects.size() > static_cast<size_t>(kMaxRects))
+        return rects;
+    }
+    std::swap(previous_row, current_row);
+  }
+
+  return rects;
+}
+
+std::vector<webrtc::DesktopRect> FrameDiffer::GetChangedBands(
+    const webrtc::DesktopSize& size) const {
+  std::vector<webrtc::DesktopRect> bands;
+  int rows_per_band = (block_rows_ + kMaxRects - 1) / kMaxRects;
+  for (int band_top = 0; band_top < block_rows_; band_top += rows_per_band) {
+    int band_bottom = std::min(band_top + rows_per_band, block_rows_);
+    int left = blocks_per_row_;
+    int right = 0;
+    int top = band_bottom;
+    int bottom = band_top;
+    for (int y = band_top; y < band_bottom; ++y) {
+      for (int x = 0; x < blocks_per_row_; ++x) {
+        if (block_states_[y * blocks_per_row_ + x] != BlockState::kChanged)
+          continue;
+        left = std::min(left, x);
+        right = std::max(right, x + 1);
+        top = std::min(top, y);
+        bottom = std::max(bottom, y + 1);
+      }
+    }
+    if (left < right) {
+      bands.push_back(webrtc::DesktopRect::MakeLTRB(
+          left * block_size_, top * block_size_,
+          std::min(right * block_size_, size.width()),
+          std::min(bottom * block_size_, size.height())));
+    }
+  }
+  return bands;
+}
+
+}  // namespace remoting
@@ -0,0 +1,88 @@
+// Copyright 2020 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef REMOTING_CODEC_FRAME_DIFFER_H_
+#define REMOTING_CODEC_FRAME_DIFFER_H_
+
+#include <stdint.h>
+
+#include <memory>
+#include <vector>
+
+#include "base/macros.h"
+#include "third_party/webrtc/modules/desktop_capture/desktop_geometry.h"
+
+namespace webrtc {
+class DesktopFrame;
+}  // namespace webrtc
+
+namespace remoting {
+
+// FrameDiffer narrows the updated region reported by a capturer down to the
+// blocks of pixels that actually changed since the previous frame, so that
+// the encoder doesn't spend time on areas that were repainted with the same
+// content. Blocks are compared with SSE2 on x86 and NEON on ARM.
+//
+// The changed blocks are coalesced into at most kMaxRects rectangles. When
+// the content changes in many scattered places, e.g. for video or noise, the
+// region is widened to bands spanning the changed blocks rather than growing
+// without bound.
+//
+// This mostly duplicates webrtc::DesktopCapturerDifferWrapper, which also
+// compares 32x32 blocks with SSE2 and which DesktopCapturerProxy uses when
+// DesktopCaptureOptions::detect_updated_region() is set. FrameDiffer is only
+// used when that option is off (see ClientSession), and adds NEON and the
+// bound on the number of rects on top of what the wrapper does. Prefer moving
+// those into the wrapper over growing this class further.
+class FrameDiffer {
+ public:
+  static constexpr int kDefaultBlockSize = 32;
+  static constexpr int kMaxRects = 16;
+
+  FrameDiffer();
+  explicit FrameDiffer(int block_size);
+  ~FrameDiffer();
+
+  // Replaces the updated region of |frame| with the blocks within it that
+  // differ from the previous frame. The whole frame is treated as updated if
+  // there is no previous frame of the same size.
+  void UpdateRegion(webrtc::DesktopFrame* frame);
+
+ private:
+  enum class BlockState : uint8_t {
+    kUnchecked,
+    kUnchanged,
+    kChanged,
+  };
+
+  // Compares the blocks of |frame| that intersect |rect| with the previous
+  // frame, and marks them in |block_states_|.
+  void CompareBlocks(const webrtc::DesktopFrame& frame,
+                     const webrtc::DesktopRect& rect);
+
+  // Returns the rectangles covering the changed blocks in |block_states_|.
+  std::vector<webrtc::DesktopRect> GetChangedRects(
+      const webrtc::DesktopSize& size) const;
+
+  // Returns at most kMaxRects bands that cover the changed blocks.
+  std::vector<webrtc::DesktopRect> GetChangedBands(
+      const webrtc::DesktopSize& size) const;
+
+  const int block_size_;
+
+  // Copy of the previously diffed frame. Only the updated parts are copied
+  // on each call.
+  std::unique_ptr<webrtc::DesktopFrame> previous_frame_;
+
+  // State of each block of the current frame, in rows.
+  std::vector<BlockState> block_states_;
+  int blocks_per_row_ = 0;
+  int block_rows_ = 0;
+
+  DISALLOW_COPY_AND_ASSIGN(FrameDiffer);
+};
+
+}  // namespace remoting
+
+#endif  // REMOTING_CODEC_FRAME_DIFFER_H_
@@ -0,0 +1,152 @@
+// Copyright 2020 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "remoting/codec/frame_differ.h"
+
+#include <stdint.h>
+#include <string.h>
+
+#include "testing/gtest/include/gtest/gtest.h"
+#include "third_party/webrtc/modules/desktop_capture/desktop_frame.h"
+
+using webrtc::BasicDesktopFrame;
+using webrtc::DesktopRect;
+using webrtc::DesktopRegion;
+using webrtc::DesktopSize;
+using webrtc::DesktopVector;
+
+namespace remoting {
+
+namespace {
+
+void FillFrame(BasicDesktopFrame* frame, uint8_t value) {
+  memset(frame->data(), value, frame->stride() * frame->size().height());
+  frame->mutable_updated_region()->SetRect(
+      DesktopRect::MakeSize(frame->size()));
+}
+
+void SetPixel(BasicDesktopFrame* frame, int x, int y, uint32_t color) {
+  *reinterpret_cast<uint32_t*>(frame->GetFrameDataAtPos(DesktopVector(x, y))) =
+      color;
+}
+
+}  // namespace
+
+TEST(FrameDifferTest, FirstFrameIsFullyUpdated) {
+  BasicDesktopFrame frame(DesktopSize(100, 100));
+  FillFrame(&frame, 0);
+  frame.mutable_updated_region()->SetRect(DesktopRect::MakeXYWH(0, 0, 8, 8));
+
+  FrameDiffer differ;
+  differ.UpdateRegion(&frame);
+  EXPECT_TRUE(DesktopRegion(DesktopRect::MakeSize(frame.size()))
+                  .Equals(frame.updated_region()));
+}
+
+TEST(FrameDifferTest, UnchangedFrameHasEmptyRegion) {
+  BasicDesktopFrame frame(DesktopSize(100, 100));
+  FillFrame(&frame, 0x20);
+
+  FrameDiffer differ;
+  differ.UpdateRegion(&frame);
+  FillFrame(&frame, 0x20);
+  differ.UpdateRegion(&frame);
+  EXPECT_TRUE(frame.updated_region().is_empty());
+}
+
+TEST(FrameDifferTest, ReportsChangedBlocks) {
+  BasicDesktopFrame frame(DesktopSize(100, 50));
+  FillFrame(&frame, 0);
+
+  FrameDiffer differ;
+  differ.UpdateRegion(&frame);
+  FillFrame(&frame, 0);
+  SetPixel(&frame, 40, 20, 0xff0000ff);
+  // Blocks at the edges are clipped to the frame.
+  SetPixel(&frame, 99, 49, 0xff00ff00);
+  differ.UpdateRegion(&frame);
+
+  DesktopRegion expected;
+  expected.AddRect(DesktopRect::MakeXYWH(32, 0, 32, 32));
+  expected.AddRect(DesktopRect::MakeXYWH(96, 32, 4, 18));
+  EXPECT_TRUE(expected.Equals(frame.updated_region()));
+
+  // The changes are now part of the previous frame.
+  frame.mutable_updated_region()->SetRect(DesktopRect::MakeSize(frame.size()));
+  differ.UpdateRegion(&frame);
+  EXPECT_TRUE(frame.updated_region().is_empty());
+}
+
+TEST(FrameDifferTest, SmallBlocks) {
+  BasicDesktopFrame frame(DesktopSize(64, 64));
+  FillFrame(&frame, 0);
+
+  FrameDiffer differ(16);
+  differ.UpdateRegion(&frame);
+  FillFrame(&frame, 0);
+  SetPixel(&frame, 20, 40, 0xffffffff);
+  differ.UpdateRegion(&frame);
+  EXPECT_TRUE(DesktopRegion(DesktopRect::MakeXYWH(16, 32, 16, 16))
+                  .Equals(frame.updated_region()));
+}
+
+TEST(FrameDifferTest, OnlyComparesUpdatedRegion) {
+  BasicDesktopFrame frame(DesktopSize(128, 128));
+  FillFrame(&frame, 0);
+
+  FrameDiffer differ;
+  differ.UpdateRegion(&frame);
+  SetPixel(&frame, 10, 10, 0xffffffff);
+  SetPixel(&frame, 100, 100, 0xffffffff);
+  frame.mutable_updated_region()->SetRect(DesktopRect::MakeXYWH(0, 0, 16, 16));
+  differ.UpdateRegion(&frame);
+  EXPECT_TRUE(DesktopRegion(DesktopRect::MakeXYWH(0, 0, 32, 32))
+                  .Equals(frame.updated_region()));
+}
+
+TEST(FrameDifferTest, CoalescesScatteredChanges) {
+  BasicDesktopFrame frame(DesktopSize(1024, 1024));
+  FillFrame(&frame, 0);
+
+  FrameDiffer differ;
+  differ.UpdateRegion(&frame);
+
+  // Change every other block, as noisy video content would.
+  DesktopRegion changed;
+  for (int y = 0; y < 1024; y += 32) {
+    for (int x = (y / 32) % 2 * 32; x < 1024; x += 64) {
+      SetPixel(&frame, x, y, 0xffffffff);
+      changed.AddRect(DesktopRect::MakeXYWH(x, y, 1, 1));
+    }
+  }
+  frame.mutable_updated_region()->SetRect(DesktopRect::MakeSize(frame.size()));
+  differ.UpdateRegion(&frame);
+
+  int rect_count = 0;
+  for (DesktopRegion::Iterator it(frame.updated_region()); !it.IsAtEnd();
+       it.Advance()) {
+    ++rect_count;
+  }
+  EXPECT_LE(rect_count, FrameDiffer::kMaxRects);
+
+  DesktopRegion missed(changed);
+  missed.Subtract(frame.updated_region());
+  EXPECT_TRUE(missed.is_empty());
+}
+
+TEST(FrameDifferTest, SizeChangeUpdatesWholeFrame) {
+  BasicDesktopFrame frame(DesktopSize(64, 64));
+  FillFrame(&frame, 0);
+
+  FrameDiffer differ;
+  differ.UpdateRegion(&frame);
+
+  BasicDesktopFrame resized_frame(DesktopSize(96, 64));
+  FillFrame(&resized_frame, 0);
+  differ.UpdateRegion(&resized_frame);
+  EXPECT_TRUE(DesktopRegion(DesktopRect::MakeSize(resized_frame.size()))
+                  .Equals(resized_frame.updated_region()));
+}
+
+}  // namespace remoting
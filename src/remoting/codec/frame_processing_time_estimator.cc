@@ -93,6 +93,18 @@ void FrameProcessingTimeEstimator::SetBandwidthKbps(int bandwidth_kbps) {
   }
 }
 
+void FrameProcessingTimeEstimator::Reset() {
+  delta_frame_processing_us_.Reset();
+  delta_frame_size_.Reset();
+  key_frame_processing_us_.Reset();
+  key_frame_size_.Reset();
+  frame_finish_ticks_.clear();
+  delta_frame_count_ = 0;
+  key_frame_count_ = 0;
+  bandwidth_kbps_.Reset();
+  start_time_ = base::TimeTicks();
+}
+
 base::TimeDelta FrameProcessingTimeEstimator::EstimatedProcessingTime(
     bool key_frame) const {
   // Avoid returning 0 if there are no records for delta-frames.
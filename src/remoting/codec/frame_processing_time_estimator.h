@@ -32,6 +32,10 @@ class FrameProcessingTimeEstimator {
   // ignored.
   void SetBandwidthKbps(int bandwidth_kbps);
 
+  // Discards all records, e.g. after a change to the encoder configuration
+  // makes them stale.
+  void Reset();
+
   // Returns the estimated processing time of a frame. The TimeDelta includes
   // both capturing and encoding time.
   base::TimeDelta EstimatedProcessingTime(bool key_frame) const;
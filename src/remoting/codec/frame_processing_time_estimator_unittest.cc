@@ -247,6 +247,27 @@ TEST(FrameProcessingTimeEstimatorTest,
   EXPECT_EQ(1, estimator.EstimatedFrameRate());
 }
 
+TEST(FrameProcessingTimeEstimatorTest, ResetDiscardsRecords) {
+  TestFrameProcessingTimeEstimator estimator;
+  for (int i = 0; i < 10; i++) {
+    estimator.StartFrame();
+    estimator.TimeElapseMs(50);
+    estimator.FinishFrame(CreateEncodedFrame(i == 0, 50));
+  }
+  estimator.SetBandwidthKbps(1000);
+  estimator.Reset();
+  EXPECT_EQ(base::TimeDelta(), estimator.EstimatedProcessingTime());
+  EXPECT_EQ(base::TimeDelta::FromMinutes(1), estimator.EstimatedTransitTime());
+  EXPECT_EQ(0, estimator.EstimatedFrameSize());
+  EXPECT_EQ(base::TimeDelta(), estimator.RecentAverageFrameInterval());
+
+  estimator.StartFrame();
+  estimator.TimeElapseMs(20);
+  estimator.FinishFrame(CreateEncodedFrame(false, 50));
+  EXPECT_EQ(base::TimeDelta::FromMilliseconds(20),
+            estimator.EstimatedProcessingTime(false));
+}
+
 TEST(FrameProcessingTimeEstimatorTest,
      RecentAverageFrameIntervalShouldConsiderDelay) {
   TestFrameProcessingTimeEstimator estimator;
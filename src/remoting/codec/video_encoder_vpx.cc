@@ -4,12 +4,14 @@
 
 #include "remoting/codec/video_encoder_vpx.h"
 
+#include <algorithm>
 #include <utility>
 
 #include "base/bind.h"
 #include "base/logging.h"
 #include "base/memory/ptr_util.h"
 #include "base/system/sys_info.h"
+#include "remoting/base/constants.h"
 #include "remoting/base/util.h"
 #include "remoting/proto/video.pb.h"
 #include "third_party/libvpx/source/libvpx/vpx/vp8cx.h"
@@ -38,6 +40,54 @@ const int kVp9I444ProfileNumber = 1;
 const int kVp9AqModeNone = 0;
 const int kVp9AqModeCyclicRefresh = 3;
 
+// VP9 speeds (CPUUSED) for lossy and lossless encoding, and the fastest speed
+// that frames with large updates may be switched to.
+const int kVp9LossySpeed = 6;
+const int kVp9LosslessSpeed = 5;
+const int kVp9MaxSpeed = 8;
+
+// Updates covering at least 1/kLargeUpdateFraction of the frame are large.
+const int kLargeUpdateFraction = 4;
+
+// Number of frames with large updates to encode before changing their speed.
+const int kFramesPerSpeedChange = 5;
+
+// Frames with large updates should be encoded within one frame interval.
+constexpr base::TimeDelta kTargetEncodeTime =
+    base::TimeDelta::FromSeconds(1) / kTargetFrameRate;
+
+// Frames are split across one encoder thread per this many pixels.
+const int kPixelsPerEncoderThread = 1280 * 720;
+
+// The minimum width of a VP9 tile column.
+const int kMinVp9TileColumnWidth = 256;
+
+int GetEncoderThreadCount(const webrtc::DesktopSize& size) {
+  // Going to multiple threads on low end windows systems can really hurt
+  // performance.
+  // http://crbug.com/99179
+  int processors = base::SysInfo::NumberOfProcessors();
+  if (processors <= 2)
+    return 1;
+
+  // Using 2 threads gives a great boost in performance for most systems with
+  // adequate processing power. Larger frames use more threads, leaving at
+  // least half of the processors for capturing and the rest of the host.
+  int threads = size.width() * size.height() / kPixelsPerEncoderThread;
+  return std::max(2, std::min(threads, processors / 2));
+}
+
+// Returns the log2 of the number of tile columns to split |width| pixel wide
+// frames into, so that each of the |threads| threads can encode its own.
+int GetVp9Log2TileColumns(int width, int threads) {
+  int log2_tile_columns = 0;
+  while ((1 << log2_tile_columns) < threads &&
+         (kMinVp9TileColumnWidth << (log2_tile_columns + 1)) <= width) {
+    ++log2_tile_columns;
+  }
+  return log2_tile_columns;
+}
+
 void SetCommonCodecParameters(vpx_codec_enc_cfg_t* config,
                               const webrtc::DesktopSize& size) {
   // Use millisecond granularity time base.
@@ -57,11 +107,7 @@ void SetCommonCodecParameters(vpx_codec_enc_cfg_t* config,
   config->kf_min_dist = 10000;
   config->kf_max_dist = 10000;
 
-  // Using 2 threads gives a great boost in performance for most systems with
-  // adequate processing power. NB: Going to multiple threads on low end
-  // windows systems can really hurt performance.
-  // http://crbug.com/99179
-  config->g_threads = (base::SysInfo::NumberOfProcessors() > 2) ? 2 : 1;
+  config->g_threads = GetEncoderThreadCount(size);
 }
 
 void SetVp8CodecParameters(vpx_codec_enc_cfg_t* config,
@@ -125,7 +171,7 @@ void SetVp9CodecOptions(vpx_codec_ctx_t* codec, bool lossless_encode) {
   // Request the lowest-CPU usage that VP9 supports, which depends on whether
   // we are encoding lossy or lossless.
   // Note that this is configured via the same parameter as for VP8.
-  int cpu_used = lossless_encode ? 5 : 6;
+  int cpu_used = lossless_encode ? kVp9LosslessSpeed : kVp9LossySpeed;
   vpx_codec_err_t ret = vpx_codec_control(codec, VP8E_SET_CPUUSED, cpu_used);
   DCHECK_EQ(VPX_CODEC_OK, ret) << "Failed to set CPUUSED";
 
@@ -145,6 +191,20 @@ void SetVp9CodecOptions(vpx_codec_ctx_t* codec, bool lossless_encode) {
   DCHECK_EQ(VPX_CODEC_OK, ret) << "Failed to set aq mode";
 }
 
+void SetVp9ThreadingOptions(vpx_codec_ctx_t* codec,
+                            const vpx_codec_enc_cfg_t& config) {
+  // Split the frame into tile columns that threads encode in parallel. Areas
+  // left out of the active map are skipped in every tile.
+  vpx_codec_err_t ret =
+      vpx_codec_control(codec, VP9E_SET_TILE_COLUMNS,
+                        GetVp9Log2TileColumns(config.g_w, config.g_threads));
+  DCHECK_EQ(VPX_CODEC_OK, ret) << "Failed to set tile columns";
+
+  // Let threads also share the rows within each tile.
+  ret = vpx_codec_control(codec, VP9E_SET_ROW_MT, config.g_threads > 1 ? 1 : 0);
+  DCHECK_EQ(VPX_CODEC_OK, ret) << "Failed to set row multi-threading";
+}
+
 void FreeImageIfMismatched(bool use_i444,
                            const webrtc::DesktopSize& size,
                            std::unique_ptr<vpx_image_t>* out_image,
@@ -243,6 +303,11 @@ void VideoEncoderVpx::SetTickClockForTests(const base::TickClock* tick_clock) {
   clock_ = tick_clock;
 }
 
+void VideoEncoderVpx::SetEncodeTimeEstimatorForTests(
+    std::unique_ptr<FrameProcessingTimeEstimator> estimator) {
+  encode_time_estimator_ = std::move(estimator);
+}
+
 void VideoEncoderVpx::SetLosslessEncode(bool want_lossless) {
   if (use_vp9_ && (want_lossless != lossless_encode_)) {
     lossless_encode_ = want_lossless;
@@ -296,6 +361,14 @@ std::unique_ptr<VideoPacket> VideoEncoderVpx::Encode(
     LOG(ERROR) << "Unable to apply active map";
   }
 
+  // Frames with large updates, such as scrolling or video, are encoded at a
+  // speed that is raised if they take too long to keep up with the frame rate.
+  bool large_update = use_vp9_ && IsLargeUpdate(updated_region);
+  if (use_vp9_)
+    SetSpeed(large_update ? large_update_speed_ : GetBaseSpeed());
+  if (large_update)
+    encode_time_estimator_->StartFrame();
+
   // Do the actual encoding.
   int timestamp = (clock_->NowTicks() - timestamp_base_).InMilliseconds();
   vpx_codec_err_t ret = vpx_codec_encode(
@@ -319,6 +392,7 @@ std::unique_ptr<VideoPacket> VideoEncoderVpx::Encode(
   // Read the encoded data.
   vpx_codec_iter_t iter = nullptr;
   bool got_data = false;
+  bool key_frame = false;
 
   // TODO(hclam): Make sure we get exactly one frame from the packet.
   // TODO(hclam): We should provide the output buffer to avoid one copy.
@@ -335,6 +409,7 @@ std::unique_ptr<VideoPacket> VideoEncoderVpx::Encode(
     switch (vpx_packet->kind) {
       case VPX_CODEC_CX_FRAME_PKT:
         got_data = true;
+        key_frame = (vpx_packet->data.frame.flags & VPX_FRAME_IS_KEY) != 0;
         packet->set_data(vpx_packet->data.frame.buf, vpx_packet->data.frame.sz);
         break;
       default:
@@ -342,12 +417,22 @@ std::unique_ptr<VideoPacket> VideoEncoderVpx::Encode(
     }
   }
 
+  if (large_update) {
+    // Only the encode time is used, so the data isn't copied.
+    WebrtcVideoEncoder::EncodedFrame encoded_frame{};
+    encoded_frame.size = frame.size();
+    encoded_frame.key_frame = key_frame;
+    encode_time_estimator_->FinishFrame(encoded_frame);
+    UpdateLargeUpdateSpeed();
+  }
+
   return packet;
 }
 
 VideoEncoderVpx::VideoEncoderVpx(bool use_vp9)
     : use_vp9_(use_vp9),
       encode_unchanged_frame_(false),
+      encode_time_estimator_(std::make_unique<FrameProcessingTimeEstimator>()),
       clock_(base::DefaultTickClock::GetInstance()) {}
 
 void VideoEncoderVpx::Configure(const webrtc::DesktopSize& size) {
@@ -408,9 +493,16 @@ void VideoEncoderVpx::Configure(const webrtc::DesktopSize& size) {
   // Apply further customizations to the codec now it's initialized.
   if (use_vp9_) {
     SetVp9CodecOptions(codec_.get(), lossless_encode_);
+    SetVp9ThreadingOptions(codec_.get(), config);
   } else {
     SetVp8CodecOptions(codec_.get());
   }
+
+  // Encode times measured with the previous configuration no longer apply.
+  speed_ = use_vp9_ ? GetBaseSpeed() : 0;
+  large_update_speed_ = std::max(large_update_speed_, speed_);
+  encode_time_estimator_->Reset();
+  large_update_count_ = 0;
 }
 
 void VideoEncoderVpx::PrepareImage(const webrtc::DesktopFrame& frame,
@@ -544,4 +636,50 @@ void VideoEncoderVpx::UpdateRegionFromActiveMap(
       webrtc::DesktopRect::MakeWH(image_->w, image_->h));
 }
 
+bool VideoEncoderVpx::IsLargeUpdate(
+    const webrtc::DesktopRegion& updated_region) const {
+  int64_t updated_area = 0;
+  for (webrtc::DesktopRegion::Iterator r(updated_region); !r.IsAtEnd();
+       r.Advance()) {
+    updated_area += r.rect().width() * r.rect().height();
+  }
+  return updated_area * kLargeUpdateFraction >=
+         static_cast<int64_t>(image_->w) * image_->h;
+}
+
+int VideoEncoderVpx::GetBaseSpeed() const {
+  DCHECK(use_vp9_);
+  return lossless_encode_ ? kVp9LosslessSpeed : kVp9LossySpeed;
+}
+
+void VideoEncoderVpx::SetSpeed(int speed) {
+  if (speed == speed_)
+    return;
+  vpx_codec_err_t ret =
+      vpx_codec_control(codec_.get(), VP8E_SET_CPUUSED, speed);
+  DCHECK_EQ(VPX_CODEC_OK, ret) << "Failed to set CPUUSED";
+  speed_ = speed;
+}
+
+void VideoEncoderVpx::UpdateLargeUpdateSpeed() {
+  if (++large_update_count_ < kFramesPerSpeedChange)
+    return;
+
+  base::TimeDelta encode_time =
+      encode_time_estimator_->EstimatedProcessingTime(false);
+  int speed = large_update_speed_;
+  if (encode_time > kTargetEncodeTime) {
+    speed = std::min(speed + 1, kVp9MaxSpeed);
+  } else if (encode_time < kTargetEncodeTime / 2) {
+    speed = std::max(speed - 1, GetBaseSpeed());
+  }
+  if (speed == large_update_speed_)
+    return;
+
+  // Times measured at the previous speed no longer apply.
+  large_update_speed_ = speed;
+  large_update_count_ = 0;
+  encode_time_estimator_->Reset();
+}
+
 }  // namespace remoting
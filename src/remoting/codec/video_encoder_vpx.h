@@ -7,10 +7,13 @@
 
 #include <stdint.h>
 
+#include <memory>
+
 #include "base/callback.h"
 #include "base/macros.h"
 #include "base/time/default_tick_clock.h"
 #include "base/time/time.h"
+#include "remoting/codec/frame_processing_time_estimator.h"
 #include "remoting/codec/scoped_vpx_codec.h"
 #include "remoting/codec/video_encoder.h"
 #include "remoting/codec/video_encoder_helper.h"
@@ -34,6 +37,14 @@ class VideoEncoderVpx : public VideoEncoder {
 
   void SetTickClockForTests(const base::TickClock* tick_clock);
 
+  // Replaces the estimator of the time taken to encode frames with large
+  // updates.
+  void SetEncodeTimeEstimatorForTests(
+      std::unique_ptr<FrameProcessingTimeEstimator> estimator);
+
+  // Returns the VP9 speed used to encode frames with large updates.
+  int large_update_speed_for_tests() const { return large_update_speed_; }
+
   // VideoEncoder interface.
   void SetLosslessEncode(bool want_lossless) override;
   void SetLosslessColor(bool want_lossless) override;
@@ -60,6 +71,21 @@ class VideoEncoderVpx : public VideoEncoder {
   // includes both content changes and areas enhanced by cyclic refresh.
   void UpdateRegionFromActiveMap(webrtc::DesktopRegion* updated_region);
 
+  // Returns true if |updated_region| covers enough of the frame that it may
+  // take longer to encode than the frame interval.
+  bool IsLargeUpdate(const webrtc::DesktopRegion& updated_region) const;
+
+  // Returns the VP9 speed to use when frames encode within the time budget.
+  int GetBaseSpeed() const;
+
+  // Applies |speed| to the encoder, if it isn't already in use.
+  void SetSpeed(int speed);
+
+  // Raises |large_update_speed_| if frames with large updates take longer to
+  // encode than the frame interval, or lowers it if they are encoding well
+  // within it.
+  void UpdateLargeUpdateSpeed();
+
   // True if the encoder is for VP9, false for VP8.
   const bool use_vp9_;
 
@@ -85,6 +111,18 @@ class VideoEncoderVpx : public VideoEncoder {
   // True if the codec wants unchanged frames to finish topping-off with.
   bool encode_unchanged_frame_;
 
+  // The speed (CPUUSED) the encoder is currently configured with.
+  int speed_ = 0;
+
+  // The VP9 speed used for frames with large updates, such as scrolling or
+  // video. Frames with small updates always use GetBaseSpeed().
+  int large_update_speed_ = 0;
+
+  // Tracks the time taken to encode frames with large updates at
+  // |large_update_speed_|, and the number of such frames.
+  std::unique_ptr<FrameProcessingTimeEstimator> encode_time_estimator_;
+  int large_update_count_ = 0;
+
   // Used to help initialize VideoPackets from DesktopFrames.
   VideoEncoderHelper helper_;
 
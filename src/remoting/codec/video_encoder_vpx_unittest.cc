@@ -11,6 +11,7 @@
 #include <vector>
 
 #include "remoting/codec/codec_test.h"
+#include "remoting/codec/frame_processing_time_estimator.h"
 #include "remoting/proto/video.pb.h"
 #include "testing/gtest/include/gtest/gtest.h"
 #include "third_party/webrtc/modules/desktop_capture/desktop_frame.h"
@@ -41,6 +42,24 @@ static std::unique_ptr<webrtc::DesktopFrame> CreateTestFrame(
   return frame;
 }
 
+// Reports every frame as taking |*encode_time| to encode.
+class FakeEncodeTimeEstimator : public FrameProcessingTimeEstimator {
+ public:
+  explicit FakeEncodeTimeEstimator(const base::TimeDelta* encode_time)
+      : encode_time_(encode_time) {}
+  ~FakeEncodeTimeEstimator() override = default;
+
+ private:
+  // Called once when a frame starts and once when it finishes.
+  base::TimeTicks Now() const override {
+    now_ += *encode_time_;
+    return now_;
+  }
+
+  const base::TimeDelta* const encode_time_;
+  mutable base::TimeTicks now_ = base::TimeTicks::Now();
+};
+
 TEST(VideoEncoderVpxTest, Vp8) {
   std::unique_ptr<VideoEncoderVpx> encoder(VideoEncoderVpx::CreateForVP8());
   TestVideoEncoder(encoder.get(), false);
@@ -164,6 +183,56 @@ TEST(VideoEncoderVpxTest, DpiPropagation) {
   EXPECT_EQ(packet->format().y_dpi(), 97);
 }
 
+// Test that the VP9 encoder speeds up frames with large updates while they
+// encode too slowly, and slows back down once they encode quickly.
+TEST(VideoEncoderVpxTest, Vp9AdaptsSpeedToEncodeTime) {
+  std::unique_ptr<VideoEncoderVpx> encoder(VideoEncoderVpx::CreateForVP9());
+  base::TimeDelta encode_time = base::TimeDelta::FromMilliseconds(100);
+  encoder->SetEncodeTimeEstimatorForTests(
+      std::make_unique<FakeEncodeTimeEstimator>(&encode_time));
+
+  std::unique_ptr<webrtc::DesktopFrame> frame(
+      CreateTestFrame(webrtc::DesktopSize(100, 100)));
+  EXPECT_TRUE(encoder->Encode(*frame));
+  const int base_speed = encoder->large_update_speed_for_tests();
+
+  int speed = base_speed;
+  for (int i = 0; i < 20; ++i) {
+    EXPECT_TRUE(encoder->Encode(*frame));
+    EXPECT_GE(encoder->large_update_speed_for_tests(), speed);
+    speed = encoder->large_update_speed_for_tests();
+  }
+  EXPECT_GT(speed, base_speed);
+
+  encode_time = base::TimeDelta::FromMilliseconds(1);
+  for (int i = 0; i < 20; ++i) {
+    EXPECT_TRUE(encoder->Encode(*frame));
+    EXPECT_LE(encoder->large_update_speed_for_tests(), speed);
+    speed = encoder->large_update_speed_for_tests();
+  }
+  EXPECT_EQ(base_speed, speed);
+}
+
+// Test that frames with small updates don't affect the speed of frames with
+// large updates.
+TEST(VideoEncoderVpxTest, Vp9SmallUpdatesKeepSpeed) {
+  std::unique_ptr<VideoEncoderVpx> encoder(VideoEncoderVpx::CreateForVP9());
+  base::TimeDelta encode_time = base::TimeDelta::FromMilliseconds(100);
+  encoder->SetEncodeTimeEstimatorForTests(
+      std::make_unique<FakeEncodeTimeEstimator>(&encode_time));
+
+  webrtc::DesktopSize frame_size(320, 240);
+  std::unique_ptr<webrtc::DesktopFrame> frame(CreateTestFrame(frame_size));
+  EXPECT_TRUE(encoder->Encode(*frame));
+  const int base_speed = encoder->large_update_speed_for_tests();
+
+  frame->mutable_updated_region()->SetRect(
+      webrtc::DesktopRect::MakeXYWH(32, 32, 16, 16));
+  for (int i = 0; i < 20; ++i)
+    EXPECT_TRUE(encoder->Encode(*frame));
+  EXPECT_EQ(base_speed, encoder->large_update_speed_for_tests());
+}
+
 TEST(VideoEncoderVpxTest, Vp8EncodeUnchangedFrame) {
   std::unique_ptr<VideoEncoderVpx> encoder(VideoEncoderVpx::CreateForVP8());
   TestVideoEncoderEmptyFrames(encoder.get(), 0);
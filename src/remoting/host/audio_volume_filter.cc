@@ -4,6 +4,8 @@
 
 #include "remoting/host/audio_volume_filter.h"
 
+#include "remoting/base/audio_sample_util.h"
+
 namespace remoting {
 
 AudioVolumeFilter::AudioVolumeFilter(int silence_threshold)
@@ -29,10 +31,7 @@ bool AudioVolumeFilter::Apply(int16_t* data, size_t frames) {
   }
 
   const int sample_count = frames * silence_detector_.channels();
-  const int32_t level_int = static_cast<int32_t>(level * 65536);
-  for (int i = 0; i < sample_count; i++) {
-    data[i] = (static_cast<int32_t>(data[i]) * level_int) >> 16;
-  }
+  ScaleAudioSamples(data, sample_count, static_cast<int32_t>(level * 65536));
 
   return true;
 }
@@ -5,7 +5,7 @@
 #ifndef REMOTING_HOST_AUDIO_VOLUME_FILTER_H_
 #define REMOTING_HOST_AUDIO_VOLUME_FILTER_H_
 
-#include "remoting/host/audio_silence_detector.h"
+#include "remoting/base/audio_silence_detector.h"
 
 namespace remoting {
 
@@ -361,6 +361,8 @@ void ClientSession::OnConnectionAuthenticated() {
 
   DesktopEnvironmentOptions options = desktop_environment_options_;
   options.ApplySessionOptions(session_options);
+  capturer_detects_updated_region_ =
+      options.desktop_capture_options()->detect_updated_region();
   // Create the desktop environment. Drop the connection if it could not be
   // created for any reason (for instance the curtain could not initialize).
   desktop_environment_ =
@@ -425,6 +427,8 @@ void ClientSession::CreateMediaStreams() {
   // Apply video-control parameters to the new stream.
   video_stream_->SetLosslessEncode(lossless_video_encode_);
   video_stream_->SetLosslessColor(lossless_video_color_);
+  if (!capturer_detects_updated_region_)
+    video_stream_->SetDiffFrames(true);
 
   // Pause capturing if necessary.
   video_stream_->Pause(pause_video_);
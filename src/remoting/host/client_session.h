@@ -318,6 +318,10 @@ class ClientSession : public protocol::HostStub,
   bool lossless_video_encode_ = false;
   bool lossless_video_color_ = false;
 
+  // Whether the video capturer narrows the updated region of captured frames
+  // down to changed pixels itself. Otherwise the video stream does.
+  bool capturer_detects_updated_region_ = true;
+
   // VideoLayout is sent only after the control channel is connected. Until
   // then it's stored in |pending_video_layout_message_|.
   std::unique_ptr<protocol::VideoLayout> pending_video_layout_message_;
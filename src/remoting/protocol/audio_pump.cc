@@ -4,6 +4,8 @@
 
 #include "remoting/protocol/audio_pump.h"
 
+#include <stdint.h>
+
 #include <memory>
 #include <utility>
 
@@ -18,6 +20,7 @@
 #include "media/base/audio_sample_types.h"
 #include "media/base/channel_layout.h"
 #include "media/base/channel_mixer.h"
+#include "remoting/base/audio_silence_detector.h"
 #include "remoting/codec/audio_encoder.h"
 #include "remoting/proto/audio.pb.h"
 #include "remoting/protocol/audio_source.h"
@@ -105,6 +108,10 @@ class AudioPump::Core {
  private:
   std::unique_ptr<AudioPacket> Downmix(std::unique_ptr<AudioPacket> packet);
 
+  // Returns true if |packet| extends a silence that is long enough to stop
+  // sending audio.
+  bool IsSilence(const AudioPacket& packet);
+
   void EncodeAudioPacket(std::unique_ptr<AudioPacket> packet);
 
   base::ThreadChecker thread_checker_;
@@ -118,6 +125,11 @@ class AudioPump::Core {
 
   bool enabled_;
 
+  // Not all capturers drop silence themselves, so silent packets are dropped
+  // here before they are encoded.
+  AudioSilenceDetector silence_detector_;
+  int silence_detector_sampling_rate_ = 0;
+
   // Number of bytes in the queue that have been encoded but haven't been sent
   // yet.
   int bytes_pending_;
@@ -136,6 +148,7 @@ AudioPump::Core::Core(base::WeakPtr<AudioPump> pump,
       audio_source_(std::move(audio_source)),
       audio_encoder_(std::move(audio_encoder)),
       enabled_(true),
+      silence_detector_(0),
       bytes_pending_(0) {
   thread_checker_.DetachFromThread();
 }
@@ -174,6 +187,10 @@ void AudioPump::Core::EncodeAudioPacket(std::unique_ptr<AudioPacket> packet) {
     return;
   }
 
+  if (IsSilence(*packet)) {
+    return;
+  }
+
   if (packet->channels() > AudioPacket::CHANNELS_STEREO) {
     packet = Downmix(std::move(packet));
   }
@@ -194,6 +211,22 @@ void AudioPump::Core::EncodeAudioPacket(std::unique_ptr<AudioPacket> packet) {
                                 std::move(encoded_packet), packet_size));
 }
 
+bool AudioPump::Core::IsSilence(const AudioPacket& packet) {
+  DCHECK(thread_checker_.CalledOnValidThread());
+  DCHECK_EQ(packet.data_size(), 1);
+  DCHECK_EQ(packet.bytes_per_sample(), AudioPacket::BYTES_PER_SAMPLE_2);
+
+  if (packet.sampling_rate() != silence_detector_sampling_rate_ ||
+      packet.channels() != silence_detector_.channels()) {
+    silence_detector_sampling_rate_ = packet.sampling_rate();
+    silence_detector_.Reset(packet.sampling_rate(), packet.channels());
+  }
+
+  return silence_detector_.IsSilence(
+      reinterpret_cast<const int16_t*>(packet.data(0).data()),
+      CalculateFrameCount(packet));
+}
+
 std::unique_ptr<AudioPacket> AudioPump::Core::Downmix(
     std::unique_ptr<AudioPacket> packet) {
   DCHECK(thread_checker_.CalledOnValidThread());
@@ -26,10 +26,12 @@ namespace protocol {
 
 namespace {
 
-// Creates a dummy packet with 1k data
-std::unique_ptr<AudioPacket> MakeAudioPacket(int channel_count = 2) {
+// Creates a dummy packet with 1k data. The packet holds silence if |silent| is
+// true.
+std::unique_ptr<AudioPacket> MakeAudioPacket(int channel_count = 2,
+                                             bool silent = false) {
   std::unique_ptr<AudioPacket> packet(new AudioPacket);
-  packet->add_data()->resize(1024);
+  packet->add_data()->resize(1024, silent ? 0 : 1);
   packet->set_encoding(AudioPacket::ENCODING_RAW);
   packet->set_sampling_rate(AudioPacket::SAMPLING_RATE_44100);
   packet->set_bytes_per_sample(AudioPacket::BYTES_PER_SAMPLE_2);
@@ -185,5 +187,35 @@ TEST_F(AudioPumpTest, DownmixAudioPacket) {
   ASSERT_EQ(sent_packets_.size(), base::size(kChannels));
 }
 
+// Verify that the pump stops sending audio after a second of silence, and
+// resumes as soon as the silence ends.
+TEST_F(AudioPumpTest, DropSilence) {
+  // Run message loop to let the pump start the capturer.
+  base::RunLoop().RunUntilIdle();
+  ASSERT_TRUE(source_->callback());
+
+  // Each packet holds 256 stereo frames, so this is about 2.3 seconds of
+  // silence at 44.1kHz.
+  const size_t kSilentPackets = 400;
+  for (size_t i = 0; i < kSilentPackets; ++i) {
+    source_->callback().Run(MakeAudioPacket(AudioPacket::CHANNELS_STEREO,
+                                            /*silent=*/true));
+    base::RunLoop().RunUntilIdle();
+    for (auto& done : done_closures_)
+      std::move(done).Run();
+    done_closures_.clear();
+    base::RunLoop().RunUntilIdle();
+  }
+
+  // Silence shorter than a second is still sent.
+  size_t num_sent_packets = sent_packets_.size();
+  EXPECT_GT(num_sent_packets, 100U);
+  EXPECT_LT(num_sent_packets, 200U);
+
+  source_->callback().Run(MakeAudioPacket());
+  base::RunLoop().RunUntilIdle();
+  EXPECT_EQ(num_sent_packets + 1, sent_packets_.size());
+}
+
 }  // namespace protocol
 }  // namespace remoting
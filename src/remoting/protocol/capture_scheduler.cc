@@ -53,6 +53,7 @@ CaptureScheduler::CaptureScheduler(
           base::TimeDelta::FromMilliseconds(kDefaultMinimumIntervalMs)),
       num_of_processors_(base::SysInfo::NumberOfProcessors()),
       capture_time_(kStatisticsWindow),
+      diff_time_(kStatisticsWindow),
       encode_time_(kStatisticsWindow),
       num_encoding_frames_(0),
       num_unacknowledged_frames_(0),
@@ -98,6 +99,14 @@ void CaptureScheduler::OnCaptureCompleted() {
   ScheduleNextCapture();
 }
 
+void CaptureScheduler::OnFrameDiffed(base::TimeDelta diff_time) {
+  DCHECK(thread_checker_.CalledOnValidThread());
+
+  // Diffing usually takes well under a millisecond, so it's recorded in
+  // microseconds to avoid truncating it to 0.
+  diff_time_.Record(diff_time.InMicroseconds());
+}
+
 void CaptureScheduler::OnFrameEncoded(VideoPacket* packet) {
   DCHECK(thread_checker_.CalledOnValidThread());
 
@@ -155,14 +164,16 @@ void CaptureScheduler::ScheduleNextCapture() {
     return;
   }
 
-  // Delay by an amount chosen such that if capture and encode times
+  // Delay by an amount chosen such that if capture, diff and encode times
   // continue to follow the averages, then we'll consume the target
   // fraction of CPU across all cores.
-  base::TimeDelta delay =
-      std::max(minimum_interval_,
-               base::TimeDelta::FromMilliseconds(
-                   (capture_time_.Average() + encode_time_.Average()) /
-                   (kRecordingCpuConsumption * num_of_processors_)));
+  base::TimeDelta delay = std::max(
+      minimum_interval_,
+      base::TimeDelta::FromMilliseconds(
+          (capture_time_.Average() +
+           diff_time_.Average() / base::Time::kMicrosecondsPerMillisecond +
+           encode_time_.Average()) /
+          (kRecordingCpuConsumption * num_of_processors_)));
 
   // Account for the time that has passed since the last capture.
   delay = std::max(base::TimeDelta(), delay - (tick_clock_->NowTicks() -
@@ -27,6 +27,9 @@ namespace protocol {
 // It implements VideoFeedbackStub to receive frame acknowledgments from the
 // client.
 //
+// Capture, detection of the changed region and encode all count towards the
+// CPU usage limit.
+//
 // It attempts to achieve the following goals when scheduling frames:
 //  - Keep round-trip latency as low a possible.
 //  - Parallelize capture, encode and transmission, to achieve frame rate as
@@ -46,6 +49,10 @@ class CaptureScheduler : public VideoFeedbackStub {
   // Notifies the scheduler that a capture has been completed.
   void OnCaptureCompleted();
 
+  // Notifies the scheduler that the changed region of a captured frame took
+  // |diff_time| to detect. Called before OnFrameEncoded() for that frame.
+  void OnFrameDiffed(base::TimeDelta diff_time);
+
   // Notifies the scheduler that a frame has been encoded. The scheduler can
   // change |packet| if necessary, e.g. set |frame_id|.
   void OnFrameEncoded(VideoPacket* packet);
@@ -88,7 +95,9 @@ class CaptureScheduler : public VideoFeedbackStub {
 
   int num_of_processors_;
 
+  // Capture and encode times are in milliseconds, diff times in microseconds.
   RunningSamples capture_time_;
+  RunningSamples diff_time_;
   RunningSamples encode_time_;
 
   // Number of frames pending encoding.
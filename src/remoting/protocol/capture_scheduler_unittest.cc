@@ -149,6 +149,49 @@ TEST_F(CaptureSchedulerTest, RollingAverageDifferentTimes) {
   }
 }
 
+// Verify that the time taken to find the changed region of frames counts
+// towards the CPU usage limit.
+TEST_F(CaptureSchedulerTest, DiffTimeDelaysCapture) {
+  InitScheduler();
+  scheduler_->SetNumOfProcessorsForTest(1);
+
+  capture_timer_->Fire();
+  CheckCaptureCalled();
+  tick_clock_.Advance(base::TimeDelta::FromMilliseconds(10));
+  scheduler_->OnCaptureCompleted();
+
+  scheduler_->OnFrameDiffed(base::TimeDelta::FromMilliseconds(20));
+  VideoPacket packet;
+  packet.set_encode_time_ms(30);
+  scheduler_->OnFrameEncoded(&packet);
+
+  // (10ms + 20ms + 30ms) / 50% CPU, less the 10ms since capture started.
+  EXPECT_TRUE(capture_timer_->IsRunning());
+  EXPECT_EQ(base::TimeDelta::FromMilliseconds(110),
+            capture_timer_->GetCurrentDelay());
+}
+
+// Verify that diff times below a millisecond aren't rounded down to 0.
+TEST_F(CaptureSchedulerTest, ShortDiffTimeDelaysCapture) {
+  InitScheduler();
+  scheduler_->SetNumOfProcessorsForTest(1);
+
+  capture_timer_->Fire();
+  CheckCaptureCalled();
+  tick_clock_.Advance(base::TimeDelta::FromMilliseconds(10));
+  scheduler_->OnCaptureCompleted();
+
+  scheduler_->OnFrameDiffed(base::TimeDelta::FromMicroseconds(900));
+  VideoPacket packet;
+  packet.set_encode_time_ms(30);
+  scheduler_->OnFrameEncoded(&packet);
+
+  // (10ms + 0.9ms + 30ms) / 50% CPU, less the 10ms since capture started.
+  EXPECT_TRUE(capture_timer_->IsRunning());
+  EXPECT_EQ(base::TimeDelta::FromMilliseconds(71),
+            capture_timer_->GetCurrentDelay());
+}
+
 // Verify that we never have more than 2 encoding frames.
 TEST_F(CaptureSchedulerTest, MaximumEncodingFrames) {
   InitScheduler();
@@ -28,6 +28,8 @@ void FakeVideoStream::SetLosslessEncode(bool want_lossless) {}
 
 void FakeVideoStream::SetLosslessColor(bool want_lossless) {}
 
+void FakeVideoStream::SetDiffFrames(bool diff_frames) {}
+
 void FakeVideoStream::SetObserver(Observer* observer) {
   observer_ = observer;
 }
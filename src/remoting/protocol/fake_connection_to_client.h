@@ -31,6 +31,7 @@ class FakeVideoStream : public protocol::VideoStream {
   void Pause(bool pause) override;
   void SetLosslessEncode(bool want_lossless) override;
   void SetLosslessColor(bool want_lossless) override;
+  void SetDiffFrames(bool diff_frames) override;
   void SetObserver(Observer* observer) override;
   void SelectSource(int id) override;
 
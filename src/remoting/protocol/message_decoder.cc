@@ -6,6 +6,8 @@
 
 #include <stdint.h>
 
+#include <algorithm>
+
 #include "base/check_op.h"
 #include "net/base/io_buffer.h"
 #include "remoting/base/compound_buffer.h"
@@ -52,6 +54,12 @@ CompoundBuffer* MessageDecoder::GetNextMessage() {
   return message_buffer;
 }
 
+int MessageDecoder::GetBytesNeededForNextMessage() const {
+  if (!next_payload_known_)
+    return 0;
+  return std::max(0, next_payload_ - buffer_.total_bytes());
+}
+
 bool MessageDecoder::GetPayloadSize(int* size) {
   // The header has a size of 4 bytes.
   const int kHeaderSize = sizeof(int32_t);
@@ -59,10 +67,8 @@ bool MessageDecoder::GetPayloadSize(int* size) {
   if (buffer_.total_bytes() < kHeaderSize)
     return false;
 
-  CompoundBuffer header_buffer;
   char header[kHeaderSize];
-  header_buffer.CopyFrom(buffer_, 0, kHeaderSize);
-  header_buffer.CopyTo(header, kHeaderSize);
+  buffer_.CopyTo(header, kHeaderSize);
   *size = rtc::GetBE32(header);
   buffer_.CropFront(kHeaderSize);
   return true;
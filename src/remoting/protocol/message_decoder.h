@@ -22,6 +22,9 @@ namespace protocol {
 //
 // Here, message_size is 4-byte integer that represents size of
 // message_data in bytes. message_data - content of the message.
+//
+// Messages reference the chunks they were received in, so they are never
+// copied into a contiguous buffer. They can be parsed with ParseMessage().
 class MessageDecoder {
  public:
   MessageDecoder();
@@ -37,6 +40,11 @@ class MessageDecoder {
   // message.
   CompoundBuffer* GetNextMessage();
 
+  // Returns the number of bytes still needed to complete the next message, or
+  // 0 if its size isn't known yet. Valid after GetNextMessage() has returned
+  // nullptr.
+  int GetBytesNeededForNextMessage() const;
+
  private:
   // Retrieves the read payload size of the current protocol buffer via |size|.
   // Returns false and leaves |size| unmodified, if we do not have enough data
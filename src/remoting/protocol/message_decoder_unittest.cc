@@ -12,10 +12,12 @@
 
 #include "base/stl_util.h"
 #include "base/strings/string_number_conversions.h"
+#include "remoting/base/compound_buffer.h"
 #include "remoting/proto/event.pb.h"
 #include "remoting/proto/internal.pb.h"
 #include "remoting/protocol/message_serialization.h"
 #include "testing/gtest/include/gtest/gtest.h"
+#include "third_party/webrtc/rtc_base/byte_order.h"
 
 namespace remoting {
 namespace protocol {
@@ -122,5 +124,41 @@ TEST(MessageDecoderTest, EmptyReads) {
   SimulateReadSequence(kReads, base::size(kReads));
 }
 
+TEST(MessageDecoderTest, MessageSpanningReads) {
+  const int kPayloadSize = 1000;
+  const int kFirstReadSize = 100;
+  MessageDecoder decoder;
+
+  scoped_refptr<net::IOBuffer> first_read =
+      base::MakeRefCounted<net::IOBuffer>(4 + kFirstReadSize);
+  rtc::SetBE32(first_read->data(), kPayloadSize);
+  memset(first_read->data() + 4, 1, kFirstReadSize);
+  decoder.AddData(first_read, 4 + kFirstReadSize);
+  EXPECT_FALSE(decoder.GetNextMessage());
+  EXPECT_EQ(kPayloadSize - kFirstReadSize,
+            decoder.GetBytesNeededForNextMessage());
+
+  scoped_refptr<net::IOBuffer> second_read =
+      base::MakeRefCounted<net::IOBuffer>(kPayloadSize - kFirstReadSize);
+  memset(second_read->data(), 2, kPayloadSize - kFirstReadSize);
+  decoder.AddData(second_read, kPayloadSize - kFirstReadSize);
+  std::unique_ptr<CompoundBuffer> message(decoder.GetNextMessage());
+  ASSERT_TRUE(message);
+  EXPECT_EQ(0, decoder.GetBytesNeededForNextMessage());
+
+  // The message references both reads rather than a copy of them.
+  EXPECT_EQ(kPayloadSize, message->total_bytes());
+  CompoundBufferInputStream stream(message.get());
+  const void* data;
+  int size;
+  ASSERT_TRUE(stream.Next(&data, &size));
+  EXPECT_EQ(first_read->data() + 4, data);
+  EXPECT_EQ(kFirstReadSize, size);
+  ASSERT_TRUE(stream.Next(&data, &size));
+  EXPECT_EQ(second_read->data(), data);
+  EXPECT_EQ(kPayloadSize - kFirstReadSize, size);
+  EXPECT_FALSE(stream.Next(&data, &size));
+}
+
 }  // namespace protocol
 }  // namespace remoting
@@ -4,6 +4,7 @@
 
 #include "remoting/protocol/message_reader.h"
 
+#include <algorithm>
 #include <utility>
 
 #include "base/bind.h"
@@ -24,6 +25,9 @@ namespace protocol {
 
 static const int kReadBufferSize = 4096;
 
+// The rest of a large message is read with a single read of up to this size.
+static const int kMaxReadBufferSize = 65536;
+
 MessageReader::MessageReader() {}
 MessageReader::~MessageReader() {
   DCHECK_CALLED_ON_VALID_SEQUENCE(sequence_checker_);
@@ -50,9 +54,15 @@ void MessageReader::DoRead() {
   // Don't try to read again if there is another read pending or we
   // have messages that we haven't finished processing yet.
   while (!closed_ && !read_pending_) {
-    read_buffer_ = base::MakeRefCounted<net::IOBuffer>(kReadBufferSize);
+    // The decoder keeps each buffer until the messages in it are consumed, so
+    // larger buffers are only used while the next message needs the data.
+    int read_size =
+        std::min(std::max(kReadBufferSize,
+                          message_decoder_.GetBytesNeededForNextMessage()),
+                 kMaxReadBufferSize);
+    read_buffer_ = base::MakeRefCounted<net::IOBuffer>(read_size);
     int result = socket_->Read(
-        read_buffer_.get(), kReadBufferSize,
+        read_buffer_.get(), read_size,
         base::BindOnce(&MessageReader::OnRead, weak_factory_.GetWeakPtr()));
 
     if (!HandleReadResult(result))
@@ -46,6 +46,7 @@ VideoFramePump::VideoFramePump(
     protocol::VideoStub* video_stub)
     : encode_task_runner_(encode_task_runner),
       capturer_(std::move(capturer)),
+      frame_differ_(std::make_unique<FrameDiffer>()),
       encoder_(std::move(encoder)),
       video_stub_(video_stub),
       keep_alive_timer_(
@@ -64,6 +65,7 @@ VideoFramePump::VideoFramePump(
 
 VideoFramePump::~VideoFramePump() {
   DCHECK(thread_checker_.CalledOnValidThread());
+  encode_task_runner_->DeleteSoon(FROM_HERE, frame_differ_.release());
   encode_task_runner_->DeleteSoon(FROM_HERE, encoder_.release());
 }
 
@@ -98,6 +100,11 @@ void VideoFramePump::SetLosslessColor(bool want_lossless) {
                      base::Unretained(encoder_.get()), want_lossless));
 }
 
+void VideoFramePump::SetDiffFrames(bool diff_frames) {
+  DCHECK(thread_checker_.CalledOnValidThread());
+  diff_frames_ = diff_frames;
+}
+
 void VideoFramePump::SetObserver(Observer* observer) {
   DCHECK(thread_checker_.CalledOnValidThread());
   observer_ = observer;
@@ -131,8 +138,10 @@ void VideoFramePump::OnCaptureResult(
   // that we don't start capturing frame n+2 before frame n is freed.
   base::PostTaskAndReplyWithResult(
       encode_task_runner_.get(), FROM_HERE,
-      base::BindOnce(&VideoFramePump::EncodeFrame, encoder_.get(),
-                     std::move(frame), std::move(captured_frame_timestamps_)),
+      base::BindOnce(&VideoFramePump::EncodeFrame,
+                     diff_frames_ ? frame_differ_.get() : nullptr,
+                     encoder_.get(), std::move(frame),
+                     std::move(captured_frame_timestamps_)),
       base::BindOnce(&VideoFramePump::OnFrameEncoded,
                      weak_factory_.GetWeakPtr()));
 }
@@ -153,11 +162,18 @@ void VideoFramePump::CaptureNextFrame() {
 
 // static
 std::unique_ptr<VideoFramePump::PacketWithTimestamps>
-VideoFramePump::EncodeFrame(VideoEncoder* encoder,
+VideoFramePump::EncodeFrame(FrameDiffer* frame_differ,
+                            VideoEncoder* encoder,
                             std::unique_ptr<webrtc::DesktopFrame> frame,
                             std::unique_ptr<FrameTimestamps> timestamps) {
   timestamps->encode_started_time = base::TimeTicks::Now();
 
+  // Capturers may report areas that were repainted with the same content, so
+  // only the blocks that changed are passed to the encoder.
+  if (frame && frame_differ)
+    frame_differ->UpdateRegion(frame.get());
+  timestamps->diff_ended_time = base::TimeTicks::Now();
+
   std::unique_ptr<VideoPacket> packet;
   // If |frame| is non-NULL then let the encoder process it.
   if (frame)
@@ -173,7 +189,7 @@ VideoFramePump::EncodeFrame(VideoEncoder* encoder,
 
   timestamps->encode_ended_time = base::TimeTicks::Now();
   packet->set_encode_time_ms(
-      (timestamps->encode_ended_time - timestamps->encode_started_time)
+      (timestamps->encode_ended_time - timestamps->diff_ended_time)
           .InMilliseconds());
 
   return std::make_unique<PacketWithTimestamps>(std::move(packet),
@@ -184,6 +200,8 @@ void VideoFramePump::OnFrameEncoded(
     std::unique_ptr<PacketWithTimestamps> packet) {
   DCHECK(thread_checker_.CalledOnValidThread());
 
+  capture_scheduler_.OnFrameDiffed(packet->timestamps->diff_ended_time -
+                                   packet->timestamps->encode_started_time);
   capture_scheduler_.OnFrameEncoded(packet->packet.get());
 
   if (send_pending_) {
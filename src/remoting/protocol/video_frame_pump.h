@@ -15,6 +15,7 @@
 #include "base/threading/thread_checker.h"
 #include "base/time/time.h"
 #include "base/timer/timer.h"
+#include "remoting/codec/frame_differ.h"
 #include "remoting/codec/video_encoder.h"
 #include "remoting/proto/video.pb.h"
 #include "remoting/protocol/capture_scheduler.h"
@@ -85,6 +86,7 @@ class VideoFramePump : public VideoStream,
   void Pause(bool pause) override;
   void SetLosslessEncode(bool want_lossless) override;
   void SetLosslessColor(bool want_lossless) override;
+  void SetDiffFrames(bool diff_frames) override;
   void SetObserver(Observer* observer) override;
   void SelectSource(int id) override;
 
@@ -104,6 +106,7 @@ class VideoFramePump : public VideoStream,
     base::TimeTicks capture_started_time;
     base::TimeTicks capture_ended_time;
     base::TimeTicks encode_started_time;
+    base::TimeTicks diff_ended_time;
     base::TimeTicks encode_ended_time;
     base::TimeTicks can_send_time;
   };
@@ -124,8 +127,10 @@ class VideoFramePump : public VideoStream,
   // Callback for CaptureScheduler.
   void CaptureNextFrame();
 
-  // Task running on the encoder thread to encode the |frame|.
+  // Task running on the encoder thread to find the changed region of |frame|,
+  // unless |frame_differ| is null, and encode it.
   static std::unique_ptr<PacketWithTimestamps> EncodeFrame(
+      FrameDiffer* frame_differ,
       VideoEncoder* encoder,
       std::unique_ptr<webrtc::DesktopFrame> frame,
       std::unique_ptr<FrameTimestamps> timestamps);
@@ -155,6 +160,12 @@ class VideoFramePump : public VideoStream,
   // Capturer used to capture the screen.
   std::unique_ptr<webrtc::DesktopCapturer> capturer_;
 
+  // Used to narrow the updated region of captured frames down to the pixels
+  // that changed, if |diff_frames_| is set. Always accessed on the encode
+  // thread.
+  std::unique_ptr<FrameDiffer> frame_differ_;
+  bool diff_frames_ = false;
+
   // Used to encode captured frames. Always accessed on the encode thread.
   std::unique_ptr<VideoEncoder> encoder_;
 
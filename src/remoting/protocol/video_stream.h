@@ -47,6 +47,13 @@ class VideoStream {
   virtual void SetLosslessEncode(bool want_lossless) = 0;
   virtual void SetLosslessColor(bool want_lossless) = 0;
 
+  // Sets whether captured frames should be compared with the previous frame
+  // to narrow their updated region down to the pixels that changed. Off by
+  // default: capturers created with DesktopCaptureOptions::
+  // detect_updated_region() already do this through
+  // webrtc::DesktopCapturerDifferWrapper.
+  virtual void SetDiffFrames(bool diff_frames) = 0;
+
   // Sets stream observer.
   virtual void SetObserver(Observer* observer) = 0;
 
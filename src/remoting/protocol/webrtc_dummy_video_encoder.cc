@@ -93,6 +93,22 @@ void WebrtcDummyVideoEncoder::SetRates(
   // frames.
 }
 
+void WebrtcDummyVideoEncoder::OnPacketLossRateUpdate(float packet_loss_rate) {
+  packet_loss_ = static_cast<int>(packet_loss_rate * 255);
+  main_task_runner_->PostTask(
+      FROM_HERE, base::BindOnce(&VideoChannelStateObserver::OnChannelParameters,
+                                video_channel_state_observer_, packet_loss_,
+                                rtt_));
+}
+
+void WebrtcDummyVideoEncoder::OnRttUpdate(int64_t rtt_ms) {
+  rtt_ = base::TimeDelta::FromMilliseconds(rtt_ms);
+  main_task_runner_->PostTask(
+      FROM_HERE, base::BindOnce(&VideoChannelStateObserver::OnChannelParameters,
+                                video_channel_state_observer_, packet_loss_,
+                                rtt_));
+}
+
 webrtc::EncodedImageCallback::Result WebrtcDummyVideoEncoder::SendEncodedFrame(
     const WebrtcVideoEncoder::EncodedFrame& frame,
     base::TimeTicks capture_time,
@@ -13,6 +13,7 @@
 #include "base/memory/weak_ptr.h"
 #include "base/single_thread_task_runner.h"
 #include "base/synchronization/lock.h"
+#include "base/time/time.h"
 #include "remoting/codec/webrtc_video_encoder.h"
 #include "third_party/webrtc/api/video_codecs/video_encoder_factory.h"
 #include "third_party/webrtc/modules/video_coding/include/video_codec_interface.h"
@@ -51,6 +52,8 @@ class WebrtcDummyVideoEncoder : public webrtc::VideoEncoder {
       const webrtc::VideoFrame& frame,
       const std::vector<webrtc::VideoFrameType>* frame_types) override;
   void SetRates(const RateControlParameters& parameters) override;
+  void OnPacketLossRateUpdate(float packet_loss_rate) override;
+  void OnRttUpdate(int64_t rtt_ms) override;
   webrtc::VideoEncoder::EncoderInfo GetEncoderInfo() const override;
 
   webrtc::EncodedImageCallback::Result SendEncodedFrame(
@@ -69,6 +72,11 @@ class WebrtcDummyVideoEncoder : public webrtc::VideoEncoder {
 
   base::WeakPtr<VideoChannelStateObserver> video_channel_state_observer_;
 
+  // Latest network parameters reported by WebRTC, which are passed together
+  // to |video_channel_state_observer_|. |packet_loss_| is in 1/255 units.
+  int packet_loss_ = 0;
+  base::TimeDelta rtt_;
+
   // Holds a reference to the creating factory, if any. Will be notified
   // when this instance is released, so it can stop delivering frames.
   WebrtcDummyVideoEncoderFactory* factory_ = nullptr;
@@ -33,9 +33,10 @@ class WebrtcFrameScheduler {
 
   // Called after |frame| has been captured to get encoding parameters for the
   // frame. Returns false if the frame should be dropped (e.g. when there are no
-  // changes), true otherwise. |frame| may be set to nullptr if the capture
-  // request failed.
-  virtual bool OnFrameCaptured(const webrtc::DesktopFrame* frame,
+  // changes, or the network is congested), true otherwise. The updated region
+  // of a dropped frame is added to the updated region of the next frame that
+  // is sent. |frame| may be set to nullptr if the capture request failed.
+  virtual bool OnFrameCaptured(webrtc::DesktopFrame* frame,
                                WebrtcVideoEncoder::FrameParams* params_out) = 0;
 
   // Called after a frame has been encoded and passed to the sender.
@@ -5,6 +5,7 @@
 #include "remoting/protocol/webrtc_frame_scheduler_simple.h"
 
 #include <algorithm>
+#include <cmath>
 
 #include "base/bind.h"
 #include "base/numerics/ranges.h"
@@ -29,6 +30,10 @@ constexpr base::TimeDelta kTargetFrameInterval =
 // Target quantizer at which stop the encoding top-off.
 const int kTargetQuantizerForTopOff = 10;
 
+// Minimum quantizer at which to encode frames when the network isn't
+// congested.
+const int kMinQuantizer = 10;
+
 // Maximum quantizer at which to encode frames. Lowering this value will
 // improve image quality (in cases of low-bandwidth or large frames) at the
 // cost of latency. Increasing the value will improve latency (in these cases)
@@ -74,7 +79,6 @@ int64_t GetRegionArea(const webrtc::DesktopRegion& region) {
 WebrtcFrameSchedulerSimple::WebrtcFrameSchedulerSimple(
     const SessionOptions& options)
     : tick_clock_(base::DefaultTickClock::GetInstance()),
-      pacing_bucket_(LeakyBucket::kUnlimitedDepth, 0),
       updated_region_area_(kStatsWindow),
       bandwidth_estimator_(new WebrtcBandwidthEstimator()) {}
 
@@ -94,7 +98,8 @@ void WebrtcFrameSchedulerSimple::OnChannelParameters(int packet_loss,
   DCHECK(thread_checker_.CalledOnValidThread());
 
   bandwidth_estimator_->UpdateRtt(rtt);
-  rtt_estimate_ = rtt;
+  pacing_controller_.SetChannelParameters(packet_loss, rtt,
+                                          tick_clock_->NowTicks());
 }
 
 void WebrtcFrameSchedulerSimple::OnTargetBitrateChanged(int bandwidth_kbps) {
@@ -103,8 +108,8 @@ void WebrtcFrameSchedulerSimple::OnTargetBitrateChanged(int bandwidth_kbps) {
   bandwidth_estimator_->OnBitrateEstimation(bandwidth_kbps);
   processing_time_estimator_.SetBandwidthKbps(
       bandwidth_estimator_->GetBitrateKbps());
-  pacing_bucket_.UpdateRate(bandwidth_estimator_->GetBitrateKbps() * 1000 / 8,
-                            tick_clock_->NowTicks());
+  pacing_controller_.SetTargetBitrate(bandwidth_estimator_->GetBitrateKbps(),
+                                      tick_clock_->NowTicks());
   ScheduleNextFrame();
 }
 
@@ -129,7 +134,7 @@ void WebrtcFrameSchedulerSimple::Pause(bool pause) {
 }
 
 bool WebrtcFrameSchedulerSimple::OnFrameCaptured(
-    const webrtc::DesktopFrame* frame,
+    webrtc::DesktopFrame* frame,
     WebrtcVideoEncoder::FrameParams* params_out) {
   DCHECK(thread_checker_.CalledOnValidThread());
 
@@ -142,6 +147,13 @@ bool WebrtcFrameSchedulerSimple::OnFrameCaptured(
     return false;
   }
 
+  // Changes in the frames that were dropped still need to be sent.
+  if (!dropped_region_.is_empty()) {
+    if (dropped_frame_size_.equals(frame->size()))
+      frame->mutable_updated_region()->AddRegion(dropped_region_);
+    dropped_region_.Clear();
+  }
+
   if (frame->updated_region().is_empty()) {
     // If we've captured an empty frame we still need to encode and send the
     // previous frame when top-off is active or a key-frame was requested. But
@@ -161,6 +173,19 @@ bool WebrtcFrameSchedulerSimple::OnFrameCaptured(
     }
   }
 
+  // Drop the frame if the queues grew since it was scheduled, e.g. because
+  // the RTT went up, unless a key-frame was requested or nothing has been
+  // sent for a while.
+  if (!key_frame_request_ &&
+      now - latest_frame_encode_start_time_ <= kKeepAliveInterval &&
+      pacing_controller_.ShouldDropFrame(now)) {
+    dropped_region_.AddRegion(frame->updated_region());
+    dropped_frame_size_ = frame->size();
+    frame_pending_ = false;
+    ScheduleNextFrame();
+    return false;
+  }
+
   // Encoder uses frame duration to calculate portion of the target bitrate it
   // can use for this frame. Higher values normally will cause bigger encoded
   // frames that will take longer to be delivered to the client. To keep
@@ -172,11 +197,17 @@ bool WebrtcFrameSchedulerSimple::OnFrameCaptured(
 
   latest_frame_encode_start_time_ = now;
 
-  params_out->bitrate_kbps = pacing_bucket_.rate() * 8 / 1000;
+  int pacing_rate = pacing_controller_.pacing_rate();
+  params_out->bitrate_kbps = pacing_rate * 8 / 1000;
   params_out->key_frame = key_frame_request_;
   key_frame_request_ = false;
 
-  params_out->vpx_min_quantizer = 10;
+  // Trade image quality for latency when the network queue grows. The quality
+  // is topped off once the congestion is gone.
+  params_out->vpx_min_quantizer =
+      kMinQuantizer + static_cast<int>(std::lround(
+                          (kMaxQuantizer - kMinQuantizer) *
+                          pacing_controller_.GetCongestionLevel()));
 
   int64_t updated_area = params_out->key_frame
                              ? frame->size().width() * frame->size().height()
@@ -193,10 +224,10 @@ bool WebrtcFrameSchedulerSimple::OnFrameCaptured(
     int expected_frame_size =
         updated_area * kEstimatedBytesPerMegapixel / kPixelsPerMegapixel;
     base::TimeDelta expected_send_delay =
-        pacing_bucket_.rate() ? base::TimeDelta::FromMicroseconds(
-                                    base::Time::kMicrosecondsPerSecond *
-                                    expected_frame_size / pacing_bucket_.rate())
-                              : base::TimeDelta::Max();
+        pacing_rate ? base::TimeDelta::FromMicroseconds(
+                          base::Time::kMicrosecondsPerSecond *
+                          expected_frame_size / pacing_rate)
+                    : base::TimeDelta::Max();
     if (expected_send_delay > kTargetFrameInterval) {
       params_out->vpx_min_quantizer = kMaxQuantizer;
     }
@@ -221,9 +252,9 @@ void WebrtcFrameSchedulerSimple::OnFrameEncoded(
   base::TimeTicks now = tick_clock_->NowTicks();
 
   if (frame_stats) {
-    // Calculate |send_pending_delay| before refilling |pacing_bucket_|.
-    frame_stats->send_pending_delay =
-        std::max(base::TimeDelta(), pacing_bucket_.GetEmptyTime() - now);
+    // Calculate |send_pending_delay| before sending the frame.
+    frame_stats->send_pending_delay = std::max(
+        base::TimeDelta(), pacing_controller_.GetSendCompleteTime() - now);
   }
 
   // TODO(zijiehe): |encoded_frame|->data.empty() is unreasonable, we should try
@@ -231,7 +262,7 @@ void WebrtcFrameSchedulerSimple::OnFrameEncoded(
   if (!encoded_frame || encoded_frame->data.empty()) {
     top_off_is_active_ = false;
   } else {
-    pacing_bucket_.RefillOrSpill(encoded_frame->data.size(), now);
+    pacing_controller_.OnFrameSent(encoded_frame->data.size(), now);
 
     processing_time_estimator_.FinishFrame(*encoded_frame);
 
@@ -242,7 +273,7 @@ void WebrtcFrameSchedulerSimple::OnFrameEncoded(
   ScheduleNextFrame();
 
   if (frame_stats) {
-    frame_stats->rtt_estimate = rtt_estimate_;
+    frame_stats->rtt_estimate = pacing_controller_.rtt();
     frame_stats->bandwidth_estimate_kbps =
         bandwidth_estimator_->GetBitrateKbps();
   }
@@ -259,7 +290,7 @@ void WebrtcFrameSchedulerSimple::ScheduleNextFrame() {
   DCHECK(thread_checker_.CalledOnValidThread());
   base::TimeTicks now = tick_clock_->NowTicks();
 
-  if (!encoder_ready_ || paused_ || pacing_bucket_.rate() == 0 ||
+  if (!encoder_ready_ || paused_ || pacing_controller_.pacing_rate() == 0 ||
       capture_callback_.is_null() || frame_pending_) {
     return;
   }
@@ -268,8 +299,11 @@ void WebrtcFrameSchedulerSimple::ScheduleNextFrame() {
   if (!last_capture_started_time_.is_null()) {
     // Try to set the capture time so that (if the estimated processing time is
     // accurate) the new frame is ready to be sent just when the previous frame
-    // is finished sending.
-    target_capture_time = pacing_bucket_.GetEmptyTime() -
+    // is finished sending. If the network queue has grown, wait for it to
+    // drain as well.
+    target_capture_time =
+        pacing_controller_.GetSendCompleteTime() +
+        pacing_controller_.GetExcessQueuingDelay() -
         processing_time_estimator_.EstimatedProcessingTime(key_frame_request_);
 
     // Ensure that the capture rate is capped by kTargetFrameInterval, to avoid
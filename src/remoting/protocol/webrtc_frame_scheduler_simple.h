@@ -13,11 +13,13 @@
 #include "base/threading/thread_checker.h"
 #include "base/time/tick_clock.h"
 #include "base/timer/timer.h"
-#include "remoting/base/leaky_bucket.h"
 #include "remoting/base/running_samples.h"
 #include "remoting/base/session_options.h"
 #include "remoting/codec/frame_processing_time_estimator.h"
 #include "remoting/protocol/video_channel_state_observer.h"
+#include "remoting/protocol/webrtc_pacing_controller.h"
+#include "third_party/webrtc/modules/desktop_capture/desktop_geometry.h"
+#include "third_party/webrtc/modules/desktop_capture/desktop_region.h"
 
 namespace remoting {
 namespace protocol {
@@ -27,7 +29,10 @@ class BandwidthEstimator;
 // WebrtcFrameSchedulerSimple is a simple implementation of WebrtcFrameScheduler
 // that always keeps only one frame in the pipeline. It schedules each frame
 // such that it is encoded and ready to be sent by the time previous one is
-// expected to finish sending.
+// expected to finish sending. WebrtcPacingController tracks the queues in the
+// pacer and the network: when the network queue grows, captures are postponed
+// and the quantizer is raised, and frames captured while the queues are too
+// long are dropped.
 class WebrtcFrameSchedulerSimple : public VideoChannelStateObserver,
                                    public WebrtcFrameScheduler {
  public:
@@ -43,7 +48,7 @@ class WebrtcFrameSchedulerSimple : public VideoChannelStateObserver,
   void Start(WebrtcDummyVideoEncoderFactory* video_encoder_factory,
              const base::RepeatingClosure& capture_callback) override;
   void Pause(bool pause) override;
-  bool OnFrameCaptured(const webrtc::DesktopFrame* frame,
+  bool OnFrameCaptured(webrtc::DesktopFrame* frame,
                        WebrtcVideoEncoder::FrameParams* params_out) override;
   void OnFrameEncoded(const WebrtcVideoEncoder::EncodedFrame* encoded_frame,
                       HostFrameStats* frame_stats) override;
@@ -75,13 +80,16 @@ class WebrtcFrameSchedulerSimple : public VideoChannelStateObserver,
   // but at a throttled rate.
   base::TimeTicks latest_frame_encode_start_time_;
 
-  LeakyBucket pacing_bucket_;
+  WebrtcPacingController pacing_controller_;
+
+  // Updated region of the frames dropped since the last frame that was sent,
+  // and the size of these frames.
+  webrtc::DesktopRegion dropped_region_;
+  webrtc::DesktopSize dropped_frame_size_;
 
   // Set to true when a frame is being captured or encoded.
   bool frame_pending_ = false;
 
-  base::TimeDelta rtt_estimate_;
-
   // Set to true when encoding unchanged frames for top-off.
   bool top_off_is_active_ = false;
 
@@ -4,6 +4,12 @@
 
 #include "remoting/protocol/webrtc_frame_scheduler.h"
 
+#include <stdint.h>
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
 #include "base/bind.h"
 #include "base/test/test_mock_time_task_runner.h"
 #include "base/threading/thread_task_runner_handle.h"
@@ -20,6 +26,68 @@ using webrtc::DesktopSize;
 namespace remoting {
 namespace protocol {
 
+namespace {
+
+const int kScreenWidth = 1280;
+const int kScreenHeight = 720;
+
+// Maximum quantizer value for VP8 and VP9.
+const int kQuantizerRange = 63;
+
+constexpr base::TimeDelta kEncodeTime = base::TimeDelta::FromMilliseconds(10);
+constexpr base::TimeDelta kFeedbackInterval =
+    base::TimeDelta::FromMilliseconds(200);
+constexpr base::TimeDelta kOneWayDelay = base::TimeDelta::FromMilliseconds(50);
+constexpr base::TimeDelta kSessionDuration = base::TimeDelta::FromSeconds(30);
+
+// Window that is updated on each frame, e.g. when scrolling.
+DesktopRect GetUpdatedRect() {
+  return DesktopRect::MakeXYWH(320, 180, 640, 360);
+}
+
+base::TimeDelta GetTransmitTime(int64_t bytes, int kbps) {
+  return base::TimeDelta::FromMicroseconds(bytes * 8000 / kbps);
+}
+
+// Simulates the WebRTC pacer, which sends frames at the target bitrate, and a
+// bottleneck link with the given bandwidth. The target bitrate may be higher
+// than the link bandwidth, in which case a queue builds up in the network and
+// increases the RTT. Lost packets are retransmitted, so they take up a part of
+// the bandwidth.
+class SimulatedNetwork {
+ public:
+  SimulatedNetwork(int link_kbps, double packet_loss)
+      : link_kbps_(link_kbps), packet_loss_(packet_loss) {}
+
+  // Sends a frame of |size| bytes at |now| through the pacer running at
+  // |pacer_kbps|. Returns the time when the frame is delivered.
+  base::TimeTicks Send(int size, int pacer_kbps, base::TimeTicks now) {
+    int64_t bytes = size / (1.0 - packet_loss_);
+    base::TimeTicks pacer_start_time = std::max(pacer_free_time_, now);
+    pacer_free_time_ = pacer_start_time + GetTransmitTime(bytes, pacer_kbps);
+    link_free_time_ = std::max(std::max(link_free_time_, pacer_start_time) +
+                                   GetTransmitTime(bytes, link_kbps_),
+                               pacer_free_time_);
+    return link_free_time_ + kOneWayDelay;
+  }
+
+  // Returns the RTT measured by packets sent at |now|, which includes the
+  // time spent queued in the network but not in the pacer.
+  base::TimeDelta GetRtt(base::TimeTicks now) const {
+    return kOneWayDelay * 2 +
+           std::max(base::TimeDelta(),
+                    link_free_time_ - std::max(now, pacer_free_time_));
+  }
+
+ private:
+  const int link_kbps_;
+  const double packet_loss_;
+  base::TimeTicks pacer_free_time_;
+  base::TimeTicks link_free_time_;
+};
+
+}  // namespace
+
 class WebrtcFrameSchedulerTest : public ::testing::Test {
  public:
   WebrtcFrameSchedulerTest()
@@ -147,5 +215,178 @@ TEST_F(WebrtcFrameSchedulerTest, Capturer_RunsAt30Fps) {
   EXPECT_LE(capture_callback_count_, 31);
 }
 
+// Runs the scheduler against a SimulatedNetwork, with a capturer that updates
+// a part of the screen on every frame and an encoder whose output size
+// depends on the quantizer, and measures the latency of the frames and the
+// throughput achieved.
+class WebrtcFrameSchedulerNetworkTest : public ::testing::Test {
+ public:
+  WebrtcFrameSchedulerNetworkTest()
+      : task_runner_(
+            new base::TestMockTimeTaskRunner(base::Time::Now(),
+                                             base::TimeTicks::Now())),
+        task_runner_handle_(task_runner_.get()),
+        frame_(DesktopSize(kScreenWidth, kScreenHeight)) {
+    video_encoder_factory_.reset(new WebrtcDummyVideoEncoderFactory());
+    scheduler_.reset(new WebrtcFrameSchedulerSimple(SessionOptions()));
+    scheduler_->SetTickClockForTest(task_runner_->GetMockTickClock());
+    scheduler_->Start(
+        video_encoder_factory_.get(),
+        base::BindRepeating(&WebrtcFrameSchedulerNetworkTest::CaptureCallback,
+                            base::Unretained(this)));
+  }
+  ~WebrtcFrameSchedulerNetworkTest() override = default;
+
+ protected:
+  // Runs a session over a link of |link_kbps|, while WebRTC reports a target
+  // bitrate of |estimated_kbps| and a |packet_loss| fraction.
+  void RunSession(int link_kbps, int estimated_kbps, double packet_loss) {
+    network_.reset(new SimulatedNetwork(link_kbps, packet_loss));
+    link_kbps_ = link_kbps;
+    estimated_kbps_ = estimated_kbps;
+    packet_loss_ = packet_loss;
+    start_time_ = task_runner_->NowTicks();
+
+    SendFeedback();
+    video_encoder_factory_->get_video_channel_state_observer_for_tests()
+        ->OnKeyFrameRequested();
+
+    task_runner_->FastForwardBy(kSessionDuration);
+  }
+
+  base::TimeDelta GetAverageLatency() const {
+    base::TimeDelta total;
+    for (base::TimeDelta latency : latencies_)
+      total += latency;
+    return latencies_.empty() ? base::TimeDelta() : total / latencies_.size();
+  }
+
+  base::TimeDelta GetMaxLatency() const {
+    return latencies_.empty()
+               ? base::TimeDelta()
+               : *std::max_element(latencies_.begin(), latencies_.end());
+  }
+
+  // Returns the fraction of the link bandwidth used by the frames delivered
+  // during the session, including retransmissions.
+  double GetLinkUtilization() const {
+    base::TimeTicks end_time = start_time_ + kSessionDuration;
+    int64_t bytes = 0;
+    for (const auto& delivery : deliveries_) {
+      if (delivery.first <= end_time)
+        bytes += delivery.second;
+    }
+    return bytes / (1.0 - packet_loss_) * 8000 / link_kbps_ /
+           kSessionDuration.InMicroseconds();
+  }
+
+  int frames_sent() const { return static_cast<int>(latencies_.size()); }
+
+ private:
+  void CaptureCallback() {
+    base::TimeTicks capture_time = task_runner_->NowTicks();
+    frame_.mutable_updated_region()->SetRect(GetUpdatedRect());
+    WebrtcVideoEncoder::FrameParams params;
+    if (!scheduler_->OnFrameCaptured(&frame_, &params))
+      return;
+
+    int64_t area = 0;
+    for (webrtc::DesktopRegion::Iterator it(frame_.updated_region());
+         !it.IsAtEnd(); it.Advance()) {
+      area += it.rect().width() * it.rect().height();
+    }
+    if (params.key_frame)
+      area = kScreenWidth * kScreenHeight;
+
+    task_runner_->PostDelayedTask(
+        FROM_HERE,
+        base::BindOnce(&WebrtcFrameSchedulerNetworkTest::OnFrameEncoded,
+                       base::Unretained(this), capture_time, area, params),
+        kEncodeTime);
+  }
+
+  void OnFrameEncoded(base::TimeTicks capture_time,
+                      int64_t area,
+                      const WebrtcVideoEncoder::FrameParams& params) {
+    // Assume that the encoder uses the lowest quantizer allowed, and that the
+    // frame size shrinks linearly as the quantizer grows.
+    WebrtcVideoEncoder::EncodedFrame encoded;
+    encoded.size = frame_.size();
+    encoded.key_frame = params.key_frame;
+    encoded.quantizer = params.vpx_min_quantizer;
+    encoded.codec = webrtc::kVideoCodecVP8;
+    encoded.data.assign(
+        area * (kQuantizerRange - params.vpx_min_quantizer) / 256, 'X');
+    scheduler_->OnFrameEncoded(&encoded, nullptr);
+
+    base::TimeTicks delivered_time = network_->Send(
+        encoded.data.size(), estimated_kbps_, task_runner_->NowTicks());
+    latencies_.push_back(delivered_time - capture_time);
+    deliveries_.emplace_back(delivered_time, encoded.data.size());
+  }
+
+  // Reports the network parameters as RTCP feedback would.
+  void SendFeedback() {
+    auto video_channel_observer =
+        video_encoder_factory_->get_video_channel_state_observer_for_tests();
+    video_channel_observer->OnChannelParameters(
+        static_cast<int>(packet_loss_ * 255),
+        network_->GetRtt(task_runner_->NowTicks()));
+    video_channel_observer->OnTargetBitrateChanged(estimated_kbps_);
+    task_runner_->PostDelayedTask(
+        FROM_HERE,
+        base::BindOnce(&WebrtcFrameSchedulerNetworkTest::SendFeedback,
+                       base::Unretained(this)),
+        kFeedbackInterval);
+  }
+
+  scoped_refptr<base::TestMockTimeTaskRunner> task_runner_;
+  base::ThreadTaskRunnerHandle task_runner_handle_;
+
+  std::unique_ptr<WebrtcDummyVideoEncoderFactory> video_encoder_factory_;
+  std::unique_ptr<WebrtcFrameSchedulerSimple> scheduler_;
+  std::unique_ptr<SimulatedNetwork> network_;
+  BasicDesktopFrame frame_;
+
+  int link_kbps_ = 0;
+  int estimated_kbps_ = 0;
+  double packet_loss_ = 0.0;
+  base::TimeTicks start_time_;
+
+  // End-to-end latency of each frame, from the start of the capture until
+  // the frame is delivered.
+  std::vector<base::TimeDelta> latencies_;
+
+  // Delivery time and size of each frame.
+  std::vector<std::pair<base::TimeTicks, int>> deliveries_;
+};
+
+TEST_F(WebrtcFrameSchedulerNetworkTest, AccurateBandwidthEstimate) {
+  RunSession(2000, 2000, 0.0);
+
+  EXPECT_LT(GetAverageLatency(), base::TimeDelta::FromMilliseconds(400));
+  EXPECT_GT(GetLinkUtilization(), 0.7);
+}
+
+TEST_F(WebrtcFrameSchedulerNetworkTest, OverestimatedBandwidth) {
+  // The network queue would grow by a second per second if frames were sent
+  // at the target bitrate.
+  RunSession(2000, 4000, 0.0);
+
+  EXPECT_LT(GetAverageLatency(), base::TimeDelta::FromMilliseconds(600));
+  EXPECT_LT(GetMaxLatency(), base::TimeDelta::FromMilliseconds(2000));
+  EXPECT_GT(GetLinkUtilization(), 0.4);
+}
+
+TEST_F(WebrtcFrameSchedulerNetworkTest, LossyNetwork) {
+  // Retransmissions would make the pacer queue grow by 3 seconds over the
+  // session if no bitrate was reserved for them.
+  RunSession(2000, 2000, 0.1);
+
+  EXPECT_GT(frames_sent(), 0);
+  EXPECT_LT(GetMaxLatency(), base::TimeDelta::FromMilliseconds(1000));
+  EXPECT_GT(GetLinkUtilization(), 0.7);
+}
+
 }  // namespace protocol
 }  // namespace remoting
@@ -0,0 +1,129 @@
+// Copyright 2020 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "remoting/protocol/webrtc_pacing_controller.h"
+
+#include <algorithm>
+
+#include "base/numerics/ranges.h"
+
+namespace remoting {
+namespace protocol {
+
+namespace {
+
+// Network queuing delay below which the pacing rate is allowed to grow back
+// to the target bitrate.
+constexpr base::TimeDelta kTargetQueuingDelay =
+    base::TimeDelta::FromMilliseconds(50);
+
+// Network queuing delay above which the pacing rate is reduced.
+constexpr base::TimeDelta kMaxQueuingDelay =
+    base::TimeDelta::FromMilliseconds(200);
+
+// Total queuing delay in the pacer and the network above which captured
+// frames are dropped.
+constexpr base::TimeDelta kMaxQueueDelay =
+    base::TimeDelta::FromMilliseconds(400);
+
+// The minimum RTT is taken over the samples received in this interval, so
+// that it follows route changes without a queue becoming the new baseline.
+constexpr base::TimeDelta kMinRttWindow = base::TimeDelta::FromSeconds(10);
+
+// Multiplicative decrease and additive increase of |rate_scale_|. Both are
+// applied at most once per RTT, so that the effect of the previous change is
+// visible before the next one.
+const double kRateScaleDecreaseFactor = 0.8;
+const double kRateScaleIncreaseStep = 0.05;
+const double kMinRateScale = 0.25;
+
+// Maximum fraction of the bitrate (in 1/255 units) reserved for
+// retransmissions.
+const int kMaxReservedPacketLoss = 128;
+
+}  // namespace
+
+WebrtcPacingController::WebrtcPacingController()
+    : pacing_bucket_(LeakyBucket::kUnlimitedDepth, 0) {}
+
+WebrtcPacingController::~WebrtcPacingController() = default;
+
+void WebrtcPacingController::SetTargetBitrate(int bitrate_kbps,
+                                              base::TimeTicks now) {
+  target_bitrate_kbps_ = std::max(bitrate_kbps, 0);
+  UpdatePacingRate(now);
+}
+
+void WebrtcPacingController::SetChannelParameters(int packet_loss,
+                                                  base::TimeDelta rtt,
+                                                  base::TimeTicks now) {
+  packet_loss_ = base::ClampToRange(packet_loss, 0, kMaxReservedPacketLoss);
+
+  if (rtt > base::TimeDelta()) {
+    rtt_ = rtt;
+    queuing_delay_ = rtt_ - UpdateMinRtt(rtt, now);
+
+    if (last_rate_scale_change_time_.is_null() ||
+        now - last_rate_scale_change_time_ >= rtt_) {
+      if (queuing_delay_ > kMaxQueuingDelay) {
+        rate_scale_ =
+            std::max(rate_scale_ * kRateScaleDecreaseFactor, kMinRateScale);
+        last_rate_scale_change_time_ = now;
+      } else if (queuing_delay_ < kTargetQueuingDelay && rate_scale_ < 1.0) {
+        rate_scale_ = std::min(rate_scale_ + kRateScaleIncreaseStep, 1.0);
+        last_rate_scale_change_time_ = now;
+      }
+    }
+  }
+
+  UpdatePacingRate(now);
+}
+
+base::TimeDelta WebrtcPacingController::UpdateMinRtt(base::TimeDelta rtt,
+                                                     base::TimeTicks now) {
+  // Samples that aren't lower than the new one can't be the minimum anymore.
+  while (!min_rtt_samples_.empty() && min_rtt_samples_.back().rtt >= rtt)
+    min_rtt_samples_.pop_back();
+  min_rtt_samples_.push_back({now, rtt});
+
+  while (now - min_rtt_samples_.front().time > kMinRttWindow)
+    min_rtt_samples_.pop_front();
+  return min_rtt_samples_.front().rtt;
+}
+
+void WebrtcPacingController::OnFrameSent(int size, base::TimeTicks now) {
+  pacing_bucket_.RefillOrSpill(size, now);
+}
+
+base::TimeTicks WebrtcPacingController::GetSendCompleteTime() {
+  return pacing_bucket_.GetEmptyTime();
+}
+
+base::TimeDelta WebrtcPacingController::GetQueueDelay(base::TimeTicks now) {
+  return std::max(base::TimeDelta(), GetSendCompleteTime() - now) +
+         queuing_delay_;
+}
+
+base::TimeDelta WebrtcPacingController::GetExcessQueuingDelay() const {
+  return std::max(base::TimeDelta(), queuing_delay_ - kTargetQueuingDelay);
+}
+
+double WebrtcPacingController::GetCongestionLevel() const {
+  return base::ClampToRange(
+      GetExcessQueuingDelay() / (kMaxQueuingDelay - kTargetQueuingDelay), 0.0,
+      1.0);
+}
+
+bool WebrtcPacingController::ShouldDropFrame(base::TimeTicks now) {
+  return GetQueueDelay(now) > kMaxQueueDelay;
+}
+
+void WebrtcPacingController::UpdatePacingRate(base::TimeTicks now) {
+  double rate = target_bitrate_kbps_ * 1000.0 / 8 * rate_scale_ *
+                (255 - packet_loss_) / 255;
+  pacing_bucket_.UpdateRate(static_cast<int>(rate), now);
+}
+
+}  // namespace protocol
+}  // namespace remoting
@@ -0,0 +1,108 @@
+// Copyright 2020 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef REMOTING_PROTOCOL_WEBRTC_PACING_CONTROLLER_H_
+#define REMOTING_PROTOCOL_WEBRTC_PACING_CONTROLLER_H_
+
+#include "base/containers/circular_deque.h"
+#include "base/macros.h"
+#include "base/time/time.h"
+#include "remoting/base/leaky_bucket.h"
+
+namespace remoting {
+namespace protocol {
+
+// WebrtcPacingController decides how fast encoded video frames can be passed
+// to WebRTC without building up queues between the host and the client. It
+// models two queues:
+//  - the WebRTC pacer, which sends the encoded frames at the target bitrate.
+//    Its depth is tracked with a LeakyBucket that drains at the pacing rate.
+//  - the network, whose queuing delay is estimated from the growth of the RTT
+//    over the minimum RTT seen in the last few seconds.
+// The target bitrate may be overestimated, e.g. on lossy networks, in which
+// case the network queue grows even though the pacer keeps up. When that
+// happens the pacing rate is reduced multiplicatively, and it's then increased
+// gradually back to the target bitrate once the queue drains. A part of the
+// bitrate is also reserved for the retransmission of lost packets.
+class WebrtcPacingController {
+ public:
+  WebrtcPacingController();
+  ~WebrtcPacingController();
+
+  // Updates the target bitrate reported by WebRTC.
+  void SetTargetBitrate(int bitrate_kbps, base::TimeTicks now);
+
+  // Updates the network parameters reported by WebRTC. |packet_loss| is the
+  // fraction of lost packets, in 1/255 units as in RTCP receiver reports.
+  void SetChannelParameters(int packet_loss,
+                            base::TimeDelta rtt,
+                            base::TimeTicks now);
+
+  // Called when a frame of |size| bytes has been passed to WebRTC.
+  void OnFrameSent(int size, base::TimeTicks now);
+
+  // Returns the time when the frames sent so far are expected to have left
+  // the pacer. The returned value may be in the past.
+  base::TimeTicks GetSendCompleteTime();
+
+  // Returns the estimated time a frame sent at |now| would spend queued in
+  // the pacer and in the network.
+  base::TimeDelta GetQueueDelay(base::TimeTicks now);
+
+  // Returns how much the network queuing delay exceeds its target, i.e. how
+  // much longer the next capture should wait for the network queue to drain.
+  base::TimeDelta GetExcessQueuingDelay() const;
+
+  // Returns a value between 0 (no congestion) and 1 (the network queuing
+  // delay is at the limit), which is used to trade image quality for latency.
+  double GetCongestionLevel() const;
+
+  // Returns true if a frame captured at |now| should be dropped rather than
+  // sent, because the queues grew too long since it was scheduled.
+  bool ShouldDropFrame(base::TimeTicks now);
+
+  // Rate in bytes per second at which encoded frames are sent. 0 if the
+  // target bitrate is unknown.
+  int pacing_rate() { return pacing_bucket_.rate(); }
+
+  base::TimeDelta rtt() const { return rtt_; }
+  base::TimeDelta queuing_delay() const { return queuing_delay_; }
+
+ private:
+  struct RttSample {
+    base::TimeTicks time;
+    base::TimeDelta rtt;
+  };
+
+  // Adds |rtt| to |min_rtt_samples_| and returns the minimum RTT over the
+  // window ending at |now|.
+  base::TimeDelta UpdateMinRtt(base::TimeDelta rtt, base::TimeTicks now);
+
+  void UpdatePacingRate(base::TimeTicks now);
+
+  int target_bitrate_kbps_ = 0;
+  int packet_loss_ = 0;
+
+  base::TimeDelta rtt_;
+  base::TimeDelta queuing_delay_;
+
+  // RTT samples that are, or may later become, the minimum over the window.
+  // Both times and RTTs increase from front to back, so the front is the
+  // current minimum.
+  base::circular_deque<RttSample> min_rtt_samples_;
+
+  // Fraction of the target bitrate currently used for pacing, reduced when
+  // the network queue grows.
+  double rate_scale_ = 1.0;
+  base::TimeTicks last_rate_scale_change_time_;
+
+  LeakyBucket pacing_bucket_;
+
+  DISALLOW_COPY_AND_ASSIGN(WebrtcPacingController);
+};
+
+}  // namespace protocol
+}  // namespace remoting
+
+#endif  // REMOTING_PROTOCOL_WEBRTC_PACING_CONTROLLER_H_
@@ -0,0 +1,108 @@
+// Copyright 2020 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "remoting/protocol/webrtc_pacing_controller.h"
+
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace remoting {
+namespace protocol {
+
+namespace {
+
+constexpr base::TimeDelta kBaseRtt = base::TimeDelta::FromMilliseconds(100);
+
+}  // namespace
+
+class WebrtcPacingControllerTest : public testing::Test {
+ protected:
+  base::TimeTicks now_ = base::TimeTicks::Now();
+  WebrtcPacingController controller_;
+};
+
+TEST_F(WebrtcPacingControllerTest, PacingRateFollowsTargetBitrate) {
+  EXPECT_EQ(0, controller_.pacing_rate());
+  controller_.SetTargetBitrate(800, now_);
+  EXPECT_NEAR(100000, controller_.pacing_rate(), 1);
+}
+
+TEST_F(WebrtcPacingControllerTest, ReservesBitrateForLostPackets) {
+  controller_.SetTargetBitrate(800, now_);
+  // 20% of packets are lost.
+  controller_.SetChannelParameters(51, kBaseRtt, now_);
+  EXPECT_NEAR(80000, controller_.pacing_rate(), 1);
+}
+
+TEST_F(WebrtcPacingControllerTest, ReducesRateWhenNetworkQueueGrows) {
+  controller_.SetTargetBitrate(800, now_);
+  controller_.SetChannelParameters(0, kBaseRtt, now_);
+  EXPECT_EQ(base::TimeDelta(), controller_.queuing_delay());
+  EXPECT_EQ(0.0, controller_.GetCongestionLevel());
+
+  now_ += base::TimeDelta::FromSeconds(1);
+  controller_.SetChannelParameters(0, base::TimeDelta::FromMilliseconds(400),
+                                   now_);
+  EXPECT_EQ(base::TimeDelta::FromMilliseconds(300),
+            controller_.queuing_delay());
+  EXPECT_EQ(base::TimeDelta::FromMilliseconds(250),
+            controller_.GetExcessQueuingDelay());
+  EXPECT_EQ(1.0, controller_.GetCongestionLevel());
+  EXPECT_NEAR(80000, controller_.pacing_rate(), 1);
+
+  // The rate isn't reduced again until an RTT has passed.
+  now_ += base::TimeDelta::FromMilliseconds(100);
+  controller_.SetChannelParameters(0, base::TimeDelta::FromMilliseconds(400),
+                                   now_);
+  EXPECT_NEAR(80000, controller_.pacing_rate(), 1);
+
+  // The rate grows back gradually once the queue has drained.
+  now_ += base::TimeDelta::FromSeconds(1);
+  controller_.SetChannelParameters(0, kBaseRtt, now_);
+  EXPECT_EQ(base::TimeDelta(), controller_.GetExcessQueuingDelay());
+  EXPECT_NEAR(85000, controller_.pacing_rate(), 1);
+}
+
+TEST_F(WebrtcPacingControllerTest, MinRttIsTakenOverWindow) {
+  controller_.SetTargetBitrate(800, now_);
+  controller_.SetChannelParameters(0, kBaseRtt, now_);
+
+  now_ += base::TimeDelta::FromSeconds(5);
+  controller_.SetChannelParameters(0, base::TimeDelta::FromMilliseconds(150),
+                                   now_);
+  EXPECT_EQ(base::TimeDelta::FromMilliseconds(50),
+            controller_.queuing_delay());
+
+  // Once the first sample leaves the window, the queue is measured against
+  // the lowest RTT still in it, rather than becoming the new baseline.
+  now_ += base::TimeDelta::FromMilliseconds(5500);
+  controller_.SetChannelParameters(0, base::TimeDelta::FromMilliseconds(400),
+                                   now_);
+  EXPECT_EQ(base::TimeDelta::FromMilliseconds(250),
+            controller_.queuing_delay());
+
+  // A longer route is detected once all lower samples have left the window.
+  now_ += base::TimeDelta::FromSeconds(5);
+  controller_.SetChannelParameters(0, base::TimeDelta::FromMilliseconds(400),
+                                   now_);
+  EXPECT_EQ(base::TimeDelta(), controller_.queuing_delay());
+}
+
+TEST_F(WebrtcPacingControllerTest, DropsFramesWhenPacerQueueIsLong) {
+  controller_.SetTargetBitrate(800, now_);
+  controller_.SetChannelParameters(0, kBaseRtt, now_);
+
+  // 500ms worth of data.
+  controller_.OnFrameSent(50000, now_);
+  EXPECT_EQ(now_ + base::TimeDelta::FromMilliseconds(500),
+            controller_.GetSendCompleteTime());
+  EXPECT_TRUE(controller_.ShouldDropFrame(now_));
+
+  now_ += base::TimeDelta::FromMilliseconds(200);
+  EXPECT_EQ(base::TimeDelta::FromMilliseconds(300),
+            controller_.GetQueueDelay(now_));
+  EXPECT_FALSE(controller_.ShouldDropFrame(now_));
+}
+
+}  // namespace protocol
+}  // namespace remoting
@@ -194,6 +194,11 @@ void WebrtcVideoStream::SetLosslessColor(bool want_lossless) {
                       "offer/answer exchange.";
 }
 
+void WebrtcVideoStream::SetDiffFrames(bool diff_frames) {
+  NOTIMPLEMENTED() << "WebRTC streams encode the region reported by the "
+                      "capturer.";
+}
+
 void WebrtcVideoStream::SetObserver(Observer* observer) {
   DCHECK(thread_checker_.CalledOnValidThread());
   observer_ = observer;
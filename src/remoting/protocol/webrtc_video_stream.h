@@ -53,6 +53,7 @@ class WebrtcVideoStream : public VideoStream,
   void Pause(bool pause) override;
   void SetLosslessEncode(bool want_lossless) override;
   void SetLosslessColor(bool want_lossless) override;
+  void SetDiffFrames(bool diff_frames) override;
   void SetObserver(Observer* observer) override;
   void SelectSource(int id) override;
 
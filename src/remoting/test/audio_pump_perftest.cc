@@ -0,0 +1,168 @@
+// Copyright 2020 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <stdint.h>
+
+#include <cmath>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "base/logging.h"
+#include "base/macros.h"
+#include "base/memory/ptr_util.h"
+#include "base/numerics/math_constants.h"
+#include "base/run_loop.h"
+#include "base/test/task_environment.h"
+#include "base/time/time.h"
+#include "remoting/codec/audio_encoder_opus.h"
+#include "remoting/host/audio_volume_filter.h"
+#include "remoting/proto/audio.pb.h"
+#include "remoting/protocol/audio_pump.h"
+#include "remoting/protocol/audio_stub.h"
+#include "remoting/protocol/fake_audio_source.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace remoting {
+namespace test {
+
+namespace {
+
+const int kSamplingRate = 48000;
+const int kChannels = 2;
+
+// Capturers deliver 10ms packets.
+const int kPacketFrames = kSamplingRate / 100;
+const int kPacketsPerMinute = 60 * 100;
+
+// Same threshold as the Windows capturer.
+const int kSilenceThreshold = 5;
+
+enum class Workload {
+  kMusic,
+  kSpeech,
+  kSilence,
+};
+
+class FixedVolumeFilter : public AudioVolumeFilter {
+ public:
+  FixedVolumeFilter() : AudioVolumeFilter(kSilenceThreshold) {}
+  ~FixedVolumeFilter() override = default;
+
+ protected:
+  float GetAudioLevel() override { return 0.7f; }
+};
+
+// Fills |samples| with the |workload| signal for packet |index|.
+void GenerateSamples(Workload workload,
+                     int index,
+                     std::vector<int16_t>* samples) {
+  // Speech is simulated as 1.5s of voice followed by 1s of pauses.
+  bool silent = workload == Workload::kSilence ||
+                (workload == Workload::kSpeech && index % 250 >= 150);
+  for (int i = 0; i < kPacketFrames; ++i) {
+    double t = static_cast<double>(index * kPacketFrames + i) / kSamplingRate;
+    double value = 0;
+    if (workload == Workload::kMusic) {
+      value = 0.3 * std::sin(2 * base::kPiDouble * 440 * t) +
+              0.2 * std::sin(2 * base::kPiDouble * 660 * t) +
+              0.1 * std::sin(2 * base::kPiDouble * 1320 * t);
+    } else if (!silent) {
+      value = 0.4 * std::sin(2 * base::kPiDouble * 180 * t) *
+              std::sin(2 * base::kPiDouble * 3 * t);
+    }
+    int16_t sample = static_cast<int16_t>(value * 32767);
+    for (int c = 0; c < kChannels; ++c)
+      (*samples)[i * kChannels + c] = sample;
+  }
+}
+
+}  // namespace
+
+class AudioPumpPerfTest : public testing::Test, public protocol::AudioStub {
+ public:
+  AudioPumpPerfTest() = default;
+
+  // protocol::AudioStub interface.
+  void ProcessAudioPacket(std::unique_ptr<AudioPacket> audio_packet,
+                          base::OnceClosure done) override {
+    ++sent_packets_;
+    for (int i = 0; i < audio_packet->data_size(); ++i)
+      sent_bytes_ += audio_packet->data(i).size();
+    std::move(done).Run();
+  }
+
+ protected:
+  // Captures a minute of |workload| audio, applies the volume filter as the
+  // Windows capturer does and passes the packets through an AudioPump with
+  // the Opus encoder, measuring the CPU time spent on the host.
+  void RunWorkload(Workload workload, const char* name) {
+    protocol::FakeAudioSource* source = new protocol::FakeAudioSource();
+    std::unique_ptr<protocol::AudioPump> pump(new protocol::AudioPump(
+        task_environment_.GetMainThreadTaskRunner(), base::WrapUnique(source),
+        std::make_unique<AudioEncoderOpus>(), this));
+    base::RunLoop().RunUntilIdle();
+    ASSERT_FALSE(source->callback().is_null());
+
+    FixedVolumeFilter filter;
+    filter.Initialize(kSamplingRate, kChannels);
+    sent_packets_ = 0;
+    sent_bytes_ = 0;
+
+    std::vector<int16_t> samples(kPacketFrames * kChannels);
+    base::TimeDelta generate_time;
+    base::ThreadTicks started = base::ThreadTicks::Now();
+    for (int i = 0; i < kPacketsPerMinute; ++i) {
+      base::ThreadTicks generate_started = base::ThreadTicks::Now();
+      GenerateSamples(workload, i, &samples);
+      generate_time += base::ThreadTicks::Now() - generate_started;
+
+      if (!filter.Apply(samples.data(), kPacketFrames))
+        continue;
+      std::unique_ptr<AudioPacket> packet(new AudioPacket());
+      packet->add_data(reinterpret_cast<char*>(samples.data()),
+                       samples.size() * sizeof(int16_t));
+      packet->set_encoding(AudioPacket::ENCODING_RAW);
+      packet->set_sampling_rate(AudioPacket::SAMPLING_RATE_48000);
+      packet->set_bytes_per_sample(AudioPacket::BYTES_PER_SAMPLE_2);
+      packet->set_channels(AudioPacket::CHANNELS_STEREO);
+      source->callback().Run(std::move(packet));
+      base::RunLoop().RunUntilIdle();
+    }
+    base::TimeDelta cpu_time =
+        base::ThreadTicks::Now() - started - generate_time;
+
+    pump.reset();
+    base::RunLoop().RunUntilIdle();
+
+    VLOG(0) << name;
+    VLOG(0) << "  Host CPU time per minute of audio (ms): "
+            << cpu_time.InMillisecondsF();
+    VLOG(0) << "  Packets sent: " << sent_packets_;
+    VLOG(0) << "  Bytes sent: " << sent_bytes_;
+  }
+
+  base::test::SingleThreadTaskEnvironment task_environment_;
+
+  int sent_packets_ = 0;
+  int64_t sent_bytes_ = 0;
+
+ private:
+  DISALLOW_COPY_AND_ASSIGN(AudioPumpPerfTest);
+};
+
+TEST_F(AudioPumpPerfTest, Music) {
+  RunWorkload(Workload::kMusic, "Music");
+}
+
+TEST_F(AudioPumpPerfTest, Speech) {
+  RunWorkload(Workload::kSpeech, "Speech");
+}
+
+TEST_F(AudioPumpPerfTest, Silence) {
+  RunWorkload(Workload::kSilence, "Silence");
+}
+
+}  // namespace test
+}  // namespace remoting
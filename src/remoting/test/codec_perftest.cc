@@ -2,6 +2,11 @@
 // Use of this source code is governed by a BSD-style license that can be
 // found in the LICENSE file.
 
+#include <stdint.h>
+#include <string.h>
+
+#include <memory>
+
 #include "base/logging.h"
 #include "base/test/simple_test_tick_clock.h"
 #include "remoting/codec/video_encoder_vpx.h"
@@ -153,5 +158,54 @@ TEST_P(CodecPerfTest, MaxFramerate) {
   VLOG(0) << "Max framerate: " << kTotalFrames / total_latency.InSecondsF();
 }
 
+// Encodes a 4K screen where a text field, a window or the whole screen
+// changes on every frame, and reports the throughput for each workload.
+TEST_P(CodecPerfTest, DesktopWorkloads) {
+  const int kFramesPerWorkload = 60;
+  const webrtc::DesktopSize kScreenSize(3840, 2160);
+  const struct {
+    const char* name;
+    webrtc::DesktopRect rect;
+  } kWorkloads[] = {
+      {"typing", webrtc::DesktopRect::MakeXYWH(400, 300, 64, 32)},
+      {"window", webrtc::DesktopRect::MakeXYWH(640, 360, 1280, 720)},
+      {"fullscreen", webrtc::DesktopRect::MakeSize(kScreenSize)},
+  };
+
+  webrtc::BasicDesktopFrame frame(kScreenSize);
+  memset(frame.data(), 0xff, frame.stride() * kScreenSize.height());
+
+  for (const auto& workload : kWorkloads) {
+    base::TimeDelta total_latency;
+    size_t total_bytes = 0;
+
+    for (int i = 0; i < kFramesPerWorkload; ++i) {
+      // Shift a stripe pattern across the updated rect so that every frame
+      // has new content to encode.
+      const webrtc::DesktopRect& rect = workload.rect;
+      for (int y = rect.top(); y < rect.bottom(); ++y) {
+        uint32_t* row = reinterpret_cast<uint32_t*>(
+            frame.GetFrameDataAtPos(webrtc::DesktopVector(rect.left(), y)));
+        for (int x = 0; x < rect.width(); ++x)
+          row[x] = ((x + y + i * 8) / 16) % 2 ? 0xff202020 : 0xffe0e0e0;
+      }
+      frame.mutable_updated_region()->SetRect(rect);
+
+      base::TimeTicks started = base::TimeTicks::Now();
+      std::unique_ptr<VideoPacket> packet = encoder_->Encode(frame);
+      total_latency += base::TimeTicks::Now() - started;
+      if (packet)
+        total_bytes += packet->data().size();
+
+      clock_.Advance(kIntervalBetweenFrames);
+    }
+
+    VLOG(0) << workload.name << " framerate: "
+            << kFramesPerWorkload / total_latency.InSecondsF();
+    VLOG(0) << workload.name
+            << " bytes per frame: " << total_bytes / kFramesPerWorkload;
+  }
+}
+
 }  // namespace test
 }  // namespace remoting
@@ -0,0 +1,139 @@
+// Copyright 2020 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <stdint.h>
+#include <string.h>
+
+#include <memory>
+
+#include "base/logging.h"
+#include "base/time/time.h"
+#include "remoting/codec/frame_differ.h"
+#include "testing/gtest/include/gtest/gtest.h"
+#include "third_party/webrtc/modules/desktop_capture/desktop_frame.h"
+
+namespace remoting {
+namespace test {
+
+namespace {
+
+const int kTotalFrames = 300;
+const int kScreenWidth = 1920;
+const int kScreenHeight = 1080;
+const int kScrollPixelsPerFrame = 8;
+
+// Window with scrolled text.
+webrtc::DesktopRect GetWindowRect() {
+  return webrtc::DesktopRect::MakeXYWH(320, 180, 1280, 720);
+}
+
+// Video player within the window.
+webrtc::DesktopRect GetVideoRect() {
+  return webrtc::DesktopRect::MakeXYWH(640, 360, 640, 360);
+}
+
+enum class Workload {
+  kStatic,
+  kScroll,
+  kVideo,
+};
+
+// Draws lines of "text" that move up by |scroll_offset| rows.
+void DrawScrolledText(webrtc::DesktopFrame* frame, int scroll_offset) {
+  const webrtc::DesktopRect window_rect = GetWindowRect();
+  for (int y = window_rect.top(); y < window_rect.bottom(); ++y) {
+    uint32_t* row = reinterpret_cast<uint32_t*>(
+        frame->GetFrameDataAtPos(webrtc::DesktopVector(window_rect.left(), y)));
+    int line = (y - window_rect.top() + scroll_offset) / 16;
+    bool text_row = (y - window_rect.top() + scroll_offset) % 16 < 10;
+    for (int x = 0; x < window_rect.width(); ++x) {
+      bool ink = text_row && x < 200 + (line * 37) % 1000 && (x * 7 + line) % 5;
+      row[x] = ink ? 0xff000000 : 0xffffffff;
+    }
+  }
+}
+
+// Fills the video area with noise that changes on every frame.
+void DrawVideo(webrtc::DesktopFrame* frame, uint32_t* seed) {
+  const webrtc::DesktopRect video_rect = GetVideoRect();
+  for (int y = video_rect.top(); y < video_rect.bottom(); ++y) {
+    uint32_t* row = reinterpret_cast<uint32_t*>(
+        frame->GetFrameDataAtPos(webrtc::DesktopVector(video_rect.left(), y)));
+    for (int x = 0; x < video_rect.width(); ++x) {
+      *seed = *seed * 1103515245 + 12345;
+      row[x] = 0xff000000 | (*seed >> 8);
+    }
+  }
+}
+
+}  // namespace
+
+class FrameDifferPerfTest : public testing::Test {
+ protected:
+  // Simulates a capturer that repaints |workload| on every frame and reports
+  // the whole screen as updated, and measures the time taken to draw the
+  // frame and find the region that actually changed.
+  void RunWorkload(Workload workload, int block_size, const char* name) {
+    const webrtc::DesktopSize screen_size(kScreenWidth, kScreenHeight);
+    webrtc::BasicDesktopFrame frame(screen_size);
+    memset(frame.data(), 0x80, frame.stride() * screen_size.height());
+    DrawScrolledText(&frame, 0);
+
+    FrameDiffer differ(block_size);
+    uint32_t seed = 1;
+    base::TimeDelta capture_time;
+    base::TimeDelta diff_time;
+    int64_t total_rects = 0;
+    int64_t total_pixels = 0;
+
+    for (int i = 0; i < kTotalFrames; ++i) {
+      base::TimeTicks started = base::TimeTicks::Now();
+      if (workload == Workload::kScroll)
+        DrawScrolledText(&frame, i * kScrollPixelsPerFrame);
+      if (workload == Workload::kVideo)
+        DrawVideo(&frame, &seed);
+      frame.mutable_updated_region()->SetRect(
+          webrtc::DesktopRect::MakeSize(screen_size));
+      base::TimeTicks captured = base::TimeTicks::Now();
+
+      differ.UpdateRegion(&frame);
+      base::TimeTicks diffed = base::TimeTicks::Now();
+
+      capture_time += captured - started;
+      diff_time += diffed - captured;
+      for (webrtc::DesktopRegion::Iterator it(frame.updated_region());
+           !it.IsAtEnd(); it.Advance()) {
+        ++total_rects;
+        total_pixels += it.rect().width() * it.rect().height();
+      }
+    }
+
+    VLOG(0) << name << " (" << block_size << "px blocks)";
+    VLOG(0) << "  Average capture time: "
+            << (capture_time / kTotalFrames).InMillisecondsF();
+    VLOG(0) << "  Average diff time: "
+            << (diff_time / kTotalFrames).InMillisecondsF();
+    VLOG(0) << "  Rects per frame: "
+            << static_cast<double>(total_rects) / kTotalFrames;
+    VLOG(0) << "  Updated pixels per frame: " << total_pixels / kTotalFrames;
+  }
+};
+
+TEST_F(FrameDifferPerfTest, Static) {
+  RunWorkload(Workload::kStatic, 16, "Static");
+  RunWorkload(Workload::kStatic, 32, "Static");
+}
+
+TEST_F(FrameDifferPerfTest, Scroll) {
+  RunWorkload(Workload::kScroll, 16, "Scroll");
+  RunWorkload(Workload::kScroll, 32, "Scroll");
+}
+
+TEST_F(FrameDifferPerfTest, Video) {
+  RunWorkload(Workload::kVideo, 16, "Video");
+  RunWorkload(Workload::kVideo, 32, "Video");
+}
+
+}  // namespace test
+}  // namespace remoting
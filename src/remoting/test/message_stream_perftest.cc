@@ -0,0 +1,139 @@
+// Copyright 2020 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <memory>
+#include <string>
+
+#include "base/bind.h"
+#include "base/logging.h"
+#include "base/run_loop.h"
+#include "base/test/task_environment.h"
+#include "base/time/time.h"
+#include "net/base/io_buffer.h"
+#include "net/traffic_annotation/network_traffic_annotation_test_helper.h"
+#include "remoting/base/buffered_socket_writer.h"
+#include "remoting/base/compound_buffer.h"
+#include "remoting/proto/video.pb.h"
+#include "remoting/protocol/fake_stream_socket.h"
+#include "remoting/protocol/message_reader.h"
+#include "remoting/protocol/message_serialization.h"
+#include "testing/gtest/include/gtest/gtest.h"
+
+namespace remoting {
+namespace test {
+
+namespace {
+
+// Number of messages written but not yet received, as with a stream of
+// video packets that is throttled by the receiver.
+const int kMessagesInFlight = 8;
+
+}  // namespace
+
+// Sends video packets through a BufferedSocketWriter and a MessageReader
+// connected by a pair of in-process sockets, and measures the throughput of
+// framing, writing, reading and parsing them.
+class MessageStreamPerfTest : public testing::Test {
+ public:
+  MessageStreamPerfTest() { host_socket_.PairWith(&client_socket_); }
+
+ protected:
+  void RunTest(int message_size, int message_count, const char* name) {
+    VideoPacket packet;
+    packet.set_data(std::string(message_size, 'x'));
+    framed_message_ = protocol::SerializeAndFrameMessage(packet);
+    messages_to_send_ = message_count;
+    messages_to_receive_ = message_count;
+
+    writer_.Start(base::BindRepeating(&MessageStreamPerfTest::WriteSocket,
+                                      base::Unretained(this)),
+                  base::BindOnce(&MessageStreamPerfTest::OnFailed,
+                                 base::Unretained(this)));
+    reader_.StartReading(
+        &client_socket_,
+        base::BindRepeating(&MessageStreamPerfTest::OnMessageReceived,
+                            base::Unretained(this)),
+        base::BindOnce(&MessageStreamPerfTest::OnFailed,
+                       base::Unretained(this)));
+
+    base::TimeTicks started = base::TimeTicks::Now();
+    for (int i = 0; i < kMessagesInFlight; ++i)
+      SendMessage();
+    run_loop_.Run();
+    base::TimeDelta elapsed = base::TimeTicks::Now() - started;
+
+    double megabytes =
+        static_cast<double>(message_size) * message_count / (1024 * 1024);
+    VLOG(0) << name << " (" << message_size << " bytes per message)";
+    VLOG(0) << "  Throughput: " << megabytes / elapsed.InSecondsF() << " MB/s";
+    VLOG(0) << "  Messages per second: "
+            << message_count / elapsed.InSecondsF();
+    VLOG(0) << "  Socket writes per message: "
+            << static_cast<double>(socket_writes_) / message_count;
+  }
+
+ private:
+  int WriteSocket(const scoped_refptr<net::IOBuffer>& buf,
+                  int buf_len,
+                  net::CompletionOnceCallback callback,
+                  const net::NetworkTrafficAnnotationTag& traffic_annotation) {
+    ++socket_writes_;
+    return host_socket_.Write(buf, buf_len, std::move(callback),
+                              traffic_annotation);
+  }
+
+  void SendMessage() {
+    if (messages_to_send_ == 0)
+      return;
+    --messages_to_send_;
+    writer_.Write(framed_message_, base::OnceClosure(),
+                  TRAFFIC_ANNOTATION_FOR_TESTS);
+  }
+
+  void OnMessageReceived(std::unique_ptr<CompoundBuffer> message) {
+    std::unique_ptr<VideoPacket> packet =
+        protocol::ParseMessage<VideoPacket>(message.get());
+    ASSERT_TRUE(packet);
+    if (--messages_to_receive_ == 0) {
+      run_loop_.Quit();
+      return;
+    }
+    SendMessage();
+  }
+
+  void OnFailed(int error) {
+    ADD_FAILURE() << "Stream failed: " << error;
+    run_loop_.Quit();
+  }
+
+  base::test::SingleThreadTaskEnvironment task_environment_;
+  protocol::FakeStreamSocket host_socket_;
+  protocol::FakeStreamSocket client_socket_;
+  BufferedSocketWriter writer_;
+  protocol::MessageReader reader_;
+  base::RunLoop run_loop_;
+
+  scoped_refptr<net::IOBufferWithSize> framed_message_;
+  int messages_to_send_ = 0;
+  int messages_to_receive_ = 0;
+  int socket_writes_ = 0;
+};
+
+// Input events and control messages.
+TEST_F(MessageStreamPerfTest, SmallMessages) {
+  RunTest(64, 50000, "SmallMessages");
+}
+
+// Video packets for small updates.
+TEST_F(MessageStreamPerfTest, MediumMessages) {
+  RunTest(4 * 1024, 5000, "MediumMessages");
+}
+
+// Video packets for full-screen updates.
+TEST_F(MessageStreamPerfTest, LargeMessages) {
+  RunTest(256 * 1024, 200, "LargeMessages");
+}
+
+}  // namespace test
+}  // namespace remoting
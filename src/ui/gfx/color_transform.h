@@ -5,6 +5,8 @@
 #ifndef UI_GFX_COLOR_TRANSFORM_H_
 #define UI_GFX_COLOR_TRANSFORM_H_
 
+#include <stddef.h>
+
 #include <memory>
 #include <string>
 
@@ -57,6 +59,17 @@ class GFX_EXPORT ColorTransform {
       int dst_bit_depth,
       Intent intent);
 
+  // Returns a transform that evaluates |transform| on the CPU by trilinear
+  // interpolation in a |lut_size|^3 table sampled over the unit cube, which is
+  // much cheaper per pixel than evaluating the transfer functions of each step.
+  // Inputs outside of [0, 1] are passed to |transform| directly. Shader sources
+  // are those of |transform|. Interpolation smooths over the kinks of clamped
+  // or piecewise transfer functions, so this is intended for RGB to RGB
+  // conversions, where the default size keeps the error within 1.5/255.
+  static std::unique_ptr<ColorTransform> NewLUTColorTransform(
+      std::unique_ptr<ColorTransform> transform,
+      size_t lut_size = kDefaultLUTSize);
+
   // Assumes bit depth 8. For higher bit depths, use above NewColorTransform()
   // method instead.
   static std::unique_ptr<ColorTransform> NewColorTransform(
@@ -70,6 +83,8 @@ class GFX_EXPORT ColorTransform {
  private:
   // The default bit depth assumed by NewColorTransform().
   static constexpr int kDefaultBitDepth = 8;
+  // The default number of samples per channel for NewLUTColorTransform().
+  static constexpr size_t kDefaultLUTSize = 33;
 
   DISALLOW_COPY_AND_ASSIGN(ColorTransform);
 };
@@ -532,6 +532,71 @@ TEST(SimpleColorSpace, CanParseSkShaderSource) {
   }
 }
 
+// Checks that transforming colors in bulk, which uses SIMD where available,
+// matches transforming them one at a time.
+TEST(SimpleColorSpace, BulkTransformMatchesSingle) {
+  std::unique_ptr<ColorTransform> t(ColorTransform::NewColorTransform(
+      ColorSpace::CreateREC709(), ColorSpace::CreateDisplayP3D65(),
+      ColorTransform::Intent::INTENT_PERCEPTUAL));
+
+  // Use a count that isn't a multiple of four to cover the scalar tail.
+  std::vector<ColorTransform::TriStim> bulk;
+  for (int i = 0; i < 23; ++i)
+    bulk.emplace_back(i / 23.f, 1.f - i / 23.f, (i % 5) / 4.f);
+  std::vector<ColorTransform::TriStim> single = bulk;
+
+  t->Transform(bulk.data(), bulk.size());
+  for (auto& color : single)
+    t->Transform(&color, 1);
+
+  for (size_t i = 0; i < bulk.size(); ++i) {
+    EXPECT_NEAR(bulk[i].x(), single[i].x(), kMathEpsilon);
+    EXPECT_NEAR(bulk[i].y(), single[i].y(), kMathEpsilon);
+    EXPECT_NEAR(bulk[i].z(), single[i].z(), kMathEpsilon);
+  }
+}
+
+TEST(SimpleColorSpace, LUTColorTransform) {
+  ColorSpace src = ColorSpace::CreateSRGB();
+  ColorSpace dst = ColorSpace::CreateDisplayP3D65();
+  std::unique_ptr<ColorTransform> exact(ColorTransform::NewColorTransform(
+      src, dst, ColorTransform::Intent::INTENT_PERCEPTUAL));
+  std::unique_ptr<ColorTransform> lut(ColorTransform::NewLUTColorTransform(
+      ColorTransform::NewColorTransform(
+          src, dst, ColorTransform::Intent::INTENT_PERCEPTUAL)));
+  EXPECT_EQ(lut->GetShaderSource(), exact->GetShaderSource());
+  EXPECT_EQ(lut->GetSrcColorSpace(), src);
+  EXPECT_EQ(lut->GetDstColorSpace(), dst);
+
+  // Sample between the grid points, where interpolation error is largest, and
+  // include values outside of the table's range.
+  std::vector<ColorTransform::TriStim> expected;
+  const int kSteps = 20;
+  for (int r = 0; r <= kSteps; ++r) {
+    for (int g = 0; g <= kSteps; ++g) {
+      for (int b = 0; b <= kSteps; ++b)
+        expected.emplace_back(r / 19.f, g / 20.f, b / 21.f);
+    }
+  }
+  expected.emplace_back(-0.25f, 0.5f, 0.5f);
+  expected.emplace_back(0.5f, 1.5f, 0.5f);
+  std::vector<ColorTransform::TriStim> actual = expected;
+
+  exact->Transform(expected.data(), expected.size());
+  lut->Transform(actual.data(), actual.size());
+  for (size_t i = 0; i < actual.size(); ++i) {
+    EXPECT_NEAR(actual[i].x(), expected[i].x(), kPixelEpsilon);
+    EXPECT_NEAR(actual[i].y(), expected[i].y(), kPixelEpsilon);
+    EXPECT_NEAR(actual[i].z(), expected[i].z(), kPixelEpsilon);
+  }
+
+  // Identity transforms aren't wrapped.
+  std::unique_ptr<ColorTransform> identity(
+      ColorTransform::NewLUTColorTransform(ColorTransform::NewColorTransform(
+          src, src, ColorTransform::Intent::INTENT_PERCEPTUAL)));
+  EXPECT_TRUE(identity->IsIdentity());
+}
+
 class TransferTest : public testing::TestWithParam<ColorSpace::TransferID> {};
 
 TEST_P(TransferTest, basicTest) {
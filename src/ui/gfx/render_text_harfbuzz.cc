@@ -1176,103 +1176,132 @@ size_t TextRunList::GetRunIndexAt(size_t position) const {
 
 namespace {
 
-// ShapeRunWithFont cache. Views makes repeated calls to ShapeRunWithFont
-// with the same arguments in several places, and typesetting is very expensive.
-// To compensate for this, encapsulate all of the input arguments to
-// ShapeRunWithFont in ShapeRunWithFontInput, all of the output arguments in
-// TextRunHarfBuzz::ShapeOutput, and add ShapeRunCache to map between the two.
-// This is analogous to the blink::ShapeCache.
-// https://crbug.com/826265
-
-// Input for the stateless implementation of ShapeRunWithFont.
-struct ShapeRunWithFontInput {
-  ShapeRunWithFontInput(const base::string16& full_text,
-                        const TextRunHarfBuzz::FontParams& font_params,
-                        Range full_range,
-                        bool obscured,
-                        float glyph_width_for_test,
-                        int obscured_glyph_spacing,
-                        bool subpixel_rendering_suppressed)
-      : skia_face(font_params.skia_face),
-        render_params(font_params.render_params),
-        script(font_params.script),
-        font_size(font_params.font_size),
-        obscured_glyph_spacing(obscured_glyph_spacing),
-        glyph_width_for_test(glyph_width_for_test),
-        is_rtl(font_params.is_rtl),
-        obscured(obscured),
-        subpixel_rendering_suppressed(subpixel_rendering_suppressed) {
-    // hb_buffer_add_utf16 will read the previous and next 5 unicode characters
-    // (which can have a maximum length of 2 uint16_t) as "context" that is used
-    // only for Arabic (which is RTL). Read the previous and next 10 uint16_ts
-    // to ensure that we capture all of this context if we're using RTL.
-    size_t kContextSize = is_rtl ? 10 : 0;
-    size_t context_start = full_range.start() < kContextSize
-                               ? 0
-                               : full_range.start() - kContextSize;
-    size_t context_end =
-        std::min(full_text.length(), full_range.end() + kContextSize);
-    range = Range(full_range.start() - context_start,
-                  full_range.end() - context_start);
-    text = full_text.substr(context_start, context_end - context_start);
-
-    // Pre-compute the hash to avoid having to re-hash at every comparison.
-    // Attempt to minimize collisions by including the typeface, script, font
-    // size, text and the text range.
-    hash = base::HashInts(hash, skia_face->uniqueID());
-    hash = base::HashInts(hash, script);
-    hash = base::HashInts(hash, font_size);
-    hash = base::Hash(text);
-    hash = base::HashInts(hash, range.start());
-    hash = base::HashInts(hash, range.length());
-  }
-
-  bool operator==(const ShapeRunWithFontInput& other) const {
-    return text == other.text && skia_face == other.skia_face &&
-           render_params == other.render_params &&
-           font_size == other.font_size && range == other.range &&
-           script == other.script && is_rtl == other.is_rtl &&
-           obscured == other.obscured &&
-           glyph_width_for_test == other.glyph_width_for_test &&
-           obscured_glyph_spacing == other.obscured_glyph_spacing &&
-           subpixel_rendering_suppressed == other.subpixel_rendering_suppressed;
-  }
-
-  struct Hash {
-    size_t operator()(const ShapeRunWithFontInput& key) const {
-      return key.hash;
-    }
-  };
-
-  sk_sp<SkTypeface> skia_face;
-  FontRenderParams render_params;
-  UScriptCode script;
-  int font_size;
-  int obscured_glyph_spacing;
-  float glyph_width_for_test;
-  bool is_rtl;
-  bool obscured;
-  bool subpixel_rendering_suppressed;
-
-  // The parts of the input text that may be read by hb_buffer_add_utf16.
-  base::string16 text;
-  // The conversion of the input range to a range within |text|.
-  Range range;
-  // The hash is cached to avoid repeated calls.
-  size_t hash = 0;
-};
+// The maximum cache size used in blink::ShapeCache is 10k. A Finch experiment
+// showed that reducing the cache size to 1k has no performance impact. Since
+// runs of up to 64 characters are cached, the cache is also bounded by the
+// approximate memory used by its entries.
+constexpr size_t kShapeRunCacheSize = 1000;
+constexpr size_t kShapeRunCacheMaxBytes = 1024 * 1024;
+// The hit rate is reported once every this many lookups.
+constexpr int kShapeRunCacheLookupsPerReport = 1000;
 
-// An MRU cache of the results from calling ShapeRunWithFont. The maximum cache
-// size used in blink::ShapeCache is 10k. A Finch experiment showed that
-// reducing the cache size to 1k has no performance impact.
-constexpr int kShapeRunCacheSize = 1000;
-using ShapeRunCacheBase = base::HashingMRUCache<ShapeRunWithFontInput,
-                                                TextRunHarfBuzz::ShapeOutput,
-                                                ShapeRunWithFontInput::Hash>;
-class ShapeRunCache : public ShapeRunCacheBase {
- public:
-  ShapeRunCache() : ShapeRunCacheBase(kShapeRunCacheSize) {}
-};
+}  // namespace
+
+ShapeRunWithFontInput::ShapeRunWithFontInput(
+    const base::string16& full_text,
+    const TextRunHarfBuzz::FontParams& font_params,
+    Range full_range,
+    bool obscured,
+    float glyph_width_for_test,
+    int obscured_glyph_spacing,
+    bool subpixel_rendering_suppressed)
+    : skia_face(font_params.skia_face),
+      render_params(font_params.render_params),
+      script(font_params.script),
+      font_size(font_params.font_size),
+      obscured_glyph_spacing(obscured_glyph_spacing),
+      glyph_width_for_test(glyph_width_for_test),
+      is_rtl(font_params.is_rtl),
+      obscured(obscured),
+      subpixel_rendering_suppressed(subpixel_rendering_suppressed) {
+  // hb_buffer_add_utf16 will read the previous and next 5 unicode characters
+  // (which can have a maximum length of 2 uint16_t) as "context" that is used
+  // only for Arabic (which is RTL). Read the previous and next 10 uint16_ts
+  // to ensure that we capture all of this context if we're using RTL.
+  size_t kContextSize = is_rtl ? 10 : 0;
+  size_t context_start =
+      full_range.start() < kContextSize ? 0 : full_range.start() - kContextSize;
+  size_t context_end =
+      std::min(full_text.length(), full_range.end() + kContextSize);
+  range = Range(full_range.start() - context_start,
+                full_range.end() - context_start);
+  text = full_text.substr(context_start, context_end - context_start);
+
+  // Pre-compute the hash to avoid having to re-hash at every comparison.
+  // Attempt to minimize collisions by including the typeface, script, font
+  // size, direction, text and the text range.
+  hash = base::Hash(text);
+  hash = base::HashInts(hash, skia_face->uniqueID());
+  hash = base::HashInts(hash, script);
+  hash = base::HashInts(hash, font_size);
+  hash = base::HashInts(hash, is_rtl);
+  hash = base::HashInts(hash, range.start());
+  hash = base::HashInts(hash, range.length());
+}
+
+ShapeRunWithFontInput::ShapeRunWithFontInput(
+    const ShapeRunWithFontInput& other) = default;
+
+ShapeRunWithFontInput::~ShapeRunWithFontInput() = default;
+
+bool ShapeRunWithFontInput::operator==(
+    const ShapeRunWithFontInput& other) const {
+  return text == other.text && skia_face == other.skia_face &&
+         render_params == other.render_params &&
+         font_size == other.font_size && range == other.range &&
+         script == other.script && is_rtl == other.is_rtl &&
+         obscured == other.obscured &&
+         glyph_width_for_test == other.glyph_width_for_test &&
+         obscured_glyph_spacing == other.obscured_glyph_spacing &&
+         subpixel_rendering_suppressed == other.subpixel_rendering_suppressed;
+}
+
+ShapeRunCache::ShapeRunCache() : ShapeRunCache(kShapeRunCacheMaxBytes) {}
+
+ShapeRunCache::ShapeRunCache(size_t max_bytes)
+    : cache_(Cache::NO_AUTO_EVICT), max_bytes_(max_bytes) {}
+
+ShapeRunCache::~ShapeRunCache() = default;
+
+const TextRunHarfBuzz::ShapeOutput* ShapeRunCache::Get(
+    const ShapeRunWithFontInput& key) {
+  auto found = cache_.Get(key);
+  const bool hit = found != cache_.end();
+  if (hit)
+    ++hits_;
+  if (++lookups_ == kShapeRunCacheLookupsPerReport) {
+    UMA_HISTOGRAM_PERCENTAGE("RenderTextHarfBuzz.ShapeRunCacheHitRate",
+                             hits_ * 100 / lookups_);
+    hits_ = 0;
+    lookups_ = 0;
+  }
+  return hit ? &found->second : nullptr;
+}
+
+void ShapeRunCache::Put(const ShapeRunWithFontInput& key,
+                        const TextRunHarfBuzz::ShapeOutput& output) {
+  auto existing = cache_.Peek(key);
+  if (existing != cache_.end()) {
+    bytes_ -= GetEntrySize(existing->first, existing->second);
+    cache_.Erase(existing);
+  }
+  bytes_ += GetEntrySize(key, output);
+  cache_.Put(key, output);
+  while (cache_.size() > kShapeRunCacheSize || bytes_ > max_bytes_) {
+    auto oldest = cache_.rbegin();
+    bytes_ -= GetEntrySize(oldest->first, oldest->second);
+    cache_.Erase(oldest);
+  }
+}
+
+void ShapeRunCache::Clear() {
+  cache_.Clear();
+  bytes_ = 0;
+  lookups_ = 0;
+  hits_ = 0;
+}
+
+// static
+size_t ShapeRunCache::GetEntrySize(const ShapeRunWithFontInput& key,
+                                   const TextRunHarfBuzz::ShapeOutput& output) {
+  return sizeof(key) + sizeof(output) +
+         key.text.size() * sizeof(base::char16) +
+         output.glyphs.size() * sizeof(uint16_t) +
+         output.positions.size() * sizeof(SkPoint) +
+         output.glyph_to_char.size() * sizeof(uint32_t);
+}
+
+namespace {
 
 void ShapeRunWithFont(const ShapeRunWithFontInput& in,
                       TextRunHarfBuzz::ShapeOutput* out) {
@@ -2154,6 +2183,12 @@ void RenderTextHarfBuzz::ShapeRuns(
   RecordShapeRunsFallback(ShapeRunFallback::FAILED);
 }
 
+// static
+internal::ShapeRunCache* RenderTextHarfBuzz::GetShapeRunCache() {
+  static base::NoDestructor<internal::ShapeRunCache> cache;
+  return cache.get();
+}
+
 void RenderTextHarfBuzz::ShapeRunsWithFont(
     const base::string16& text,
     const internal::TextRunHarfBuzz::FontParams& font_params,
@@ -2161,9 +2196,10 @@ void RenderTextHarfBuzz::ShapeRunsWithFont(
   // ShapeRunWithFont can be extremely slow, so use cached results if possible.
   // Only do this on the UI thread, to avoid synchronization overhead (and
   // because almost all calls are on the UI thread. Also avoid caching long
-  // strings, to avoid blowing up the cache size.
-  constexpr size_t kMaxRunLengthToCache = 25;
-  static base::NoDestructor<internal::ShapeRunCache> cache;
+  // strings, to avoid blowing up the cache size. The limit covers typical
+  // labels and list rows; the cache's byte budget bounds the rest.
+  constexpr size_t kMaxRunLengthToCache = 64;
+  internal::ShapeRunCache* cache = GetShapeRunCache();
 
   std::vector<internal::TextRunHarfBuzz*> runs_with_missing_glyphs;
   for (internal::TextRunHarfBuzz*& run : *in_out_runs) {
@@ -2175,9 +2211,10 @@ void RenderTextHarfBuzz::ShapeRunsWithFont(
         text, font_params, run->range, obscured(), glyph_width_for_test_,
         obscured_glyph_spacing(), subpixel_rendering_suppressed());
     if (can_use_cache) {
-      auto found = cache.get()->Get(cache_key);
-      if (found != cache.get()->end()) {
-        run->UpdateFontParamsAndShape(font_params, found->second);
+      const internal::TextRunHarfBuzz::ShapeOutput* found =
+          cache->Get(cache_key);
+      if (found) {
+        run->UpdateFontParamsAndShape(font_params, *found);
         found_in_cache = true;
       }
     }
@@ -2190,7 +2227,7 @@ void RenderTextHarfBuzz::ShapeRunsWithFont(
       ShapeRunWithFont(cache_key, &output);
       run->UpdateFontParamsAndShape(font_params, output);
       if (can_use_cache)
-        cache.get()->Put(cache_key, output);
+        cache->Put(cache_key, output);
     }
 
     // Check to see if we still have missing glyphs.
@@ -12,6 +12,7 @@
 #include <string>
 #include <vector>
 
+#include "base/containers/mru_cache.h"
 #include "base/macros.h"
 #include "third_party/icu/source/common/unicode/ubidi.h"
 #include "third_party/icu/source/common/unicode/uscript.h"
@@ -199,6 +200,99 @@ class TextRunList {
   DISALLOW_COPY_AND_ASSIGN(TextRunList);
 };
 
+// ShapeRunWithFont cache. Views makes repeated calls to ShapeRunWithFont
+// with the same arguments in several places, and typesetting is very expensive.
+// To compensate for this, encapsulate all of the input arguments to
+// ShapeRunWithFont in ShapeRunWithFontInput, all of the output arguments in
+// TextRunHarfBuzz::ShapeOutput, and add ShapeRunCache to map between the two.
+// This is analogous to the blink::ShapeCache.
+// https://crbug.com/826265
+
+// Input for the stateless implementation of ShapeRunWithFont.
+struct GFX_EXPORT ShapeRunWithFontInput {
+  ShapeRunWithFontInput(const base::string16& full_text,
+                        const TextRunHarfBuzz::FontParams& font_params,
+                        Range full_range,
+                        bool obscured,
+                        float glyph_width_for_test,
+                        int obscured_glyph_spacing,
+                        bool subpixel_rendering_suppressed);
+  ShapeRunWithFontInput(const ShapeRunWithFontInput& other);
+  ~ShapeRunWithFontInput();
+
+  bool operator==(const ShapeRunWithFontInput& other) const;
+
+  struct Hash {
+    size_t operator()(const ShapeRunWithFontInput& key) const {
+      return key.hash;
+    }
+  };
+
+  sk_sp<SkTypeface> skia_face;
+  FontRenderParams render_params;
+  UScriptCode script;
+  int font_size;
+  int obscured_glyph_spacing;
+  float glyph_width_for_test;
+  bool is_rtl;
+  bool obscured;
+  bool subpixel_rendering_suppressed;
+
+  // The parts of the input text that may be read by hb_buffer_add_utf16.
+  base::string16 text;
+  // The conversion of the input range to a range within |text|.
+  Range range;
+  // The hash is cached to avoid repeated calls.
+  size_t hash = 0;
+};
+
+// An MRU cache of the results from calling ShapeRunWithFont, shared by all
+// RenderTextHarfBuzz instances so that short-lived instances showing the same
+// strings (e.g. list rows and labels being scrolled) don't re-shape them. It
+// is bounded both by entry count and by the approximate memory used by its
+// entries.
+class GFX_EXPORT ShapeRunCache {
+ public:
+  ShapeRunCache();
+  explicit ShapeRunCache(size_t max_bytes);
+  ~ShapeRunCache();
+
+  // Returns the cached output for |key|, or null. Lookups count towards the
+  // reported hit rate.
+  const TextRunHarfBuzz::ShapeOutput* Get(const ShapeRunWithFontInput& key);
+
+  // Caches |output| for |key|, evicting the least recently used entries over
+  // the bounds.
+  void Put(const ShapeRunWithFontInput& key,
+           const TextRunHarfBuzz::ShapeOutput& output);
+
+  // Removes all entries and resets the hit rate.
+  void Clear();
+
+  size_t size() const { return cache_.size(); }
+  size_t bytes() const { return bytes_; }
+
+  // Lookups and hits since the hit rate was last reported.
+  int lookups() const { return lookups_; }
+  int hits() const { return hits_; }
+
+ private:
+  using Cache = base::HashingMRUCache<ShapeRunWithFontInput,
+                                      TextRunHarfBuzz::ShapeOutput,
+                                      ShapeRunWithFontInput::Hash>;
+
+  static size_t GetEntrySize(const ShapeRunWithFontInput& key,
+                             const TextRunHarfBuzz::ShapeOutput& output);
+
+  Cache cache_;
+  const size_t max_bytes_;
+  size_t bytes_ = 0;
+  int lookups_ = 0;
+  int hits_ = 0;
+
+  DISALLOW_COPY_AND_ASSIGN(ShapeRunCache);
+};
+
 }  // namespace internal
 
 class GFX_EXPORT RenderTextHarfBuzz : public RenderText {
@@ -278,6 +372,10 @@ class GFX_EXPORT RenderTextHarfBuzz : public RenderText {
       const internal::TextRunHarfBuzz::FontParams& font_params,
       std::vector<internal::TextRunHarfBuzz*>* in_out_runs);
 
+  // Returns the ShapeRunWithFont cache shared by all instances. Only used on
+  // the UI thread.
+  static internal::ShapeRunCache* GetShapeRunCache();
+
   // Itemize |text| into runs in |out_run_list|, shape the runs, and populate
   // |out_run_list|'s visual <-> logical maps.
   void ItemizeAndShapeText(const base::string16& text,
@@ -17,6 +17,7 @@
 #include "base/i18n/char_iterator.h"
 #include "base/run_loop.h"
 #include "base/stl_util.h"
+#include "base/strings/string_number_conversions.h"
 #include "base/strings/string_split.h"
 #include "base/strings/string_util.h"
 #include "base/strings/stringprintf.h"
@@ -554,6 +555,10 @@ class RenderTextTest : public testing::Test {
 
   RenderTextHarfBuzz* GetRenderText() { return render_text_.get(); }
 
+  internal::ShapeRunCache* GetShapeRunCache() {
+    return RenderTextHarfBuzz::GetShapeRunCache();
+  }
+
   Rect GetSubstringBoundsUnion(const Range& range) {
     const std::vector<Rect> bounds = render_text_->GetSubstringBounds(range);
     return std::accumulate(
@@ -6104,6 +6109,103 @@ TEST_F(RenderTextTest, HarfBuzz_SubglyphGraphemePartition) {
   }
 }
 
+// Ensures that runs differing in any of the hashed font parameters get their
+// own ShapeRunCache entries.
+TEST_F(RenderTextTest, HarfBuzz_ShapeRunCacheKey) {
+  const base::string16 text = UTF8ToUTF16("abc");
+  RenderTextHarfBuzz* render_text = GetRenderText();
+  render_text->SetText(text);
+  const internal::TextRunList* run_list = GetHarfBuzzRunList();
+  ASSERT_EQ(1U, run_list->size());
+  const internal::TextRunHarfBuzz::FontParams font_params =
+      run_list->runs()[0]->font_params;
+  const internal::ShapeRunWithFontInput key(text, font_params, Range(0, 3),
+                                            false, 0, 0, false);
+
+  internal::TextRunHarfBuzz::FontParams other_script = font_params;
+  other_script.script = USCRIPT_GREEK;
+  internal::TextRunHarfBuzz::FontParams other_size = font_params;
+  other_size.font_size += 1;
+  internal::TextRunHarfBuzz::FontParams other_direction = font_params;
+  other_direction.is_rtl = !font_params.is_rtl;
+
+  internal::ShapeRunCache cache;
+  internal::TextRunHarfBuzz::ShapeOutput output;
+  output.width = 1.0f;
+  cache.Put(key, output);
+  float width = 1.0f;
+  for (const auto& params : {other_script, other_size, other_direction}) {
+    const internal::ShapeRunWithFontInput other_key(text, params, Range(0, 3),
+                                                    false, 0, 0, false);
+    EXPECT_FALSE(other_key == key);
+    EXPECT_NE(key.hash, other_key.hash);
+    EXPECT_FALSE(cache.Get(other_key));
+    output.width = ++width;
+    cache.Put(other_key, output);
+    ASSERT_TRUE(cache.Get(other_key));
+    EXPECT_EQ(width, cache.Get(other_key)->width);
+  }
+  ASSERT_TRUE(cache.Get(key));
+  EXPECT_EQ(1.0f, cache.Get(key)->width);
+  EXPECT_EQ(4U, cache.size());
+}
+
+// Ensures that the ShapeRunCache evicts its least recently used entries once
+// their approximate size exceeds the byte bound.
+TEST_F(RenderTextTest, HarfBuzz_ShapeRunCacheEvictsOverByteBound) {
+  RenderTextHarfBuzz* render_text = GetRenderText();
+  render_text->SetText(UTF8ToUTF16("a"));
+  const internal::TextRunHarfBuzz::FontParams font_params =
+      GetHarfBuzzRunList()->runs()[0]->font_params;
+
+  constexpr size_t kMaxBytes = 32 * 1024;
+  internal::ShapeRunCache cache(kMaxBytes);
+  internal::TextRunHarfBuzz::ShapeOutput output;
+  output.glyphs.resize(1000);
+  output.positions.resize(1000);
+  output.glyph_to_char.resize(1000);
+
+  std::vector<internal::ShapeRunWithFontInput> keys;
+  for (int i = 0; i < 10; ++i) {
+    keys.emplace_back(base::NumberToString16(i), font_params, Range(0, 1),
+                      false, 0, 0, false);
+    cache.Put(keys.back(), output);
+    EXPECT_LE(cache.bytes(), kMaxBytes);
+  }
+  EXPECT_GT(cache.size(), 0U);
+  EXPECT_LT(cache.size(), keys.size());
+  EXPECT_TRUE(cache.Get(keys.back()));
+  EXPECT_FALSE(cache.Get(keys.front()));
+
+  cache.Clear();
+  EXPECT_EQ(0U, cache.size());
+  EXPECT_EQ(0U, cache.bytes());
+}
+
+// Ensures that shaping the same text again is served from the shared
+// ShapeRunCache.
+TEST_F(RenderTextTest, HarfBuzz_ShapeRunCacheHit) {
+  internal::ShapeRunCache* cache = GetShapeRunCache();
+  cache->Clear();
+
+  const base::string16 text = UTF8ToUTF16("Hello World");
+  RenderTextHarfBuzz* render_text = GetRenderText();
+  render_text->SetText(text);
+  render_text->GetStringSize();
+  const size_t cache_size = cache->size();
+  const int hits = cache->hits();
+  EXPECT_GT(cache_size, 0U);
+  EXPECT_GT(cache->lookups(), 0);
+
+  std::unique_ptr<RenderTextHarfBuzz> other_render_text =
+      std::make_unique<RenderTextHarfBuzz>();
+  other_render_text->SetFontList(render_text->font_list());
+  other_render_text->SetText(text);
+  other_render_text->GetStringSize();
+  EXPECT_EQ(cache_size, cache->size());
+  EXPECT_GT(cache->hits(), hits);
+}
+
 TEST_F(RenderTextTest, HarfBuzz_RunDirection) {
   RenderTextHarfBuzz* render_text = GetRenderText();
   const base::string16 mixed = UTF8ToUTF16("\u05D0\u05D11234\u05D2\u05D3abc");
@@ -8,8 +8,14 @@
 #include <stdint.h>
 #include <string.h>
 #include <algorithm>
+#include <tuple>
 
 #include "base/check_op.h"
+#include "base/containers/mru_cache.h"
+#include "base/no_destructor.h"
+#include "base/synchronization/lock.h"
+#include "base/thread_annotations.h"
+#include "build/build_config.h"
 #include "third_party/skia/include/core/SkBitmap.h"
 #include "third_party/skia/include/core/SkCanvas.h"
 #include "third_party/skia/include/core/SkColorFilter.h"
@@ -20,6 +26,213 @@
 #include "ui/gfx/geometry/point.h"
 #include "ui/gfx/geometry/size.h"
 
+#if defined(ARCH_CPU_X86_FAMILY)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON__) || defined(__ARM_NEON)
+#include <arm_neon.h>
+#define SKBITMAP_OPERATIONS_USE_NEON
+#endif
+
+namespace {
+
+// Blends one row of pixels per channel as
+// (first * (256 - second_weight) + second * second_weight) / 256.
+// |second_weight| must be in [1, 255].
+void BlendRow(const uint32_t* first,
+              const uint32_t* second,
+              uint32_t* dst,
+              int width,
+              int second_weight) {
+  const int first_weight = 256 - second_weight;
+  int x = 0;
+#if defined(ARCH_CPU_X86_FAMILY)
+  const __m128i zero = _mm_setzero_si128();
+  const __m128i fw = _mm_set1_epi16(static_cast<int16_t>(first_weight));
+  const __m128i sw = _mm_set1_epi16(static_cast<int16_t>(second_weight));
+  for (; x + 4 <= width; x += 4) {
+    __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(first + x));
+    __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(second + x));
+    __m128i lo = _mm_add_epi16(_mm_mullo_epi16(_mm_unpacklo_epi8(a, zero), fw),
+                               _mm_mullo_epi16(_mm_unpacklo_epi8(b, zero), sw));
+    __m128i hi = _mm_add_epi16(_mm_mullo_epi16(_mm_unpackhi_epi8(a, zero), fw),
+                               _mm_mullo_epi16(_mm_unpackhi_epi8(b, zero), sw));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + x),
+                     _mm_packus_epi16(_mm_srli_epi16(lo, 8),
+                                      _mm_srli_epi16(hi, 8)));
+  }
+#elif defined(SKBITMAP_OPERATIONS_USE_NEON)
+  const uint8x8_t fw = vdup_n_u8(static_cast<uint8_t>(first_weight));
+  const uint8x8_t sw = vdup_n_u8(static_cast<uint8_t>(second_weight));
+  for (; x + 4 <= width; x += 4) {
+    uint8x16_t a = vld1q_u8(reinterpret_cast<const uint8_t*>(first + x));
+    uint8x16_t b = vld1q_u8(reinterpret_cast<const uint8_t*>(second + x));
+    uint16x8_t lo = vmlal_u8(vmull_u8(vget_low_u8(a), fw), vget_low_u8(b), sw);
+    uint16x8_t hi =
+        vmlal_u8(vmull_u8(vget_high_u8(a), fw), vget_high_u8(b), sw);
+    vst1q_u8(reinterpret_cast<uint8_t*>(dst + x),
+             vcombine_u8(vshrn_n_u16(lo, 8), vshrn_n_u16(hi, 8)));
+  }
+#endif
+  for (; x < width; ++x) {
+    uint32_t a = first[x];
+    uint32_t b = second[x];
+    uint32_t result = 0;
+    for (int shift = 0; shift < 32; shift += 8) {
+      uint32_t channel = (((a >> shift) & 0xFF) * first_weight +
+                          ((b >> shift) & 0xFF) * second_weight) >>
+                         8;
+      result |= channel << shift;
+    }
+    dst[x] = result;
+  }
+}
+
+// Scales every channel of one row of pixels by the alpha of the matching
+// pixel in |alpha|, exactly as SkAlphaMulQ(rgb, SkAlpha255To256(alpha)).
+void MaskRow(const uint32_t* rgb,
+             const uint32_t* alpha,
+             uint32_t* dst,
+             int width) {
+  int x = 0;
+#if defined(ARCH_CPU_X86_FAMILY)
+  const __m128i zero = _mm_setzero_si128();
+  const __m128i alpha_mask = _mm_set1_epi32(0xFF);
+  for (; x + 4 <= width; x += 4) {
+    __m128i c = _mm_loadu_si128(reinterpret_cast<const __m128i*>(rgb + x));
+    __m128i a = _mm_and_si128(
+        _mm_srli_epi32(
+            _mm_loadu_si128(reinterpret_cast<const __m128i*>(alpha + x)),
+            SK_A32_SHIFT),
+        alpha_mask);
+    // SkAlpha255To256(), then the scale of each pixel in both 16-bit halves of
+    // its lane, then spread over the four channels of each pixel.
+    __m128i scale = _mm_add_epi32(a, _mm_srli_epi32(a, 7));
+    scale = _mm_or_si128(scale, _mm_slli_epi32(scale, 16));
+    __m128i scale_lo = _mm_unpacklo_epi32(scale, scale);
+    __m128i scale_hi = _mm_unpackhi_epi32(scale, scale);
+    __m128i lo = _mm_srli_epi16(
+        _mm_mullo_epi16(_mm_unpacklo_epi8(c, zero), scale_lo), 8);
+    __m128i hi = _mm_srli_epi16(
+        _mm_mullo_epi16(_mm_unpackhi_epi8(c, zero), scale_hi), 8);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + x),
+                     _mm_packus_epi16(lo, hi));
+  }
+#elif defined(SKBITMAP_OPERATIONS_USE_NEON)
+  for (; x + 4 <= width; x += 4) {
+    uint8x16_t c = vld1q_u8(reinterpret_cast<const uint8_t*>(rgb + x));
+    uint32x4_t a = vandq_u32(vshrq_n_u32(vld1q_u32(alpha + x), SK_A32_SHIFT),
+                             vdupq_n_u32(0xFF));
+    uint32x4_t scale = vaddq_u32(a, vshrq_n_u32(a, 7));
+    uint16x8_t scale16 =
+        vreinterpretq_u16_u32(vorrq_u32(scale, vshlq_n_u32(scale, 16)));
+    uint16x8x2_t scales = vzipq_u16(scale16, scale16);
+    uint16x8_t lo =
+        vshrq_n_u16(vmulq_u16(vmovl_u8(vget_low_u8(c)), scales.val[0]), 8);
+    uint16x8_t hi =
+        vshrq_n_u16(vmulq_u16(vmovl_u8(vget_high_u8(c)), scales.val[1]), 8);
+    vst1q_u8(reinterpret_cast<uint8_t*>(dst + x),
+             vcombine_u8(vmovn_u16(lo), vmovn_u16(hi)));
+  }
+#endif
+  for (; x < width; ++x) {
+    unsigned scale = SkAlpha255To256(SkGetPackedA32(alpha[x]));
+    dst[x] = SkAlphaMulQ(rgb[x], scale);
+  }
+}
+
+// Upper bound on the pixel bytes held by the derived bitmap cache. Larger
+// results than a quarter of this are not cached.
+constexpr size_t kMaxDerivedBitmapCacheBytes = 4 * 1024 * 1024;
+
+enum class DerivedBitmapOperation { kBlended, kMasked, kHSLShifted };
+
+// Identifies the pixels of an immutable bitmap: a generation id names the
+// contents of a whole pixel ref, and subsets share their parent's pixel ref.
+using BitmapId = std::tuple<uint32_t, int, int, int, int>;
+
+BitmapId GetBitmapId(const SkBitmap& bitmap) {
+  SkIPoint origin = bitmap.pixelRefOrigin();
+  return BitmapId(bitmap.getGenerationID(), origin.x(), origin.y(),
+                  bitmap.width(), bitmap.height());
+}
+
+using DerivedBitmapKey = std::
+    tuple<DerivedBitmapOperation, BitmapId, BitmapId, double, double, double>;
+
+class DerivedBitmapCache {
+ public:
+  static DerivedBitmapCache* Get() {
+    static base::NoDestructor<DerivedBitmapCache> cache;
+    return cache.get();
+  }
+
+  DerivedBitmapCache() : entries_(Entries::NO_AUTO_EVICT) {}
+  DerivedBitmapCache(const DerivedBitmapCache&) = delete;
+  DerivedBitmapCache& operator=(const DerivedBitmapCache&) = delete;
+
+  bool Lookup(const DerivedBitmapKey& key, SkBitmap* result) {
+    base::AutoLock lock(lock_);
+    auto it = entries_.Get(key);
+    if (it == entries_.end())
+      return false;
+    *result = it->second;
+    return true;
+  }
+
+  void Put(const DerivedBitmapKey& key, const SkBitmap& bitmap) {
+    size_t size = bitmap.computeByteSize();
+    if (size > kMaxDerivedBitmapCacheBytes / 4)
+      return;
+
+    base::AutoLock lock(lock_);
+    // Another thread may have created the same bitmap meanwhile.
+    auto existing = entries_.Peek(key);
+    if (existing != entries_.end()) {
+      total_bytes_ -= existing->second.computeByteSize();
+      entries_.Erase(existing);
+    }
+    entries_.Put(key, bitmap);
+    total_bytes_ += size;
+    while (total_bytes_ > kMaxDerivedBitmapCacheBytes) {
+      auto oldest = entries_.rbegin();
+      total_bytes_ -= oldest->second.computeByteSize();
+      entries_.Erase(oldest);
+    }
+  }
+
+  void Clear() {
+    base::AutoLock lock(lock_);
+    entries_.Clear();
+    total_bytes_ = 0;
+  }
+
+ private:
+  using Entries = base::MRUCache<DerivedBitmapKey, SkBitmap>;
+
+  base::Lock lock_;
+  Entries entries_ GUARDED_BY(lock_);
+  size_t total_bytes_ GUARDED_BY(lock_) = 0;
+};
+
+template <typename CreateFunction>
+SkBitmap GetOrCreateDerivedBitmap(const DerivedBitmapKey& key,
+                                  bool cacheable,
+                                  CreateFunction create) {
+  if (!cacheable)
+    return create();
+
+  DerivedBitmapCache* cache = DerivedBitmapCache::Get();
+  SkBitmap result;
+  if (cache->Lookup(key, &result))
+    return result;
+  result = create();
+  result.setImmutable();
+  cache->Put(key, result);
+  return result;
+}
+
+}  // namespace
+
 // static
 SkBitmap SkBitmapOperations::CreateInvertedBitmap(const SkBitmap& image) {
   DCHECK(image.colorType() == kN32_SkColorType);
@@ -31,11 +244,10 @@ SkBitmap SkBitmapOperations::CreateInvertedBitmap(const SkBitmap& image) {
     uint32_t* image_row = image.getAddr32(0, y);
     uint32_t* dst_row = inverted.getAddr32(0, y);
 
-    for (int x = 0; x < image.width(); ++x) {
-      uint32_t image_pixel = image_row[x];
-      dst_row[x] = (image_pixel & 0xFF000000) |
-                   (0x00FFFFFF - (image_pixel & 0x00FFFFFF));
-    }
+    // Subtracting each color channel from 255 is the same as flipping its
+    // bits, which the compiler vectorizes.
+    for (int x = 0; x < image.width(); ++x)
+      dst_row[x] = image_row[x] ^ 0x00FFFFFF;
   }
 
   return inverted;
@@ -62,28 +274,14 @@ SkBitmap SkBitmapOperations::CreateBlendedBitmap(const SkBitmap& first,
   SkBitmap blended;
   blended.allocN32Pixels(first.width(), first.height());
 
-  double first_alpha = 1 - alpha;
+  // Blend in 8.8 fixed point so that both weights fit in a byte. The early
+  // returns above keep |second_weight| in [1, 255].
+  int second_weight = static_cast<int>(alpha * 256 + 0.5);
+  second_weight = std::min(std::max(second_weight, 1), 255);
 
   for (int y = 0; y < first.height(); ++y) {
-    uint32_t* first_row = first.getAddr32(0, y);
-    uint32_t* second_row = second.getAddr32(0, y);
-    uint32_t* dst_row = blended.getAddr32(0, y);
-
-    for (int x = 0; x < first.width(); ++x) {
-      uint32_t first_pixel = first_row[x];
-      uint32_t second_pixel = second_row[x];
-
-      int a = static_cast<int>((SkColorGetA(first_pixel) * first_alpha) +
-                               (SkColorGetA(second_pixel) * alpha));
-      int r = static_cast<int>((SkColorGetR(first_pixel) * first_alpha) +
-                               (SkColorGetR(second_pixel) * alpha));
-      int g = static_cast<int>((SkColorGetG(first_pixel) * first_alpha) +
-                               (SkColorGetG(second_pixel) * alpha));
-      int b = static_cast<int>((SkColorGetB(first_pixel) * first_alpha) +
-                               (SkColorGetB(second_pixel) * alpha));
-
-      dst_row[x] = SkColorSetARGB(a, r, g, b);
-    }
+    BlendRow(first.getAddr32(0, y), second.getAddr32(0, y),
+             blended.getAddr32(0, y), first.width(), second_weight);
   }
 
   return blended;
@@ -102,15 +300,8 @@ SkBitmap SkBitmapOperations::CreateMaskedBitmap(const SkBitmap& rgb,
   masked.allocN32Pixels(rgb.width(), rgb.height());
 
   for (int y = 0; y < masked.height(); ++y) {
-    uint32_t* rgb_row = rgb.getAddr32(0, y);
-    uint32_t* alpha_row = alpha.getAddr32(0, y);
-    uint32_t* dst_row = masked.getAddr32(0, y);
-
-    for (int x = 0; x < masked.width(); ++x) {
-      unsigned alpha32 = SkGetPackedA32(alpha_row[x]);
-      unsigned scale = SkAlpha255To256(alpha32);
-      dst_row[x] = SkAlphaMulQ(rgb_row[x], scale);
-    }
+    MaskRow(rgb.getAddr32(0, y), alpha.getAddr32(0, y),
+            masked.getAddr32(0, y), masked.width());
   }
 
   return masked;
@@ -764,3 +955,41 @@ SkBitmap SkBitmapOperations::Rotate(const SkBitmap& source,
 
   return result;
 }
+
+// static
+SkBitmap SkBitmapOperations::GetOrCreateBlendedBitmap(const SkBitmap& first,
+                                                      const SkBitmap& second,
+                                                      double alpha) {
+  DerivedBitmapKey key(DerivedBitmapOperation::kBlended, GetBitmapId(first),
+                       GetBitmapId(second), alpha, 0, 0);
+  return GetOrCreateDerivedBitmap(
+      key, first.isImmutable() && second.isImmutable(),
+      [&]() { return CreateBlendedBitmap(first, second, alpha); });
+}
+
+// static
+SkBitmap SkBitmapOperations::GetOrCreateMaskedBitmap(const SkBitmap& rgb,
+                                                     const SkBitmap& alpha) {
+  DerivedBitmapKey key(DerivedBitmapOperation::kMasked, GetBitmapId(rgb),
+                       GetBitmapId(alpha), 0, 0, 0);
+  return GetOrCreateDerivedBitmap(
+      key, rgb.isImmutable() && alpha.isImmutable(),
+      [&]() { return CreateMaskedBitmap(rgb, alpha); });
+}
+
+// static
+SkBitmap SkBitmapOperations::GetOrCreateHSLShiftedBitmap(
+    const SkBitmap& bitmap,
+    const color_utils::HSL& hsl_shift) {
+  DerivedBitmapKey key(DerivedBitmapOperation::kHSLShifted,
+                       GetBitmapId(bitmap), BitmapId(), hsl_shift.h,
+                       hsl_shift.s, hsl_shift.l);
+  return GetOrCreateDerivedBitmap(
+      key, bitmap.isImmutable(),
+      [&]() { return CreateHSLShiftedBitmap(bitmap, hsl_shift); });
+}
+
+// static
+void SkBitmapOperations::ClearDerivedBitmapCache() {
+  DerivedBitmapCache::Get()->Clear();
+}
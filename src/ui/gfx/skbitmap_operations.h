@@ -109,6 +109,24 @@ class GFX_EXPORT SkBitmapOperations {
   // Rotates the given source bitmap clockwise by the requested amount.
   static SkBitmap Rotate(const SkBitmap& source, RotationAmount rotation);
 
+  // Variants of the above that return a previously created bitmap when called
+  // again with the same source pixels and parameters, for callers that derive
+  // the same images repeatedly, e.g. themed icons. Results are only cached
+  // when every source bitmap is immutable, since otherwise its pixels may
+  // change without its generation id changing. Cached results are shared and
+  // immutable. The cache is bounded in size and may be used from any thread.
+  static SkBitmap GetOrCreateBlendedBitmap(const SkBitmap& first,
+                                           const SkBitmap& second,
+                                           double alpha);
+  static SkBitmap GetOrCreateMaskedBitmap(const SkBitmap& first,
+                                          const SkBitmap& alpha);
+  static SkBitmap GetOrCreateHSLShiftedBitmap(
+      const SkBitmap& bitmap,
+      const color_utils::HSL& hsl_shift);
+
+  // Drops all bitmaps cached by the GetOrCreate*() methods.
+  static void ClearDerivedBitmapCache();
+
  private:
   SkBitmapOperations();  // Class for scoping only.
 
@@ -194,6 +194,75 @@ TEST(SkBitmapOperationsTest, CreateMaskedBitmap) {
   }
 }
 
+// Blend and mask bitmaps whose width isn't a multiple of the SIMD width, and
+// compare against per-pixel references.
+TEST(SkBitmapOperationsTest, BlendAndMaskOddWidth) {
+  const int src_w = 13, src_h = 3;
+  SkBitmap src_a;
+  FillDataToBitmap(src_w, src_h, &src_a);
+  SkBitmap src_b;
+  src_b.allocN32Pixels(src_w, src_h);
+  for (int y = 0, i = 0; y < src_h; y++) {
+    for (int x = 0; x < src_w; x++, i++)
+      *src_b.getAddr32(x, y) = SkPackARGB32(255 - i, i % 7, 255 - i, i);
+  }
+
+  const double alpha = 0.3;
+  SkBitmap blended =
+      SkBitmapOperations::CreateBlendedBitmap(src_a, src_b, alpha);
+  SkBitmap masked = SkBitmapOperations::CreateMaskedBitmap(src_a, src_b);
+  for (int y = 0; y < src_h; y++) {
+    for (int x = 0; x < src_w; x++) {
+      uint32_t a = *src_a.getAddr32(x, y);
+      uint32_t b = *src_b.getAddr32(x, y);
+      uint32_t expected_blend = SkColorSetARGB(
+          static_cast<int>(SkColorGetA(a) * (1 - alpha) +
+                           SkColorGetA(b) * alpha),
+          static_cast<int>(SkColorGetR(a) * (1 - alpha) +
+                           SkColorGetR(b) * alpha),
+          static_cast<int>(SkColorGetG(a) * (1 - alpha) +
+                           SkColorGetG(b) * alpha),
+          static_cast<int>(SkColorGetB(a) * (1 - alpha) +
+                           SkColorGetB(b) * alpha));
+      EXPECT_TRUE(ColorsClose(expected_blend, *blended.getAddr32(x, y)));
+
+      unsigned scale = SkAlpha255To256(SkGetPackedA32(b));
+      EXPECT_EQ(SkAlphaMulQ(a, scale), *masked.getAddr32(x, y));
+    }
+  }
+}
+
+// Derived bitmaps of immutable sources are shared; others are recreated.
+TEST(SkBitmapOperationsTest, GetOrCreateHSLShiftedBitmap) {
+  SkBitmapOperations::ClearDerivedBitmapCache();
+
+  SkBitmap src;
+  FillDataToBitmap(16, 16, &src);
+  color_utils::HSL grey = {-1, 0, -1};
+  color_utils::HSL darker = {-1, -1, 0.2};
+
+  SkBitmap mutable_1 =
+      SkBitmapOperations::GetOrCreateHSLShiftedBitmap(src, grey);
+  SkBitmap mutable_2 =
+      SkBitmapOperations::GetOrCreateHSLShiftedBitmap(src, grey);
+  EXPECT_NE(mutable_1.getPixels(), mutable_2.getPixels());
+
+  src.setImmutable();
+  SkBitmap grey_1 = SkBitmapOperations::GetOrCreateHSLShiftedBitmap(src, grey);
+  SkBitmap grey_2 = SkBitmapOperations::GetOrCreateHSLShiftedBitmap(src, grey);
+  EXPECT_EQ(grey_1.getPixels(), grey_2.getPixels());
+  EXPECT_TRUE(grey_1.isImmutable());
+  EXPECT_TRUE(BitmapsClose(
+      grey_1, SkBitmapOperations::CreateHSLShiftedBitmap(src, grey)));
+
+  SkBitmap dark = SkBitmapOperations::GetOrCreateHSLShiftedBitmap(src, darker);
+  EXPECT_NE(grey_1.getPixels(), dark.getPixels());
+
+  SkBitmapOperations::ClearDerivedBitmapCache();
+  SkBitmap grey_3 = SkBitmapOperations::GetOrCreateHSLShiftedBitmap(src, grey);
+  EXPECT_NE(grey_1.getPixels(), grey_3.getPixels());
+}
+
 // Make sure that when shifting a bitmap without any shift parameters,
 // the end result is close enough to the original (rounding errors
 // notwithstanding).